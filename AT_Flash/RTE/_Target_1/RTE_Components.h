@@ -16,6 +16,8 @@
  */
 #define CMSIS_device_header "at32f413.h"
 
+/* ArteryTek::Device:at32f413_firmware_library:crc:2.0.0 */
+#define RTE_DEVICE_STDPERIPHERALS_CRC
 /* ArteryTek::Device:at32f413_firmware_library:crm:2.0.0 */
 #define RTE_DEVICE_STDPERIPHERALS_CRM
 /* ArteryTek::Device:at32f413_firmware_library:flash:2.0.0 */
@@ -3,9 +3,9 @@
   *
   * @file      AT_START_F413_V1.2.c
   *
-  * @brief           AT-START-F413 V1.2.
+  * @brief     Аппаратный драйвер для работы с платой AT-START-F413 V1.2.
   * 
-  * @copyright Copyright (C) 2022 Awada Systems.   .
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
   *
   * @author    Larionov A.S. (larion.alex@mail.ru)
   *
@@ -15,6 +15,7 @@
 //---Includes-------------------------------------------------------------------//
 #include "AT_START_F413_V1.2.h"
 #include "at32f413_conf.h"
+#include "FLASH.h"
 //------------------------------------------------------------------------------//
 
 //---Private macros-------------------------------------------------------------//
@@ -39,6 +40,8 @@
 //------------------------------------------------------------------------------//
 
 //---Private variables----------------------------------------------------------//
+static uint32_t Irq_last_entry  = 0; /*!< Значение DWT CYCCNT при предыдущем входе в SysTick_Handler.  */
+static uint32_t Irq_latency_max = 0; /*!< Наибольшая задержка входа в SysTick_Handler в тактах ядра.  */
 //------------------------------------------------------------------------------//
 
 //---Private constants----------------------------------------------------------//
@@ -50,11 +53,11 @@
 //---Exported functions---------------------------------------------------------//
 
 /**
-  * @brief    .
-  * @details  :                                                 \n 
+  * @brief   Инициализация микроконтроллера.
+  * @details Настройки тактирования:                                                 \n 
   *          After a system reset, the HICK oscillator is selected as system clock.  \n 
   *          The internal frequency of the HICK clock is 48 MHz.                     \n 
-  *          .  -> internal HICK (48MHz) -> external HEXT (8MHz) -> PLL -> \n 
+  *          Вкл. питание -> internal HICK (48MHz) -> external HEXT (8MHz) -> PLL -> \n 
   *          -> 192MHz -> SCLK 192MHz -> AHB 192MHz -> /2 -> APB2 96 MHz             \n 
   *                                                |                                 \n 
   *                                                 -> /4 -> APB1 48 MHz
@@ -70,7 +73,7 @@ while(crm_hext_stable_wait() == ERROR) // Wait till hext is ready.
   {;}
 
 crm_pll_config(CRM_PLL_SOURCE_HEXT, CRM_PLL_MULT_24, CRM_PLL_OUTPUT_RANGE_GT72MHZ); // Config pll clock resource.
-crm_clock_source_enable(CRM_CLOCK_SOURCE_PLL, TRUE);                                // nable pll.
+crm_clock_source_enable(CRM_CLOCK_SOURCE_PLL, TRUE);                                // Еnable pll.
 
 while(crm_flag_get(CRM_PLL_STABLE_FLAG) != SET) // Wait till pll is ready.
   {;}
@@ -89,21 +92,21 @@ system_core_clock_update();       // Update system_core_clock global variable.
 NVIC_SetPriorityGrouping(NVIC_PRIORITY_GROUP_4); // Set the prigroup[10:8] bits according to nvic_prioritygroup value.
 
 CRM->apb2en_bit.gpiocen = SET;                             // GPIOC clock enable.
-//--- LED2 Red, PC2-----//
+//---Настройка LED2 Red, PC2-----//
 GPIOC->cfglr_bit.iomc2 &= 0;                               // Clear mode configuration.
 GPIOC->cfglr_bit.iofc2 &= 0;                               // Clear function configuration.
 GPIOC->cfglr_bit.iomc2 |= GPIO_MODE_OUTPUT_LARGE_STRENGTH; // Set mode configuration    : Output mode, large sourcing/sinking strength.
 GPIOC->cfglr_bit.iofc2 |= GPIO_FUNC_OUTPUT_PUSH_PULL;      // Set function configuration: General-purpose push-pull output.
 GPIOC->odt_bit.odt2     = LED_OFF;
 //-------------------------------//
-//--- LED3 White, PC3---//
+//---Настройка LED3 White, PC3---//
 GPIOC->cfglr_bit.iomc3 &= 0;                               // Clear mode configuration.
 GPIOC->cfglr_bit.iofc3 &= 0;                               // Clear function configuration.
 GPIOC->cfglr_bit.iomc3 |= GPIO_MODE_OUTPUT_LARGE_STRENGTH; // Set mode configuration    : Output mode, large sourcing/sinking strength.
 GPIOC->cfglr_bit.iofc3 |= GPIO_FUNC_OUTPUT_PUSH_PULL;      // Set function configuration: General-purpose push-pull output.
 GPIOC->odt_bit.odt3     = LED_OFF;
 //-------------------------------//
-//--- LED3 Green, PC5---//
+//---Настройка LED3 Green, PC5---//
 GPIOC->cfglr_bit.iomc5 &= 0;                               // Clear mode configuration.
 GPIOC->cfglr_bit.iofc5 &= 0;                               // Clear function configuration.
 GPIOC->cfglr_bit.iomc5 |= GPIO_MODE_OUTPUT_LARGE_STRENGTH; // Set mode configuration    : Output mode, large sourcing/sinking strength.
@@ -113,11 +116,12 @@ GPIOC->odt_bit.odt5     = LED_OFF;
 
 systick_clock_source_config(SYSTICK_CLOCK_SOURCE_AHBCLK_NODIV); // Config systick clock source.
 SysTick_Config(MS_TICK);                                        // Config systick reload value and enable interrupt.
+NVIC_SetPriority(SysTick_IRQn, 0);                              // Highest priority: SysTick is served during flash operations (FLASH_RAMFUNC_MODE).
 }
 //------------------------------------------------------------------------------//
 
 
-//---   SysTick----------------------------------------------------------//
+//---Функция ожидания на SysTick----------------------------------------------------------//
 void mDelay (uint32_t Delay)
 {
 __IO uint32_t  tmp = SysTick->CTRL; // Clear the COUNTFLAG first.
@@ -146,14 +150,87 @@ mDelay(100);
 GPIOC->odt_bit.odt5 = LED_OFF;
 mDelay(100);
 }
+//------------------------------------------------------------------------------//
+
 
+/**
+  * @brief   Запуск счётчика тактов ядра (DWT CYCCNT).
+  * @details Используется для замера времени выполнения функций в тактах ядра.  \n 
+  *          Счётчик сбрасывается в 0. Вызывается один раз при старте (Start_Latency_Probe): повторный   \n 
+  *          запуск во время замера задержки прерывания искажает результат Probe_IRQ_latency.
+  * @return  None.
+  */
+void Start_Cycle_Counter (void)
+{
+CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable DWT.
+DWT->CYCCNT       = 0;
+DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;     // Enable cycle counter.
+}
+//------------------------------------------------------------------------------//
 
 
+/**
+  * @brief   Чтение счётчика тактов ядра (DWT CYCCNT).
+  * @return  uint32_t - количество тактов ядра с момента запуска счётчика.
+  */
+uint32_t Get_Cycle_Counter (void)
+{
+return DWT->CYCCNT;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запуск замера задержки обработки прерывания SysTick.
+  * @details Сбрасывает результат предыдущего замера и запускает счётчик тактов ядра.
+  * @return  None.
+  */
+void Start_Latency_Probe (void)
+{
+Start_Cycle_Counter();
+Irq_last_entry  = 0;
+Irq_latency_max = 0;
+}
+//------------------------------------------------------------------------------//
 
 
+/**
+  * @brief   Замер задержки обработки прерывания SysTick.
+  * @details Вызывается первой командой SysTick_Handler. Задержка - число тактов ядра от запроса прерывания  \n 
+  *          (перезагрузки SysTick) до входа в обработчик. Если ядро стояло дольше периода SysTick        \n 
+  *          (например, выборка команд из FLASH во время стирания), пропущенные периоды определяются     \n 
+  *          по DWT CYCCNT и добавляются к задержке.                                                      \n 
+  *          При FLASH_RAMFUNC_MODE = 1 размещается в SRAM.
+  * @return  None.
+  */
+FLASH_RAMFUNC void Probe_IRQ_latency (void)
+{
+uint32_t period  = SysTick->LOAD + 1;
+uint32_t latency = SysTick->LOAD - SysTick->VAL; // Тактов с последней перезагрузки SysTick.
+uint32_t now     = DWT->CYCCNT;
+uint32_t ticks;
 
+if (Irq_last_entry != 0)
+  {
+  ticks = (now - Irq_last_entry + period / 2) / period; // Периодов SysTick с предыдущего входа.
+  if (ticks > 1)
+    latency += (ticks - 1) * period;                     // Пропущенные запросы SysTick.
+  if (latency > Irq_latency_max)
+    Irq_latency_max = latency;
+  }
+Irq_last_entry = now;
+}
+//------------------------------------------------------------------------------//
 
 
+/**
+  * @brief   Результат замера задержки обработки прерывания SysTick.
+  * @return  uint32_t - наибольшая задержка входа в SysTick_Handler в тактах ядра с момента Start_Latency_Probe.
+  */
+uint32_t Get_IRQ_Latency_max (void)
+{
+return Irq_latency_max;
+}
 //------------------------------------------------------------------------------//
 
 
@@ -3,160 +3,188 @@
   * 
   * @file      AT_flash.c
   * 
-  * @brief      flash  AT32F413RCT7.
+  * @brief     Драйвер flash для AT32F413RCT7.
   * 
-  * @details       flash    AT32F413.
+  * @details   Функции для работы с flash в микроконтроллерах семейства AT32F413.
   *
-  * @warning   **!**                                                                                              \n 
-  *    : 
-  *                       +  at32f413_flash.c -     flash  Artery;
-  *                       +  at32f413_flash.h - header for at32f413_flash.c.
+  * @warning   **ВАЖНО!**                                                                                              \n 
+  * Для работы драйвера требуется: 
+  *                       + файл at32f413_flash.c - аппаратный драйвер работы с flash от Artery;
+  *                       + файл at32f413_flash.h - header for at32f413_flash.c.
   *
   * **Manual** \n 
-  *     :
-  * - Write_Config_to_flash (uint32_t *Data) -   FLASH    Config Page.               \n 
-  *           uint32_t   Config_struct.                    \n 
-  *      /    / FLASH   ADDR_CONFIG_PAGE.
+  * В драйвере реализованы следующие функции:
+  * - Read_MCU_FMD (void) - чтение размера FLASH памяти микроконтроллера в Kbyte.
   *
-  * - Read_Config_from_flash (Config_struct* Config) -      FLASH                    \n 
-  *      Config_struct.
-  *   
-  * - Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants) -             \n 
-  *      RO_Constants_struct.
+  * - Calc_CRC32 (const uint32_t *Words, uint32_t Amount) - CRC32 на блоке CRC (записи Config Page, RO Constants        \n 
+  *   и области FLASH для Verify_Region_of_flash). CRC секторов контроллера flash (flash_crc_calibrate) не используется:  \n 
+  *   его результат не совпадает с Calc_CRC32_soft и не воспроизводится на ПК (Pack, Diff).
   *
-  * - Write_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words) -   FLASH   .
+  * - Unlock_flash, Lock_flash, Erase_Page_of_flash, Program_Words_to_flash, Get_Page_Size_of_flash -                  \n 
+  *   функции доступа к контроллеру flash,                                                                              \n 
+  *   через которые надаппаратный драйвер (FLASH.c) ведёт журнал Config Page                                           \n 
+  *   (Write_Config_to_flash, Read_Config_from_flash) и записывает массивы слов (Write_Words_to_flash).
   *
-  * **  FLASH   ** \n 
-  *    AT32F403AR  FLASH    :
+  * - Init_flash_RAM_mode (void) - перенос таблицы векторов в SRAM (только при FLASH_RAMFUNC_MODE = 1).
+  *
+  * - Start_Erase_Page_of_flash, Start_Program_Word_of_flash, Enable_flash_IRQ, Disable_flash_IRQ, FLASH_IRQHandler -        \n 
+  *   запуск операций контроллера flash без ожидания и прерывание по окончании операции для асинхронной записи             \n 
+  *   (Write_Words_to_flash_async).
+  *
+  * - Get_Flash_stats (Flash_stats_struct *Stats) - статистика операций контроллера flash с момента старта (FLASH_STATS = 1): \n 
+  *   количество разблокировок, стёртых секторов и запрограммированных слов, время операций в тактах DWT->CYCCNT         \n 
+  *   (суммарное и наибольшее), таймауты, ошибки проверки записанных слов и последняя ошибка с адресом.              \n 
+  *   Итерации ожидания OBF считаются в циклах ожидания этого файла (FLASH_BATCHED_PROGRAM, FLASH_RAMFUNC_MODE),      \n 
+  *   ожидание внутри flash_sector_erase и flash_word_program не учитывается. Время операций без ожидания             \n 
+  *   измеряется от запуска до FLASH_IRQHandler.
+  *
+  * **Режим FLASH_RAMFUNC_MODE** \n 
+  * Во время стирания и программирования выборка команд из FLASH останавливает ядро.                    \n 
+  * При FLASH_RAMFUNC_MODE = 1 функции стирания/программирования размещаются в SRAM (FLASH_RAMFUNC)     \n 
+  * и работают с регистрами контроллера flash напрямую, без функций at32f413_flash.c. Для сборки        \n 
+  * требуется scatter-файл AT_Flash_ramfunc.sct (Options for Target -> Linker -> Scatter File).         \n 
+  * На время операции FLASH BASEPRI маскирует прерывания с приоритетом FLASH_RAM_ISR_PRIO_LIMIT и ниже. \n 
+  * Прерывания с более высоким приоритетом продолжают обслуживаться, поэтому их обработчики и всё,       \n 
+  * что они вызывают, должны быть помечены FLASH_RAMFUNC, а таблица векторов перенесена в SRAM          \n 
+  * (Init_flash_RAM_mode). Конец FLASH (Flash_geometry.c) копируется в SRAM при Unlock_flash,          \n 
+  * поэтому функции FLASH_RAMFUNC не вызывают функции из FLASH.
+  *
+  * **Особенности организации FLASH памяти в проекте** \n 
+  * В контроллерах серии AT32F403AR размер FLASH может иметь следующие значения:
   * - 256 Kbyte  (AT32F403ARC),
   * - 512 Kbyte  (AT32F403ARE),
   * - 1024 Kbyte (AT32F403ARG).
   * \n \n 
   *
-  * ** FLASH   AT32F403ARG (1024 Kbyte)** \n 
+  * **Организация FLASH памяти для AT32F403ARG (1024 Kbyte)** \n 
   *
   * | Block             | Bank               | Name              | Address Range             | Size (bytes) |
   * | ----------------- | :----------------: | :---------------: | :-----------------------: | :----------: |
-  * | Main Flash memory | Bank 1 (512 Kbyte) | Page 0            | 0x0800 0000  0x0800 07FF | 2 KB         |
-  * | ^                 | ^                  | Page 1            | 0x0800 0800  0x0800 0FFF | 2 KB         |
-  * | ^                 | ^                  | Page 2            | 0x0800 1000  0x0800 17FF | 2 KB         |
+  * | Main Flash memory | Bank 1 (512 Kbyte) | Page 0            | 0x0800 0000 – 0x0800 07FF | 2 KB         |
+  * | ^                 | ^                  | Page 1            | 0x0800 0800 – 0x0800 0FFF | 2 KB         |
+  * | ^                 | ^                  | Page 2            | 0x0800 1000 – 0x0800 17FF | 2 KB         |
   * | ^                 | ^                  | ...               | ...                       | ...          |
-  * | ^                 | ^                  | Page 255          | 0x0807 F800  0x0807 FFFF | 2 KB         |
-  * | ^                 | Bank 2 (512 Kbyte) | Page 256          | 0x0808 0000  0x0808 07FF | 2 KB         |
-  * | ^                 | ^                  | Page 257          | 0x0808 0800  0x0808 0FFF | 2 KB         |
-  * | ^                 | ^                  | Page 258          | 0x0808 1000  0x0808 17FF | 2 KB         |
+  * | ^                 | ^                  | Page 255          | 0x0807 F800 – 0x0807 FFFF | 2 KB         |
+  * | ^                 | Bank 2 (512 Kbyte) | Page 256          | 0x0808 0000 – 0x0808 07FF | 2 KB         |
+  * | ^                 | ^                  | Page 257          | 0x0808 0800 – 0x0808 0FFF | 2 KB         |
+  * | ^                 | ^                  | Page 258          | 0x0808 1000 – 0x0808 17FF | 2 KB         |
   * | ^                 | ^                  | ...               | ...                       | ...          |
-  * | ^                 | ^                  | Page 511          | 0x080F F800  0x080F FFFF | 2 KB         |
-  * | External memory   | 16 MB              | Page 0            | 0x0840 0000  0x0840 0FFF | 4 KB         |
-  * | ^                 | ^                  | Page 1            | 0x0840 1000  0x0840 1FFF | 4 KB         |
-  * | ^                 | ^                  | Page 2            | 0x0840 2000  0x0840 2FFF | 4 KB         |
+  * | ^                 | ^                  | Page 511          | 0x080F F800 – 0x080F FFFF | 2 KB         |
+  * | External memory   | 16 MB              | Page 0            | 0x0840 0000 – 0x0840 0FFF | 4 KB         |
+  * | ^                 | ^                  | Page 1            | 0x0840 1000 – 0x0840 1FFF | 4 KB         |
+  * | ^                 | ^                  | Page 2            | 0x0840 2000 – 0x0840 2FFF | 4 KB         |
   * | ^                 | ^                  | ...               | ...                       | ...          |
-  * | ^                 | ^                  | Page 4095         | 0x093F F000  0x093F FFFF | 4 KB         |
-  * | Information Block |                    | Boot loader       | 0x1FFF B000  0x1FFF EFFF | 16 KB        |
-  * | ^                 | ^                  | User option bytes | 0x1FFF F800  0x1FFF F82F | 48 B         |
+  * | ^                 | ^                  | Page 4095         | 0x093F F000 – 0x093F FFFF | 4 KB         |
+  * | Information Block |                    | Boot loader       | 0x1FFF B000 – 0x1FFF EFFF | 16 KB        |
+  * | ^                 | ^                  | User option bytes | 0x1FFF F800 – 0x1FFF F82F | 48 B         |
   *  \n 
   *
-  * ** FLASH   AT32F403ARE (512 Kbyte)** \n 
+  * **Организация FLASH памяти для AT32F403ARE (512 Kbyte)** \n 
   *
   * | Block             | Bank               | Name              | Address Range             | Size (bytes) |
   * | ------------------| :----------------: | :---------------: | :-----------------------: | :----------: |
-  * | Main Flash Block  | Bank 1 (512 Kbyte) | Page 0            | 0x0800 0000  0x0800 07FF | 2 KB         |
-  * | ^                 | ^                  | Page 1            | 0x0800 0800  0x0800 0FFF | 2 KB         |
+  * | Main Flash Block  | Bank 1 (512 Kbyte) | Page 0            | 0x0800 0000 – 0x0800 07FF | 2 KB         |
+  * | ^                 | ^                  | Page 1            | 0x0800 0800 – 0x0800 0FFF | 2 KB         |
   * | ^                 | ^                  | Page 2            | 0x0800 1000 - 0x0800 17FF | 2 KB         |
   * | ^                 | ^                  | ...               | ...                       | ...          |
-  * | ^                 | ^                  | Page 255          | 0x0807 F800  0x0807 FFFF | 2 KB         |
-  * | External memory   | 16 MB              | Page 0            | 0x0840 0000  0x0840 0FFF | 4 KB         |
-  * | ^                 | ^                  | Page 1            | 0x0840 1000  0x0840 1FFF | 4 KB         |
-  * | ^                 | ^                  | Page 2            | 0x0840 2000  0x0840 2FFF | 4 KB         |
+  * | ^                 | ^                  | Page 255          | 0x0807 F800 – 0x0807 FFFF | 2 KB         |
+  * | External memory   | 16 MB              | Page 0            | 0x0840 0000 – 0x0840 0FFF | 4 KB         |
+  * | ^                 | ^                  | Page 1            | 0x0840 1000 – 0x0840 1FFF | 4 KB         |
+  * | ^                 | ^                  | Page 2            | 0x0840 2000 – 0x0840 2FFF | 4 KB         |
   * | ^                 | ^                  | ...               | ...                       | ...          |
-  * | ^                 | ^                  | Page 4095         | 0x093F F000  0x093F FFFF | 4 KB         |
-  * | Information Block |                    | Boot loader       | 0x1FFF B000  0x1FFF EFFF | 16 KB        |
-  * | ^                 | ^                  | User option bytes | 0x1FFF F800  0x1FFF F82F | 48 B         |
+  * | ^                 | ^                  | Page 4095         | 0x093F F000 – 0x093F FFFF | 4 KB         |
+  * | Information Block |                    | Boot loader       | 0x1FFF B000 – 0x1FFF EFFF | 16 KB        |
+  * | ^                 | ^                  | User option bytes | 0x1FFF F800 – 0x1FFF F82F | 48 B         |
   * \n 
   *
-  * ** FLASH   AT32F403ARC (256 Kbyte)** \n 
+  * **Организация FLASH памяти для AT32F403ARC (256 Kbyte)** \n 
   *
   * | Block             | Bank               | Name              | Address Range             | Size (bytes) |
   * | ------------------| :----------------: | :---------------: | :-----------------------: | :----------: |
-  * | Main Flash Block  | Bank 1 (256 Kbyte) | Page 0            | 0x0800 0000  0x0800 07FF | 2 KB         |
-  * | ^                 | ^                  | Page 1            | 0x0800 0800  0x0800 0FFF | 2 KB         |
-  * | ^                 | ^                  | Page 2            | 0x0800 1000  0x0800 17FF | 2 KB         |
+  * | Main Flash Block  | Bank 1 (256 Kbyte) | Page 0            | 0x0800 0000 – 0x0800 07FF | 2 KB         |
+  * | ^                 | ^                  | Page 1            | 0x0800 0800 – 0x0800 0FFF | 2 KB         |
+  * | ^                 | ^                  | Page 2            | 0x0800 1000 – 0x0800 17FF | 2 KB         |
   * | ^                 | ^                  | ...               | ...                       | ...          |
-  * | ^                 | ^                  | Page 127          | 0x0803 F800  0x0803 FFFF | 2 KB         |
-  * | External memory   | 16 MB              | Page 0            | 0x0840 0000  0x0840 0FFF | 4 KB         |
-  * | ^                 | ^                  | Page 1            | 0x0840 1000  0x0840 1FFF | 4 KB         |
-  * | ^                 | ^                  | Page 2            | 0x0840 2000  0x0840 2FFF | 4 KB         |
+  * | ^                 | ^                  | Page 127          | 0x0803 F800 – 0x0803 FFFF | 2 KB         |
+  * | External memory   | 16 MB              | Page 0            | 0x0840 0000 – 0x0840 0FFF | 4 KB         |
+  * | ^                 | ^                  | Page 1            | 0x0840 1000 – 0x0840 1FFF | 4 KB         |
+  * | ^                 | ^                  | Page 2            | 0x0840 2000 – 0x0840 2FFF | 4 KB         |
   * | ^                 | ^                  | ...               | ...                       | ...          |
-  * | ^                 | ^                  | Page 4095         | 0x093F F000  0x093F FFFF | 4 KB         |
-  * | Information Block |                    | Boot loader       | 0x1FFF B000  0x1FFF EFFF | 16 KB        |
-  * | ^                 | ^                  | User option bytes | 0x1FFF F800  0x1FFF F82F | 48 B         |
+  * | ^                 | ^                  | Page 4095         | 0x093F F000 – 0x093F FFFF | 4 KB         |
+  * | Information Block |                    | Boot loader       | 0x1FFF B000 – 0x1FFF EFFF | 16 KB        |
+  * | ^                 | ^                  | User option bytes | 0x1FFF F800 – 0x1FFF F82F | 48 B         |
   * \n 
   *
-  *  FLASH      (- -)   (  ). \n 
-  *         128 Kbyte FLASH .                                            \n 
-  * ,     AT32F403AR c  FLASH  256 Kbyte  .            \n 
-  *   ()    FLASH  (    )                   \n 
-  *     AT32F403AR.                                                                              \n 
-  *          Bank 1 Page0...Page63.                                     \n 
+  * Память FLASH используется в соответствии с установленной (кем-то когда-то) картой памяти (такой способ организации). \n 
+  * Для хранения этой карты памяти требуется не менее 128 Kbyte FLASH памяти.                                            \n 
+  * Подразумевается, что используется контроллер серии AT32F403AR c объёмом FLASH памяти 256 Kbyte или более.            \n 
+  * В таблице (ниже) представлен способ организации FLASH памяти (с учётом установленной карты памяти)                   \n 
+  * для всех контроллеров серии AT32F403AR.                                                                              \n 
+  * Вся карта памяти во всех контроллерах серии размещается в Bank 1 Page0...Page63.                                     \n 
   * \n 
   * 
-  * **     AT32F403AR**
-  * |         |        Bank        |      |            |    |   |
+  * **Карта памяти для микроконтроллеров серии AT32F403AR**
+  * |    Назначение     |        Bank        |  Номер страницы   |     Диапазон адресов      | Занимаемый объем  | Число страниц |
   * | ----------------- | :----------------: | :---------------: | :-----------------------: | :---------------: | :-----------: |
-  * | Bootloader        | Bank 1 (256 Kbyte) | Page 0            | 0x0800 0000  0x0800 07FF | 28 Kbyte (0x7000) | 14  2 KB    |
+  * | Bootloader        | Bank 1 (256 Kbyte) | Page 0            | 0x0800 0000 – 0x0800 07FF | 28 Kbyte (0x7000) | 14 по 2 KB    |
   * | ^                 | ^                  | ...               | ...                       | ^                 | ^             |
-  * | ^                 | ^                  | Page 13           | 0x0800 6800  0x0800 6FFF | ^                 | ^             |
-  * | Main Programm     | ^                  | Page 14           | 0x0800 7000  0x0800 77FF | 48 Kbyte (0xC000) | 24  2 KB    |
+  * | ^                 | ^                  | Page 13           | 0x0800 6800 – 0x0800 6FFF | ^                 | ^             |
+  * | Main Programm     | ^                  | Page 14           | 0x0800 7000 – 0x0800 77FF | 48 Kbyte (0xC000) | 24 по 2 KB    |
   * | ^                 | ^                  | ...               | ...                       | ^                 | ^             |
-  * | ^                 | ^                  | Page 37           | 0x0801 2800  0x0801 2FFF | ^                 | ^             |
-  * | Download Buffer   | ^                  | Page 38           | 0x0800 3000  0x0800 37FF | 48 Kbyte (0xC000) | 24  2 KB    |
+  * | ^                 | ^                  | Page 37           | 0x0801 2800 – 0x0801 2FFF | ^                 | ^             |
+  * | Download Buffer   | ^                  | Page 38           | 0x0800 3000 – 0x0800 37FF | 48 Kbyte (0xC000) | 24 по 2 KB    |
   * | ^                 | ^                  | ...               | ...                       | ^                 | ^             |
-  * | ^                 | ^                  | Page 61           | 0x0801 E800  0x0801 EFFF | ^                 | ^             |
-  * | Config Page       | ^                  | Page 62           | 0x0801 F000  0x0801 F7FF | 2 Kbyte (0x800)   | 1  2 KB     |
-  * | RO Constants      | ^                  | Page 63           | 0x0801 F800  0x0801 FFFF | 2 Kbyte (0x800)   | 1  2 KB     |
-  * | Unused            | ^                  | Page 64           | 0x0802 0000  0x0802 07FF | 2 Kbyte (0x800)   | 1  2 KB     |
+  * | ^                 | ^                  | Page 61           | 0x0801 E800 – 0x0801 EFFF | ^                 | ^             |
+  * | Config Page       | ^                  | Page 62           | 0x0801 F000 – 0x0801 F7FF | 2 Kbyte (0x800)   | 1 по 2 KB     |
+  * | RO Constants      | ^                  | Page 63           | 0x0801 F800 – 0x0801 FFFF | 2 Kbyte (0x800)   | 1 по 2 KB     |
+  * | Config Page B     | ^                  | Page 64           | 0x0802 0000 – 0x0802 07FF | 2 Kbyte (0x800)   | 1 по 2 KB     |
+  * | Unused            | ^                  | Page 65           | 0x0802 0800 – 0x0802 0FFF | 2 Kbyte (0x800)   | 1 по 2 KB     |
   * | ^                 | ^                  | ...               | ...                       | ...               | ...           |
-  * | ^                 | ^                  | Page 127          | 0x0807 F800  0x0807 FFFF | 2 Kbyte (0x800)   | 1  2 KB     |
+  * | ^                 | ^                  | Page 127          | 0x0807 F800 – 0x0807 FFFF | 2 Kbyte (0x800)   | 1 по 2 KB     |
   * | ^                 | ^                  | ...               | ...                       | ...               | ...           |
   * | ^                 | ...                | ...               | ...                       | ...               | ...           |
-  * | Information Block ||                     Boot loader       | 0x1FFF B000  0x1FFF EFFF | 16 KB             |               |
-  * | ^                 ||                     User option bytes | 0x1FFF F800  0x1FFF F82F | 48 B              |               |
+  * | Information Block ||                     Boot loader       | 0x1FFF B000 – 0x1FFF EFFF | 16 KB             |               |
+  * | ^                 ||                     User option bytes | 0x1FFF F800 – 0x1FFF F82F | 48 B              |               |
   * 
-  * Bootloader      -                                                     \n
-  * Main Programm   -                                              \n
-  * Download Buffer -      ( )                 \n
-  * Config Page     -                                         \n
-  * RO Constants    -      (   ) \n
+  * Bootloader      - область расположения загрузчика                                                  \n
+  * Main Programm   - область расположения основной программы                                          \n
+  * Download Buffer - область для сохранения новой прошивки (используется загрузчиком)                 \n
+  * Config Page     - область хранения изменяемых параметров модуля                                    \n
+  * Config Page B   - вторая страница журнала изменяемых параметров модуля (см. FLASH.h)               \n
+  * RO Constants    - область хранения неизменяемых параметров модуля (записывается при сборке модуля) \n
   * \n 
   *
-  * **  Config Page**
-  * |                         |       | 0x00  | 0x01  | 0x02 | 0x03 |
-  * | ------------------------------- | :--------: | :---: | :---: | :--: | :--: |
-  * |                      | 0x0801F000 | addr  | 0xFF  | 0xFF | 0xFF |
-  * |                 | 0x0801F004 | minor | major | 0xFF | 0xFF |
-  * |                  | 0x0801F008 | minor | major | 0xFF | 0xFF |
-  * |               | 0x0801F00C | flag  | 0xFF  | 0xFF | 0xFF |
-  * |     Modbus | 0x0801F010 | 0xFF  | 0xFF  | 0xFF | 0xFF |
-  * |  Modbus  0        | 0x0801F014 | baud  |  par  | stop | 0xFF |
-  * |  Modbus  1        | 0x0801F018 | baud  |  par  | stop | 0xFF |
-  * |  Modbus  2        | 0x0801F01C | baud  |  par  | stop | 0xFF |
-  * |  Modbus  3        | 0x0801F020 | baud  |  par  | stop | 0xFF |
-  *  Config Page   ,    32- .
+  * **Карта памяти Config Page**
+  * | Параметр                        |   Адрес    |   0x00   |   0x01   | 0x02 | 0x03 |
+  * | ------------------------------- | :--------: | :------: | :------: | :--: | :--: |
+  * | Номер записи                    | 0x0801F000 |   seq    |   seq    | seq  | seq  |
+  * | Адрес модуля                    | 0x0801F004 |   addr   |   0xFF   | 0xFF | 0xFF |
+  * | Скорость CAN                    | 0x0801F008 |          |          |      |      |
+  * | Версия загрузчика               | 0x0801F00C | bl_minor | bl_major | 0xFF | 0xFF |
+  * | Версия программы                | 0x0801F010 | sw_minor | sw_major | 0xFF | 0xFF |
+  * | Флаг первого запуска            | 0x0801F014 |   flag   |   0xFF   | 0xFF | 0xFF |
+  * | Не используется в модуле Modbus | 0x0801F018 |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Параметры Modbus порта 0        | 0x0801F01C |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 1        | 0x0801F020 |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 2        | 0x0801F024 |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 3        | 0x0801F028 |   baud   |   par    | stop | 0xFF |
+  * | Слово состояния записи          | 0x0801F02C |    st    |    st    |  st  |  st  |
+  * Страница Config Page содержит параметры модуля, записанные в виде 32-битных слов.
   * \n \n 
   *
-  * **  RO Constants**
-  * |            |       | 0x00  | 0x01  | 0x02 | 0x03 |
+  * **Карта памяти RO Constants**
+  * | Параметр           |   Адрес    | 0x00  | 0x01  | 0x02 | 0x03 |
   * | ------------------ | :--------: | :---: | :---: | :--: | :--: |
-  * |           | 0x0801F800 | class | 0xFF  | 0xFF | 0xFF |
-  * |   | 0x0801F804 | minor | major | 0xFF | 0xFF |
-  * |   lw  | 0x0801F808 | 0xFF  | 0xFF  | 0xFF | 0xFF |
-  * |   hw  | 0x0801F80C | 0xFF  | 0xFF  | 0xFF | 0xFF |
+  * | Тип модуля         | 0x0801F800 | class | 0xFF  | 0xFF | 0xFF |
+  * | Аппаратная ревизия | 0x0801F804 | minor | major | 0xFF | 0xFF |
+  * | Серийный номер lw  | 0x0801F808 | 0xFF  | 0xFF  | 0xFF | 0xFF |
+  * | Серийный номер hw  | 0x0801F80C | 0xFF  | 0xFF  | 0xFF | 0xFF |
   *
-  *  RO Constants   ,    32- .
+  * Страница RO Constants содержит параметры модуля, записанные в виде 32-битных слов.
   * \n \n 
   *
   * 
-  * @copyright Copyright (C) 2022 Awada Systems.   .
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
   *
   * @author    Larionov A.S. (larion.alex@mail.ru)
   * 
@@ -165,31 +193,38 @@
 
 //---Includes-------------------------------------------------------------------//
 #include "AT_flash.h"
+#include "Flash_geometry.h"
 #include "at32f413_flash.h"
+#include "at32f413_crc.h"
+#include "at32f413_crm.h"
 //------------------------------------------------------------------------------//
 
 //---Private macros-------------------------------------------------------------//
 #define FLASH_SIZE            (*(uint32_t*)0x1FFFF7E0)             /*!< Flash size, in terms of KByte.               */
-#define PAGE0_ADDR            0x08000000U                          /*!<     FLASH.          */
-#define END_ADDR_OF_LAST_PAGE (PAGE0_ADDR + FLASH_SIZE * 1024 - 1) /*!<      . */
-
-//---  FLASH   Kbyte    ---//
-#define MEMSIZE_BOOTLOADER       28 /*!<   FLASH   Kbyte.       */
-#define MEMSIZE_MAIN_PROGRAM     48 /*!<   FLASH   Kbyte.       */
-#define MEMSIZE_DOWNLOAD_BUFFER  48 /*!<   FLASH   Kbyte.       */
-#define MEMSIZE_CONFIG_PAGE      2  /*!<   FLASH   Kbyte.       */
-#define MEMSIZE_RO_CONSTANS      2  /*!<   FLASH   Kbyte.       */
-//------------------------------------------------------------------------------------//
-
-//---     FLASH---//
-#define ADDR_BOOTLOADER       PAGE0_ADDR                                              /*!<    BootLoader.                   */
-#define ADDR_MAIN_PROGRAM     (ADDR_BOOTLOADER      + MEMSIZE_BOOTLOADER      * 1024) /*!< 0x08007000U //    MainProgram.   */
-#define ADDR_DOWNLOAD_BUFFER  (ADDR_MAIN_PROGRAM    + MEMSIZE_MAIN_PROGRAM    * 1024) /*!< 0x08013000U //    DowloadBuffer. */
-#define ADDR_CONFIG_PAGE      (ADDR_DOWNLOAD_BUFFER + MEMSIZE_DOWNLOAD_BUFFER * 1024) /*!< 0x0801F000U //    ConfigPage.    */
-#define ADDR_RO_CONSTANS      (ADDR_CONFIG_PAGE     + MEMSIZE_CONFIG_PAGE     * 1024) /*!< 0x0801F800U //    RO_Constans.   */
-//--------------------------------------------------------//
-
-#define DEF_FLASH_ADDR (END_ADDR_OF_LAST_PAGE - PAGE_SIZE_2KB + 1 ) /*!<      -     flash (0x803F800). */
+#define END_ADDR_OF_LAST_PAGE (Flash_end - 1)                      /*!< Адрес последнего байта в последней странице (копия Flash_geometry.c). */
+#define RAM_VECTORS_NUM       128U                                 /*!< Размер таблицы векторов в SRAM (не меньше __Vectors_Size / 4). */
+
+#if (FLASH_STATS)
+#define STATS_TIME()          (DWT->CYCCNT)                        /*!< Текущее время в тактах ядра.                 */
+#define STATS_ATOMIC(Statement) do { uint32_t primask_ = __get_PRIMASK(); __disable_irq(); Statement; \
+                                     __set_PRIMASK(primask_); } while (0) /*!< Изменение статистики с запретом прерываний (её изменяет и FMC_IRQHandler). */
+#define STATS_ADD(Field, Value) STATS_ATOMIC(Flash_stats.Field += (Value))                   /*!< Увеличение счётчика статистики.  */
+#define STATS_BUSY(Max, Start) do { uint32_t cycles_ = DWT->CYCCNT - (Start);                                   \
+                                    STATS_ATOMIC(Flash_stats.Busy_cycles += cycles_; if (cycles_ > (Max)) (Max) = cycles_); \
+                                  } while (0)                                                   /*!< Учёт времени операции.    */
+#define STATS_ERROR(State, Address) STATS_ATOMIC(Flash_stats.Errors++; Flash_stats.Last_error = (State); \
+                                                 Flash_stats.Last_error_addr = (Address))        /*!< Учёт операции с ошибкой.  */
+#define STATS_VERIFY(Address, Word) do { if (*(__IO uint32_t*)(uintptr_t)(Address) != (Word)) { STATS_ADD(Verify_errors, 1); \
+                                         STATS_ERROR(FLASH_ERROR, (Address)); } } while (0)        /*!< Проверка записанного слова. */
+#else
+#define STATS_TIME()          0U
+#define STATS_ADD(Field, Value) ((void)0)
+#define STATS_BUSY(Max, Start) ((void)(Start))
+#define STATS_ERROR(State, Address) ((void)0)
+#define STATS_VERIFY(Address, Word) ((void)0)
+#endif
+
+#define DEF_FLASH_ADDR (END_ADDR_OF_LAST_PAGE - PAGE_SIZE_2KB + 1 ) /*!< Адрес для записи по умолчанию - адрес начала последней страницы flash (0x803F800). */
 
 //------------------------------------------------------------------------------//
 
@@ -200,116 +235,432 @@
 //------------------------------------------------------------------------------//
 
 //---Private variables----------------------------------------------------------//
+static uint32_t Flash_end = PAGE0_ADDR; /*!< Конец FLASH (End_addr геометрии), копируется при Unlock_flash.                 */
+#if (FLASH_RAMFUNC_MODE)
+static uint32_t Vectors_in_RAM [RAM_VECTORS_NUM] __attribute__((aligned(4 * RAM_VECTORS_NUM))); /*!< Таблица векторов в SRAM. */
+#endif
+#if (FLASH_STATS)
+static Flash_stats_struct Flash_stats = {.Last_error = FLASH_OK}; /*!< Статистика операций контроллера flash.                  */
+static uint32_t  Async_start;                                     /*!< Время запуска операции без ожидания (такты ядра).      */
+static uint32_t  Async_address;                                   /*!< Адрес операции без ожидания.                           */
+static uint32_t *Async_max;                                       /*!< Наибольшее время для типа операции без ожидания.       */
+#endif
 //------------------------------------------------------------------------------//
 
 //---Private constants----------------------------------------------------------//
 //------------------------------------------------------------------------------//
 
 //---Function prototypes--------------------------------------------------------//
+#if (FLASH_BATCHED_PROGRAM)
+static flash_status Program_Run_to_flash    (uint32_t Address, uint32_t Amount, uint32_t *Words);
+#endif
+#if (FLASH_RAMFUNC_MODE)
+static flash_status Erase_Page_by_registers (uint32_t Address);
+#endif
 //------------------------------------------------------------------------------//
 
 //---Exported functions---------------------------------------------------------//
 /**
-  * @brief    Config  FLASH.
-  * @param   Data -   uint32_t*     Config.
+  * @brief   Снятие блокировки записи/стирания FLASH.
+  * @details Конец FLASH копируется из геометрии в SRAM: проверки адресов в функциях FLASH_RAMFUNC \n 
+  *          не обращаются к Flash_geometry.c во FLASH.
+  * @return  None.
+  */
+void Unlock_flash (void)
+{
+Flash_end = Get_flash_geometry()->End_addr;
+if (FLASH->ctrl_bit.oplk != RESET) // Повторная запись ключей в разблокированный контроллер недопустима.
+  {
+  flash_unlock();                  // Unlock the main FMC operation.
+  STATS_ADD(Unlocks, 1);
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Установка блокировки записи/стирания FLASH.
+  * @return  None.
+  */
+void Lock_flash (void)
+{
+flash_lock(); // Lock the main FMC operation.
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Стирание страницы (сектора) FLASH.
+  * @details Стирается сектор, содержащий адрес Address. FLASH должна быть разблокирована (Unlock_flash). \n 
+  *          При FLASH_RAMFUNC_MODE = 1 выполняется из SRAM через регистры контроллера flash (Erase_Page_by_registers).
+  * @param   Address - адрес внутри стираемого сектора.
   * @return  flash status.
   */
-flash_status Write_Config_to_flash (uint32_t* Data)
+FLASH_RAMFUNC flash_status Erase_Page_of_flash (uint32_t Address)
 {
-flash_status_type state;
+if ( (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_LAST_PAGE) )
+  return FLASH_WROG_ADDRES;
 
-flash_unlock(); // Unlock the main FMC operation.
-state = flash_sector_erase(ADDR_CONFIG_PAGE);
+#if (FLASH_RAMFUNC_MODE)
+return Erase_Page_by_registers(Address);
+#else
+uint32_t          start = STATS_TIME();
+flash_status_type state = flash_sector_erase(Address);
+
+STATS_BUSY(Flash_stats.Erase_max_cycles, start);
 if (state != FLASH_OPERATE_DONE)
+  {
+  if (state == FLASH_OPERATE_TIMEOUT)
+    STATS_ADD(Timeouts, 1);
+  STATS_ERROR(FLASH_ERROR, Address);
   return FLASH_ERROR;
-else
+  }
+STATS_ADD(Erases, 1);
+return FLASH_OK;
+#endif
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Программирование массива слов в стёртую область FLASH.
+  * @details Стирание не выполняется. FLASH должна быть разблокирована (Unlock_flash).               \n 
+  *          При FLASH_BATCHED_PROGRAM = 1 массив программируется одной серией (Program_Run_to_flash), \n 
+  *          при FLASH_BATCHED_PROGRAM = 0 каждое слово программируется функцией flash_word_program.
+  * @param   Address - адрес начальной ячейки.
+  * @param   Amount  - количество записываемых слов.
+  * @param   Words   - указатель типа uint32_t* на массив с данными. Данные должны быть выровнены по 4 байта.
+  * @return  flash status.
+  */
+FLASH_RAMFUNC flash_status Program_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words)
+{
+if ( (Address < PAGE0_ADDR) || (Address + 4*Amount - 1 > END_ADDR_OF_LAST_PAGE) )
+  return FLASH_WROG_ADDRES;
+
+#if (FLASH_BATCHED_PROGRAM)
+return Program_Run_to_flash(Address, Amount, Words);
+#else
+for (uint32_t i = 0; i < Amount; i++)
   {
-  for (uint8_t i = 0; i < NUM_OF_CONFIG_WORDS; i++)
+  uint32_t          start = STATS_TIME();
+  flash_status_type state = flash_word_program(Address + 4*i, *(Words + i)); // Program a word at the corresponding address.
+
+  STATS_BUSY(Flash_stats.Program_max_cycles, start);
+  if (state != FLASH_OPERATE_DONE)
     {
-    state = flash_word_program(ADDR_CONFIG_PAGE + 4*i, *(Data+i)); // Program a word at the corresponding address.
-    if (state != FLASH_OPERATE_DONE)
-      {
-      break;
-      }
+    if (state == FLASH_OPERATE_TIMEOUT)
+      STATS_ADD(Timeouts, 1);
+    STATS_ERROR(FLASH_ERROR, Address + 4*i);
+    return FLASH_ERROR;
     }
+  STATS_ADD(Programs, 1);
+  STATS_VERIFY(Address + 4*i, *(Words + i));
   }
-flash_lock(); // Lock the main FMC operation.
+return FLASH_OK;
+#endif
+}
+//------------------------------------------------------------------------------//
 
-if (state != FLASH_OPERATE_DONE)
-  return FLASH_ERROR;
-else
-  return FLASH_OK;
+
+/**
+  * @brief   Размер страницы (сектора) FLASH.
+  * @details Размер сектора определяется по FLASH_SIZE (Flash_geometry.c): 1 KB до 128 Kbyte, 2 KB - 256 Kbyte.
+  * @param   Address - адрес внутри сектора.
+  * @return  uint32_t - размер сектора в байтах.
+  */
+uint32_t Get_Page_Size_of_flash (uint32_t Address)
+{
+return Get_Geometry_Page_Size(Address);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запуск стирания сектора FLASH без ожидания окончания.
+  * @details Окончание стирания - прерывание FLASH (FLASH_IRQHandler). FLASH должна быть разблокирована (Unlock_flash).
+  * @param   Address - адрес внутри стираемого сектора.
+  * @return  flash status.
+  */
+flash_status Start_Erase_Page_of_flash (uint32_t Address)
+{
+if ( (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_LAST_PAGE) )
+  return FLASH_WROG_ADDRES;
+if (FLASH->sts_bit.obf != RESET)
+  return FLASH_BUSY;
+
+FLASH->sts = FLASH_ODF_FLAG | FLASH_PRGMERR_FLAG | FLASH_EPPERR_FLAG; // Сброс флагов предыдущих операций.
+FLASH->ctrl_bit.secers = TRUE;
+FLASH->addr            = Address;
+FLASH->ctrl_bit.erstr  = TRUE;
+#if (FLASH_STATS)
+Async_start   = STATS_TIME();
+Async_address = Address;
+Async_max     = &Flash_stats.Erase_max_cycles;
+#endif
+STATS_ADD(Erases, 1);
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запуск программирования слова FLASH без ожидания окончания.
+  * @details Окончание программирования - прерывание FLASH (FLASH_IRQHandler). FLASH должна быть разблокирована (Unlock_flash).
+  * @param   Address - адрес ячейки.
+  * @param   Word    - записываемое слово.
+  * @return  flash status.
+  */
+flash_status Start_Program_Word_of_flash (uint32_t Address, uint32_t Word)
+{
+if ( (Address < PAGE0_ADDR) || (Address + 3 > END_ADDR_OF_LAST_PAGE) )
+  return FLASH_WROG_ADDRES;
+if (FLASH->sts_bit.obf != RESET)
+  return FLASH_BUSY;
+
+FLASH->sts = FLASH_ODF_FLAG | FLASH_PRGMERR_FLAG | FLASH_EPPERR_FLAG; // Сброс флагов предыдущих операций.
+FLASH->ctrl_bit.fprgm = TRUE;
+*(__IO uint32_t*)(uintptr_t)Address = Word;
+#if (FLASH_STATS)
+Async_start   = STATS_TIME();
+Async_address = Address;
+Async_max     = &Flash_stats.Program_max_cycles;
+#endif
+STATS_ADD(Programs, 1);
+return FLASH_OK;
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief    Config  FLASH.
-  * @param   Config -   Config_struct*     Config.
+  * @brief   Разрешение прерывания FLASH по окончании операции и по ошибке.
+  * @param   Bank - номер банка FLASH (AT32F413 - один банк, не используется).
   * @return  None.
   */
-void Read_Config_from_flash (Config_struct* Config)
+void Enable_flash_IRQ (uint8_t Bank)
 {
-*Config = *((Config_struct*)ADDR_CONFIG_PAGE);
+flash_interrupt_enable(FLASH_ODF_INT | FLASH_ERR_INT, TRUE);
+NVIC_EnableIRQ(FLASH_IRQn);
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief    RO_Constants  FLASH.
-  * @param   RO_Constants -   RO_Constants_struct*     RO_Constants.
+  * @brief   Запрет прерывания FLASH.
+  * @param   Bank - номер банка FLASH (AT32F413 - один банк, не используется).
   * @return  None.
   */
-void Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants)
+void Disable_flash_IRQ (uint8_t Bank)
 {
-*RO_Constants = *((RO_Constants_struct*)ADDR_RO_CONSTANS);
+NVIC_DisableIRQ(FLASH_IRQn);
+flash_interrupt_enable(FLASH_ODF_INT | FLASH_ERR_INT, FALSE);
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief       FLASH.
-  * @details      FLASH.
-  * @param   Address -    .
-  * @param   Amount  -   .
-  * @param   Words   -   uint32_t*    .      4 .
+  * @brief   Прерывание FLASH.
+  * @details Окончание операции, запущенной Start_Erase_Page_of_flash или Start_Program_Word_of_flash: \n 
+  *          сброс флагов и битов SECERS/FPRGM, передача результата надаппаратному драйверу (Flash_operation_complete).
+  * @return  None.
+  */
+void FLASH_IRQHandler (void)
+{
+flash_status state = FLASH_OK;
+
+if ( (FLASH->sts_bit.prgmerr != RESET) || (FLASH->sts_bit.epperr != RESET) )
+  state = FLASH_ERROR;
+#if (FLASH_STATS)
+STATS_BUSY(*Async_max, Async_start);
+if (state != FLASH_OK)
+  STATS_ERROR(state, Async_address);
+#endif
+FLASH->sts = FLASH_ODF_FLAG | FLASH_PRGMERR_FLAG | FLASH_EPPERR_FLAG;
+FLASH->ctrl_bit.secers = FALSE;
+FLASH->ctrl_bit.fprgm  = FALSE;
+
+Flash_operation_complete(0, state);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Статистика операций контроллера flash с момента старта.
+  * @details При FLASH_STATS = 0 статистика не ведётся, структура заполняется нулями.
+  * @param   Stats - указатель на структуру для статистики.
+  * @return  None.
+  */
+void Get_Flash_stats (Flash_stats_struct *Stats)
+{
+#if (FLASH_STATS)
+STATS_ATOMIC(*Stats = Flash_stats); // Без изменения статистики из FMC_IRQHandler во время копирования.
+#else
+Flash_stats_struct none = {0};
+
+*Stats = none;
+#endif
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Чтение параметра Flash memory density.
+  * @details Чтение значения размера FLASH памяти (Flash memory density) микроконтроллера (STM, GD, AT).
+  * @return  uint16_t - размер FLASH памяти используемого микроконтроллера (STM, GD, AT) в Kbyte.
+  */
+uint16_t Read_MCU_FMD (void)
+{
+return (uint16_t)FLASH_SIZE;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Расчёт CRC32 массива слов на блоке CRC.
+  * @details Результат совпадает с Calc_CRC32_soft (FLASH.c). Блок CRC сбрасывается перед расчётом, \n 
+  *          поэтому функция не вызывается одновременно из прерываний и основной программы.
+  * @param   Words  - указатель на массив слов.
+  * @param   Amount - количество слов.
+  * @return  uint32_t - CRC32.
+  */
+uint32_t Calc_CRC32 (const uint32_t *Words, uint32_t Amount)
+{
+crm_periph_clock_enable(CRM_CRC_PERIPH_CLOCK, TRUE);
+crc_data_reset();
+return crc_block_calculate((uint32_t*)Words, Amount);
+}
+//------------------------------------------------------------------------------//
+
+
+#if (FLASH_RAMFUNC_MODE)
+/**
+  * @brief   Перенос таблицы векторов в SRAM.
+  * @details Таблица векторов копируется в SRAM, VTOR переключается на копию: выборка вектора при входе   \n 
+  *          в прерывание не обращается к FLASH и не останавливается на время стирания/программирования.  \n 
+  *          Вызывается один раз после Init_MCU, до разрешения прерываний, обслуживаемых во время операций FLASH. \n 
+  *          Если таблица (__Vectors_Size) больше RAM_VECTORS_NUM слов, VTOR не переключается.
+  * @return  None.
+  */
+void Init_flash_RAM_mode (void)
+{
+extern uint32_t       __Vectors[];
+extern const uint32_t __Vectors_Size;
+
+if ((uint32_t)(uintptr_t)&__Vectors_Size / 4 > RAM_VECTORS_NUM)
+  return; // Таблица векторов не помещается в Vectors_in_RAM: векторы выбираются из FLASH.
+for (uint32_t i = 0; i < (uint32_t)(uintptr_t)&__Vectors_Size / 4; i++)
+  {
+  Vectors_in_RAM[i] = __Vectors[i];
+  }
+SCB->VTOR = (uint32_t)(uintptr_t)Vectors_in_RAM;
+__DSB();
+}
+//------------------------------------------------------------------------------//
+#endif
+
+
+//---Private functions----------------------------------------------------------//
+#if (FLASH_BATCHED_PROGRAM)
+/**
+  * @brief   Программирование серии слов.
+  * @details Бит FPRGM устанавливается один раз на всю серию, между словами выполняется только ожидание \n 
+  *          сброса OBF. Флаги PRGMERR и EPPERR проверяются один раз после серии: флаги не сбрасываются  \n 
+  *          аппаратно, поэтому ошибка в любом слове серии сохраняется до проверки.
+  * @param   Address - адрес начальной ячейки.
+  * @param   Amount  - количество записываемых слов.
+  * @param   Words   - указатель типа uint32_t* на массив с данными.
   * @return  flash status.
   */
-flash_status Write_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words)
+static FLASH_RAMFUNC flash_status Program_Run_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words)
 {
-flash_status_type state;
+uint32_t timeout;
+uint32_t i = 0;
+#if (FLASH_RAMFUNC_MODE)
+uint32_t basepri = __get_BASEPRI();
 
-if ( (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_LAST_PAGE) )
-  return FLASH_WROG_ADDRES;
+__set_BASEPRI(FLASH_RAM_ISR_PRIO_LIMIT << (8U - __NVIC_PRIO_BITS)); // Прерывания с обработчиками во FLASH ожидают окончания серии.
+#endif
 
-flash_unlock(); // Unlock the main FMC operation.
-state = flash_sector_erase(Address);
-if (state != FLASH_OPERATE_DONE)
-  return FLASH_ERROR;
-else
+for (timeout = PROGRAMMING_TIMEOUT; (FLASH->sts_bit.obf != RESET) && (timeout > 0); timeout--) // Wait for last operation to be completed.
+  {;}
+STATS_ADD(Busy_waits, PROGRAMMING_TIMEOUT - timeout);
+FLASH->sts = FLASH_ODF_FLAG | FLASH_PRGMERR_FLAG | FLASH_EPPERR_FLAG; // Сброс флагов предыдущих операций.
+FLASH->ctrl_bit.fprgm = TRUE;
+
+for (i = 0; (i < Amount) && (timeout > 0); i++)
   {
-  for (uint32_t i = 0; i < Amount; i++)
-    {
-    state = flash_word_program(Address + 4*i, (uint32_t)*(Words + i)); // Program a halfword at the corresponding address.
-    if (state != FLASH_OPERATE_DONE)
-      {
-      break;
-      }
-    }
+  uint32_t start = STATS_TIME();
+
+  *(__IO uint32_t*)(uintptr_t)(Address + 4*i) = *(Words + i);
+  for (timeout = PROGRAMMING_TIMEOUT; (FLASH->sts_bit.obf != RESET) && (timeout > 0); timeout--) // Wait for operation to be completed.
+    {;}
+  STATS_ADD(Busy_waits, PROGRAMMING_TIMEOUT - timeout);
+  STATS_BUSY(Flash_stats.Program_max_cycles, start);
+  STATS_ADD(Programs, 1);
+  if (timeout > 0)
+    STATS_VERIFY(Address + 4*i, *(Words + i));
   }
-flash_lock(); // Lock the main FMC operation.
 
-if (state != FLASH_OPERATE_DONE)
+FLASH->ctrl_bit.fprgm = FALSE;
+#if (FLASH_RAMFUNC_MODE)
+__set_BASEPRI(basepri);
+#endif
+if ( (timeout == 0) || (FLASH->sts_bit.prgmerr != RESET) || (FLASH->sts_bit.epperr != RESET) )
+  {
+  if (timeout == 0)
+    STATS_ADD(Timeouts, 1);
+  STATS_ERROR(FLASH_ERROR, Address + 4*((i > 0) ? i - 1 : 0)); // Последнее слово, запись которого начата.
   return FLASH_ERROR;
-else
-  return FLASH_OK;
+  }
+return FLASH_OK;
 }
 //------------------------------------------------------------------------------//
-//------------------------------------------------------------------------------//
+#endif
 
 
-//---Private functions----------------------------------------------------------//
+#if (FLASH_RAMFUNC_MODE)
+/**
+  * @brief   Стирание сектора через регистры контроллера flash (выполняется из SRAM).
+  * @details Повторяет последовательность flash_sector_erase без вызова функций из FLASH.                \n 
+  *          На время стирания BASEPRI маскирует прерывания с приоритетом FLASH_RAM_ISR_PRIO_LIMIT и ниже. \n 
+  *          Ошибка - таймаут, PRGMERR или EPPERR после стирания.
+  * @param   Address - адрес внутри стираемого сектора.
+  * @return  flash status.
+  */
+static FLASH_RAMFUNC flash_status Erase_Page_by_registers (uint32_t Address)
+{
+uint32_t timeout;
+uint32_t start;
+uint32_t basepri = __get_BASEPRI();
+
+__set_BASEPRI(FLASH_RAM_ISR_PRIO_LIMIT << (8U - __NVIC_PRIO_BITS)); // Прерывания с обработчиками во FLASH ожидают окончания стирания.
+
+for (timeout = ERASE_TIMEOUT; (FLASH->sts_bit.obf != RESET) && (timeout > 0); timeout--) // Wait for last operation to be completed.
+  {;}
+STATS_ADD(Busy_waits, ERASE_TIMEOUT - timeout);
+FLASH->sts = FLASH_ODF_FLAG | FLASH_PRGMERR_FLAG | FLASH_EPPERR_FLAG; // Сброс флагов предыдущих операций.
+FLASH->ctrl_bit.secers = TRUE;
+FLASH->addr            = Address;
+start = STATS_TIME();
+FLASH->ctrl_bit.erstr  = TRUE;
+for (timeout = ERASE_TIMEOUT; (FLASH->sts_bit.obf != RESET) && (timeout > 0); timeout--) // Wait for operation to be completed.
+  {;}
+STATS_ADD(Busy_waits, ERASE_TIMEOUT - timeout);
+STATS_BUSY(Flash_stats.Erase_max_cycles, start);
+FLASH->ctrl_bit.secers = FALSE;
+
+__set_BASEPRI(basepri);
+if ( (timeout == 0) || (FLASH->sts_bit.prgmerr != RESET) || (FLASH->sts_bit.epperr != RESET) )
+  {
+  if (timeout == 0)
+    STATS_ADD(Timeouts, 1);
+  STATS_ERROR(FLASH_ERROR, Address);
+  return FLASH_ERROR;
+  }
+STATS_ADD(Erases, 1);
+return FLASH_OK;
+}
 //------------------------------------------------------------------------------//
+#endif
 
 
 //***************************************END OF FILE**************************************//
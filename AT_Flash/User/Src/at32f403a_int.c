@@ -26,6 +26,8 @@
 
 //---Includes-------------------------------------------------------------------//
 #include "at32f403a_int.h"
+#include "AT_START_F413_V1.2.h"
+#include "FLASH.h"
 //------------------------------------------------------------------------------//
 
 //---Defines--------------------------------------------------------------------//
@@ -124,9 +126,9 @@ void PendSV_Handler(void)
   * @param  none
   * @retval none
   */
-void SysTick_Handler(void)
+FLASH_RAMFUNC void SysTick_Handler(void)
 {
-  ;
+  Probe_IRQ_latency();
 }
 
 /**
@@ -16,6 +16,8 @@
  */
 #define CMSIS_device_header "gd32f10x.h"
 
+/* GigaDevice::Device:GD32F10x_StdPeripherals:CRC:2.0.1 */
+#define RTE_DEVICE_STDPERIPHERALS_CRC
 /* GigaDevice::Device:GD32F10x_StdPeripherals:FMC:2.0.1 */
 #define RTE_DEVICE_STDPERIPHERALS_FMC
 /* GigaDevice::Device:GD32F10x_StdPeripherals:MISC:2.0.1 */
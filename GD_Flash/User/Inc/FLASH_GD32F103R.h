@@ -5,7 +5,7 @@
   *
   * @brief     Header for FLASH_GD32F103R.c file.
   *
-  * @copyright Copyright (C) 2022 Awada Systems.   .
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
   *
   * @author    Larionov A.S. (larion.alex@mail.ru)
   *
@@ -32,11 +32,22 @@
 //------------------------------------------------------------------------------//
 
 //---Function prototypes--------------------------------------------------------//
-flash_status  Write_Config_to_flash        (Config_struct* Config);
-void          Read_Config_from_flash       (Config_struct* Config);
-void          Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants);
-flash_status  Write_Words_to_flash         (uint32_t Address, uint32_t Amount, uint32_t *Words);
 uint16_t      Read_MCU_FMD                 (void);
+uint32_t      Calc_CRC32                   (const uint32_t *Words, uint32_t Amount);
+void          Unlock_flash                 (void);
+void          Lock_flash                   (void);
+flash_status  Erase_Page_of_flash          (uint32_t Address);
+flash_status  Program_Words_to_flash       (uint32_t Address, uint32_t Amount, uint32_t *Words);
+uint32_t      Get_Page_Size_of_flash       (uint32_t Address);
+flash_status  Start_Erase_Page_of_flash    (uint32_t Address);
+flash_status  Start_Program_Word_of_flash  (uint32_t Address, uint32_t Word);
+void          Enable_flash_IRQ             (uint8_t Bank);
+void          Disable_flash_IRQ            (uint8_t Bank);
+uint8_t       Get_Bank_of_flash            (uint32_t Address);
+void          FMC_IRQHandler               (void);
+#if (FLASH_RAMFUNC_MODE)
+void          Init_flash_RAM_mode          (void);
+#endif
 //------------------------------------------------------------------------------//
 
 
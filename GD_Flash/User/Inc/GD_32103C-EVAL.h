@@ -5,7 +5,7 @@
   *
   * @brief     Header for GD_32103C-EVAL.c file.
   *
-  * @copyright Copyright (C) 2022 Awada Systems.   .
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
   *
   * @author    Larionov A.S. (larion.alex@mail.ru)
   *
@@ -17,6 +17,7 @@
 #define __GD_32103C_EVAL_H
 
 //---Includes-------------------------------------------------------------------//
+#include <stdint.h>
 //------------------------------------------------------------------------------//
 
 //---Defines--------------------------------------------------------------------//
@@ -29,8 +30,13 @@
 //------------------------------------------------------------------------------//
 
 //---Function prototypes--------------------------------------------------------//
-void Init_MCU (void);
-void Blink    (void);
+void     Init_MCU            (void);
+void     Blink               (void);
+void     Start_Cycle_Counter (void);
+uint32_t Get_Cycle_Counter   (void);
+void     Start_Latency_Probe (void);
+void     Probe_IRQ_latency   (void);
+uint32_t Get_IRQ_Latency_max (void);
 //------------------------------------------------------------------------------//
 
   
@@ -3,39 +3,60 @@
   * 
   * @file      FLASH_GD32F103R.c
   * 
-  * @brief      flash  GD32F103R.
+  * @brief     Драйвер flash для GD32F103R.
   * 
-  * @details       flash    GD32F103R.
+  * @details   Функции для работы с flash в микроконтроллерах семейства GD32F103R.
   *
-  * @warning   **!**                                                                                  \n 
-  *    : 
-  *                       +  gd32f10x_fmc.c -     flash  GD;
-  *                       +  gd32f10x_fmc.h - header for gd32f10x_fmc.c.
+  * @warning   **ВАЖНО!**                                                                                  \n 
+  * Для работы драйвера требуется: 
+  *                       + файл gd32f10x_fmc.c - аппаратный драйвер работы с flash от GD;
+  *                       + файл gd32f10x_fmc.h - header for gd32f10x_fmc.c.
   *
   * **Manual** \n 
-  *     :
-  * - Write_Config_to_flash (Config_struct* Config) -   FLASH    Config Page.        \n 
-  *           uint32_t   Config_struct.                    \n 
-  *      /    / FLASH   ADDR_CONFIG_PAGE.
+  * В драйвере реализованы следующие функции:
+  * - Unlock_flash, Lock_flash, Erase_Page_of_flash, Program_Words_to_flash, Get_Page_Size_of_flash - функции доступа к FMC, \n 
+  *   через которые надаппаратный драйвер (FLASH.c) ведёт журнал Config Page                                           \n 
+  *   (Write_Config_to_flash, Read_Config_from_flash) и записывает массивы слов (Write_Words_to_flash).
   *
-  * - Read_Config_from_flash (Config_struct* Config) -      FLASH                    \n 
-  *      Config_struct.
-  *   
-  * - Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants) -             \n 
-  *      RO_Constants_struct.
+  * - Init_flash_RAM_mode (void) - перенос таблицы векторов в SRAM (только при FLASH_RAMFUNC_MODE = 1).
   *
-  * - Write_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words) -   FLASH   .
+  * - Start_Erase_Page_of_flash, Start_Program_Word_of_flash, Enable_flash_IRQ, Disable_flash_IRQ, FMC_IRQHandler -          \n 
+  *   запуск операций FMC без ожидания и прерывание FMC по окончании операции для асинхронной записи                        \n 
+  *   (Write_Words_to_flash_async). На Extra-density операции в bank0 и bank1 выполняются одновременно.
   *
-  * **  FLASH   ** \n 
-  *   GD32F103R  FLASH   16 KB (GD32F103R4T6)  3072 KB (GD32F103RKT6). \n 
-  *  FLASH    (density):
+  * - Get_Bank_of_flash (uint32_t Address) - номер банка FMC (0 - bank0, 1 - bank1 на Extra-density).
+  *
+  * - Get_Flash_stats (Flash_stats_struct *Stats) - статистика операций FMC с момента старта (FLASH_STATS = 1):             \n 
+  *   количество разблокировок, стёртых страниц и запрограммированных слов, время операций в тактах DWT->CYCCNT          \n 
+  *   (суммарное и наибольшее), таймауты, ошибки проверки записанных слов и последняя ошибка с адресом.               \n 
+  *   Итерации ожидания BUSY считаются в циклах ожидания этого файла (FLASH_BATCHED_PROGRAM, FLASH_RAMFUNC_MODE),      \n 
+  *   ожидание внутри fmc_page_erase и fmc_word_program не учитывается. Время операций без ожидания                    \n 
+  *   измеряется от запуска до Complete_bank_operation. Счётчик тактов запускается Start_Cycle_Counter.
+  *
+  * - Calc_CRC32 (const uint32_t *Words, uint32_t Amount) - CRC32 на блоке CRC (записи Config Page и RO Constants).
+  *
+  * **Режим FLASH_RAMFUNC_MODE** \n 
+  * Во время стирания и программирования выборка команд из FLASH останавливает ядро.                    \n 
+  * При FLASH_RAMFUNC_MODE = 1 функции стирания/программирования размещаются в SRAM (FLASH_RAMFUNC)     \n 
+  * и работают с регистрами FMC напрямую, без функций gd32f10x_fmc.c. Для сборки требуется              \n 
+  * scatter-файл GD_Flash_ramfunc.sct (Options for Target -> Linker -> Scatter File).                   \n 
+  * На время операции FLASH BASEPRI маскирует прерывания с приоритетом FLASH_RAM_ISR_PRIO_LIMIT и ниже. \n 
+  * Прерывания с более высоким приоритетом продолжают обслуживаться, поэтому их обработчики и всё,       \n 
+  * что они вызывают, должны быть помечены FLASH_RAMFUNC, а таблица векторов перенесена в SRAM          \n 
+  * (Init_flash_RAM_mode). Конец FLASH и начало bank1 (Flash_geometry.c) копируются в SRAM              \n 
+  * при Unlock_flash, поэтому функции FLASH_RAMFUNC не вызывают функции из FLASH.
+  *
+  * **Особенности организации FLASH памяти в проекте** \n 
+  * В контроллерах GD32F103R размер FLASH варьируется от 16 KB (GD32F103R4T6) до 3072 KB (GD32F103RKT6). \n 
+  * Размер FLASH определяет параметр плотность (density):
   * - Medium-density devices are GD32F101xx and GD32F103xx microcontrollers which the flash memory density ranges from 16 to 128 Kbytes.
   * - High-density devices are GD32F101xx and GD32F103xx microcontrollers which the flash memory density ranges from 256 to 512 Kbytes.
   * - Extra-density devices are GD32F101xx and GD32F103xx microcontrollers which the flash memory density larger than 512 Kbytes.  \n 
   *
-  *  density   FLASH . \n \n 
+  * Параметр density опрелеляет организацию FLASH памяти. Density определяется при старте по FMC_SIZE         \n 
+  * (Flash_geometry.c): одна прошивка работает на платах с разным объёмом FLASH. \n \n 
   *
-  * ** FLASH   Medium-density** \n 
+  * **Организация FLASH памяти для Medium-density** \n 
   * (GD32F10x_MD)
   *
   * | Block              | Name             | Address Range             | Size (bytes) |
@@ -49,7 +70,7 @@
   * | Option bytes Block | Option bytes     | 0x1FFF F800 - 0x1FFF F80F | 16 B         |
   *  \n
   *
-  * ** FLASH   High-density  Extra-density** \n 
+  * **Организация FLASH памяти для High-density и Extra-density** \n 
   * (GD32F10x_CL, GD32F10x_HD, GD32F10x_XD)
   *
   * | Block              | Density     | Name             | Address Range             | Size (bytes) |
@@ -68,87 +89,98 @@
   * | ^                  | GD32F10x_CL | ^                | 0x1FFF B000 - 0x1FFF F7FF | 18 KB        |
   * | Option bytes Block | CL, HD, XD  | Option bytes     | 0x1FFF F800 - 0x1FFF F80F | 16 B         |
   * \n 
-  *  FLASH      (- -)   (  ). \n 
-  *         128 Kbyte FLASH .                                            \n 
-  * ,     GD32F103R c  FLASH    128 Kbyte.              \n 
-  *    ()     FLASH  (    )       \n 
-  *     Medium Density  High/Extra Density.                                                   \n 
+  * Память FLASH используется в соответствии с установленной (кем-то когда-то) картой памяти (такой способ организации). \n 
+  * Для хранения этой карты памяти требуется не менее 128 Kbyte FLASH памяти.                                            \n 
+  * Подразумевается, что используется контроллер серии GD32F103R c объёмом FLASH памяти не менее 128 Kbyte.              \n 
+  * В двух таблицах (ниже) представлены два способа организации FLASH памяти (с учётом установленной карты памяти)       \n 
+  * для контроллеров с плотностью Medium Density и High/Extra Density.                                                   \n 
   * \n 
-  * **     GD32F103R Medium Density**
-  * |       |   |            |    |   |
+  * **Карта памяти для микроконтроллеров серии GD32F103R Medium Density**
+  * |   Назначение    | Номер страницы | Диапазон адресов          | Занимаемый объем  | Число страниц |
   * | --------------- | :------------: | :-----------------------: | :---------------: | :-----------: |
-  * | Bootloader      | Page 0         | 0x0800 0000 - 0x0800 03FF | 28 Kbyte (0x7000) | 28  1 KB    |
+  * | Bootloader      | Page 0         | 0x0800 0000 - 0x0800 03FF | 28 Kbyte (0x7000) | 28 по 1 KB    |
   * | ^               | ...            | ...                       | ^                 | ^             |
   * | ^               | Page 27        | 0x0800 6BFF - 0x0800 6FFF | ^                 | ^             |
-  * | Main Programm   | Page 28        | 0x0800 7000 - 0x0800 73FF | 48 Kbyte (0xC000) | 48  1 KB    |
+  * | Main Programm   | Page 28        | 0x0800 7000 - 0x0800 73FF | 48 Kbyte (0xC000) | 48 по 1 KB    |
   * | ^               | ...            | ...                       | ^                 | ^             |
   * | ^               | Page 75        | 0x0801 2BFF - 0x0801 2FFF | ^                 | ^             |
-  * | Download Buffer | Page 76        | 0x0801 3000 - 0x0800 33FF | 48 Kbyte (0xC000) | 48  1 KB    |
+  * | Download Buffer | Page 76        | 0x0801 3000 - 0x0800 33FF | 48 Kbyte (0xC000) | 48 по 1 KB    |
   * | ^               | ...            | ...                       | ^                 | ^             |
   * | ^               | Page 123       | 0x0801 3400 - 0x0801 EFFF | ^                 | ^             |
-  * | Config Page     | Page 124       | 0x0801 F000 - 0x0801 F3FF |  1 Kbyte (0x400)  | 2  1 KB     |
+  * | Config Page     | Page 124       | 0x0801 F000 - 0x0801 F3FF |  1 Kbyte (0x400)  | 2 по 1 KB     |
   * | ^               | Page 125       | 0x0801 F400 - 0x0801 F7FF |  1 Kbyte (0x400)  | ^             |
-  * | RO Constants    | Page 126       | 0x0801 F800 - 0x0801 FBFF |  1 Kbyte (0x400)  | 2  1 KB     |
+  * | RO Constants    | Page 126       | 0x0801 F800 - 0x0801 FBFF |  1 Kbyte (0x400)  | 2 по 1 KB     |
   * | ^               | Page 127       | 0x0801 FC00 - 0x0801 FFFF |  1 Kbyte (0x400)  | ^             |
+  *
+  * На Medium Density нет места для Config Page B (ADDR_CONFIG_PAGE_B), поэтому журнал Config Page ведётся на двух      \n 
+  * страницах области Config Page: Page 124 (страница A) и Page 125 (страница B).
   * \n 
-  * **     GD32F103R High/Extra Density**
-  * |       |   |            |    |   |
+  * **Карта памяти для микроконтроллеров серии GD32F103R High/Extra Density**
+  * |   Назначение    | Номер страницы | Диапазон адресов          | Занимаемый объем  | Число страниц |
   * | --------------- | :------------: | :-----------------------: | :---------------: | :-----------: |
-  * | Bootloader      | Page 0         | 0x0800 0000 - 0x0800 07FF | 28 Kbyte (0x7000) | 14  2 KB    |
+  * | Bootloader      | Page 0         | 0x0800 0000 - 0x0800 07FF | 28 Kbyte (0x7000) | 14 по 2 KB    |
   * | ^               | ...            | ...                       | ^                 | ^             |
   * | ^               | Page 13        | 0x0800 6800 - 0x0800 6FFF | ^                 | ^             |
-  * | Main Programm   | Page 14        | 0x0800 7000 - 0x0800 77FF | 48 Kbyte (0xC000) | 24  2 KB    |
+  * | Main Programm   | Page 14        | 0x0800 7000 - 0x0800 77FF | 48 Kbyte (0xC000) | 24 по 2 KB    |
   * | ^               | ...            | ...                       | ^                 | ^             |
   * | ^               | Page 37        | 0x0801 2800 - 0x0801 2FFF | ^                 | ^             |
-  * | Download Buffer | Page 38        | 0x0800 3000 - 0x0800 37FF | 48 Kbyte (0xC000) | 24  2 KB    |
+  * | Download Buffer | Page 38        | 0x0800 3000 - 0x0800 37FF | 48 Kbyte (0xC000) | 24 по 2 KB    |
   * | ^               | ...            | ...                       | ^                 | ^             |
   * | ^               | Page 61        | 0x0801 E800 - 0x0801 EFFF | ^                 | ^             |
-  * | Config Page     | Page 62        | 0x0801 F000 - 0x0801 F7FF | 2 Kbyte (0x800)   | 1  2 KB     |
-  * | RO Constants    | Page 63        | 0x0801 F800 - 0x0801 FFFF | 2 Kbyte (0x800)   | 1  2 KB     |
-  * | Unused_page_2KB | Page 64        | 0x0802 0000 - 0x0802 07FF | 384 Kbyte         | 192  2 KB   |
+  * | Config Page     | Page 62        | 0x0801 F000 - 0x0801 F7FF | 2 Kbyte (0x800)   | 1 по 2 KB     |
+  * | RO Constants    | Page 63        | 0x0801 F800 - 0x0801 FFFF | 2 Kbyte (0x800)   | 1 по 2 KB     |
+  * | Config Page B   | Page 64        | 0x0802 0000 - 0x0802 07FF | 2 Kbyte (0x800)   | 1 по 2 KB     |
+  * | Unused_page_2KB | Page 65        | 0x0802 0800 - 0x0802 0FFF | 382 Kbyte         | 191 по 2 KB   |
   * | ^               | ...            | ...                       | ^                 | ^             |
   * | ^               | Page 255       | 0x0807 F800 - 0x0807 FFFF | ^                 | ^             |
-  * | Unused_page_4KB | Page 256       | 0x0808 0000 - 0x0808 0FFF | 2556 Kbyte        | 639  4 KB   |
+  * | Unused_page_4KB | Page 256       | 0x0808 0000 - 0x0808 0FFF | 2556 Kbyte        | 639 по 4 KB   |
   * | ^               | ...            | ...                       | ^                 | ^             |
   * | ^               | Page 895       | 0x082F F000 - 0x082F FFFF | ^                 | ^             |
   * 
-  * Bootloader      -                                                     \n
-  * Main Programm   -                                              \n
-  * Download Buffer -      ( )                 \n
-  * Config Page     -                                         \n
-  * RO Constants    -      (   ) \n
+  * Bootloader      - область расположения загрузчика                                                  \n
+  * Main Programm   - область расположения основной программы                                          \n
+  * Download Buffer - область для сохранения новой прошивки (используется загрузчиком)                 \n
+  * Config Page     - область хранения изменяемых параметров модуля                                    \n
+  * Config Page B   - вторая страница журнала изменяемых параметров модуля (см. FLASH.h)               \n
+  * RO Constants    - область хранения неизменяемых параметров модуля (записывается при сборке модуля) \n
+  * \n 
+  * На Extra-density (FLASH_BANK1_LAYOUT, см. FLASH.h) Download Buffer (Page 256 - 267) и области данных          \n 
+  * (KV Store, журналы, с Page 268) размещаются в bank1: стирание и запись в bank1 не останавливают выборку кода  \n 
+  * из bank0. Config Page, RO Constants и Config Page B остаются на прежних адресах (Page 62 - 64).              \n 
   * \n 
   *
-  * **  Config Page**
-  * |                         |       |   0x00   |   0x01   | 0x02 | 0x03 |
+  * **Карта памяти Config Page**
+  * | Параметр                        |   Адрес    |   0x00   |   0x01   | 0x02 | 0x03 |
   * | ------------------------------- | :--------: | :------: | :------: | :--: | :--: |
-  * |                      | 0x0801F000 |   addr   |   0xFF   | 0xFF | 0xFF |
-  * |  CAN                    | 0x0801F004 |          |          |      |      |
-  * |                 | 0x0801F008 | bl_minor | bl_major | 0xFF | 0xFF |
-  * |                  | 0x0801F00C | sw_minor | sw_major | 0xFF | 0xFF |
-  * |               | 0x0801F010 |   flag   |   0xFF   | 0xFF | 0xFF |
-  * |     Modbus | 0x0801F014 |   0xFF   |   0xFF   | 0xFF | 0xFF |
-  * |  Modbus  0        | 0x0801F018 |   baud   |    par   | stop | 0xFF |
-  * |  Modbus  1        | 0x0801F01C |   baud   |    par   | stop | 0xFF |
-  * |  Modbus  2        | 0x0801F020 |   baud   |    par   | stop | 0xFF |
-  * |  Modbus  3        | 0x0801F024 |   baud   |    par   | stop | 0xFF |
+  * | Номер записи                    | 0x0801F000 |   seq    |   seq    | seq  | seq  |
+  * | Адрес модуля                    | 0x0801F004 |   addr   |   0xFF   | 0xFF | 0xFF |
+  * | Скорость CAN                    | 0x0801F008 |          |          |      |      |
+  * | Версия загрузчика               | 0x0801F00C | bl_minor | bl_major | 0xFF | 0xFF |
+  * | Версия программы                | 0x0801F010 | sw_minor | sw_major | 0xFF | 0xFF |
+  * | Флаг первого запуска            | 0x0801F014 |   flag   |   0xFF   | 0xFF | 0xFF |
+  * | Не используется в модуле Modbus | 0x0801F018 |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Параметры Modbus порта 0        | 0x0801F01C |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 1        | 0x0801F020 |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 2        | 0x0801F024 |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 3        | 0x0801F028 |   baud   |   par    | stop | 0xFF |
+  * | Слово состояния записи          | 0x0801F02C |    st    |    st    |  st  |  st  |
   *
-  *  Config Page   ,    32- .
+  * Страница Config Page содержит параметры модуля, записанные в виде 32-битных слов.
   * \n \n 
   *
-  * **  RO Constants**
-  * |                   |       |   0x00   |   0x01   | 0x02 | 0x03 |
+  * **Карта памяти RO Constants**
+  * | Параметр                  |   Адрес    |   0x00   |   0x01   | 0x02 | 0x03 |
   * | ------------------------- | :--------: | :------: | :------: | :--: | :--: |
-  * |                  | 0x0801F800 |  class   |   0xFF   | 0xFF | 0xFF |
-  * |          | 0x0801F804 | hw_minor | hw_major | 0xFF | 0xFF |
-  * |    lw  | 0x0801F808 |   0xFF   |   0xFF   | 0xFF | 0xFF |
-  * |    hw  | 0x0801F80C |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Тип модуля                | 0x0801F800 |  class   |   0xFF   | 0xFF | 0xFF |
+  * | Аппаратная ревизия        | 0x0801F804 | hw_minor | hw_major | 0xFF | 0xFF |
+  * | Серийный номер модуля lw  | 0x0801F808 |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Серийный номер модуля hw  | 0x0801F80C |   0xFF   |   0xFF   | 0xFF | 0xFF |
   *
-  *  RO Constants   ,    32- .
+  * Страница RO Constants содержит параметры модуля, записанные в виде 32-битных слов.
   * \n \n 
   *
   * 
-  * @copyright Copyright (C) 2022 Awada Systems.   .
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
   *
   * @author    Larionov A.S. (larion.alex@mail.ru)
   * 
@@ -157,32 +189,43 @@
 
 //---Includes-------------------------------------------------------------------//
 #include "FLASH_GD32F103R.h"
+#include "Flash_geometry.h"
 //#include "gd32f10x_fmc.h"
 //------------------------------------------------------------------------------//
 
 //---Private macros-------------------------------------------------------------//
-#define PAGE0_ADDR            0x08000000U                        /*!<     FLASH.          */
-#define END_ADDR_OF_LAST_PAGE (PAGE0_ADDR + FMC_SIZE * 1024 - 1) /*!<      . */
-
-//---  FLASH   Kbyte    ---//
-#define MEMSIZE_BOOTLOADER       28 /*!<   FLASH   Kbyte.       */
-#define MEMSIZE_MAIN_PROGRAM     48 /*!<   FLASH   Kbyte.       */
-#define MEMSIZE_DOWNLOAD_BUFFER  48 /*!<   FLASH   Kbyte.       */
-#define MEMSIZE_CONFIG_PAGE      2  /*!<   FLASH   Kbyte.       */
-#define MEMSIZE_RO_CONSTANS      2  /*!<   FLASH   Kbyte.       */
-//------------------------------------------------------------------------------------//
-
-//---     FLASH---//
-#define ADDR_BOOTLOADER       PAGE0_ADDR                                              /*!<    BootLoader.                   */
-#define ADDR_MAIN_PROGRAM     (ADDR_BOOTLOADER      + MEMSIZE_BOOTLOADER      * 1024) /*!< 0x08007000U //    MainProgram.  1024 -    . */
-#define ADDR_DOWNLOAD_BUFFER  (ADDR_MAIN_PROGRAM    + MEMSIZE_MAIN_PROGRAM    * 1024) /*!< 0x08013000U //    DowloadBuffer. */
-#define ADDR_CONFIG_PAGE      (ADDR_DOWNLOAD_BUFFER + MEMSIZE_DOWNLOAD_BUFFER * 1024) /*!< 0x0801F000U //    ConfigPage.    */
-#define ADDR_RO_CONSTANS      (ADDR_CONFIG_PAGE     + MEMSIZE_CONFIG_PAGE     * 1024) /*!< 0x0801F800U //    RO_Constans.   */
-//--------------------------------------------------------//
-
-#define DEF_FLASH_ADDR (END_ADDR_OF_LAST_PAGE - PAGE_SIZE_2KB + 1) /*!<      -     flash (0x803F800). */
-
-//#define NUM_OF_CONFIG_WORDS 9U /*!<    (  32- ),      Config Page. */
+#define END_ADDR_OF_LAST_PAGE (Flash_end - 1)                      /*!< Адрес последнего байта в последней странице (копия Flash_geometry.c). */
+#define BANK1_ADDR            (Flash_bank1)                        /*!< Начало bank1 (0 - bank1 нет).                                  */
+#define ADDR_IN_BANK1(Address) ((BANK1_ADDR != 0) && ((Address) >= BANK1_ADDR)) /*!< Адрес в bank1 (без вызова Get_Bank_of_flash из FLASH). */
+
+#define RAM_VECTORS_NUM       128U                               /*!< Размер таблицы векторов в SRAM (не меньше __Vectors_Size / 4).   */
+
+#define BANK_CTL(Bank)        ((Bank) ? &FMC_CTL1  : &FMC_CTL0)  /*!< Регистр управления банка FMC.                                    */
+#define BANK_STAT(Bank)       ((Bank) ? &FMC_STAT1 : &FMC_STAT0) /*!< Регистр состояния банка FMC.                                     */
+
+#if (FLASH_STATS)
+#define STATS_TIME()          (DWT->CYCCNT)                      /*!< Текущее время в тактах ядра.                                     */
+#define STATS_ATOMIC(Statement) do { uint32_t primask_ = __get_PRIMASK(); __disable_irq(); Statement; \
+                                     __set_PRIMASK(primask_); } while (0) /*!< Изменение статистики с запретом прерываний (её изменяет и FMC_IRQHandler). */
+#define STATS_ADD(Field, Value) STATS_ATOMIC(Flash_stats.Field += (Value))                   /*!< Увеличение счётчика статистики.  */
+#define STATS_BUSY(Max, Start) do { uint32_t cycles_ = DWT->CYCCNT - (Start);                                   \
+                                    STATS_ATOMIC(Flash_stats.Busy_cycles += cycles_; if (cycles_ > (Max)) (Max) = cycles_); \
+                                  } while (0)                                                   /*!< Учёт времени операции.    */
+#define STATS_ERROR(State, Address) STATS_ATOMIC(Flash_stats.Errors++; Flash_stats.Last_error = (State); \
+                                                 Flash_stats.Last_error_addr = (Address))        /*!< Учёт операции с ошибкой.  */
+#define STATS_VERIFY(Address, Word) do { if (REG32(Address) != (Word)) { STATS_ADD(Verify_errors, 1); \
+                                         STATS_ERROR(FLASH_ERROR, (Address)); } } while (0)        /*!< Проверка записанного слова. */
+#else
+#define STATS_TIME()          0U
+#define STATS_ADD(Field, Value) ((void)0)
+#define STATS_BUSY(Max, Start) ((void)(Start))
+#define STATS_ERROR(State, Address) ((void)0)
+#define STATS_VERIFY(Address, Word) ((void)0)
+#endif
+
+#define DEF_FLASH_ADDR (END_ADDR_OF_LAST_PAGE - PAGE_SIZE_2KB + 1) /*!< Адрес для записи по умолчанию - адрес начала последней страницы flash (0x803F800). */
+
+//#define NUM_OF_CONFIG_WORDS 9U /*!< Количество параметров модуля (в виде 32-битных слов), которые будут записываться в область Config Page. */
 //------------------------------------------------------------------------------//
 
 //---Exported variables---------------------------------------------------------//
@@ -192,117 +235,336 @@
 //------------------------------------------------------------------------------//
 
 //---Private variables----------------------------------------------------------//
+static uint32_t Flash_end   = PAGE0_ADDR; /*!< Конец FLASH (End_addr геометрии), копируется при Unlock_flash.               */
+static uint32_t Flash_bank1 = 0;          /*!< Начало bank1 (Bank1_addr геометрии), копируется при Unlock_flash.            */
+#if (FLASH_RAMFUNC_MODE)
+static uint32_t Vectors_in_RAM [RAM_VECTORS_NUM] __attribute__((aligned(4 * RAM_VECTORS_NUM))); /*!< Таблица векторов в SRAM. */
+#endif
+#if (FLASH_STATS)
+static Flash_stats_struct Flash_stats = {.Last_error = FLASH_OK}; /*!< Статистика операций FMC.                                     */
+static uint32_t  Async_start   [2];                               /*!< Время запуска операции без ожидания в банке (такты ядра).     */
+static uint32_t  Async_address [2];                               /*!< Адрес операции без ожидания в банке.                          */
+static uint32_t *Async_max     [2];                               /*!< Наибольшее время для типа операции без ожидания в банке.      */
+#endif
 //------------------------------------------------------------------------------//
 
 //---Private constants----------------------------------------------------------//
 //------------------------------------------------------------------------------//
 
 //---Function prototypes--------------------------------------------------------//
+#if (FLASH_BATCHED_PROGRAM)
+static flash_status Program_Run_to_flash    (volatile uint32_t *Ctl, volatile uint32_t *Stat, uint32_t Address, uint32_t Amount, uint32_t *Words);
+#endif
+static void         Complete_bank_operation (uint8_t Bank);
+#if (FLASH_RAMFUNC_MODE)
+static flash_status Erase_Page_by_registers (volatile uint32_t *Ctl, volatile uint32_t *Stat, volatile uint32_t *Addr, uint32_t Address);
+#endif
 //------------------------------------------------------------------------------//
 
 //---Exported functions---------------------------------------------------------//
 /**
-  * @brief    Config  FLASH.
-  * @param   Config -   Config_struct*     Config.
-  * @return  flash status.
+  * @brief   Снятие блокировки записи/стирания FLASH.
+  * @details Границы FLASH копируются из геометрии в SRAM: проверки адресов в функциях FLASH_RAMFUNC \n 
+  *          не обращаются к Flash_geometry.c во FLASH.
+  * @return  None.
   */
-flash_status Write_Config_to_flash (Config_struct* Config)
+void Unlock_flash (void)
 {
-fmc_state_enum state;
+const Flash_geometry_struct *geometry = Get_flash_geometry();
 
+Flash_end   = geometry->End_addr;
+Flash_bank1 = geometry->Bank1_addr;
 fmc_unlock(); // Unlock the main FMC operation.
-state = fmc_page_erase(ADDR_CONFIG_PAGE);
+STATS_ADD(Unlocks, 1);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Установка блокировки записи/стирания FLASH.
+  * @return  None.
+  */
+void Lock_flash (void)
+{
+fmc_lock(); // Lock the main FMC operation.
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Стирание страницы FLASH.
+  * @details Стирается страница, содержащая адрес Address. FLASH должна быть разблокирована (Unlock_flash). \n 
+  *          При FLASH_RAMFUNC_MODE = 1 выполняется из SRAM через регистры FMC (Erase_Page_by_registers).
+  * @param   Address - адрес внутри стираемой страницы.
+  * @return  flash status.
+  */
+FLASH_RAMFUNC flash_status Erase_Page_of_flash (uint32_t Address)
+{
+if ( (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_LAST_PAGE) )
+  return FLASH_WROG_ADDRES;
+
+#if (FLASH_RAMFUNC_MODE)
+if (ADDR_IN_BANK1(Address))
+  return Erase_Page_by_registers(&FMC_CTL1, &FMC_STAT1, &FMC_ADDR1, Address);
+return Erase_Page_by_registers(&FMC_CTL0, &FMC_STAT0, &FMC_ADDR0, Address);
+#else
+uint32_t       start = STATS_TIME();
+fmc_state_enum state = fmc_page_erase(Address);
+
+STATS_BUSY(Flash_stats.Erase_max_cycles, start);
 if (state != FMC_READY)
+  {
+  if (state == FMC_TOERR)
+    STATS_ADD(Timeouts, 1);
+  STATS_ERROR(FLASH_ERROR, Address);
   return FLASH_ERROR;
-else
+  }
+STATS_ADD(Erases, 1);
+return FLASH_OK;
+#endif
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Программирование массива слов в стёртую область FLASH.
+  * @details Стирание не выполняется. FLASH должна быть разблокирована (Unlock_flash).                  \n 
+  *          При FLASH_BATCHED_PROGRAM = 1 массив программируется сериями (Program_Run_to_flash),       \n 
+  *          отдельная серия для каждого банка FMC (bank1 есть только на Extra-density).               \n 
+  *          При FLASH_BATCHED_PROGRAM = 0 каждое слово программируется функцией fmc_word_program.
+  * @param   Address - адрес начальной ячейки.
+  * @param   Amount  - количество записываемых слов.
+  * @param   Words   - указатель типа uint32_t* на массив с данными. Данные должны быть выровнены по 4 байта.
+  * @return  flash status.
+  */
+FLASH_RAMFUNC flash_status Program_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words)
+{
+if ( (Address < PAGE0_ADDR) || (Address + 4*Amount - 1 > END_ADDR_OF_LAST_PAGE) )
+  return FLASH_WROG_ADDRES;
+
+#if (FLASH_BATCHED_PROGRAM)
+flash_status state = FLASH_OK;
+uint32_t     run   = Amount;
+uint32_t     bank1 = BANK1_ADDR;
+
+if ( (bank1 != 0) && (Address >= bank1) )
+  return Program_Run_to_flash(&FMC_CTL1, &FMC_STAT1, Address, Amount, Words); // Массив целиком в bank1.
+
+if ( (bank1 != 0) && (Address + 4*Amount > bank1) )
+  run = (bank1 - Address) / 4; // Количество слов массива в bank0.
+
+state = Program_Run_to_flash(&FMC_CTL0, &FMC_STAT0, Address, run, Words);
+if ( (state == FLASH_OK) && (run < Amount) )
+  state = Program_Run_to_flash(&FMC_CTL1, &FMC_STAT1, Address + 4*run, Amount - run, Words + run);
+return state;
+#else
+for (uint32_t i = 0; i < Amount; i++)
   {
-  for (uint8_t i = 0; i < NUM_OF_CONFIG_WORDS; i++)
+  uint32_t       start = STATS_TIME();
+  fmc_state_enum state = fmc_word_program(Address + 4*i, *(Words + i)); // Program a word at the corresponding address.
+
+  STATS_BUSY(Flash_stats.Program_max_cycles, start);
+  if (state != FMC_READY)
     {
-    state = fmc_word_program(ADDR_CONFIG_PAGE + 4*i, *( ((uint32_t*)Config) + i )); // Program a word at the corresponding address.
-    if (state != FMC_READY)
-      {
-      break;
-      }
+    if (state == FMC_TOERR)
+      STATS_ADD(Timeouts, 1);
+    STATS_ERROR(FLASH_ERROR, Address + 4*i);
+    return FLASH_ERROR;
     }
+  STATS_ADD(Programs, 1);
+  STATS_VERIFY(Address + 4*i, *(Words + i));
   }
-fmc_lock(); // Lock the main FMC operation.
-
-if (state != FMC_READY)
-  return FLASH_ERROR;
-else
-  return FLASH_OK;
+return FLASH_OK;
+#endif
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief    Config  FLASH.
-  * @param   Config -   Config_struct*     Config.
-  * @return  None.
+  * @brief   Размер страницы FLASH.
+  * @details Размер страницы определяется плотностью (density) контроллера по FMC_SIZE (Flash_geometry.c): \n 
+  *          Medium-density - 1 KB, High-density - 2 KB,                                    \n 
+  *          Extra-density - 2 KB в первых 512 Kbyte и 4 KB начиная с Page 256.
+  * @param   Address - адрес внутри страницы.
+  * @return  uint32_t - размер страницы в байтах.
   */
-void Read_Config_from_flash (Config_struct* Config)
+uint32_t Get_Page_Size_of_flash (uint32_t Address)
 {
-*Config = *((Config_struct*)ADDR_CONFIG_PAGE);
+return Get_Geometry_Page_Size(Address);
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief    RO_Constants  FLASH.
-  * @param   RO_Constants -   RO_Constants_struct*     RO_Constants.
-  * @return  None.
+  * @brief   Запуск стирания страницы FLASH без ожидания окончания.
+  * @details Окончание стирания - прерывание FMC (FMC_IRQHandler). FLASH должна быть разблокирована (Unlock_flash).
+  * @param   Address - адрес внутри стираемой страницы.
+  * @return  flash status.
   */
-void Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants)
+flash_status Start_Erase_Page_of_flash (uint32_t Address)
 {
-*RO_Constants = *((RO_Constants_struct*)ADDR_RO_CONSTANS);
+uint8_t bank;
+
+if ( (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_LAST_PAGE) )
+  return FLASH_WROG_ADDRES;
+
+bank = Get_Bank_of_flash(Address);
+if (*BANK_STAT(bank) & FMC_STAT0_BUSY)
+  return FLASH_BUSY;
+
+*BANK_STAT(bank) = FMC_STAT0_ENDF | FMC_STAT0_PGERR | FMC_STAT0_WPERR; // Сброс флагов предыдущих операций.
+*BANK_CTL(bank) |= FMC_CTL0_PER;                                        // Start page erase.
+if (bank == 0)
+  FMC_ADDR0 = Address;
+else
+  FMC_ADDR1 = Address;
+*BANK_CTL(bank) |= FMC_CTL0_START;
+#if (FLASH_STATS)
+Async_start[bank]   = STATS_TIME();
+Async_address[bank] = Address;
+Async_max[bank]     = &Flash_stats.Erase_max_cycles;
+#endif
+STATS_ADD(Erases, 1);
+return FLASH_OK;
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief       FLASH.
-  * @details      FLASH.
-  * @param   Address -   .
-  * @param   Amount  -   .
-  * @param   Words   -   uint32_t*    .      4 .
+  * @brief   Запуск программирования слова FLASH без ожидания окончания.
+  * @details Окончание программирования - прерывание FMC (FMC_IRQHandler). FLASH должна быть разблокирована (Unlock_flash).
+  * @param   Address - адрес ячейки.
+  * @param   Word    - записываемое слово.
   * @return  flash status.
   */
-flash_status Write_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words)
+flash_status Start_Program_Word_of_flash (uint32_t Address, uint32_t Word)
 {
-fmc_state_enum state;
+uint8_t bank;
 
-if ( (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_LAST_PAGE) )
+if ( (Address < PAGE0_ADDR) || (Address + 3 > END_ADDR_OF_LAST_PAGE) )
   return FLASH_WROG_ADDRES;
 
-fmc_unlock(); // Unlock the main FMC operation.
-state = fmc_page_erase(Address);
-if (state != FMC_READY)
-  return FLASH_ERROR;
+bank = Get_Bank_of_flash(Address);
+if (*BANK_STAT(bank) & FMC_STAT0_BUSY)
+  return FLASH_BUSY;
+
+*BANK_STAT(bank) = FMC_STAT0_ENDF | FMC_STAT0_PGERR | FMC_STAT0_WPERR; // Сброс флагов предыдущих операций.
+*BANK_CTL(bank) |= FMC_CTL0_PG;                                         // Set the PG bit to start program.
+REG32(Address)   = Word;
+#if (FLASH_STATS)
+Async_start[bank]   = STATS_TIME();
+Async_address[bank] = Address;
+Async_max[bank]     = &Flash_stats.Program_max_cycles;
+#endif
+STATS_ADD(Programs, 1);
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Разрешение прерывания FMC по окончании операции и по ошибке.
+  * @details Прерывания разрешаются только для банка Bank: блокирующие операции в другом банке \n 
+  *          выполняются без прерываний.
+  * @param   Bank - номер банка FMC.
+  * @return  None.
+  */
+void Enable_flash_IRQ (uint8_t Bank)
+{
+if (Bank == 0)
+  {
+  fmc_interrupt_enable(FMC_INT_BANK0_END);
+  fmc_interrupt_enable(FMC_INT_BANK0_ERR);
+  }
 else
   {
-  for (uint32_t i = 0; i < Amount; i++)
-    {
-    state = fmc_word_program(Address + 4*i, (uint32_t)*(Words + i)); // Program a halfword at the corresponding address.
-    if (state != FMC_READY)
-      {
-      break;
-      }
-    }
+  fmc_interrupt_enable(FMC_INT_BANK1_END);
+  fmc_interrupt_enable(FMC_INT_BANK1_ERR);
   }
-fmc_lock(); // Lock the main FMC operation.
+NVIC_EnableIRQ(FMC_IRQn);
+}
+//------------------------------------------------------------------------------//
 
-if (state != FMC_READY)
-  return FLASH_ERROR;
+
+/**
+  * @brief   Запрет прерывания FMC.
+  * @details Прерывание FMC в NVIC запрещается, когда прерывания запрещены для обоих банков.
+  * @param   Bank - номер банка FMC.
+  * @return  None.
+  */
+void Disable_flash_IRQ (uint8_t Bank)
+{
+if (Bank == 0)
+  {
+  fmc_interrupt_disable(FMC_INT_BANK0_END);
+  fmc_interrupt_disable(FMC_INT_BANK0_ERR);
+  }
 else
-  return FLASH_OK;
+  {
+  fmc_interrupt_disable(FMC_INT_BANK1_END);
+  fmc_interrupt_disable(FMC_INT_BANK1_ERR);
+  }
+if ( !(FMC_CTL0 & FMC_CTL0_ENDIE) && !( (BANK1_ADDR != 0) && (FMC_CTL1 & FMC_CTL1_ENDIE) ) )
+  NVIC_DisableIRQ(FMC_IRQn);
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief     Flash memory density.
-  * @details    FLASH  (Flash memory density)  (STM, GD, AT).
-  * @return  uint16_t -  FLASH    (STM, GD, AT)  Kbyte.
+  * @brief   Прерывание FMC.
+  * @details Окончание операции, запущенной Start_Erase_Page_of_flash или Start_Program_Word_of_flash, \n 
+  *          в каждом банке с разрешённым прерыванием (Complete_bank_operation).
+  * @return  None.
+  */
+void FMC_IRQHandler (void)
+{
+if ( (FMC_CTL0 & FMC_CTL0_ENDIE) && (FMC_STAT0 & (FMC_STAT0_ENDF | FMC_STAT0_PGERR | FMC_STAT0_WPERR)) )
+  Complete_bank_operation(0);
+if ( (BANK1_ADDR != 0) && (FMC_CTL1 & FMC_CTL1_ENDIE) && (FMC_STAT1 & (FMC_STAT1_ENDF | FMC_STAT1_PGERR | FMC_STAT1_WPERR)) )
+  Complete_bank_operation(1);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Номер банка FMC.
+  * @param   Address - адрес ячейки.
+  * @return  uint8_t - 0 - bank0, 1 - bank1 (только Extra-density, адреса с ADDR_OF_BANK1).
+  */
+uint8_t Get_Bank_of_flash (uint32_t Address)
+{
+uint32_t bank1 = Get_flash_geometry()->Bank1_addr; // Вызывается и до Unlock_flash (FLASH.c).
+
+if ( (bank1 != 0) && (Address >= bank1) )
+  return 1;
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Статистика операций FMC с момента старта.
+  * @details При FLASH_STATS = 0 статистика не ведётся, структура заполняется нулями.
+  * @param   Stats - указатель на структуру для статистики.
+  * @return  None.
+  */
+void Get_Flash_stats (Flash_stats_struct *Stats)
+{
+#if (FLASH_STATS)
+STATS_ATOMIC(*Stats = Flash_stats); // Без изменения статистики из FMC_IRQHandler во время копирования.
+#else
+Flash_stats_struct none = {0};
+
+*Stats = none;
+#endif
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Чтение параметра Flash memory density.
+  * @details Чтение значения размера FLASH памяти (Flash memory density) микроконтроллера (STM, GD, AT).
+  * @return  uint16_t - размер FLASH памяти используемого микроконтроллера (STM, GD, AT) в Kbyte.
   */
 uint16_t Read_MCU_FMD (void)
 {
@@ -311,4 +573,185 @@ return FMC_SIZE;
 //------------------------------------------------------------------------------//
 
 
+/**
+  * @brief   Расчёт CRC32 массива слов на блоке CRC.
+  * @details Результат совпадает с Calc_CRC32_soft (FLASH.c). Блок CRC сбрасывается перед расчётом, \n 
+  *          поэтому функция не вызывается одновременно из прерываний и основной программы.
+  * @param   Words  - указатель на массив слов.
+  * @param   Amount - количество слов.
+  * @return  uint32_t - CRC32.
+  */
+uint32_t Calc_CRC32 (const uint32_t *Words, uint32_t Amount)
+{
+rcu_periph_clock_enable(RCU_CRC);
+crc_data_register_reset();
+return crc_block_data_calculate((uint32_t*)Words, Amount);
+}
+//------------------------------------------------------------------------------//
+
+
+#if (FLASH_RAMFUNC_MODE)
+/**
+  * @brief   Перенос таблицы векторов в SRAM.
+  * @details Таблица векторов копируется в SRAM, VTOR переключается на копию: выборка вектора при входе   \n 
+  *          в прерывание не обращается к FLASH и не останавливается на время стирания/программирования.  \n 
+  *          Вызывается один раз после Init_MCU, до разрешения прерываний, обслуживаемых во время операций FLASH. \n 
+  *          Если таблица (__Vectors_Size) больше RAM_VECTORS_NUM слов, VTOR не переключается.
+  * @return  None.
+  */
+void Init_flash_RAM_mode (void)
+{
+extern uint32_t       __Vectors[];
+extern const uint32_t __Vectors_Size;
+
+if ((uint32_t)(uintptr_t)&__Vectors_Size / 4 > RAM_VECTORS_NUM)
+  return; // Таблица векторов не помещается в Vectors_in_RAM: векторы выбираются из FLASH.
+for (uint32_t i = 0; i < (uint32_t)(uintptr_t)&__Vectors_Size / 4; i++)
+  {
+  Vectors_in_RAM[i] = __Vectors[i];
+  }
+SCB->VTOR = (uint32_t)(uintptr_t)Vectors_in_RAM;
+__DSB();
+}
+//------------------------------------------------------------------------------//
+#endif
+
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Окончание операции без ожидания в банке FMC.
+  * @details Сброс флагов и битов PER/PG банка, передача результата надаппаратному драйверу (Flash_operation_complete).
+  * @param   Bank - номер банка FMC.
+  * @return  None.
+  */
+static void Complete_bank_operation (uint8_t Bank)
+{
+flash_status state = FLASH_OK;
+
+if (*BANK_STAT(Bank) & (FMC_STAT0_PGERR | FMC_STAT0_WPERR))
+  state = FLASH_ERROR;
+#if (FLASH_STATS)
+STATS_BUSY(*Async_max[Bank], Async_start[Bank]);
+if (state != FLASH_OK)
+  STATS_ERROR(state, Async_address[Bank]);
+#endif
+*BANK_STAT(Bank) = FMC_STAT0_ENDF | FMC_STAT0_PGERR | FMC_STAT0_WPERR;
+*BANK_CTL(Bank) &= ~(FMC_CTL0_PER | FMC_CTL0_PG);
+
+Flash_operation_complete(Bank, state);
+}
+//------------------------------------------------------------------------------//
+
+
+#if (FLASH_BATCHED_PROGRAM)
+/**
+  * @brief   Программирование серии слов в пределах одного банка FMC.
+  * @details Бит PG устанавливается один раз на всю серию, между словами выполняется только ожидание   \n 
+  *          сброса BUSY. Флаги PGERR и WPERR проверяются один раз после серии: флаги не сбрасываются  \n 
+  *          аппаратно, поэтому ошибка в любом слове серии сохраняется до проверки.                     \n 
+  *          Регистры CTL1/STAT1 банка bank1 имеют то же расположение битов, что и CTL0/STAT0.
+  * @param   Ctl     - указатель на регистр управления банка (FMC_CTL0 или FMC_CTL1).
+  * @param   Stat    - указатель на регистр состояния банка (FMC_STAT0 или FMC_STAT1).
+  * @param   Address - адрес начальной ячейки.
+  * @param   Amount  - количество записываемых слов.
+  * @param   Words   - указатель типа uint32_t* на массив с данными.
+  * @return  flash status.
+  */
+static FLASH_RAMFUNC flash_status Program_Run_to_flash (volatile uint32_t *Ctl, volatile uint32_t *Stat, uint32_t Address, uint32_t Amount, uint32_t *Words)
+{
+uint32_t timeout;
+uint32_t i = 0;
+#if (FLASH_RAMFUNC_MODE)
+uint32_t basepri = __get_BASEPRI();
+
+__set_BASEPRI(FLASH_RAM_ISR_PRIO_LIMIT << (8U - __NVIC_PRIO_BITS)); // Прерывания с обработчиками во FLASH ожидают окончания серии.
+#endif
+
+for (timeout = FMC_TIMEOUT_COUNT; (*Stat & FMC_STAT0_BUSY) && (timeout > 0); timeout--) // Wait for the FMC ready.
+  {;}
+STATS_ADD(Busy_waits, FMC_TIMEOUT_COUNT - timeout);
+*Stat = FMC_STAT0_ENDF | FMC_STAT0_PGERR | FMC_STAT0_WPERR; // Сброс флагов предыдущих операций.
+*Ctl |= FMC_CTL0_PG;                                         // Set the PG bit to start program.
+
+for (i = 0; (i < Amount) && (timeout > 0); i++)
+  {
+  uint32_t start = STATS_TIME();
+
+  REG32(Address + 4*i) = *(Words + i);
+  for (timeout = FMC_TIMEOUT_COUNT; (*Stat & FMC_STAT0_BUSY) && (timeout > 0); timeout--) // Wait for the FMC ready.
+    {;}
+  STATS_ADD(Busy_waits, FMC_TIMEOUT_COUNT - timeout);
+  STATS_BUSY(Flash_stats.Program_max_cycles, start);
+  STATS_ADD(Programs, 1);
+  if (timeout > 0)
+    STATS_VERIFY(Address + 4*i, *(Words + i));
+  }
+
+*Ctl &= ~FMC_CTL0_PG; // Reset the PG bit.
+#if (FLASH_RAMFUNC_MODE)
+__set_BASEPRI(basepri);
+#endif
+if ( (timeout == 0) || (*Stat & (FMC_STAT0_PGERR | FMC_STAT0_WPERR)) )
+  {
+  if (timeout == 0)
+    STATS_ADD(Timeouts, 1);
+  STATS_ERROR(FLASH_ERROR, Address + 4*((i > 0) ? i - 1 : 0)); // Последнее слово, запись которого начата.
+  return FLASH_ERROR;
+  }
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+#endif
+
+
+#if (FLASH_RAMFUNC_MODE)
+/**
+  * @brief   Стирание страницы через регистры FMC (выполняется из SRAM).
+  * @details Повторяет последовательность fmc_page_erase без вызова функций из FLASH.                  \n 
+  *          На время стирания BASEPRI маскирует прерывания с приоритетом FLASH_RAM_ISR_PRIO_LIMIT и ниже. \n 
+  *          Регистры CTL1/STAT1/ADDR1 банка bank1 имеют то же расположение битов, что и CTL0/STAT0/ADDR0. \n 
+  *          Ошибка - таймаут, PGERR или WPERR после стирания.
+  * @param   Ctl     - указатель на регистр управления банка (FMC_CTL0 или FMC_CTL1).
+  * @param   Stat    - указатель на регистр состояния банка (FMC_STAT0 или FMC_STAT1).
+  * @param   Addr    - указатель на регистр адреса банка (FMC_ADDR0 или FMC_ADDR1).
+  * @param   Address - адрес внутри стираемой страницы.
+  * @return  flash status.
+  */
+static FLASH_RAMFUNC flash_status Erase_Page_by_registers (volatile uint32_t *Ctl, volatile uint32_t *Stat, volatile uint32_t *Addr, uint32_t Address)
+{
+uint32_t timeout;
+uint32_t start;
+uint32_t basepri = __get_BASEPRI();
+
+__set_BASEPRI(FLASH_RAM_ISR_PRIO_LIMIT << (8U - __NVIC_PRIO_BITS)); // Прерывания с обработчиками во FLASH ожидают окончания стирания.
+
+for (timeout = FMC_TIMEOUT_COUNT; (*Stat & FMC_STAT0_BUSY) && (timeout > 0); timeout--) // Wait for the FMC ready.
+  {;}
+STATS_ADD(Busy_waits, FMC_TIMEOUT_COUNT - timeout);
+*Stat = FMC_STAT0_ENDF | FMC_STAT0_PGERR | FMC_STAT0_WPERR; // Сброс флагов предыдущих операций.
+*Ctl |= FMC_CTL0_PER;                                        // Start page erase.
+*Addr = Address;
+start = STATS_TIME();
+*Ctl |= FMC_CTL0_START;
+for (timeout = FMC_TIMEOUT_COUNT; (*Stat & FMC_STAT0_BUSY) && (timeout > 0); timeout--) // Wait for the FMC ready.
+  {;}
+STATS_ADD(Busy_waits, FMC_TIMEOUT_COUNT - timeout);
+STATS_BUSY(Flash_stats.Erase_max_cycles, start);
+*Ctl &= ~FMC_CTL0_PER; // Reset the PER bit.
+
+__set_BASEPRI(basepri);
+if ( (timeout == 0) || (*Stat & (FMC_STAT0_PGERR | FMC_STAT0_WPERR)) )
+  {
+  if (timeout == 0)
+    STATS_ADD(Timeouts, 1);
+  STATS_ERROR(FLASH_ERROR, Address);
+  return FLASH_ERROR;
+  }
+STATS_ADD(Erases, 1);
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+#endif
+
+
 //***************************************END OF FILE**************************************//
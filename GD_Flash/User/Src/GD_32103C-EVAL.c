@@ -3,9 +3,9 @@
   *
   * @file      CAN_GD32F103R.c
   *
-  * @brief           GD_32103-EVAL.
+  * @brief     Аппаратный драйвер для работы с платой GD_32103С-EVAL.
   * 
-  * @copyright Copyright (C) 2022 Awada Systems.   .
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
   *
   * @author    Larionov A.S. (larion.alex@mail.ru)
   *
@@ -16,6 +16,7 @@
 #include "GD_32103C-EVAL.h"
 #include "gd32f10x_gpio.h"
 #include "systick.h"
+#include "FLASH.h"
 //------------------------------------------------------------------------------//
 
 //---Private macros ------------------------------------------------------------//
@@ -28,6 +29,8 @@
 //------------------------------------------------------------------------------//
 
 //---Private variables----------------------------------------------------------//
+static uint32_t Irq_last_entry  = 0; /*!< Значение DWT CYCCNT при предыдущем входе в SysTick_Handler.  */
+static uint32_t Irq_latency_max = 0; /*!< Наибольшая задержка входа в SysTick_Handler в тактах ядра.  */
 //------------------------------------------------------------------------------//
 
 //---Private constants----------------------------------------------------------//
@@ -38,9 +41,9 @@
 
 //---Exported functions---------------------------------------------------------//
 /**
-  * @brief    .
-  * @details  :
-  *          .  -> internal 8MRC (8MHz) -> external HXTAL (8MHz) -> PLL -> \n 
+  * @brief   Инициализация микроконтроллера.
+  * @details Настройки тактирования:
+  *          Вкл. питание -> internal 8MRC (8MHz) -> external HXTAL (8MHz) -> PLL -> \n 
   *          -> 96MHz -> CK_SYS 96MHz -> AHB 96MHz -> /1 -> APB2 96 MHz              \n 
   *                                               |                                  \n 
   *                                                -> /2 -> APB1 48 MHz
@@ -52,7 +55,7 @@ void Init_MCU (void)
 RCU_APB1EN |= RCU_APB1EN_PMUEN; // Enabled power management unit (PMU) clock.
 systick_config();               // Configure the system clock.
 
-//--- GPIO-----------------------------------------//
+//---Настройка GPIO-----------------------------------------//
 RCU_APB2EN |= RCU_APB2EN_PCEN; // IO port C clock enabled.
 RCU_APB2EN |= RCU_APB2EN_PEEN; // IO port E clock enabled.
 
@@ -91,5 +94,86 @@ delay_1ms(100);
 //------------------------------------------------------------------------------//
 
 
+/**
+  * @brief   Запуск счётчика тактов ядра (DWT CYCCNT).
+  * @details Используется для замера времени выполнения функций в тактах ядра.  \n 
+  *          Счётчик сбрасывается в 0. Вызывается один раз при старте (Start_Latency_Probe): повторный   \n 
+  *          запуск во время замера задержки прерывания искажает результат Probe_IRQ_latency.
+  * @return  None.
+  */
+void Start_Cycle_Counter (void)
+{
+CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Enable DWT.
+DWT->CYCCNT       = 0;
+DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;     // Enable cycle counter.
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Чтение счётчика тактов ядра (DWT CYCCNT).
+  * @return  uint32_t - количество тактов ядра с момента запуска счётчика.
+  */
+uint32_t Get_Cycle_Counter (void)
+{
+return DWT->CYCCNT;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запуск замера задержки обработки прерывания SysTick.
+  * @details Сбрасывает результат предыдущего замера и запускает счётчик тактов ядра.
+  * @return  None.
+  */
+void Start_Latency_Probe (void)
+{
+Start_Cycle_Counter();
+Irq_last_entry  = 0;
+Irq_latency_max = 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Замер задержки обработки прерывания SysTick.
+  * @details Вызывается первой командой SysTick_Handler. Задержка - число тактов ядра от запроса прерывания  \n 
+  *          (перезагрузки SysTick) до входа в обработчик. Если ядро стояло дольше периода SysTick        \n 
+  *          (например, выборка команд из FLASH во время стирания), пропущенные периоды определяются     \n 
+  *          по DWT CYCCNT и добавляются к задержке.                                                      \n 
+  *          При FLASH_RAMFUNC_MODE = 1 размещается в SRAM.
+  * @return  None.
+  */
+FLASH_RAMFUNC void Probe_IRQ_latency (void)
+{
+uint32_t period  = SysTick->LOAD + 1;
+uint32_t latency = SysTick->LOAD - SysTick->VAL; // Тактов с последней перезагрузки SysTick.
+uint32_t now     = DWT->CYCCNT;
+uint32_t ticks;
+
+if (Irq_last_entry != 0)
+  {
+  ticks = (now - Irq_last_entry + period / 2) / period; // Периодов SysTick с предыдущего входа.
+  if (ticks > 1)
+    latency += (ticks - 1) * period;                     // Пропущенные запросы SysTick.
+  if (latency > Irq_latency_max)
+    Irq_latency_max = latency;
+  }
+Irq_last_entry = now;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Результат замера задержки обработки прерывания SysTick.
+  * @return  uint32_t - наибольшая задержка входа в SysTick_Handler в тактах ядра с момента Start_Latency_Probe.
+  */
+uint32_t Get_IRQ_Latency_max (void)
+{
+return Irq_latency_max;
+}
+//------------------------------------------------------------------------------//
+
+
 
 //***************************************END OF FILE**************************************//
@@ -37,6 +37,8 @@ OF SUCH DAMAGE.
 //---Includes-------------------------------------------------------------------//
 #include "gd32f10x_it.h"
 #include "systick.h"
+#include "GD_32103C-EVAL.h"
+#include "FLASH.h"
 //------------------------------------------------------------------------------//
 
 //---Defines--------------------------------------------------------------------//
@@ -142,7 +144,8 @@ void PendSV_Handler(void)
     \param[out] none
     \retval     none
 */
-void SysTick_Handler(void)
+FLASH_RAMFUNC void SysTick_Handler(void)
 {
+Probe_IRQ_latency();
 delay_decrement();
 }
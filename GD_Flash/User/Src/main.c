@@ -50,18 +50,21 @@ Cfg->ModbusPort0Param.reserved_param = 0xEE;
 
   
 /*
-  * **  Config Page**
-  *                         |       | 0x00 | 0x01 | 0x02 | 0x03
-  * ------------------------------- | ---------- | ---- | ---- | ---- | ---- 
-  *                      | 0x0801F000 | addr | 0xFF | 0xFF | 0xFF
-  *                 | 0x0801F004 | minor| major| 0xFF | 0xFF
-  *                  | 0x0801F008 | minor| major| 0xFF | 0xFF
-  *               | 0x0801F00C | flag | 0xFF | 0xFF | 0xFF
-  *     Modbus | 0x0801F010 | 0xFF | 0xFF | 0xFF | 0xFF
-  *  Modbus  0        | 0x0801F014 | baud | par  | stop | 0xFF
-  *  Modbus  1        | 0x0801F018 | baud | par  | stop | 0xFF
-  *  Modbus  2        | 0x0801F01C | baud | par  | stop | 0xFF
-  *  Modbus  3        | 0x0801F020 | baud | par  | stop | 0xFF
+  * **Карта памяти Config Page**
+  * Параметр                        | Адрес      | 0x00     | 0x01     | 0x02 | 0x03
+  * ------------------------------- | ---------- | -------- | -------- | ---- | ----
+  * Номер записи                    | 0x0801F000 | seq      | seq      | seq  | seq
+  * Адрес модуля                    | 0x0801F004 | addr     | 0xFF     | 0xFF | 0xFF
+  * Скорость CAN                    | 0x0801F008 |          |          |      |
+  * Версия загрузчика               | 0x0801F00C | bl_minor | bl_major | 0xFF | 0xFF
+  * Версия программы                | 0x0801F010 | sw_minor | sw_major | 0xFF | 0xFF
+  * Флаг первого запуска            | 0x0801F014 | flag     | 0xFF     | 0xFF | 0xFF
+  * Не используется в модуле Modbus | 0x0801F018 | 0xFF     | 0xFF     | 0xFF | 0xFF
+  * Параметры Modbus порта 0        | 0x0801F01C | baud     | par      | stop | 0xFF
+  * Параметры Modbus порта 1        | 0x0801F020 | baud     | par      | stop | 0xFF
+  * Параметры Modbus порта 2        | 0x0801F024 | baud     | par      | stop | 0xFF
+  * Параметры Modbus порта 3        | 0x0801F028 | baud     | par      | stop | 0xFF
+  * Слово состояния записи          | 0x0801F02C | st       | st       | st   | st
 */
 
 Write_Config_to_flash((uint32_t*)Cfg);
@@ -80,13 +83,13 @@ Write_Words_to_flash (0x0801F800U, 4, (uint32_t*)RO_Const);
 
 Read_RO_Constants_from_flash(RO_Const_rd);
 /*
-  * **  RO Constants**
-  *              |       | 0x00  | 0x01  | 0x02 | 0x03
+  * **Карта памяти RO Constants**
+  * Параметр             | Адрес      | 0x00  | 0x01  | 0x02 | 0x03
   * -------------------- | ---------- | ----- | ----- | ---- | ---- 
-  *             | 0x0801F800 | class | 0xFF  | 0xFF | 0xFF
-  *     | 0x0801F804 | minor | major | 0xFF | 0xFF
-  *   hw    | 0x0801F808 | 0xFF  | 0xFF  | 0xFF | 0xFF
-  *   lw    | 0x0801F810 | 0xFF  | 0xFF  | 0xFF | 0xFF
+  * Тип модуля           | 0x0801F800 | class | 0xFF  | 0xFF | 0xFF
+  * Аппаратная ревизия   | 0x0801F804 | minor | major | 0xFF | 0xFF
+  * Серийный номер hw    | 0x0801F808 | 0xFF  | 0xFF  | 0xFF | 0xFF
+  * Серийный номер lw    | 0x0801F810 | 0xFF  | 0xFF  | 0xFF | 0xFF
 */
 
 while(1)
@@ -36,6 +36,7 @@ OF SUCH DAMAGE.
 
 #include "gd32f10x.h"
 #include "systick.h"
+#include "FLASH.h"
 
 volatile static uint32_t delay;
 
@@ -77,7 +78,7 @@ void delay_1ms(uint32_t count)
     \param[out] none
     \retval     none
 */
-void delay_decrement(void)
+FLASH_RAMFUNC void delay_decrement(void)
 {
     if(0U != delay){
         delay--;
@@ -0,0 +1,106 @@
+/**
+  ******************************************************************************
+  *
+  * @file      FLASH_host.h
+  *
+  * @brief     Header for FLASH_host.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FLASH_HOST_H
+#define __FLASH_HOST_H
+
+//---Includes-------------------------------------------------------------------//
+#include <stdint.h>
+#include "FLASH.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#define FLASH_SIM_SIZE_MAX_KB    3072U /*!< Наибольший объём моделируемой FLASH в Kbyte (GD32F103 Extra-density).        */
+#define FLASH_SIM_POWER_LOST     0x50U /*!< Код завершения процесса при моделируемом отключении питания (Set_flash_sim_power_cut). */
+//------------------------------------------------------------------------------//
+
+//---Exported types-------------------------------------------------------------//
+/**
+  * @brief  Моделируемый микроконтроллер (размеры страниц и банков FLASH).
+  */
+typedef enum
+{
+FLASH_SIM_GD_MD = 0, /*!< GD32F103 Medium-density: страницы 1 KB, по умолчанию 128 Kbyte.                              */
+FLASH_SIM_GD_HD    , /*!< GD32F103 High-density: страницы 2 KB, по умолчанию 512 Kbyte.                                */
+FLASH_SIM_GD_XD    , /*!< GD32F103 Extra-density: bank0 - страницы 2 KB, bank1 (с ADDR_OF_BANK1) - 4 KB, по умолчанию 1024 Kbyte. */
+FLASH_SIM_AT32F413   /*!< AT32F413: секторы 2 KB, по умолчанию 256 Kbyte.                                                 */
+} flash_sim_density;
+
+
+/**
+  * @brief  Состояние операции FLASH в момент отключения питания.
+  */
+typedef enum
+{
+FLASH_SIM_CUT_OFF = 0, /*!< Отключение питания не моделируется.                                                             */
+FLASH_SIM_CUT_BEFORE , /*!< Питание отключено до начала операции.                                                           */
+FLASH_SIM_CUT_TORN     /*!< Питание отключено во время операции: страница стёрта частично, у слова запрограммирована половина бит. */
+} flash_sim_cut;
+
+
+/**
+  * @brief  Длительность операций моделируемой FLASH, мкс.
+  */
+typedef struct
+{
+uint32_t Unlock_us;       /*!< Разблокировка FLASH (Unlock_flash).        */
+uint32_t Erase_page_us;   /*!< Стирание страницы.                         */
+uint32_t Program_word_us; /*!< Программирование слова.                    */
+} Flash_sim_timing_struct;
+
+
+/**
+  * @brief  Счётчики операций моделируемой FLASH.
+  */
+typedef struct
+{
+uint64_t Time_us;         /*!< Суммарное моделируемое время операций, мкс.                                       */
+uint32_t Unlocks;         /*!< Количество разблокировок.                                                        */
+uint32_t Erases;          /*!< Количество стёртых страниц.                                                      */
+uint32_t Programs;        /*!< Количество запрограммированных слов.                                             */
+uint32_t Errors;          /*!< Количество отвергнутых операций (FLASH заблокирована, слово не стёрто, адрес).  */
+} Flash_sim_stats_struct;
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Init_flash_sim               (flash_sim_density Density, uint16_t Size_KB);
+void          Set_flash_sim_timing         (const Flash_sim_timing_struct *Timing);
+void          Get_flash_sim_stats          (Flash_sim_stats_struct *Stats);
+void          Reset_flash_sim_stats        (void);
+uint32_t      Get_flash_sim_time           (void);
+uint32_t      Get_flash_sim_clock          (void);
+void          Advance_flash_sim_clock      (uint32_t Time_us);
+void          Flash_sim_IRQ                (void);
+void          Set_flash_sim_power_cut      (uint32_t Operations, flash_sim_cut Cut);
+
+uint16_t      Read_MCU_FMD                 (void);
+void          Unlock_flash                 (void);
+void          Lock_flash                   (void);
+flash_status  Erase_Page_of_flash          (uint32_t Address);
+flash_status  Program_Words_to_flash       (uint32_t Address, uint32_t Amount, uint32_t *Words);
+uint32_t      Get_Page_Size_of_flash       (uint32_t Address);
+flash_status  Start_Erase_Page_of_flash    (uint32_t Address);
+flash_status  Start_Program_Word_of_flash  (uint32_t Address, uint32_t Word);
+void          Enable_flash_IRQ             (uint8_t Bank);
+void          Disable_flash_IRQ            (uint8_t Bank);
+uint8_t       Get_Bank_of_flash            (uint32_t Address);
+void          Get_Flash_stats              (Flash_stats_struct *Stats);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __FLASH_HOST_H */
+
+
+//***********************************END OF FILE***********************************
@@ -0,0 +1,31 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_diff.h
+  *
+  * @brief     Header for Image_diff.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IMAGE_DIFF_H
+#define __IMAGE_DIFF_H
+
+//---Includes-------------------------------------------------------------------//
+#include <stdint.h>
+#include "Image_delta.h"
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+uint32_t      Diff_Image_delta             (const uint32_t *Old, uint32_t Old_size, const uint32_t *New, uint32_t New_size, uint8_t *Patch, uint32_t Capacity);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __IMAGE_DIFF_H */
+
+//***********************************END OF FILE***********************************
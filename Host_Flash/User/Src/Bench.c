@@ -0,0 +1,196 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Bench.c
+  *
+  * @brief     Замеры Flash_bench.c на модели FLASH (ПК, Linux).
+  *
+  * @details   Выполняет Run_Flash_bench на чистой модели FLASH и выводит отчёт CSV (время - мкс модели).         \n
+  *            Main Programm модели заполняется машинным кодом flash_bench (образ замера lz_unpack_16k).             \n
+  *            Часы модели не учитывают время процессора, поэтому скорость распаковки Unpack_Image_lz                \n
+  *            (Main Programm, MEMSIZE_MAIN_PROGRAM Kbyte) на ПК замеряется отдельно и выводится в stderr.           \n
+  *            Так же замеряется Init_Log_ring журнала из LOG_PAGES страниц, записанного на полтора круга: модель         \n
+  *            переключается на FLASH_SIM_SIZE_MAX_KB Kbyte, журнал размещается за первым мегабайтом FLASH.          \n
+  *            Для сравнения тот же журнал просматривается линейно (Scan_log_linear - все заголовки страниц и слова     \n
+  *            состояния записей до первой стёртой): выводятся время обоих способов на ПК и количество прочитанных слов   \n
+  *            линейного просмотра (Init_Log_ring - двоичный поиск: около 10 заголовков и 7 записей при 512 страницах).  \n
+  *            Сборка и запуск: make -C Host_Flash bench (DENSITY=HD|XD|AT|MD), например, make -s bench > bench.csv.  \n
+  *            Код завершения 0 - все замеры выполнены.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "FLASH_host.h"
+#include "Flash_bench.h"
+#include "Flash_geometry.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#ifndef FLASH_SIM_DENSITY
+#define FLASH_SIM_DENSITY   FLASH_SIM_GD_HD     /*!< Моделируемый микроконтроллер (задаётся в Makefile: DENSITY=HD|XD|AT|MD). */
+#endif
+
+#define LZ_BYTES            (MEMSIZE_MAIN_PROGRAM * 1024U) /*!< Образ замера распаковки на ПК (Main Programm).          */
+#define LZ_REPEATS          50U                 /*!< Количество распаковок замера на ПК.                                  */
+#define LOG_PAGES           512U                /*!< Страниц журнала замера Init_Log_ring на ПК.                          */
+#define LOG_ADDR            (PAGE0_ADDR + 1024U * 1024U) /*!< Начало журнала замера Init_Log_ring на ПК.                  */
+#define LOG_REPEATS         10000U              /*!< Количество вызовов Init_Log_ring замера на ПК.                      */
+#define LOG_SCAN_REPEATS    100U                /*!< Количество линейных просмотров журнала замера на ПК.                */
+#define LOG_SLOT_WORDS      (FLASH_BENCH_LOG_RECORD / 4 + 1) /*!< Размер записи журнала во FLASH в словах (см. Log_ring.c). */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint32_t Lz_image [LZ_BYTES / 4];                     /*!< Машинный код flash_bench, затем распакованный образ.   */
+static uint8_t  Lz_packed[IMAGE_LZ_PACKED_MAX(LZ_BYTES)];    /*!< Сжатый образ.                                          */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static uint32_t Scan_log_linear (uint32_t *Reads);
+static double   Seconds_since   (const struct timespec *Start);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+int main (void)
+{
+Flash_bench_result_struct results[FLASH_BENCH_NUM];
+char                      report[512];
+flash_status              state;
+FILE                     *exe;
+uint32_t                  packed;
+uint32_t                  size;
+struct timespec           start;
+double                    seconds;
+double                    scan_seconds;
+uint32_t                  records;
+uint32_t                  record[FLASH_BENCH_LOG_RECORD / 4] = {0};
+uint32_t                  scanned = 0;
+uint32_t                  reads   = 0;
+
+if (Init_flash_sim(FLASH_SIM_DENSITY, 0) != FLASH_OK)
+  {
+  fprintf(stderr, "FAIL: Init_flash_sim\n");
+  return 1;
+  }
+
+exe = fopen("/proc/self/exe", "rb");
+memset(Lz_image, 0xFF, sizeof(Lz_image));
+if (exe != 0)
+  {
+  fseek(exe, 4096, SEEK_SET);
+  fread(Lz_image, 1, LZ_BYTES, exe);
+  fclose(exe);
+  }
+Write_Words_to_flash(ADDR_MAIN_PROGRAM, LZ_BYTES / 4, Lz_image);
+
+state = Run_Flash_bench(Get_flash_sim_time, results);
+Format_Flash_bench_report(results, "us", report, sizeof(report));
+fputs(report, stdout);
+
+packed = Pack_Image_lz((const uint32_t*)ADDR_MAIN_PROGRAM, LZ_BYTES, Lz_packed, sizeof(Lz_packed));
+clock_gettime(CLOCK_MONOTONIC, &start);
+for (uint32_t i = 0; (i < LZ_REPEATS) && (state == FLASH_OK); i++)
+  {
+  state = Unpack_Image_lz(Lz_packed, packed, Lz_image, sizeof(Lz_image), &size);
+  }
+seconds = Seconds_since(&start);
+fprintf(stderr, "lz: %u -> %u bytes (%u%%), unpack %.1f MB/s (host CPU)\n",
+        LZ_BYTES, packed, packed * 100 / LZ_BYTES, (double)LZ_BYTES * LZ_REPEATS / seconds / 1e6);
+
+if (state == FLASH_OK)
+  state = Init_flash_sim(FLASH_SIM_DENSITY, (FLASH_SIM_DENSITY == FLASH_SIM_GD_MD) ? 0 : FLASH_SIM_SIZE_MAX_KB);
+Init_flash_geometry(); // Раскладка FLASH.h не проверяется: журнал занимает LOG_ADDR.
+if ( (state == FLASH_OK) && !Area_in_flash(LOG_ADDR, LOG_PAGES * Get_Page_Size_of_flash(LOG_ADDR)) )
+  {
+  fprintf(stderr, "log_init: %u pages from LOG_ADDR outside FLASH, skipped\n", LOG_PAGES);
+  return 0;
+  }
+if (state == FLASH_OK)
+  state = Init_Log_ring(LOG_ADDR, LOG_PAGES, FLASH_BENCH_LOG_RECORD);
+records = LOG_PAGES * 3 / 2 * (Get_Page_Size_of_flash(LOG_ADDR) / (FLASH_BENCH_LOG_RECORD + 4));
+for (uint32_t i = 0; (i < records) && (state == FLASH_OK); i++)
+  {
+  record[0] = i;
+  state     = Append_Log_to_flash(record);
+  }
+clock_gettime(CLOCK_MONOTONIC, &start);
+for (uint32_t i = 0; (i < LOG_REPEATS) && (state == FLASH_OK); i++)
+  {
+  state = Init_Log_ring(LOG_ADDR, LOG_PAGES, FLASH_BENCH_LOG_RECORD);
+  }
+seconds = Seconds_since(&start);
+clock_gettime(CLOCK_MONOTONIC, &start);
+for (uint32_t i = 0; i < LOG_SCAN_REPEATS; i++)
+  {
+  scanned = Scan_log_linear(&reads);
+  }
+scan_seconds = Seconds_since(&start);
+if ( (state == FLASH_OK) && (scanned != Get_Log_count()) )
+  state = FLASH_ERROR; // Способы нашли разное количество записей.
+fprintf(stderr, "log_init: %u pages of %u bytes, %u records, %.3f us per Init_Log_ring (host CPU)\n",
+        LOG_PAGES, Get_Page_Size_of_flash(LOG_ADDR), Get_Log_count(), seconds / LOG_REPEATS * 1e6);
+fprintf(stderr, "log_scan: %u records, %u words read, %.3f us per linear scan (host CPU), %.0fx Init_Log_ring\n",
+        scanned, reads, scan_seconds / LOG_SCAN_REPEATS * 1e6, (scan_seconds / LOG_SCAN_REPEATS) / (seconds / LOG_REPEATS));
+return (state == FLASH_OK) ? 0 : 1;
+}
+//------------------------------------------------------------------------------//
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Линейный просмотр журнала замера (для сравнения с Init_Log_ring).
+  * @details Читаются заголовки всех LOG_PAGES страниц, на размеченных страницах - слова состояния записей \n
+  *          до первой стёртой записи. Записи подсчитываются на всех размеченных страницах: впереди конца   \n
+  *          журнала одна стёртая страница, остальные - от начала до конца журнала.
+  * @param   Reads - указатель для количества прочитанных слов FLASH.
+  * @return  uint32_t - количество записей журнала.
+  */
+static uint32_t Scan_log_linear (uint32_t *Reads)
+{
+const uint32_t *page;
+uint32_t        page_size = Get_Page_Size_of_flash(LOG_ADDR);
+uint32_t        slots     = (page_size / 4 - 2) / LOG_SLOT_WORDS;
+uint32_t        records   = 0;
+
+*Reads = 0;
+for (uint32_t p = 0; p < LOG_PAGES; p++)
+  {
+  page    = (const uint32_t*)(uintptr_t)(LOG_ADDR + p * page_size);
+  *Reads += 2;
+  if ( (page[0] == BLANK_WORD) || (page[1] != LOG_PAGE_TAG(FLASH_BENCH_LOG_RECORD)) )
+    continue;
+  for (uint32_t slot = 0; slot < slots; slot++)
+    {
+    (*Reads)++;
+    if (page[2 + slot * LOG_SLOT_WORDS + LOG_SLOT_WORDS - 1] != LOG_RECORD_VALID)
+      break;
+    records++;
+    }
+  }
+return records;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Время с момента Start.
+  * @param   Start - момент начала замера (CLOCK_MONOTONIC).
+  * @return  double - время в секундах.
+  */
+static double Seconds_since (const struct timespec *Start)
+{
+struct timespec stop;
+
+clock_gettime(CLOCK_MONOTONIC, &stop);
+return (stop.tv_sec - Start->tv_sec) + (stop.tv_nsec - Start->tv_nsec) * 1e-9;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
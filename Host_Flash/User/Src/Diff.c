@@ -0,0 +1,177 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Diff.c
+  *
+  * @brief     Создание патча разностного обновления (ПК, Linux): image_diff.
+  *
+  * @details   Читает прежний (установленный в Main Programm) и новый образы прошивки (.bin), создаёт патч                \n
+  *            Diff_Image_delta (Image_diff.c), проверяет его на модели FLASH: прежний образ записывается в Main Programm,  \n
+  *            патч применяется Open_Image_delta / Write_Image_delta_chunk / Finalize_Image_delta, Download Buffer          \n
+  *            сравнивается с новым образом. Затем патч записывается в файл.                                                 \n
+  *            Сборка: make -C Host_Flash image_diff. Запуск: ./image_diff old.bin new.bin image.patch [baud].               \n
+  *            Выводит размеры, время передачи при скорости baud (по умолчанию 9600, 10 бит на байт) и количество           \n
+  *            изменённых страниц Main Programm (Install_Image перезаписывает только их).                                   \n
+  *            Код завершения 0 - патч создан и проверен.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FLASH_host.h"
+#include "Image_diff.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define DIFF_OLD_BYTES      (MEMSIZE_MAIN_PROGRAM * 1024U)      /*!< Наибольший размер прежнего образа (Main Programm).  */
+#define DIFF_NEW_BYTES      (MEMSIZE_DOWNLOAD_BUFFER * 1024U)   /*!< Наибольший размер нового образа (Download Buffer).  */
+#define DIFF_BAUD           9600U                               /*!< Скорость передачи по умолчанию.                     */
+
+#ifndef FLASH_SIM_DENSITY
+#define FLASH_SIM_DENSITY   FLASH_SIM_GD_HD     /*!< Моделируемый микроконтроллер (задаётся в Makefile: DENSITY=HD|XD|AT|MD). */
+#endif
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint32_t Old  [DIFF_OLD_BYTES / 4 + 1];                  /*!< Прежний образ, дополненный до слова байтами 0xFF.  */
+static uint32_t New  [DIFF_NEW_BYTES / 4 + 1];                  /*!< Новый образ, дополненный до слова байтами 0xFF.    */
+static uint8_t  Patch[IMAGE_DELTA_PATCH_MAX(DIFF_NEW_BYTES)];   /*!< Патч.                                               */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static uint32_t     Read_image   (const char *Name, uint32_t *Image, uint32_t Capacity);
+static flash_status Apply_patch  (uint32_t Size);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+int main (int argc, char **argv)
+{
+FILE     *file;
+uint32_t  old_size;
+uint32_t  new_size;
+uint32_t  size;
+uint32_t  page_size;
+uint32_t  pages   = 0;
+uint32_t  changed = 0;
+uint32_t  baud    = (argc > 4) ? (uint32_t)strtoul(argv[4], 0, 10) : DIFF_BAUD;
+
+if ( (argc < 4) || (baud == 0) )
+  {
+  fprintf(stderr, "usage: image_diff old.bin new.bin image.patch [baud]\n");
+  return 2;
+  }
+
+old_size = Read_image(argv[1], Old, DIFF_OLD_BYTES);
+new_size = Read_image(argv[2], New, DIFF_NEW_BYTES);
+if ( (old_size == 0) || (new_size == 0) )
+  return 1;
+
+size = Diff_Image_delta(Old, old_size, New, new_size, Patch, sizeof(Patch));
+if (Init_flash_sim(FLASH_SIM_DENSITY, 0) != FLASH_OK)
+  {
+  fprintf(stderr, "FAIL: Init_flash_sim\n");
+  return 1;
+  }
+Write_Words_to_flash(ADDR_MAIN_PROGRAM, (old_size + 3U) / 4, Old);
+if ( (size == 0) || (Apply_patch(size) != FLASH_OK) ||
+     (memcmp((const void*)ADDR_DOWNLOAD_BUFFER, New, (new_size + 3U) & ~3U) != 0) )
+  {
+  fprintf(stderr, "FAIL: patched image differs\n");
+  return 1;
+  }
+
+file = fopen(argv[3], "wb");
+if ( (file == 0) || (fwrite(Patch, 1, size, file) != size) || (fclose(file) != 0) )
+  {
+  fprintf(stderr, "FAIL: %s: cannot write\n", argv[3]);
+  return 1;
+  }
+
+page_size = Get_Page_Size_of_flash(ADDR_MAIN_PROGRAM);
+for (uint32_t i = 0; i < new_size; i += page_size)
+  {
+  uint32_t length = (new_size - i < page_size) ? new_size - i : page_size;
+
+  pages++;
+  if ( (i >= old_size) || (memcmp((uint8_t*)Old + i, (uint8_t*)New + i, (length + 3U) & ~3U) != 0) )
+    changed++;
+  }
+
+printf("%s: %u -> %u bytes patch (%u%%), crc32 0x%08X\n", argv[3], new_size, size, size * 100 / new_size, Patch[8] | Patch[9] << 8 | Patch[10] << 16 | (uint32_t)Patch[11] << 24);
+printf("transfer at %u baud: %.1f s -> %.1f s\n", baud, new_size * 10.0 / baud, size * 10.0 / baud);
+printf("changed pages: %u of %u\n", changed, pages);
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Чтение образа с дополнением до слова байтами 0xFF.
+  * @return  uint32_t - размер образа в байтах, 0 - ошибка.
+  */
+static uint32_t Read_image (const char *Name, uint32_t *Image, uint32_t Capacity)
+{
+FILE     *file = fopen(Name, "rb");
+uint32_t  size;
+
+if (file == 0)
+  {
+  fprintf(stderr, "FAIL: %s: cannot open\n", Name);
+  return 0;
+  }
+memset(Image, 0xFF, Capacity + 4);
+size = fread(Image, 1, Capacity + 1, file);
+fclose(file);
+if ( (size == 0) || (size > Capacity) )
+  {
+  fprintf(stderr, "FAIL: %s: image size must be 1 ... %u bytes\n", Name, Capacity);
+  return 0;
+  }
+memset((uint8_t*)Image + size, 0xFF, Capacity + 4 - size);
+return size;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Применение патча на модели FLASH частями IMAGE_DELTA_INPUT_BYTES.
+  * @return  flash_status - FLASH_OK - новый образ записан в Download Buffer.
+  */
+static flash_status Apply_patch (uint32_t Size)
+{
+flash_status state = Open_Image_delta();
+uint32_t     sent  = 0;
+uint32_t     length;
+
+while ( (state == FLASH_OK) && (sent < Size) )
+  {
+  length = (Size - sent < IMAGE_DELTA_INPUT_BYTES) ? Size - sent : IMAGE_DELTA_INPUT_BYTES;
+  state  = Write_Image_delta_chunk(Patch + sent, length);
+  if (state == FLASH_OK)
+    sent += length;
+  else if (state == FLASH_BUSY)
+    {
+    Flash_sim_IRQ();
+    state = FLASH_OK;
+    }
+  }
+if (state != FLASH_OK)
+  return state;
+while ( (state = Finalize_Image_delta()) == FLASH_BUSY )
+  {
+  Flash_sim_IRQ();
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
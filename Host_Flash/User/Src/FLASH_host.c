@@ -0,0 +1,628 @@
+/**
+  ******************************************************************************
+  *
+  * @file      FLASH_host.c
+  *
+  * @brief     Драйвер flash для ПК (Linux): модель FLASH в RAM.
+  *
+  * @details   Аппаратный драйвер для FLASH.c, который вместо FMC работает с массивом в RAM, размещённым по адресу      \n
+  *            PAGE0_ADDR. Позволяет проверять и сравнивать по времени функции FLASH.c без платы и Keil.
+  *
+  * @warning   **ВАЖНО!**                                                                                  \n
+  * Для работы драйвера требуется:
+  *                       + Linux (mmap с MAP_FIXED_NOREPLACE: адреса PAGE0_ADDR ... + 3 Mbyte должны быть свободны);
+  *                         массив FLASH разделяемый (MAP_SHARED): процессы, порождённые fork, работают с той же FLASH;
+  *                       + сборка gcc с -D__weak='__attribute__((weak))' (см. Host_Flash/Makefile).
+  *
+  * **Manual** \n
+  * В драйвере реализованы следующие функции:
+  * - Init_flash_sim (flash_sim_density Density, uint16_t Size_KB) - выбор моделируемого микроконтроллера (размеры       \n
+  *   страниц и банков) и объёма FLASH (0 - по умолчанию для Density). Вся FLASH стирается, счётчики обнуляются,         \n
+  *   устанавливается длительность операций по умолчанию. Вызывается до остальных функций FLASH.                         \n
+  *
+  * - Set_flash_sim_timing (const Flash_sim_timing_struct *Timing) - длительность разблокировки, стирания страницы       \n
+  *   и программирования слова. Get_flash_sim_stats, Reset_flash_sim_stats - моделируемое время и количество операций.  \n
+  *   Get_flash_sim_time - моделируемое время в мкс (часы для Run_Flash_bench), Get_Flash_stats - статистика           \n
+  *   аппаратного драйвера (время в мкс модели вместо тактов, итераций ожидания, таймаутов и ошибок проверки нет).     \n
+  *
+  * - Unlock_flash, Lock_flash, Erase_Page_of_flash, Program_Words_to_flash, Get_Page_Size_of_flash, Read_MCU_FMD,         \n
+  *   Get_Bank_of_flash - функции аппаратного драйвера с поведением NOR FLASH:                                            \n
+  *   + стирание устанавливает все биты страницы в 1 (0xFF);                                                               \n
+  *   + программирование только сбрасывает биты и допускается только для стёртого слова (иначе FLASH_ERROR, как PGERR);  \n
+  *   + адрес, не выровненный на слово, и адрес за пределами FLASH - FLASH_WROG_ADDRES;                                   \n
+  *   + стирание и программирование заблокированной FLASH - FLASH_ERROR.                                                  \n
+  *
+  * - Start_Erase_Page_of_flash, Start_Program_Word_of_flash, Enable_flash_IRQ, Disable_flash_IRQ, Flash_sim_IRQ -         \n
+  *   асинхронная запись (Write_Words_to_flash_async). Содержимое FLASH изменяется при запуске операции, а окончание      \n
+  *   наступает через её длительность по часам модели (Get_flash_sim_clock). Операции разных банков идут одновременно.  \n
+  *   Flash_sim_IRQ (аналог обработчика прерывания FLASH, его вызывает цикл программы на ПК) ждёт окончания ближайшей    \n
+  *   операции: часы переводятся на момент её окончания, для закончившихся операций вызывается Flash_operation_complete. \n
+  *   Advance_flash_sim_clock (uint32_t Time_us) - ход часов без ожидания: сообщается только об операциях,               \n
+  *   закончившихся за Time_us (операция, запущенная меньше её длительности назад, остаётся FLASH_BUSY).                 \n
+  *
+  * - Set_flash_sim_power_cut (uint32_t Operations, flash_sim_cut Cut) - отключение питания: после Operations            \n
+  *   выполненных стираний страниц и программирований слов следующая операция не выполняется (FLASH_SIM_CUT_BEFORE)      \n
+  *   или выполняется частично (FLASH_SIM_CUT_TORN): стирается первая половина страницы, во второй половине                \n
+  *   устанавливается только часть бит; у слова программируется только младшая половина. Затем процесс завершается     \n
+  *   с кодом FLASH_SIM_POWER_LOST, содержимое FLASH остаётся как после отключения питания (см. Power_loss.c).
+  *
+  * Моделируемое время не зависит от скорости ПК: Time_us - сумма длительностей выполненных операций,                \n
+  * часы модели (Get_flash_sim_clock) - время с Init_flash_sim: синхронные операции и ожидание асинхронных             \n
+  * (одновременные операции двух банков увеличивают Time_us вдвое, а часы - один раз).                                 \n
+  * Длительность по умолчанию - ориентировочные типовые значения из документации (GD32F103: стирание страницы 48 мс,  \n
+  * программирование слова 38 мкс; AT32F413: 50 мс и 42 мкс) и задаётся Set_flash_sim_timing для конкретного кристалла.
+  *
+  * **Размеры страниц**
+  * | Density         | Объём по умолчанию | Страницы                                   | Банки                         |
+  * | --------------- | :----------------: | :----------------------------------------: | :---------------------------: |
+  * | FLASH_SIM_GD_MD | 128 Kbyte          | 1 KB                                       | 1                             |
+  * | FLASH_SIM_GD_HD | 512 Kbyte          | 2 KB                                       | 1                             |
+  * | FLASH_SIM_GD_XD | 1024 Kbyte         | 2 KB до ADDR_OF_BANK1, далее 4 KB          | 2 (bank1 с ADDR_OF_BANK1)     |
+  * | FLASH_SIM_AT32F413 | 256 Kbyte       | 2 KB                                       | 1                             |
+  *
+  * Для FLASH_SIM_GD_XD FLASH.c собирается с GD32F10X_XD (FLASH_BANK1_LAYOUT = 1), как и для платы.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "FLASH_host.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define SIM_WORD(Address)   (*((volatile uint32_t*)(uintptr_t)(Address))) /*!< Слово моделируемой FLASH по адресу.                         */
+#define TORN_ERASE_BITS     0xAAAAAAAAU                                  /*!< Биты, установленные во второй половине частично стёртой страницы. */
+#define TORN_PROGRAM_BITS   0xFFFF0000U                                  /*!< Биты, не запрограммированные у частично запрограммированного слова. */
+//------------------------------------------------------------------------------//
+
+//---Private types--------------------------------------------------------------//
+/**
+  * @brief  Операция асинхронной записи, об окончании которой ещё не сообщено (Flash_sim_IRQ).
+  */
+typedef struct
+{
+uint8_t      Pending;    /*!< 1 - операция запущена, об окончании ещё не сообщено (Flash_sim_IRQ). */
+uint8_t      IRQ_enable; /*!< 1 - прерывание банка разрешено (Enable_flash_IRQ).                    */
+flash_status State;      /*!< Результат операции.                                                   */
+uint64_t     Done_us;    /*!< Момент окончания операции по часам модели (Clock_us).                 */
+} sim_bank;
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint8_t                 Mapped      = 0;               /*!< 1 - массив FLASH размещён по адресу PAGE0_ADDR.     */
+static flash_sim_density       Sim_density = FLASH_SIM_GD_HD; /*!< Моделируемый микроконтроллер.                       */
+static uint32_t                Size_kb     = 0;               /*!< Объём моделируемой FLASH в Kbyte.                    */
+static uint8_t                 Unlocked    = 0;               /*!< 1 - FLASH разблокирована.                            */
+static Flash_sim_timing_struct Sim_timing;                    /*!< Длительность операций.                               */
+static Flash_sim_stats_struct  Sim_stats;                     /*!< Счётчики операций.                                   */
+static uint64_t                Clock_us    = 0;               /*!< Часы модели с Init_flash_sim, мкс.                    */
+static sim_bank                Banks[FLASH_BANKS_MAX];        /*!< Асинхронные операции банков.                         */
+static flash_sim_cut           Cut_mode    = FLASH_SIM_CUT_OFF; /*!< Моделируемое отключение питания.                     */
+static uint32_t                Cut_after   = 0;               /*!< Количество операций до отключения питания.          */
+static flash_status            Last_error  = FLASH_OK;        /*!< Результат последней отвергнутой операции.            */
+static uint32_t                Last_error_addr = 0;           /*!< Адрес последней отвергнутой операции.                */
+//------------------------------------------------------------------------------//
+
+//---Private constants----------------------------------------------------------//
+static const uint16_t                Default_size[] = {128, 512, 1024, 256};   /*!< Объём FLASH по умолчанию, Kbyte (по flash_sim_density). */
+static const Flash_sim_timing_struct GD_timing      = {1, 48000, 38};          /*!< Длительность операций GD32F103.                          */
+static const Flash_sim_timing_struct AT_timing      = {1, 50000, 42};          /*!< Длительность операций AT32F413.                          */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static flash_status Check_address (uint32_t Address, uint32_t Size);
+static flash_status Erase_page    (uint32_t Address);
+static flash_status Program_word  (uint32_t Address, uint32_t Word);
+static uint8_t      Power_cut     (void);
+static void         Sim_error     (flash_status State, uint32_t Address);
+static void         Complete_ops  (void);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Выбор моделируемого микроконтроллера и стирание FLASH.
+  * @param   Density - моделируемый микроконтроллер (flash_sim_density).
+  * @param   Size_KB - объём FLASH в Kbyte (0 - по умолчанию для Density, не больше FLASH_SIM_SIZE_MAX_KB).
+  * @return  flash status: FLASH_WROG_ADDRES - неверный объём, FLASH_ERROR - адреса FLASH заняты.
+  */
+flash_status Init_flash_sim (flash_sim_density Density, uint16_t Size_KB)
+{
+void *map;
+
+if (Size_KB == 0)
+  Size_KB = Default_size[Density];
+if ( (Size_KB > FLASH_SIM_SIZE_MAX_KB) || ((Density == FLASH_SIM_GD_MD) && (Size_KB > 128)) )
+  return FLASH_WROG_ADDRES;
+
+if (!Mapped)
+  {
+  map = mmap((void*)(uintptr_t)PAGE0_ADDR, FLASH_SIM_SIZE_MAX_KB * 1024, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+  if (map != (void*)(uintptr_t)PAGE0_ADDR)
+    return FLASH_ERROR;
+  Mapped = 1;
+  }
+
+Sim_density = Density;
+Size_kb     = Size_KB;
+Unlocked    = 0;
+Sim_timing  = (Sim_density == FLASH_SIM_AT32F413) ? AT_timing : GD_timing;
+Cut_mode    = FLASH_SIM_CUT_OFF;
+memset((void*)(uintptr_t)PAGE0_ADDR, 0xFF, FLASH_SIM_SIZE_MAX_KB * 1024);
+memset(Banks, 0, sizeof(Banks));
+Clock_us    = 0;
+Reset_flash_sim_stats();
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Длительность операций моделируемой FLASH.
+  * @param   Timing - указатель на длительности операций, мкс.
+  * @return  None.
+  */
+void Set_flash_sim_timing (const Flash_sim_timing_struct *Timing)
+{
+Sim_timing = *Timing;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Счётчики операций моделируемой FLASH.
+  * @param   Stats - указатель на структуру для счётчиков.
+  * @return  None.
+  */
+void Get_flash_sim_stats (Flash_sim_stats_struct *Stats)
+{
+*Stats = Sim_stats;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Обнуление счётчиков операций моделируемой FLASH.
+  * @return  None.
+  */
+void Reset_flash_sim_stats (void)
+{
+memset(&Sim_stats, 0, sizeof(Sim_stats));
+Last_error      = FLASH_OK;
+Last_error_addr = 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Моделируемое время.
+  * @return  uint32_t - сумма длительностей операций с момента Reset_flash_sim_stats, мкс (младшие 32 бита).
+  */
+uint32_t Get_flash_sim_time (void)
+{
+return (uint32_t)Sim_stats.Time_us;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Часы модели.
+  * @return  uint32_t - время с Init_flash_sim, мкс (младшие 32 бита): синхронные операции и ожидание асинхронных.
+  */
+uint32_t Get_flash_sim_clock (void)
+{
+return (uint32_t)Clock_us;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Ход часов модели без ожидания операций.
+  * @details Сообщает (Flash_operation_complete) об асинхронных операциях, закончившихся за Time_us.
+  * @param   Time_us - время, мкс.
+  * @return  None.
+  */
+void Advance_flash_sim_clock (uint32_t Time_us)
+{
+Clock_us += Time_us;
+Complete_ops();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Статистика операций аппаратного драйвера.
+  * @details Операции с момента Reset_flash_sim_stats. Время - моделируемое, в мкс вместо тактов ядра. \n
+  *          Ожидания готовности, таймаутов и ошибок проверки записанных слов в модели нет.
+  * @param   Stats - указатель на структуру для статистики.
+  * @return  None.
+  */
+void Get_Flash_stats (Flash_stats_struct *Stats)
+{
+memset(Stats, 0, sizeof(*Stats));
+Stats->Unlocks            = Sim_stats.Unlocks;
+Stats->Erases             = Sim_stats.Erases;
+Stats->Programs           = Sim_stats.Programs;
+Stats->Busy_cycles        = (uint32_t)(Sim_stats.Erases * Sim_timing.Erase_page_us + Sim_stats.Programs * Sim_timing.Program_word_us);
+Stats->Erase_max_cycles   = Sim_stats.Erases   ? Sim_timing.Erase_page_us   : 0;
+Stats->Program_max_cycles = Sim_stats.Programs ? Sim_timing.Program_word_us : 0;
+Stats->Errors             = Sim_stats.Errors;
+Stats->Last_error         = Last_error;
+Stats->Last_error_addr    = Last_error_addr;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Прерывание FLASH моделируемой FLASH.
+  * @details Ожидание окончания ближайшей асинхронной операции банка с разрешённым прерыванием: часы модели  \n
+  *          переводятся на момент её окончания, для закончившихся операций вызывается Flash_operation_complete \n
+  *          (FLASH.c), которая запускает следующую операцию.
+  * @return  None.
+  */
+void Flash_sim_IRQ (void)
+{
+uint64_t next = UINT64_MAX;
+
+for (uint8_t bank = 0; bank < FLASH_BANKS_MAX; bank++)
+  {
+  if (Banks[bank].Pending && Banks[bank].IRQ_enable && (Banks[bank].Done_us < next))
+    next = Banks[bank].Done_us;
+  }
+if (next == UINT64_MAX)
+  return;
+if (next > Clock_us)
+  Clock_us = next;
+Complete_ops();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Моделируемое отключение питания.
+  * @details После Operations стираний страниц и программирований слов следующая операция не выполняется \n
+  *          (FLASH_SIM_CUT_BEFORE) или выполняется частично (FLASH_SIM_CUT_TORN), и процесс завершается  \n
+  *          с кодом FLASH_SIM_POWER_LOST.
+  * @param   Operations - количество операций, выполняемых полностью.
+  * @param   Cut        - состояние операции при отключении питания (FLASH_SIM_CUT_OFF - не отключать).
+  * @return  None.
+  */
+void Set_flash_sim_power_cut (uint32_t Operations, flash_sim_cut Cut)
+{
+Cut_after = Operations;
+Cut_mode  = Cut;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Объём FLASH моделируемого микроконтроллера.
+  * @return  uint16_t - объём FLASH в Kbyte.
+  */
+uint16_t Read_MCU_FMD (void)
+{
+return (uint16_t)Size_kb;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Снятие блокировки записи/стирания FLASH.
+  * @return  None.
+  */
+void Unlock_flash (void)
+{
+Unlocked       = 1;
+Sim_stats.Unlocks += 1;
+Sim_stats.Time_us += Sim_timing.Unlock_us;
+Clock_us          += Sim_timing.Unlock_us;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Установка блокировки записи/стирания FLASH.
+  * @return  None.
+  */
+void Lock_flash (void)
+{
+Unlocked = 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Стирание страницы FLASH.
+  * @details Все байты страницы, содержащей Address, становятся 0xFF. FLASH должна быть разблокирована.
+  * @param   Address - адрес внутри стираемой страницы.
+  * @return  flash status.
+  */
+flash_status Erase_Page_of_flash (uint32_t Address)
+{
+flash_status state = Erase_page(Address);
+
+if (state == FLASH_OK)
+  Clock_us += Sim_timing.Erase_page_us;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Программирование массива слов в стёртую область FLASH.
+  * @details Программирование прекращается на первом слове с ошибкой. FLASH должна быть разблокирована.
+  * @param   Address - адрес начальной ячейки (выровнен по 4 байта).
+  * @param   Amount  - количество записываемых слов.
+  * @param   Words   - указатель на массив с данными.
+  * @return  flash status.
+  */
+flash_status Program_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words)
+{
+flash_status state = Check_address(Address, 4*Amount);
+uint32_t     i     = 0;
+
+for (i = 0; (i < Amount) && (state == FLASH_OK); i++)
+  {
+  state = Program_word(Address + 4*i, Words[i]);
+  if (state == FLASH_OK)
+    Clock_us += Sim_timing.Program_word_us;
+  }
+if (state != FLASH_OK)
+  Sim_error(state, (i > 0) ? Address + 4*(i - 1) : Address);
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Размер страницы FLASH.
+  * @param   Address - адрес внутри страницы.
+  * @return  uint32_t - размер страницы в байтах.
+  */
+uint32_t Get_Page_Size_of_flash (uint32_t Address)
+{
+if (Sim_density == FLASH_SIM_GD_MD)
+  return 0x400U;
+if ( (Sim_density == FLASH_SIM_GD_XD) && (Address >= ADDR_OF_BANK1) )
+  return 0x1000U;
+return 0x800U;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Номер банка FLASH.
+  * @param   Address - адрес FLASH.
+  * @return  uint8_t - 0 - bank0, 1 - bank1 (только FLASH_SIM_GD_XD).
+  */
+uint8_t Get_Bank_of_flash (uint32_t Address)
+{
+return ( (Sim_density == FLASH_SIM_GD_XD) && (Address >= ADDR_OF_BANK1) ) ? 1 : 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запуск стирания страницы FLASH без ожидания окончания.
+  * @details Страница стирается сразу, операция заканчивается через Erase_page_us по часам модели, \n
+  *          об окончании сообщает Flash_sim_IRQ.
+  * @param   Address - адрес внутри стираемой страницы.
+  * @return  flash status: FLASH_BUSY - в банке уже выполняется операция.
+  */
+flash_status Start_Erase_Page_of_flash (uint32_t Address)
+{
+sim_bank    *bank = &Banks[Get_Bank_of_flash(Address)];
+flash_status state;
+
+if (bank->Pending)
+  return FLASH_BUSY;
+state = Erase_page(Address);
+if (state == FLASH_OK)
+  {
+  bank->State   = FLASH_OK;
+  bank->Done_us = Clock_us + Sim_timing.Erase_page_us;
+  bank->Pending = 1;
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запуск программирования слова FLASH без ожидания окончания.
+  * @details Слово программируется сразу, операция заканчивается через Program_word_us по часам модели, \n
+  *          об окончании сообщает Flash_sim_IRQ.
+  * @param   Address - адрес ячейки.
+  * @param   Word    - записываемое слово.
+  * @return  flash status: FLASH_BUSY - в банке уже выполняется операция.
+  */
+flash_status Start_Program_Word_of_flash (uint32_t Address, uint32_t Word)
+{
+sim_bank    *bank = &Banks[Get_Bank_of_flash(Address)];
+flash_status state;
+
+if (bank->Pending)
+  return FLASH_BUSY;
+state = Check_address(Address, 4);
+if (state == FLASH_OK)
+  state = Program_word(Address, Word);
+if (state != FLASH_OK)
+  {
+  Sim_error(state, Address);
+  return state;
+  }
+bank->State   = FLASH_OK;
+bank->Done_us = Clock_us + Sim_timing.Program_word_us;
+bank->Pending = 1;
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Разрешение прерывания FLASH банка.
+  * @param   Bank - номер банка FLASH.
+  * @return  None.
+  */
+void Enable_flash_IRQ (uint8_t Bank)
+{
+Banks[Bank].IRQ_enable = 1;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запрет прерывания FLASH банка.
+  * @param   Bank - номер банка FLASH.
+  * @return  None.
+  */
+void Disable_flash_IRQ (uint8_t Bank)
+{
+Banks[Bank].IRQ_enable = 0;
+}
+//------------------------------------------------------------------------------//
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Проверка адреса операции.
+  * @param   Address - начальный адрес.
+  * @param   Size    - размер в байтах.
+  * @return  flash status: FLASH_WROG_ADDRES - адрес не выровнен на слово или выходит за пределы FLASH.
+  */
+static flash_status Check_address (uint32_t Address, uint32_t Size)
+{
+if ( (Address & 3U) || (Address < PAGE0_ADDR) || (Address - PAGE0_ADDR + Size > Size_kb * 1024) )
+  return FLASH_WROG_ADDRES;
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Стирание страницы моделируемой FLASH.
+  * @param   Address - адрес внутри стираемой страницы.
+  * @return  flash status.
+  */
+static flash_status Erase_page (uint32_t Address)
+{
+uint32_t page_size = Get_Page_Size_of_flash(Address);
+
+if ( (Address < PAGE0_ADDR) || (Address - PAGE0_ADDR >= Size_kb * 1024) )
+  {
+  Sim_error(FLASH_WROG_ADDRES, Address);
+  return FLASH_WROG_ADDRES;
+  }
+if (!Unlocked)
+  {
+  Sim_error(FLASH_ERROR, Address);
+  return FLASH_ERROR;
+  }
+
+Address &= ~(page_size - 1);
+if (Power_cut())
+  {
+  memset((void*)(uintptr_t)Address, 0xFF, page_size / 2);
+  for (uint32_t addr = Address + page_size / 2; addr < Address + page_size; addr += 4)
+    {
+    SIM_WORD(addr) |= TORN_ERASE_BITS;
+    }
+  _exit(FLASH_SIM_POWER_LOST);
+  }
+memset((void*)(uintptr_t)Address, 0xFF, page_size);
+Sim_stats.Erases  += 1;
+Sim_stats.Time_us += Sim_timing.Erase_page_us;
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Программирование слова моделируемой FLASH.
+  * @details Программирование только сбрасывает биты. Слово, которое не стёрто, не программируется (PGERR).
+  * @param   Address - адрес слова (проверен Check_address).
+  * @param   Word    - записываемое слово.
+  * @return  flash status.
+  */
+static flash_status Program_word (uint32_t Address, uint32_t Word)
+{
+if ( !Unlocked || (SIM_WORD(Address) != BLANK_WORD) )
+  return FLASH_ERROR;
+
+if (Power_cut())
+  {
+  SIM_WORD(Address) &= Word | TORN_PROGRAM_BITS;
+  _exit(FLASH_SIM_POWER_LOST);
+  }
+SIM_WORD(Address) &= Word;
+Sim_stats.Programs += 1;
+Sim_stats.Time_us  += Sim_timing.Program_word_us;
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Проверка отключения питания перед операцией стирания или программирования.
+  * @details При FLASH_SIM_CUT_BEFORE процесс завершается сразу, при FLASH_SIM_CUT_TORN операцию \n
+  *          частично выполняет и завершает процесс вызывающая функция.
+  * @return  uint8_t - 1 - операция выполняется частично.
+  */
+static uint8_t Power_cut (void)
+{
+if (Cut_mode == FLASH_SIM_CUT_OFF)
+  return 0;
+if (Cut_after > 0)
+  {
+  Cut_after--;
+  return 0;
+  }
+if (Cut_mode == FLASH_SIM_CUT_BEFORE)
+  _exit(FLASH_SIM_POWER_LOST);
+return 1;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Учёт отвергнутой операции.
+  * @param   State   - результат операции.
+  * @param   Address - адрес операции.
+  * @return  None.
+  */
+static void Sim_error (flash_status State, uint32_t Address)
+{
+Sim_stats.Errors++;
+Last_error      = State;
+Last_error_addr = Address;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Сообщение об окончании асинхронных операций.
+  * @details Для каждого банка с разрешённым прерыванием и операцией, закончившейся к текущему моменту часов  \n
+  *          модели, вызывает Flash_operation_complete.
+  * @return  None.
+  */
+static void Complete_ops (void)
+{
+for (uint8_t bank = 0; bank < FLASH_BANKS_MAX; bank++)
+  {
+  if (Banks[bank].Pending && Banks[bank].IRQ_enable && (Banks[bank].Done_us <= Clock_us))
+    {
+    Banks[bank].Pending = 0;
+    Flash_operation_complete(bank, Banks[bank].State);
+    }
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
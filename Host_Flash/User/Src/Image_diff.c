@@ -0,0 +1,215 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_diff.c
+  *
+  * @brief     Создание патча разностного обновления (ПК): формат Image_delta.c.
+  *
+  * @details   Diff_Image_delta (const uint32_t *Old, uint32_t Old_size, const uint32_t *New, uint32_t New_size,           \n
+  *            uint8_t *Patch, uint32_t Capacity) - патч, собирающий New из Old (образы дополнены до слова байтами 0xFF,  \n
+  *            Old - образ в Main Programm). Capacity - не менее IMAGE_DELTA_PATCH_MAX(New_size). Возвращает размер патча,  \n
+  *            0 - буфер мал или прежний образ больше Main Programm.                                                      \n
+  *            Для каждого байта New выбирается самое выгодное копирование: с курсора прежнего образа (сдвиг 0) или     \n
+  *            с одного из DIFF_CHAIN последних участков Old с теми же 4 байтами (хеш-цепочки). Копирование записывается, \n
+  *            если оно короче вставки тех же байт, иначе байт добавляется во вставку.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Image_diff.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define DIFF_HASH_BITS      16U                 /*!< Размер таблицы хеш-цепочек (степень 2).                 */
+#define DIFF_CHAIN          64U                 /*!< Количество просматриваемых участков одной цепочки.      */
+#define DIFF_NONE           0xFFFFFFFFU         /*!< Конец хеш-цепочки.                                      */
+#define DIFF_HASH(Bytes)    (((uint32_t)(Bytes)[0] | (uint32_t)(Bytes)[1] << 8 | (uint32_t)(Bytes)[2] << 16 | (uint32_t)(Bytes)[3] << 24) * 2654435761U >> (32 - DIFF_HASH_BITS))
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint32_t Head[1U << DIFF_HASH_BITS];            /*!< Последний участок Old с данным хешем.       */
+static uint32_t Prev[MEMSIZE_MAIN_PROGRAM * 1024];     /*!< Предыдущий участок Old с тем же хешем.      */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static uint32_t Diff_match   (const uint8_t *Old, uint32_t Old_size, uint32_t From, const uint8_t *New, uint32_t New_size, uint32_t Position);
+static int32_t  Diff_gain    (uint32_t Length, uint32_t From, uint32_t Cursor);
+static uint32_t Diff_varint  (uint8_t *Patch, uint32_t Value);
+static uint32_t Diff_insert  (uint8_t *Patch, const uint8_t *Bytes, uint32_t Count);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Создание патча.
+  * @param   Old      - указатель на прежний образ.
+  * @param   Old_size - размер прежнего образа в байтах (не более MEMSIZE_MAIN_PROGRAM Kbyte).
+  * @param   New      - указатель на новый образ.
+  * @param   New_size - размер нового образа в байтах.
+  * @param   Patch    - указатель на буфер патча.
+  * @param   Capacity - размер буфера в байтах.
+  * @return  uint32_t - размер патча в байтах, 0 - ошибка.
+  */
+uint32_t Diff_Image_delta (const uint32_t *Old, uint32_t Old_size, const uint32_t *New, uint32_t New_size, uint8_t *Patch, uint32_t Capacity)
+{
+const uint8_t *old_image = (const uint8_t*)Old;
+const uint8_t *new_image = (const uint8_t*)New;
+uint32_t       header[5] = {IMAGE_DELTA_TAG, New_size, Calc_CRC32(New, (New_size + 3U) / 4), Old_size, Calc_CRC32(Old, (Old_size + 3U) / 4)};
+uint32_t       pos       = IMAGE_DELTA_HEADER_BYTES;
+uint32_t       cursor    = 0;
+uint32_t       pending   = 0;
+uint32_t       best_from;
+uint32_t       best_length;
+int32_t        best_gain;
+uint32_t       length;
+uint32_t       from;
+int32_t        gain;
+
+if ( (Capacity < IMAGE_DELTA_PATCH_MAX(New_size)) || (Old_size > MEMSIZE_MAIN_PROGRAM * 1024) )
+  return 0;
+for (uint32_t i = 0; i < IMAGE_DELTA_HEADER_BYTES; i++)
+  {
+  Patch[i] = (uint8_t)(header[i / 4] >> (8 * (i % 4)));
+  }
+
+for (uint32_t i = 0; i < (1U << DIFF_HASH_BITS); i++)
+  {
+  Head[i] = DIFF_NONE;
+  }
+for (uint32_t i = 0; i + 4 <= Old_size; i++)
+  {
+  Prev[i]                        = Head[DIFF_HASH(old_image + i)];
+  Head[DIFF_HASH(old_image + i)] = i;
+  }
+
+for (uint32_t i = 0; i < New_size; )
+  {
+  best_gain   = 0;
+  best_from   = 0;
+  best_length = 0;
+  if (cursor < Old_size)
+    {
+    best_length = Diff_match(old_image, Old_size, cursor, new_image, New_size, i);
+    best_from   = cursor;
+    best_gain   = Diff_gain(best_length, cursor, cursor);
+    }
+  from = (i + 4 <= New_size) ? Head[DIFF_HASH(new_image + i)] : DIFF_NONE;
+  for (uint32_t n = 0; (n < DIFF_CHAIN) && (from != DIFF_NONE); n++, from = Prev[from])
+    {
+    length = Diff_match(old_image, Old_size, from, new_image, New_size, i);
+    gain   = Diff_gain(length, from, cursor);
+    if (gain > best_gain)
+      {
+      best_gain   = gain;
+      best_from   = from;
+      best_length = length;
+      }
+    }
+
+  if (best_gain <= 0)
+    {
+    pending++;
+    cursor++;
+    i++;
+    continue; // Байт добавляется во вставку: курсор сдвигается, как при выполнении вставки.
+    }
+
+  pos         += Diff_insert(Patch + pos, new_image + i - pending, pending);
+  pending      = 0;
+  from         = (best_from >= cursor) ? (best_from - cursor) << 1 : ((cursor - best_from) << 1) - 1; // Сдвиг zigzag.
+  Patch[pos++] = IMAGE_DELTA_COPY;
+  pos         += Diff_varint(Patch + pos, best_length);
+  pos         += Diff_varint(Patch + pos, from);
+  cursor       = best_from + best_length;
+  i           += best_length;
+  }
+pos += Diff_insert(Patch + pos, new_image + New_size - pending, pending);
+return pos;
+}
+//------------------------------------------------------------------------------//
+
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Длина совпадения New с позиции Position и Old с позиции From.
+  * @return  uint32_t - количество совпадающих байт.
+  */
+static uint32_t Diff_match (const uint8_t *Old, uint32_t Old_size, uint32_t From, const uint8_t *New, uint32_t New_size, uint32_t Position)
+{
+uint32_t length = 0;
+
+while ( (From + length < Old_size) && (Position + length < New_size) && (Old[From + length] == New[Position + length]) )
+  {
+  length++;
+  }
+return length;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Выигрыш копирования по сравнению со вставкой тех же байт.
+  * @details Команда копирования - код, длина и сдвиг (LEB128); вставка может разделиться на две - ещё один байт.
+  * @param   Length - длина копирования.
+  * @param   From   - начало копирования в Old.
+  * @param   Cursor - курсор прежнего образа.
+  * @return  int32_t - количество сэкономленных байт патча (не больше 0 - копирование невыгодно).
+  */
+static int32_t Diff_gain (uint32_t Length, uint32_t From, uint32_t Cursor)
+{
+uint8_t  bytes[5];
+uint32_t shift = (From >= Cursor) ? (From - Cursor) << 1 : ((Cursor - From) << 1) - 1;
+
+return (int32_t)Length - (int32_t)(2 + Diff_varint(bytes, Length) + Diff_varint(bytes, shift));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись числа LEB128.
+  * @return  uint32_t - количество байт числа.
+  */
+static uint32_t Diff_varint (uint8_t *Patch, uint32_t Value)
+{
+uint32_t count = 0;
+
+do
+  {
+  Patch[count++] = (uint8_t)((Value & 0x7FU) | ((Value > 0x7FU) ? 0x80U : 0));
+  Value        >>= 7;
+  } while (Value != 0);
+return count;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись команд вставки (не более IMAGE_DELTA_INSERT_MAX байт каждая).
+  * @return  uint32_t - количество байт команд.
+  */
+static uint32_t Diff_insert (uint8_t *Patch, const uint8_t *Bytes, uint32_t Count)
+{
+uint32_t pos = 0;
+uint32_t piece;
+
+while (Count > 0)
+  {
+  piece        = (Count < IMAGE_DELTA_INSERT_MAX) ? Count : IMAGE_DELTA_INSERT_MAX;
+  Patch[pos++] = (uint8_t)(piece - 1);
+  for (uint32_t i = 0; i < piece; i++)
+    {
+    Patch[pos++] = Bytes[i];
+    }
+  Bytes += piece;
+  Count -= piece;
+  }
+return pos;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
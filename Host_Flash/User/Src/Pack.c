@@ -0,0 +1,93 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Pack.c
+  *
+  * @brief     Сжатие образа прошивки для загрузки (ПК, Linux): image_pack.
+  *
+  * @details   Читает образ прошивки (.bin), сжимает его Pack_Image_lz (Image_lz.c), проверяет распаковку               \n
+  *            Unpack_Image_lz и записывает сжатый образ: он передаётся по интерфейсу и принимается                      \n
+  *            Open_Image_lz / Write_Image_lz_chunk / Finalize_Image_lz.                                                 \n
+  *            Сборка: make -C Host_Flash image_pack. Запуск: ./image_pack image.bin image.lz [baud].                    \n
+  *            Выводит размеры, степень сжатия и время передачи при скорости baud (по умолчанию 9600, 10 бит на байт).  \n
+  *            Код завершения 0 - образ сжат и проверен.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Image_lz.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define PACK_MAX_BYTES      (MEMSIZE_DOWNLOAD_BUFFER * 1024U) /*!< Наибольший размер образа (Download Buffer).     */
+#define PACK_BAUD           9600U                             /*!< Скорость передачи по умолчанию.                 */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint32_t Image   [PACK_MAX_BYTES / 4 + 1];              /*!< Образ, дополненный до слова байтами 0xFF.       */
+static uint32_t Unpacked[PACK_MAX_BYTES / 4 + 1];              /*!< Проверка распаковки.                            */
+static uint8_t  Packed  [IMAGE_LZ_PACKED_MAX(PACK_MAX_BYTES)]; /*!< Сжатый образ.                                   */
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+int main (int argc, char **argv)
+{
+FILE     *file;
+uint32_t  size;
+uint32_t  packed;
+uint32_t  unpacked;
+uint32_t  baud = (argc > 3) ? (uint32_t)strtoul(argv[3], 0, 10) : PACK_BAUD;
+
+if ( (argc < 3) || (baud == 0) )
+  {
+  fprintf(stderr, "usage: image_pack image.bin image.lz [baud]\n");
+  return 2;
+  }
+
+file = fopen(argv[1], "rb");
+if (file == 0)
+  {
+  fprintf(stderr, "FAIL: %s: cannot open\n", argv[1]);
+  return 1;
+  }
+memset(Image, 0xFF, sizeof(Image));
+size = fread(Image, 1, PACK_MAX_BYTES + 1, file);
+fclose(file);
+if ( (size == 0) || (size > PACK_MAX_BYTES) )
+  {
+  fprintf(stderr, "FAIL: %s: image size must be 1 ... %u bytes\n", argv[1], PACK_MAX_BYTES);
+  return 1;
+  }
+memset((uint8_t*)Image + size, 0xFF, sizeof(Image) - size);
+
+packed = Pack_Image_lz(Image, size, Packed, sizeof(Packed));
+if ( (Unpack_Image_lz(Packed, packed, Unpacked, sizeof(Unpacked), &unpacked) != FLASH_OK) ||
+     (unpacked != size) || (memcmp(Unpacked, Image, (size + 3U) & ~3U) != 0) )
+  {
+  fprintf(stderr, "FAIL: unpacked image differs\n");
+  return 1;
+  }
+
+file = fopen(argv[2], "wb");
+if ( (file == 0) || (fwrite(Packed, 1, packed, file) != packed) || (fclose(file) != 0) )
+  {
+  fprintf(stderr, "FAIL: %s: cannot write\n", argv[2]);
+  return 1;
+  }
+
+printf("%s: %u -> %u bytes (%u%%), crc32 0x%08X\n", argv[2], size, packed, packed * 100 / size, Packed[8] | Packed[9] << 8 | Packed[10] << 16 | (uint32_t)Packed[11] << 24);
+printf("transfer at %u baud: %.1f s -> %.1f s\n", baud, size * 10.0 / baud, packed * 10.0 / baud);
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
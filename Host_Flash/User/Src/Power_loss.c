@@ -0,0 +1,745 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Power_loss.c
+  *
+  * @brief     Проверка функций записи FLASH.c, KV_store.c, Log_ring.c, Image_install.c при отключении питания (ПК, Linux).
+  *
+  * @details   Для каждой проверки последовательность записей выполняется заново, и питание отключается перед каждой  \n
+  *            операцией FLASH (стирание страницы, программирование слова) и во время неё (Set_flash_sim_power_cut):    \n
+  *            страница остаётся стёртой частично, слово - запрограммированным наполовину.
+  *
+  * **Manual** \n
+  * Каждое отключение питания проверяется двумя процессами (fork):
+  * - запись: подготовка области, затем последовательность записей до отключения питания. После каждой записи,       \n
+  *   вернувшей FLASH_OK, номер записи сохраняется в Committed (разделяемая память);
+  * - перезапуск: процесс с исходным состоянием RAM (как после сброса микроконтроллера) инициализирует модуль и       \n
+  *   проверяет, что читаются данные последней завершённой записи или прерванной записи (Committed + 1),              \n
+  *   а затем, что следующая запись выполняется и читается.
+  *
+  * Проверки:
+  * - Config Page   - Write_Config_to_flash / Read_Config_from_flash, журнал заполняется несколько раз (стирание страниц);
+  * - RO Constants  - Write_RO_Constants_to_flash поверх записанных: Read_RO_Constants_from_flash возвращает            \n
+  *                   прежние или новые данные либо FLASH_ERROR (область перезаписывается не атомарно, CRC32             \n
+  *                   программируется первым и отвергает частично записанные данные);
+  * - Write Words   - Write_Words_to_flash через три страницы: каждая страница содержит прежние или новые данные,        \n
+  *                   кроме одной прерванной; соседние страницы не изменяются; повторная запись завершается;
+  * - KV Store      - Write_KV_to_flash по нескольким ключам с уплотнением областей;
+  * - Log ring      - Append_Log_to_flash с переходами по кругу страниц;
+  * - Install       - Install_Image из Download Buffer в Main Programm: после перезапуска незавершённая установка       \n
+  *                   (Get_Pending_Install) продолжается и завершается, страницы за образом не изменяются.
+  *
+  * Сборка и запуск: make -C Host_Flash power (DENSITY=HD|XD|AT|MD). Код завершения 0 - все проверки пройдены.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "FLASH_host.h"
+#include "Flash_geometry.h"
+#include "KV_store.h"
+#include "Log_ring.h"
+#include "Image_install.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#ifndef FLASH_SIM_DENSITY
+#define FLASH_SIM_DENSITY   FLASH_SIM_GD_HD     /*!< Моделируемый микроконтроллер (задаётся в Makefile: DENSITY=HD|XD|AT|MD). */
+#endif
+
+#define CONFIG_WRITES       (CONFIG_RECORDS_IN_PAGE * 2 + 5) /*!< Записей Config Page: два заполнения страниц журнала.  */
+#define WORDS_PAGES         3U                  /*!< Количество страниц, затрагиваемых записью Write Words.                 */
+#define KV_KEYS             3U                  /*!< Количество ключей KV Store.                                            */
+#define KV_WRITES           300U                /*!< Записей KV Store: больше вмещает одна область (уплотнение).             */
+#define LOG_PAGES           3U                  /*!< Количество страниц кольцевого журнала.                                 */
+#define LOG_RECORD          16U                 /*!< Размер записи кольцевого журнала в байтах.                             */
+#define LOG_WRITES          350U                /*!< Записей кольцевого журнала: больше вмещают LOG_PAGES страниц.           */
+#define INSTALL_PAGES       3U                  /*!< Количество страниц Main Programm, занятых образом Install.             */
+#define REPORT_FAILS        5U                  /*!< Количество подробно выводимых ошибок каждой проверки.                  */
+
+#define CHECK(Condition)    do { if (!(Condition)) { printf("    %s:%d: %s\n", __FILE__, __LINE__, #Condition); fflush(stdout); return 1; } } while (0)
+//------------------------------------------------------------------------------//
+
+//---Private types--------------------------------------------------------------//
+/**
+  * @brief  Проверка функции записи.
+  */
+typedef struct
+{
+const char *Name;              /*!< Название проверки.                                                         */
+uint32_t    Address;           /*!< Начальный адрес области проверки.                                          */
+uint32_t    Size;              /*!< Размер области в байтах: проверка пропускается, если область вне FLASH.    */
+void      (*Prepare) (void);   /*!< Подготовка области (без отключения питания).                               */
+void      (*Run)     (void);   /*!< Последовательность записей, Committed - номер последней завершённой записи. */
+int       (*Verify)  (void);   /*!< Проверка после перезапуска: 0 - данные действительны.                      */
+} power_test;
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static volatile uint32_t *Committed;   /*!< Номер последней завершённой записи (разделяемая память).               */
+static uint32_t           Words_page;  /*!< Размер страницы области Write Words в байтах.                           */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static void     Config_run       (void);
+static int      Config_verify    (void);
+static void     Config_fill      (Config_struct *Config, uint32_t Number);
+static void     RO_prepare       (void);
+static void     RO_run           (void);
+static int      RO_verify        (void);
+static void     RO_fill          (RO_Constants_struct *RO_Constants, uint32_t Number);
+static void     Words_prepare    (void);
+static void     Words_run        (void);
+static int      Words_verify     (void);
+static uint32_t Words_value      (uint32_t Index, uint8_t New);
+static void     KV_prepare       (void);
+static void     KV_run           (void);
+static int      KV_verify        (void);
+static int      KV_check_key     (uint16_t Key, uint32_t Number);
+static void     Log_prepare      (void);
+static void     Log_run          (void);
+static int      Log_verify       (void);
+static void     Install_prepare  (void);
+static void     Install_run      (void);
+static int      Install_verify   (void);
+static uint32_t Install_value    (uint32_t Index, uint8_t New);
+static int      Wait_child       (pid_t Pid);
+static uint32_t Run_test         (const power_test *Test, flash_sim_cut Cut, uint32_t *Cuts);
+//------------------------------------------------------------------------------//
+
+//---Private constants----------------------------------------------------------//
+static const power_test Tests[] =
+{
+{"Config Page",  ADDR_CONFIG_PAGE,     MEMSIZE_CONFIG_PAGE     * 1024, 0,               Config_run,  Config_verify },
+{"RO Constants", ADDR_RO_CONSTANS,     MEMSIZE_RO_CONSTANS     * 1024, RO_prepare,      RO_run,      RO_verify     },
+{"Write Words",  ADDR_DOWNLOAD_BUFFER, MEMSIZE_DOWNLOAD_BUFFER * 1024, Words_prepare,   Words_run,   Words_verify  },
+{"KV Store",     ADDR_KV_AREA_A,       MEMSIZE_KV_AREA * 2     * 1024, KV_prepare,      KV_run,      KV_verify     },
+{"Log ring",     ADDR_LOG_AREA,        MEMSIZE_LOG_AREA        * 1024, Log_prepare,     Log_run,     Log_verify    },
+{"Install",      ADDR_INSTALL_AREA,    MEMSIZE_INSTALL_AREA    * 1024, Install_prepare, Install_run, Install_verify},
+};
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+int main (void)
+{
+uint32_t fails = 0;
+uint32_t cuts;
+uint32_t test_fails;
+
+Committed = mmap(0, sizeof(uint32_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+if ( (Committed == MAP_FAILED) || (Init_flash_sim(FLASH_SIM_DENSITY, 0) != FLASH_OK) )
+  {
+  printf("FAIL: Init_flash_sim\n");
+  return 1;
+  }
+Init_flash_geometry(); // Medium-density: области за 128 Kbyte отключены, их проверки пропускаются.
+Words_page = Get_Page_Size_of_flash(ADDR_DOWNLOAD_BUFFER);
+
+for (uint32_t i = 0; i < sizeof(Tests) / sizeof(Tests[0]); i++)
+  {
+  if (!Area_in_flash(Tests[i].Address, Tests[i].Size))
+    {
+    printf("%-14s skipped: area outside FLASH\n", Tests[i].Name);
+    continue;
+    }
+  test_fails  = Run_test(&Tests[i], FLASH_SIM_CUT_BEFORE, &cuts);
+  printf("%-14s cut before: %5u power cuts, %u failed\n", Tests[i].Name, cuts, test_fails);
+  fails      += test_fails;
+  test_fails  = Run_test(&Tests[i], FLASH_SIM_CUT_TORN, &cuts);
+  printf("%-14s torn:       %5u power cuts, %u failed\n", Tests[i].Name, cuts, test_fails);
+  fails      += test_fails;
+  }
+
+printf("%s: %u failed\n", (fails == 0) ? "PASS" : "FAIL", fails);
+return (fails == 0) ? 0 : 1;
+}
+//------------------------------------------------------------------------------//
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Выполнение проверки с отключением питания после каждой операции FLASH.
+  * @details Отключение питания сдвигается на одну операцию, пока последовательность записей не завершится полностью.
+  * @param   Test - проверка.
+  * @param   Cut  - состояние операции при отключении питания.
+  * @param   Cuts - указатель для количества выполненных отключений питания.
+  * @return  uint32_t - количество отключений питания, после которых проверка не пройдена.
+  */
+static uint32_t Run_test (const power_test *Test, flash_sim_cut Cut, uint32_t *Cuts)
+{
+uint32_t fails = 0;
+int      status;
+pid_t    pid;
+
+for (uint32_t operations = 0; ; operations++)
+  {
+  Init_flash_sim(FLASH_SIM_DENSITY, 0);
+  *Committed = 0;
+
+  fflush(stdout);
+  pid = fork();
+  if (pid == 0)
+    {
+    if (Test->Prepare)
+      Test->Prepare();
+    Set_flash_sim_power_cut(operations, Cut);
+    Test->Run();
+    _exit(0);
+    }
+  status = Wait_child(pid);
+  if ( (status != 0) && (status != FLASH_SIM_POWER_LOST) )
+    {
+    printf("  %s: write failed after %u operations (exit %d)\n", Test->Name, operations, status);
+    fails++;
+    }
+
+  pid = fork();
+  if (pid == 0)
+    _exit(Test->Verify());
+  if (Wait_child(pid) != 0)
+    {
+    if (fails < REPORT_FAILS)
+      printf("  %s: power cut after %u operations, committed %u\n", Test->Name, operations, *Committed);
+    fails++;
+    }
+
+  if (status != FLASH_SIM_POWER_LOST)
+    {
+    *Cuts = operations;
+    return fails;
+    }
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Ожидание завершения процесса.
+  * @param   Pid - идентификатор процесса.
+  * @return  int - код завершения процесса, -1 - процесс завершён сигналом.
+  */
+static int Wait_child (pid_t Pid)
+{
+int status;
+
+if ( (Pid < 0) || (waitpid(Pid, &status, 0) != Pid) || !WIFEXITED(status) )
+  return -1;
+return WEXITSTATUS(status);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Config Page: записи 1 ... CONFIG_WRITES.
+  * @return  None.
+  */
+static void Config_run (void)
+{
+Config_struct config;
+
+for (uint32_t i = 1; i <= CONFIG_WRITES; i++)
+  {
+  Config_fill(&config, i);
+  if (Write_Config_to_flash(&config) != FLASH_OK)
+    _exit(2);
+  *Committed = i;
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Config Page после перезапуска.
+  * @return  int - 0 - читается запись Committed или Committed + 1, следующая запись выполняется.
+  */
+static int Config_verify (void)
+{
+Config_struct config;
+Config_struct expected;
+Config_struct next;
+uint32_t      number = *Committed;
+
+if (Read_Config_from_flash(&config) == FLASH_OK)
+  {
+  Config_fill(&expected, config.AddrModule);
+  CHECK( (config.AddrModule == number) || (config.AddrModule == number + 1) );
+  CHECK(memcmp(&config, &expected, sizeof(config)) == 0);
+  }
+else
+  {
+  CHECK(number == 0);
+  }
+
+Config_fill(&next, CONFIG_WRITES + 1);
+CHECK(Write_Config_to_flash(&next) == FLASH_OK);
+CHECK( (Read_Config_from_flash(&config) == FLASH_OK) && (memcmp(&config, &next, sizeof(config)) == 0) );
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Данные записи Config Page с номером Number.
+  * @param   Config - указатель на структуру для данных.
+  * @param   Number - номер записи (хранится в AddrModule).
+  * @return  None.
+  */
+static void Config_fill (Config_struct *Config, uint32_t Number)
+{
+memset(Config, 0, sizeof(*Config));
+Config->AddrModule   = Number;
+Config->CanSpeed     = Number * 7919U;
+Config->FirstRunFlag = ~Number;
+Config->ModbusPort0Param.baud = (uint8_t)Number;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   RO Constants: запись 1.
+  * @return  None.
+  */
+static void RO_prepare (void)
+{
+RO_Constants_struct ro;
+
+RO_fill(&ro, 1);
+Write_RO_Constants_to_flash(&ro);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   RO Constants: запись 2 поверх записи 1.
+  * @return  None.
+  */
+static void RO_run (void)
+{
+RO_Constants_struct ro;
+
+*Committed = 1;
+RO_fill(&ro, 2);
+if (Write_RO_Constants_to_flash(&ro) != FLASH_OK)
+  _exit(2);
+*Committed = 2;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   RO Constants после перезапуска.
+  * @return  int - 0 - читаются запись 1 или 2 либо FLASH_ERROR (частично записанные данные), повторная запись выполняется.
+  */
+static int RO_verify (void)
+{
+RO_Constants_struct ro;
+RO_Constants_struct expected;
+
+if (Read_RO_Constants_from_flash(&ro) == FLASH_OK)
+  {
+  RO_fill(&expected, ro.SerialNumberLW);
+  CHECK( (ro.SerialNumberLW == 1) || (ro.SerialNumberLW == 2) );
+  CHECK(memcmp(&ro, &expected, sizeof(ro)) == 0);
+  }
+else
+  {
+  CHECK(*Committed < 2);
+  }
+
+RO_fill(&expected, 2);
+CHECK(Write_RO_Constants_to_flash(&expected) == FLASH_OK);
+CHECK( (Read_RO_Constants_from_flash(&ro) == FLASH_OK) && (memcmp(&ro, &expected, sizeof(ro)) == 0) );
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Данные RO Constants с номером Number.
+  * @param   RO_Constants - указатель на структуру для данных.
+  * @param   Number       - номер записи (хранится в SerialNumberLW).
+  * @return  None.
+  */
+static void RO_fill (RO_Constants_struct *RO_Constants, uint32_t Number)
+{
+memset(RO_Constants, 0, sizeof(*RO_Constants));
+RO_Constants->ModulType      = 0x55U;
+RO_Constants->SerialNumberLW = Number;
+RO_Constants->SerialNumberHW = Number * 0x01010101U;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Write Words: прежние данные на WORDS_PAGES + 2 страницах (с соседними).
+  * @return  None.
+  */
+static void Words_prepare (void)
+{
+static uint32_t words[(WORDS_PAGES + 2) * 0x1000U / 4];
+uint32_t        amount = (WORDS_PAGES + 2) * Words_page / 4;
+
+for (uint32_t i = 0; i < amount; i++)
+  {
+  words[i] = Words_value(i, 0);
+  }
+Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, amount, words);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Write Words: новые данные с середины второй до середины последней страницы.
+  * @return  None.
+  */
+static void Words_run (void)
+{
+static uint32_t words[WORDS_PAGES * 0x1000U / 4];
+uint32_t        first  = Words_page / 4 + Words_page / 8;
+uint32_t        amount = (WORDS_PAGES - 1) * Words_page / 4;
+
+for (uint32_t i = 0; i < amount; i++)
+  {
+  words[i] = Words_value(first + i, 1);
+  }
+if (Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER + 4*first, amount, words) != FLASH_OK)
+  _exit(2);
+*Committed = 1;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Write Words после перезапуска.
+  * @return  int - 0 - соседние страницы не изменены, страницы записи содержат прежние или новые данные,      \n
+  *          кроме одной, повторная запись выполняется.
+  */
+static int Words_verify (void)
+{
+uint32_t *flash  = (uint32_t*)ADDR_DOWNLOAD_BUFFER;
+uint32_t  first  = Words_page / 4 + Words_page / 8;
+uint32_t  amount = (WORDS_PAGES - 1) * Words_page / 4;
+uint32_t  torn   = 0;
+uint32_t  from;
+uint32_t  to;
+uint8_t   old_data;
+uint8_t   new_data;
+
+for (uint32_t i = 0; i < Words_page / 4; i++)
+  {
+  CHECK(flash[i] == Words_value(i, 0));
+  CHECK(flash[(WORDS_PAGES + 1) * Words_page / 4 + i] == Words_value((WORDS_PAGES + 1) * Words_page / 4 + i, 0));
+  }
+
+for (uint32_t page = 1; page <= WORDS_PAGES; page++)
+  {
+  from     = (page == 1) ? first : page * Words_page / 4;
+  to       = (page == WORDS_PAGES) ? first + amount : (page + 1) * Words_page / 4;
+  old_data = 1;
+  new_data = 1;
+  for (uint32_t i = from; i < to; i++)
+    {
+    old_data &= (flash[i] == Words_value(i, 0));
+    new_data &= (flash[i] == Words_value(i, 1));
+    }
+  if (!old_data && !new_data)
+    torn++;
+  }
+CHECK(torn <= 1);
+if (*Committed)
+  CHECK(torn == 0);
+
+Words_run();
+for (uint32_t i = first; i < first + amount; i++)
+  {
+  CHECK(flash[i] == Words_value(i, 1));
+  }
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Слово области Write Words.
+  * @param   Index - номер слова от ADDR_DOWNLOAD_BUFFER.
+  * @param   New   - 0 - прежние данные, 1 - новые (каждое восьмое слово совпадает с прежним).
+  * @return  uint32_t - значение слова.
+  */
+static uint32_t Words_value (uint32_t Index, uint8_t New)
+{
+uint32_t value = 0x5A000000U + Index;
+
+return ( New && (Index % 8) ) ? (value ^ 0x00FF00FFU) : value;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   KV Store: разметка областей.
+  * @return  None.
+  */
+static void KV_prepare (void)
+{
+Init_KV_store();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   KV Store: записи 1 ... KV_WRITES, запись Number - ключ Number % KV_KEYS.
+  * @return  None.
+  */
+static void KV_run (void)
+{
+uint32_t value[2];
+
+for (uint32_t i = 1; i <= KV_WRITES; i++)
+  {
+  value[0] = i;
+  value[1] = ~i;
+  if (Write_KV_to_flash(i % KV_KEYS, value, 4 + 4 * (i % 2)) != FLASH_OK)
+    _exit(2);
+  *Committed = i;
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   KV Store после перезапуска.
+  * @return  int - 0 - у каждого ключа значение последней завершённой или прерванной записи, следующая запись выполняется.
+  */
+static int KV_verify (void)
+{
+uint32_t number = *Committed;
+uint32_t value[2];
+
+CHECK(Init_KV_store() == FLASH_OK);
+for (uint16_t key = 0; key < KV_KEYS; key++)
+  {
+  CHECK(KV_check_key(key, number) == 0);
+  }
+
+value[0] = KV_WRITES + 1;
+value[1] = ~value[0];
+CHECK(Write_KV_to_flash(0, value, 8) == FLASH_OK);
+CHECK( (Read_KV_from_flash(0, value, 8) == 8) && (value[0] == KV_WRITES + 1) );
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Значение ключа KV Store после Number завершённых записей.
+  * @param   Key    - ключ.
+  * @param   Number - количество завершённых записей.
+  * @return  int - 0 - значение ключа записано последней завершённой записью ключа или записью Number + 1.
+  */
+static int KV_check_key (uint16_t Key, uint32_t Number)
+{
+uint32_t value[2] = {0, 0};
+uint32_t last     = Number;
+uint16_t length;
+
+while ( (last > 0) && (last % KV_KEYS != Key) )
+  {
+  last--;
+  }
+length = Read_KV_from_flash(Key, value, sizeof(value));
+
+if ( (length != 0) && (value[0] == Number + 1) && (Key == (Number + 1) % KV_KEYS) )
+  last = Number + 1;
+if (last == 0)
+  {
+  CHECK(length == 0);
+  return 0;
+  }
+CHECK(length == 4 + 4 * (last % 2));
+CHECK(value[0] == last);
+CHECK( (length == 4) || (value[1] == ~last) );
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Log ring: разметка LOG_PAGES страниц.
+  * @return  None.
+  */
+static void Log_prepare (void)
+{
+Init_Log_ring(ADDR_LOG_AREA, LOG_PAGES, LOG_RECORD);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Log ring: записи 1 ... LOG_WRITES.
+  * @return  None.
+  */
+static void Log_run (void)
+{
+uint32_t record[LOG_RECORD / 4];
+
+for (uint32_t i = 1; i <= LOG_WRITES; i++)
+  {
+  for (uint32_t j = 0; j < LOG_RECORD / 4; j++)
+    {
+    record[j] = i + j;
+    }
+  if (Append_Log_to_flash(record) != FLASH_OK)
+    _exit(2);
+  *Committed = i;
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Log ring после перезапуска.
+  * @return  int - 0 - действительные записи идут подряд и заканчиваются записью Committed или Committed + 1, \n
+  *          повреждённой может быть только самая новая запись, следующая запись выполняется.
+  */
+static int Log_verify (void)
+{
+uint32_t number = *Committed;
+uint32_t record[LOG_RECORD / 4];
+uint32_t count;
+uint32_t last   = 0;
+
+CHECK(Init_Log_ring(ADDR_LOG_AREA, LOG_PAGES, LOG_RECORD) == FLASH_OK);
+count = Get_Log_count();
+for (uint32_t i = 0; i < count; i++)
+  {
+  if (Read_Log_from_flash(i, record) != FLASH_OK)
+    {
+    CHECK(i == count - 1);
+    continue;
+    }
+  for (uint32_t j = 1; j < LOG_RECORD / 4; j++)
+    {
+    CHECK(record[j] == record[0] + j);
+    }
+  CHECK( (last == 0) || (record[0] == last + 1) );
+  last = record[0];
+  }
+CHECK( (last == number) || (last == number + 1) );
+
+record[0] = LOG_WRITES + 1;
+for (uint32_t j = 1; j < LOG_RECORD / 4; j++)
+  {
+  record[j] = record[0] + j;
+  }
+CHECK(Append_Log_to_flash(record) == FLASH_OK);
+count = Get_Log_count();
+CHECK( (Read_Log_from_flash(count - 1, record) == FLASH_OK) && (record[0] == LOG_WRITES + 1) );
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Install: новый образ в Download Buffer, прежние данные на INSTALL_PAGES + 1 страницах Main Programm.
+  * @return  None.
+  */
+static void Install_prepare (void)
+{
+static uint32_t words[(INSTALL_PAGES + 1) * 0x1000U / 4];
+uint32_t        amount = (INSTALL_PAGES + 1) * Words_page / 4;
+
+for (uint32_t i = 0; i < amount; i++)
+  {
+  words[i] = Install_value(i, 0);
+  }
+Write_Words_to_flash(ADDR_MAIN_PROGRAM, amount, words);
+for (uint32_t i = 0; i < amount; i++)
+  {
+  words[i] = Install_value(i, 1);
+  }
+Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, amount, words);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Install: установка образа (INSTALL_PAGES страниц без двух слов).
+  * @return  None.
+  */
+static void Install_run (void)
+{
+uint32_t size = INSTALL_PAGES * Words_page - 8;
+
+if (Install_Image(size, Calc_CRC32((const uint32_t*)ADDR_DOWNLOAD_BUFFER, size / 4), 0, 0) != FLASH_OK)
+  _exit(2);
+*Committed = 1;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Install после перезапуска.
+  * @return  int - 0 - незавершённая установка обнаруживается и завершается (или завершена), Main Programm      \n
+  *          содержит образ, страница за образом не изменена.
+  */
+static int Install_verify (void)
+{
+uint32_t             *flash = (uint32_t*)ADDR_MAIN_PROGRAM;
+uint32_t              size  = INSTALL_PAGES * Words_page - 8;
+uint32_t              crc   = Calc_CRC32((const uint32_t*)ADDR_DOWNLOAD_BUFFER, size / 4);
+uint32_t              pending_size;
+uint32_t              pending_crc;
+Install_report_struct report;
+
+if (Get_Pending_Install(&pending_size, &pending_crc) == FLASH_OK)
+  {
+  CHECK(*Committed == 0);
+  CHECK( (pending_size == size) && (pending_crc == crc) );
+  }
+else if (*Committed)
+  {
+  for (uint32_t i = 0; i < size / 4; i++)
+    {
+    CHECK(flash[i] == Install_value(i, 1));
+    }
+  }
+
+CHECK(Install_Image(size, crc, 0, &report) == FLASH_OK);
+CHECK(report.Copied + report.Skipped == report.Pages - report.First_page);
+for (uint32_t i = 0; i < size / 4; i++)
+  {
+  CHECK(flash[i] == Install_value(i, 1));
+  }
+for (uint32_t i = INSTALL_PAGES * Words_page / 4; i < (INSTALL_PAGES + 1) * Words_page / 4; i++)
+  {
+  CHECK(flash[i] == Install_value(i, 0));
+  }
+CHECK(Get_Pending_Install(&pending_size, &pending_crc) == FLASH_ERROR);
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Слово Main Programm или Download Buffer проверки Install.
+  * @param   Index - номер слова от начала области.
+  * @param   New   - 0 - прежние данные Main Programm, 1 - образ (каждое четвёртое слово совпадает с прежним).
+  * @return  uint32_t - значение слова.
+  */
+static uint32_t Install_value (uint32_t Index, uint8_t New)
+{
+uint32_t value = 0x3C000000U + Index;
+
+return ( New && (Index % 4) ) ? (value ^ 0x0F0F0F0FU) : value;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
@@ -0,0 +1,946 @@
+/**
+  ******************************************************************************
+  *
+  * @file      main.c
+  *
+  * @brief     Проверка функций FLASH.c и модулей common на модели FLASH (ПК, Linux).
+  *
+  * @details   Функции выполняются с моделью FLASH_host.c (NOR семантика, время операций, банки), каждая группа   \n
+  *            проверок - отдельная функция. Для операций записи выводится моделируемое время и количество          \n
+  *            операций (Report), для непройденной проверки - её название (Check).
+  *
+  * **Manual** \n
+  * Проверки (в порядке выполнения):
+  * - Test_NOR_semantics  - блокировка, программирование без стирания, невыровненный адрес, статистика FLASH;
+  * - Test_Config         - RO Constants, журнал Config Page (количество стираний и слов на запись), кэш Config;
+  * - Test_Write_Words    - способы записи Write_Words_to_flash, асинхронная запись и её перекрытие в разных банках,  \n
+  *                         отказы для неверных адресов, Verify_Region_of_flash;
+  * - Test_Image_writer   - потоковая запись образа в Download Buffer частями разного размера;
+  * - Test_Install        - установка образа в Main Programm: полная, повторная и после изменения одной страницы;
+  * - Test_Image_lz       - сжатый образ: распаковка, потоковая распаковка в Download Buffer, повреждённый образ;
+  * - Test_Image_delta    - разностное обновление относительно Main Programm, патч для другого образа;
+  * - Test_KV_store       - KV Store: запись, перезапись, удаление, наибольшая длина значения, свободное место,   \n
+  *                         уплотнение на границе заполнения области, чтение после уплотнения и сброса, полное хранилище;
+  * - Test_Log_ring       - кольцевой журнал: порядок чтения от старой записи к новой, Get_Log_count, переход    \n
+  *                         по кругу после заполнения, восстановление начала и конца журнала Init_Log_ring;
+  * - Test_Erase_counters - учёт стираний, сохранение и чтение после сброса, перенос в резервную область,            \n
+  *                         сохранение каждые WEAR_SAVE_PERIOD стираний;
+  * - Test_Geometry       - геометрия FLASH для вариантов плат, отключение областей, не помещающихся во FLASH,  \n
+  *                         сохранение результата для неподдерживаемого объёма FLASH.
+  *
+  * Test_Install и Test_Image_delta используют образы предыдущих проверок (Host_image, Host_code).
+  *
+  * Сборка и запуск: make -C Host_Flash run (DENSITY=HD|XD|AT|MD). Код завершения 0 - все проверки пройдены.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include <stdio.h>
+#include <string.h>
+#include "FLASH_host.h"
+#include "Config_cache.h"
+#include "Image_writer.h"
+#include "Image_install.h"
+#include "KV_store.h"
+#include "Log_ring.h"
+#include "Erase_counters.h"
+#include "Image_lz.h"
+#include "Image_diff.h"
+#include "Flash_geometry.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#ifndef FLASH_SIM_DENSITY
+#define FLASH_SIM_DENSITY   FLASH_SIM_GD_HD     /*!< Моделируемый микроконтроллер (задаётся в Makefile: DENSITY=HD|XD|AT|MD). */
+#endif
+
+#define HOST_WORDS          1024U               /*!< Количество слов для замеров записи (4 KB).                              */
+#define IMAGE_SIZE          40001U              /*!< Размер образа для потоковой записи (не кратен слову и странице).        */
+#define IMAGE_WORDS         ((IMAGE_SIZE + 3) / 4) /*!< Размер образа в словах.                                             */
+#define CONFIG_SAVES        1000U               /*!< Количество сохранений Config для проверки числа стираний журнала.       */
+#define WEAR_ERASES         5U                  /*!< Количество стираний страницы до первого сохранения счётчиков.           */
+#define WEAR_SAVES          1000U               /*!< Количество сохранений счётчиков: больше вмещает одна область.           */
+#define KV_RECORD_BYTES(Length) (4U * (2U + ((Length) + 3U) / 4U)) /*!< Размер записи KV Store в байтах (см. KV_store.c). */
+#define LOG_PAGES           4U                  /*!< Количество страниц журнала Test_Log_ring.                               */
+#define LOG_RECORD          16U                 /*!< Размер записи журнала Test_Log_ring в байтах.                           */
+#define LOG_CIRCLES         3U                  /*!< Количество кругов записи журнала Test_Log_ring.                         */
+#define UNSUPPORTED_KB      8U                  /*!< Объём FLASH, не поддерживаемый Flash_geometry.c, в Kbyte.               */
+#define CHUNKS_MAX          100000U             /*!< Наибольшее количество попыток передачи частей образа.                   */
+#define FINALIZE_TRIES      1000U               /*!< Наибольшее количество попыток завершения приёма образа.                 */
+//------------------------------------------------------------------------------//
+
+//---Private types--------------------------------------------------------------//
+typedef flash_status (*chunk_writer)    (const uint8_t *Data, uint32_t Length); /*!< Приём части образа.      */
+typedef flash_status (*chunk_finalize)  (void);                                 /*!< Завершение приёма образа. */
+
+/**
+  * @brief  Вариант платы для проверки геометрии.
+  */
+typedef struct
+{
+flash_sim_density Density;    /*!< Моделируемый микроконтроллер.        */
+uint16_t          Size_KB;    /*!< Объём FLASH в Kbyte.                 */
+flash_density     Expected;   /*!< Ожидаемая плотность Flash_geometry.c. */
+} host_board;
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint32_t Host_words [HOST_WORDS];                        /*!< Данные для записи.                                      */
+static uint32_t Host_errors = 0;                                /*!< Количество непройденных проверок.                       */
+static uint32_t Host_image [IMAGE_WORDS];                       /*!< Образ прошивки, дополненный до слова байтами 0xFF.      */
+static uint32_t Host_code  [IMAGE_WORDS];                       /*!< Образ для сжатия: машинный код host_flash, байты 0xFF.  */
+static uint8_t  Host_packed[IMAGE_LZ_PACKED_MAX(IMAGE_SIZE)];   /*!< Сжатый образ Host_code.                                 */
+static uint8_t  Host_patch [IMAGE_DELTA_PATCH_MAX(IMAGE_SIZE)]; /*!< Патч Host_code -> Host_image.                            */
+//------------------------------------------------------------------------------//
+
+//---Private constants----------------------------------------------------------//
+static const host_board Boards[] =
+{
+{FLASH_SIM_GD_MD, 128,  FLASH_DENSITY_MEDIUM},
+{FLASH_SIM_GD_HD, 256,  FLASH_DENSITY_HIGH  },
+{FLASH_SIM_GD_HD, 512,  FLASH_DENSITY_HIGH  },
+{FLASH_SIM_GD_XD, 768,  FLASH_DENSITY_EXTRA },
+{FLASH_SIM_GD_XD, 1024, FLASH_DENSITY_EXTRA },
+{FLASH_SIM_AT32F413, 256, FLASH_DENSITY_HIGH},
+};
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static void         Test_NOR_semantics   (void);
+static void         Test_Config          (void);
+static void         Test_Write_Words     (void);
+static void         Test_Image_writer    (void);
+static void         Test_Install         (void);
+static void         Test_Image_lz        (void);
+static void         Test_Image_delta     (void);
+static void         Test_KV_store        (void);
+static void         Test_Log_ring        (void);
+static void         Test_Erase_counters  (void);
+static void         Test_Geometry        (void);
+static void         Check                (int Condition, const char *Name);
+static void         Report               (const char *Name);
+static flash_status Write_async_and_wait (uint32_t Address, uint32_t Amount, uint32_t *Words);
+static uint32_t     Send_chunks          (chunk_writer Write, const uint8_t *Data, uint32_t Size, uint32_t Step,
+                                          uint32_t Length_max, uint32_t Irq_period, uint32_t *Busy);
+static flash_status Finalize_chunks      (chunk_finalize Finalize);
+static flash_status Finalize_Host_image  (void);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+int main (void)
+{
+if (Init_flash_sim(FLASH_SIM_DENSITY, 0) != FLASH_OK)
+  {
+  printf("FAIL: Init_flash_sim\n");
+  return 1;
+  }
+for (uint32_t i = 0; i < HOST_WORDS; i++)
+  {
+  Host_words[i] = 0xA5A50000U + i;
+  }
+
+Test_NOR_semantics();
+Test_Config();
+Test_Write_Words();
+Test_Image_writer();
+Test_Install();
+Test_Image_lz();
+Test_Image_delta();
+Test_KV_store();
+Test_Log_ring();
+Test_Erase_counters();
+Test_Geometry();
+
+printf("%s: %u failed\n", (Host_errors == 0) ? "PASS" : "FAIL", Host_errors);
+return (Host_errors == 0) ? 0 : 1;
+}
+//------------------------------------------------------------------------------//
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Поведение NOR FLASH модели.
+  * @details Программирование заблокированной FLASH, невыровненного адреса и слова без стирания возвращает ошибку, \n
+  *          Get_Flash_stats хранит последнюю ошибку, стирание заполняет страницу байтами 0xFF.
+  * @return  None.
+  */
+static void Test_NOR_semantics (void)
+{
+uint32_t           word = 0x12345678;
+Flash_stats_struct stats;
+
+Check(Program_Words_to_flash(ADDR_DOWNLOAD_BUFFER, 1, &word) == FLASH_ERROR, "program locked");
+Unlock_flash();
+Check(Program_Words_to_flash(ADDR_DOWNLOAD_BUFFER + 2, 1, &word) == FLASH_WROG_ADDRES, "program misaligned");
+Check(Program_Words_to_flash(ADDR_DOWNLOAD_BUFFER, 1, &word) == FLASH_OK, "program blank");
+Check(Program_Words_to_flash(ADDR_DOWNLOAD_BUFFER, 1, &word) == FLASH_ERROR, "program without erase");
+Get_Flash_stats(&stats);
+Check( (stats.Errors == 3) && (stats.Last_error == FLASH_ERROR) && (stats.Last_error_addr == ADDR_DOWNLOAD_BUFFER), "Get_Flash_stats last error");
+Check(Erase_Page_of_flash(ADDR_DOWNLOAD_BUFFER) == FLASH_OK, "erase");
+Check(*(uint32_t*)ADDR_DOWNLOAD_BUFFER == BLANK_WORD, "erased to 0xFF");
+Lock_flash();
+Report("NOR semantics");
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Журнал Config Page, RO Constants и кэш Config.
+  * @details Журнал Config Page стирает страницу только после заполнения всех слотов записей,               \n
+  *          каждая запись программирует CONFIG_RECORD_SIZE слов. Серия изменений через кэш - одна запись.
+  * @return  None.
+  */
+static void Test_Config (void)
+{
+Config_struct          cfg = {0};
+Config_struct          cfg_rd;
+RO_Constants_struct    ro  = {0x12, {0x34, 0x56}, 0xEEEE, 0xF0F1F2F3, 0x789ABCDE};
+RO_Constants_struct    ro_rd;
+Flash_sim_stats_struct sim;
+uint32_t               cfg_addr;
+uint32_t               cfg_size;
+
+Check(Write_RO_Constants_to_flash(&ro) == FLASH_OK, "Write_RO_Constants_to_flash");
+Check( (Read_RO_Constants_from_flash(&ro_rd) == FLASH_OK) && (ro_rd.SerialNumberHW == ro.SerialNumberHW), "Read_RO_Constants_from_flash");
+Report("RO Constants");
+
+for (uint32_t i = 0; i < CONFIG_SAVES; i++)
+  {
+  cfg.AddrModule = i;
+  Check(Write_Config_to_flash(&cfg) == FLASH_OK, "Write_Config_to_flash");
+  }
+Check( (Read_Config_from_flash(&cfg_rd) == FLASH_OK) && (cfg_rd.AddrModule == CONFIG_SAVES - 1), "Read_Config_from_flash");
+Get_flash_sim_stats(&sim);
+Get_Region_of_flash(FLASH_REGION_CONFIG_PAGE_B, &cfg_addr, &cfg_size);
+Check(sim.Erases == ((CONFIG_SAVES - 1) / (cfg_size / (CONFIG_RECORD_SIZE * 4))) * (cfg_size / Get_Page_Size_of_flash(cfg_addr)),
+      "Config Page erases per record slots");
+Check(sim.Programs == CONFIG_SAVES * CONFIG_RECORD_SIZE, "Config Page words per save");
+Report("Config Page x1000");
+
+Check(Init_Config_cache() == FLASH_OK, "Init_Config_cache saved config");
+for (uint8_t port = 0; port < NUM_OF_MODBUS_PORTS; port++)
+  {
+  Set_Config_ModbusBaud(port, 6);
+  Set_Config_ModbusParity(port, 7);
+  }
+Check(Flush_Config() == FLASH_OK, "Flush_Config");
+Report("Config cache flush");
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Способы записи Write_Words_to_flash (4 KB) и асинхронная запись.
+  * @details Асинхронная запись заканчивается через моделируемое время; записи в разные банки (Extra-density)  \n
+  *          выполняются одновременно. При стирании слова страниц вне записываемого массива сохраняются.         \n
+  *          Неверные адреса и размеры отвергаются без записи.
+  * @return  None.
+  */
+static void Test_Write_Words (void)
+{
+uint32_t               bank1 = Get_flash_geometry()->Bank1_addr;
+Flash_sim_stats_struct sim;
+uint32_t               clock;
+uint32_t               page;
+uint32_t               words[4];
+
+Check(Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, HOST_WORDS, Host_words) == FLASH_OK, "Write_Words_to_flash");
+Report("Write 4 KB (blank)");
+Check(Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, HOST_WORDS, Host_words) == FLASH_OK, "Write_Words_to_flash same");
+Check(Get_Last_Write_Path() == FLASH_WRITE_SKIPPED, "path skipped");
+Report("Write 4 KB (same data)");
+Host_words[HOST_WORDS - 1] = 0;
+Check(Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, HOST_WORDS, Host_words) == FLASH_OK, "Write_Words_to_flash clear bits");
+Check(Get_Last_Write_Path() == FLASH_WRITE_ERASED, "path erased");
+Report("Write 4 KB (one word)");
+page  = Get_Page_Size_of_flash(ADDR_DOWNLOAD_BUFFER);
+for (uint32_t i = 0; i < 4; i++)
+  {
+  words[i] = ~Host_words[page / 4 - 2 + i];
+  Host_words[page / 4 - 2 + i] = words[i];
+  }
+Check(Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER + page - 8, 4, words) == FLASH_OK, "Write_Words_to_flash across pages");
+Check(Get_Last_Write_Path() == FLASH_WRITE_ERASED, "path erased across pages");
+for (uint32_t i = 0; i < HOST_WORDS; i++)
+  {
+  Check(*((uint32_t*)ADDR_DOWNLOAD_BUFFER + i) == Host_words[i], "words around the array kept");
+  }
+Report("Write 4 words (two pages kept)");
+Check(Write_async_and_wait(ADDR_DOWNLOAD_BUFFER + 4 * HOST_WORDS, HOST_WORDS, Host_words) == FLASH_OK, "Write_Words_to_flash_async");
+for (uint32_t i = 0; i < HOST_WORDS; i++)
+  {
+  Check(*((uint32_t*)(ADDR_DOWNLOAD_BUFFER + 4 * HOST_WORDS) + i) == Host_words[i], "async data");
+  }
+Report("Write 4 KB (async)");
+
+Check(Write_Words_to_flash_async(ADDR_DOWNLOAD_BUFFER + 8 * HOST_WORDS, HOST_WORDS, Host_words, 0) == FLASH_OK, "async start");
+Advance_flash_sim_clock(1);
+Check(Get_Async_Status() == FLASH_BUSY, "async busy until modelled time");
+Check(Verify_Region_of_flash(FLASH_REGION_MAIN_PROGRAM, 0) == FLASH_BUSY, "Verify_Region_of_flash busy");
+Check(Write_Words_to_flash_async(ADDR_DOWNLOAD_BUFFER + 2, 1, Host_words, 0) == FLASH_WROG_ADDRES, "async misaligned");
+clock = Get_flash_sim_clock();
+if (bank1 != 0)
+  Check(Write_Words_to_flash_async(bank1 - 4 * HOST_WORDS, HOST_WORDS, Host_words, 0) == FLASH_OK, "async other bank");
+Check( (Get_Bank_Async_Status(0) == FLASH_BUSY) || (bank1 == 0), "async bank0 busy");
+while (Get_Async_Status() == FLASH_BUSY)
+  {
+  Flash_sim_IRQ();
+  }
+Get_flash_sim_stats(&sim);
+printf("Async overlap: %u us modelled clock, %llu us of operations\n", Get_flash_sim_clock() - clock, (unsigned long long)sim.Time_us);
+if (bank1 != 0)
+  Check( (Get_flash_sim_clock() - clock) * 10 < sim.Time_us * 6, "async banks overlap");
+for (uint32_t i = 0; i < HOST_WORDS; i++)
+  {
+  Check(*((uint32_t*)(ADDR_DOWNLOAD_BUFFER + 8 * HOST_WORDS) + i) == Host_words[i], "overlap data");
+  if (bank1 != 0)
+    Check(*((uint32_t*)(uintptr_t)(bank1 - 4 * HOST_WORDS) + i) == Host_words[i], "overlap data other bank");
+  }
+Report("Write 2 x 4 KB (async overlap)");
+
+Check(Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, 0, Host_words) == FLASH_WROG_ADDRES, "Write_Words_to_flash zero amount");
+Check(Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, 0x40000000U, Host_words) == FLASH_WROG_ADDRES, "Write_Words_to_flash amount overflow");
+Check(Write_Words_to_flash(Get_flash_geometry()->End_addr - 4, 2, Host_words) == FLASH_WROG_ADDRES, "Write_Words_to_flash past end");
+Check(Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER + Get_Page_Size_of_flash(ADDR_DOWNLOAD_BUFFER) - 2, 2, Host_words) == FLASH_WROG_ADDRES,
+      "Write_Words_to_flash misaligned at page end");
+Check(Erase_Area_of_flash(ADDR_DOWNLOAD_BUFFER + 2, 4) == FLASH_WROG_ADDRES, "Erase_Area_of_flash misaligned");
+Check(Verify_Region_of_flash(FLASH_REGION_MAIN_PROGRAM, Calc_Region_CRC32(FLASH_REGION_MAIN_PROGRAM)) == FLASH_OK, "Verify_Region_of_flash");
+Check(Verify_Region_of_flash(FLASH_REGION_MAIN_PROGRAM, Calc_CRC32_soft((const uint32_t*)ADDR_MAIN_PROGRAM, MEMSIZE_MAIN_PROGRAM * 256)) == FLASH_OK,
+      "Verify_Region_of_flash Calc_CRC32_soft");
+Check( (Erase_Area_of_flash(ADDR_DOWNLOAD_BUFFER, Get_Page_Size_of_flash(ADDR_DOWNLOAD_BUFFER)) == FLASH_OK) &&
+       (Write_Words_to_flash_async(ADDR_DOWNLOAD_BUFFER, 4, Host_words, 0) == FLASH_OK) &&
+       (Verify_Region_of_flash(FLASH_REGION_MAIN_PROGRAM, Calc_Region_CRC32(FLASH_REGION_MAIN_PROGRAM)) == FLASH_BUSY),
+      "Verify_Region_of_flash async write");
+while (Get_Async_Status() == FLASH_BUSY)
+  {
+  Flash_sim_IRQ();
+  }
+Check(Verify_Region_of_flash(FLASH_REGION_CONFIG_PAGE, Calc_Region_CRC32(FLASH_REGION_CONFIG_PAGE)) == FLASH_WROG_ADDRES,
+      "Verify_Region_of_flash mutable region");
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Потоковая запись образа в Download Buffer частями разного размера.
+  * @details Download Buffer предварительно заполнен данными: каждая страница образа стирается.              \n
+  *          Части, принятые во время стирания, накапливаются в буфере приёма (Send_chunks).
+  * @return  None.
+  */
+static void Test_Image_writer (void)
+{
+uint8_t *image = (uint8_t*)Host_image;
+uint32_t busy;
+
+for (uint32_t i = 0; i < sizeof(Host_image); i++)
+  {
+  image[i] = (i < IMAGE_SIZE) ? (uint8_t)(i * 7 + (i >> 8)) : 0xFF;
+  }
+for (uint32_t addr = ADDR_DOWNLOAD_BUFFER; addr < ADDR_DOWNLOAD_BUFFER + MEMSIZE_DOWNLOAD_BUFFER * 1024; addr += 4 * HOST_WORDS)
+  {
+  Write_Words_to_flash(addr, HOST_WORDS, Host_words);
+  }
+Reset_flash_sim_stats();
+Check(Open_Image_writer(IMAGE_SIZE) == FLASH_OK, "Open_Image_writer");
+Send_chunks(Write_Image_chunk, image, IMAGE_SIZE, 37, 250, 16, &busy);
+Check(Get_Image_writer_received() == IMAGE_SIZE, "Write_Image_chunk");
+Check(Finalize_chunks(Finalize_Host_image) == FLASH_OK, "Finalize_Image_writer");
+Check(Get_Async_Status() != FLASH_BUSY, "image writer idle");
+for (uint32_t i = 0; i < IMAGE_WORDS; i++)
+  {
+  Check(*((uint32_t*)ADDR_DOWNLOAD_BUFFER + i) == Host_image[i], "image data");
+  }
+Check(Write_Image_chunk(image, 1) == FLASH_ERROR, "image writer closed");
+printf("Image writer: %u bytes, %u busy retries\n", IMAGE_SIZE, busy);
+Report("Image 40 KB (stream)");
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Установка образа Host_image из Download Buffer в Main Programm.
+  * @details Полная, повторная (все страницы совпадают) и после изменения одной страницы Main Programm        \n
+  *          (записывается только она). Если журнал установки не помещается во FLASH (Medium-density),       \n
+  *          установка отключена.
+  * @return  None.
+  */
+static void Test_Install (void)
+{
+Install_report_struct install;
+uint32_t              pending_size;
+uint32_t              pending_crc;
+uint32_t              word      = 0;
+uint32_t              image_crc = Calc_CRC32(Host_image, IMAGE_WORDS);
+
+if (!Area_in_flash(ADDR_INSTALL_AREA, MEMSIZE_INSTALL_AREA * 1024))
+  {
+  Check(Install_Image(IMAGE_SIZE, image_crc, 0, 0) == FLASH_WROG_ADDRES, "Install_Image outside FLASH");
+  Check(Get_Pending_Install(&pending_size, &pending_crc) == FLASH_ERROR, "install outside FLASH");
+  printf("Install: journal outside FLASH, skipped\n");
+  return;
+  }
+
+Check(Install_Image(IMAGE_SIZE, image_crc ^ 1, 0, 0) == FLASH_ERROR, "Install_Image CRC");
+Check(Install_Image(IMAGE_SIZE, image_crc, Get_flash_sim_time, &install) == FLASH_OK, "Install_Image");
+for (uint32_t i = 0; i < IMAGE_WORDS; i++)
+  {
+  Check(*((uint32_t*)ADDR_MAIN_PROGRAM + i) == Host_image[i], "install data");
+  }
+Check(Get_Pending_Install(&pending_size, &pending_crc) == FLASH_ERROR, "install done");
+printf("Install: %u pages, %u copied, %u skipped, %u us\n", install.Pages, install.Copied, install.Skipped, install.Time);
+Report("Install 40 KB");
+
+Check(Install_Image(IMAGE_SIZE, image_crc, 0, &install) == FLASH_OK, "Install_Image again");
+Check(install.Copied == 0, "install skips equal pages");
+Report("Install 40 KB (equal)");
+
+Write_Words_to_flash(ADDR_MAIN_PROGRAM + 4 * Get_Page_Size_of_flash(ADDR_MAIN_PROGRAM), 1, &word);
+Check(Install_Image(IMAGE_SIZE, image_crc, 0, &install) == FLASH_OK, "Install_Image page");
+Check(install.Copied == 1, "install copies changed page");
+Report("Install 40 KB (one page)");
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Сжатый образ: Pack_Image_lz машинного кода host_flash (Host_code).
+  * @details Распаковка в RAM, потоковая распаковка в Download Buffer частями разного размера и частями         \n
+  *          полного размера (незавершённый повтор в буфере приёма не должен блокировать приём - FLASH_BUSY      \n
+  *          без конца), затем повреждённый образ.
+  * @return  None.
+  */
+static void Test_Image_lz (void)
+{
+FILE    *exe  = fopen("/proc/self/exe", "rb");
+uint32_t size = 0;
+uint32_t packed;
+uint32_t busy;
+
+memset(Host_code, 0xFF, sizeof(Host_code));
+if (exe != 0)
+  {
+  fseek(exe, 4096, SEEK_SET);
+  fread(Host_code, 1, IMAGE_SIZE, exe);
+  fclose(exe);
+  }
+packed = Pack_Image_lz(Host_code, IMAGE_SIZE, Host_packed, sizeof(Host_packed));
+Check(Unpack_Image_lz(Host_packed, packed, Host_image, sizeof(Host_image), &size) == FLASH_OK, "Unpack_Image_lz");
+Check( (size == IMAGE_SIZE) && (memcmp(Host_image, Host_code, sizeof(Host_code)) == 0), "Unpack_Image_lz data");
+
+Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, HOST_WORDS, Host_words);
+Reset_flash_sim_stats();
+Check(Open_Image_lz() == FLASH_OK, "Open_Image_lz");
+Check(Send_chunks(Write_Image_lz_chunk, Host_packed, packed, 53, IMAGE_LZ_INPUT_BYTES, 16, &busy) == packed, "Write_Image_lz_chunk");
+Finalize_chunks(Finalize_Image_lz);
+Check(Get_Image_lz_size() == IMAGE_SIZE, "Get_Image_lz_size");
+Check(memcmp((const void*)ADDR_DOWNLOAD_BUFFER, Host_code, sizeof(Host_code)) == 0, "lz image data");
+printf("Image lz: %u -> %u bytes (%u%%), %u busy retries\n", IMAGE_SIZE, packed, packed * 100 / IMAGE_SIZE, busy);
+Report("Image 40 KB (lz stream)");
+
+Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, HOST_WORDS, Host_words);
+Check(Open_Image_lz() == FLASH_OK, "Open_Image_lz full chunks");
+Check(Send_chunks(Write_Image_lz_chunk, Host_packed, packed, 0, IMAGE_LZ_INPUT_BYTES, 0, 0) == packed, "Write_Image_lz_chunk full chunks");
+Finalize_chunks(Finalize_Image_lz);
+Check(memcmp((const void*)ADDR_DOWNLOAD_BUFFER, Host_code, sizeof(Host_code)) == 0, "lz image data full chunks");
+
+Host_packed[packed / 2] ^= 0x01;
+Check(Open_Image_lz() == FLASH_OK, "Open_Image_lz corrupted");
+Send_chunks(Write_Image_lz_chunk, Host_packed, packed, 0, IMAGE_LZ_INPUT_BYTES, 0, 0);
+Check(Finalize_chunks(Finalize_Image_lz) == FLASH_ERROR, "lz corrupted image");
+Host_packed[packed / 2] ^= 0x01;
+Reset_flash_sim_stats();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Разностное обновление относительно Main Programm.
+  * @details Host_code (Test_Image_lz) записывается в Main Programm, новый образ - Host_code с изменёнными      \n
+  *          16 байтами и 64 вставленными байтами (остаток сдвинут). Патч применяется частями разного размера    \n
+  *          в Download Buffer, затем проверяются патч для другого прежнего образа и повреждённый патч.
+  * @return  None.
+  */
+static void Test_Image_delta (void)
+{
+uint8_t *image = (uint8_t*)Host_image;
+uint8_t *code  = (uint8_t*)Host_code;
+uint32_t patch;
+uint32_t busy;
+
+memcpy(image, code, 20000);
+memset(image + 20000, 0x3C, 64);
+memcpy(image + 20064, code + 20000, IMAGE_SIZE - 20064);
+for (uint32_t i = 1000; i < 1016; i++)
+  {
+  image[i] ^= 0x5A;
+  }
+while (Get_Async_Status() == FLASH_BUSY) // Стирание, запущенное прерванным приёмом Test_Image_lz.
+  {
+  Flash_sim_IRQ();
+  }
+Check(Write_Words_to_flash(ADDR_MAIN_PROGRAM, IMAGE_WORDS, Host_code) == FLASH_OK, "Main Programm base image");
+patch = Diff_Image_delta(Host_code, IMAGE_SIZE, Host_image, IMAGE_SIZE, Host_patch, sizeof(Host_patch));
+Check(patch != 0, "Diff_Image_delta");
+
+Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, HOST_WORDS, Host_words);
+Reset_flash_sim_stats();
+Check(Open_Image_delta() == FLASH_OK, "Open_Image_delta");
+Check(Send_chunks(Write_Image_delta_chunk, Host_patch, patch, 29, IMAGE_DELTA_INPUT_BYTES, 4, &busy) == patch, "Write_Image_delta_chunk");
+Finalize_chunks(Finalize_Image_delta);
+Check(Get_Image_delta_size() == IMAGE_SIZE, "Get_Image_delta_size");
+Check(memcmp((const void*)ADDR_DOWNLOAD_BUFFER, Host_image, sizeof(Host_image)) == 0, "delta image data");
+printf("Image delta: %u -> %u bytes patch, %u busy retries\n", IMAGE_SIZE, patch, busy);
+Report("Image 40 KB (delta)");
+
+Host_patch[16] ^= 0x01;
+Check(Open_Image_delta() == FLASH_OK, "Open_Image_delta other base");
+Check(Write_Image_delta_chunk(Host_patch, IMAGE_DELTA_HEADER_BYTES) == FLASH_ERROR, "delta other base");
+Host_patch[16] ^= 0x01;
+
+Host_patch[patch - 1] ^= 0x01;
+Check(Open_Image_delta() == FLASH_OK, "Open_Image_delta corrupted");
+Send_chunks(Write_Image_delta_chunk, Host_patch, patch, 0, IMAGE_DELTA_INPUT_BYTES, 0, 0);
+Check(Finalize_chunks(Finalize_Image_delta) == FLASH_ERROR, "delta corrupted patch");
+Host_patch[patch - 1] ^= 0x01;
+Reset_flash_sim_stats();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   KV Store.
+  * @details На чистой FLASH проверяются запись, перезапись, удаление, наибольшая длина значения и расход       \n
+  *          свободного места (KV_RECORD_BYTES на запись). Затем один ключ перезаписывается до заполнения       \n
+  *          области без стираний: следующая запись выполняет уплотнение, значения читаются после уплотнения     \n
+  *          и после повторной Init_KV_store (как после сброса). В конце хранилище заполняется разными ключами   \n
+  *          до отказа записи: сохранённые значения не теряются, после удаления ключа запись снова выполняется.   \n
+  *          Если области KV Store не помещаются во FLASH (Medium-density), хранилище отключено.
+  * @return  None.
+  */
+static void Test_KV_store (void)
+{
+uint32_t               area   = MEMSIZE_KV_AREA * 1024;
+uint32_t               writes = 0;
+uint32_t               free_space;
+uint32_t               bad;
+uint16_t               key;
+uint8_t                last;
+uint8_t                value[KV_VALUE_MAX + 1];
+uint8_t                read [KV_VALUE_MAX + 1];
+flash_status           state = FLASH_OK;
+Flash_sim_stats_struct stats;
+
+Init_flash_sim(FLASH_SIM_DENSITY, 0);
+Init_flash_geometry();
+if (!Area_in_flash(ADDR_KV_AREA_A, 2 * area))
+  {
+  Check(Init_KV_store() == FLASH_WROG_ADDRES, "Init_KV_store outside FLASH");
+  printf("KV store: areas outside FLASH, skipped\n");
+  return;
+  }
+for (uint32_t i = 0; i < sizeof(value); i++)
+  {
+  value[i] = (uint8_t)(0x80 + i);
+  }
+
+Check( (Init_KV_store() == FLASH_OK) && (Get_KV_free_space() == area - 8), "Init_KV_store blank");
+Check( (Write_KV_to_flash(1, "abc", 3) == FLASH_OK) && (Read_KV_from_flash(1, read, sizeof(read)) == 3) &&
+       (memcmp(read, "abc", 3) == 0), "Write_KV_to_flash");
+Check(Get_KV_free_space() == area - 8 - KV_RECORD_BYTES(3), "Get_KV_free_space");
+Check( (Write_KV_to_flash(1, "abcde", 5) == FLASH_OK) && (Read_KV_from_flash(1, read, sizeof(read)) == 5) &&
+       (memcmp(read, "abcde", 5) == 0), "Write_KV_to_flash overwrite");
+free_space = Get_KV_free_space();
+Check( (Write_KV_to_flash(1, "abcde", 5) == FLASH_OK) && (Get_KV_free_space() == free_space), "Write_KV_to_flash same value");
+memset(read, 0x55, sizeof(read));
+Check( (Read_KV_from_flash(1, read, 2) == 5) && (read[1] == 'b') && (read[2] == 0x55), "Read_KV_from_flash buffer size");
+Check( (Delete_KV_from_flash(1) == FLASH_OK) && (Read_KV_from_flash(1, read, sizeof(read)) == 0) && (Get_KV_from_flash(1, 0) == 0),
+       "Delete_KV_from_flash");
+Check(Get_KV_free_space() == free_space - KV_RECORD_BYTES(0), "Get_KV_free_space delete");
+free_space = Get_KV_free_space();
+Check( (Delete_KV_from_flash(1) == FLASH_OK) && (Get_KV_free_space() == free_space), "Delete_KV_from_flash absent key");
+Check( (Write_KV_to_flash(2, value, KV_VALUE_MAX) == FLASH_OK) && (Read_KV_from_flash(2, read, sizeof(read)) == KV_VALUE_MAX) &&
+       (memcmp(read, value, KV_VALUE_MAX) == 0), "Write_KV_to_flash KV_VALUE_MAX");
+Check(Write_KV_to_flash(3, value, KV_VALUE_MAX + 1) == FLASH_WROG_ADDRES, "Write_KV_to_flash length");
+Check(Write_KV_to_flash(KV_MAX_KEYS, value, 1) == FLASH_WROG_ADDRES, "Write_KV_to_flash key");
+Check(Write_KV_to_flash(4, "kv04", 4) == FLASH_OK, "Write_KV_to_flash key 4");
+Report("KV store");
+
+// Граница заполнения: перезапись ключа 2, пока запись помещается в активную область.
+while ( (Get_KV_free_space() >= KV_RECORD_BYTES(KV_VALUE_MAX)) && (state == FLASH_OK) )
+  {
+  value[0] = (uint8_t)++writes;
+  state    = Write_KV_to_flash(2, value, KV_VALUE_MAX);
+  }
+Get_flash_sim_stats(&stats);
+Check( (state == FLASH_OK) && (stats.Erases == 0), "KV store filled without erase");
+last     = (uint8_t)++writes;
+value[0] = last;
+Check(Write_KV_to_flash(2, value, KV_VALUE_MAX) == FLASH_OK, "Write_KV_to_flash compact");
+Get_flash_sim_stats(&stats);
+Check(stats.Erases == area / Get_Page_Size_of_flash(ADDR_KV_AREA_A), "compaction erases the old area");
+Check(Get_KV_free_space() == area - 8 - KV_RECORD_BYTES(4) - 2 * KV_RECORD_BYTES(KV_VALUE_MAX), "Get_KV_free_space compact");
+for (uint32_t pass = 0; pass < 2; pass++) // Чтение после уплотнения и после сброса.
+  {
+  Check( (Read_KV_from_flash(2, read, sizeof(read)) == KV_VALUE_MAX) && (memcmp(read, value, KV_VALUE_MAX) == 0) &&
+         (Read_KV_from_flash(4, read, sizeof(read)) == 4) && (memcmp(read, "kv04", 4) == 0) &&
+         (Get_KV_from_flash(1, 0) == 0), (pass == 0) ? "read after compact" : "read after Init_KV_store");
+  Check( (pass != 0) || (Init_KV_store() == FLASH_OK), "Init_KV_store compacted");
+  }
+Report("KV store compaction");
+
+// Полное хранилище: разные ключи наибольшей длины до отказа записи.
+for (key = 8; (key < KV_MAX_KEYS) && (state == FLASH_OK); key++)
+  {
+  value[0] = (uint8_t)key;
+  state    = Write_KV_to_flash(key, value, KV_VALUE_MAX);
+  }
+key--;
+Check( (state == FLASH_ERROR) && (Get_KV_from_flash(key, 0) == 0), "Write_KV_to_flash full store");
+bad = 0;
+for (uint16_t k = 8; k < key; k++)
+  {
+  value[0] = (uint8_t)k;
+  if ( (Read_KV_from_flash(k, read, sizeof(read)) != KV_VALUE_MAX) || (memcmp(read, value, KV_VALUE_MAX) != 0) )
+    bad++;
+  }
+value[0] = last;
+Check( (bad == 0) && (Read_KV_from_flash(2, read, sizeof(read)) == KV_VALUE_MAX) && (memcmp(read, value, KV_VALUE_MAX) == 0),
+       "full store keeps values");
+value[0] = (uint8_t)key;
+Check( (Delete_KV_from_flash(8) == FLASH_OK) && (Write_KV_to_flash(key, value, KV_VALUE_MAX) == FLASH_OK) &&
+       (Read_KV_from_flash(key, read, sizeof(read)) == KV_VALUE_MAX) && (Get_KV_from_flash(8, 0) == 0), "write after delete in full store");
+printf("KV store: %u keys of %u bytes fit in %u bytes\n", (uint32_t)(key - 8), KV_VALUE_MAX, area);
+Report("KV store full");
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Кольцевой журнал.
+  * @details Журнал из LOG_PAGES страниц записывается LOG_CIRCLES кругов, запись n содержит свой номер. После каждой     \n
+  *          записи Get_Log_count сравнивается с ожидаемым: до перехода по кругу - n, затем (LOG_PAGES - 2) страниц      \n
+  *          и записи страницы конца журнала (страница впереди конца стёрта). На заполненной и на половине страницы     \n
+  *          журнал открывается заново (Init_Log_ring, как после сброса): количество записей не изменяется, все записи  \n
+  *          читаются от самой старой (номер n - Get_Log_count) к самой новой (n - 1).                                  \n
+  *          Если область журнала не помещается во FLASH (Medium-density), журнал отключён.
+  * @return  None.
+  */
+static void Test_Log_ring (void)
+{
+uint32_t page  = Get_Page_Size_of_flash(ADDR_LOG_AREA);
+uint32_t slots = (page / 4 - 2) / (LOG_RECORD / 4 + 1);
+uint32_t total = LOG_CIRCLES * LOG_PAGES * slots;
+uint32_t record[LOG_RECORD / 4];
+uint32_t pages;
+uint32_t head_slot;
+uint32_t expected;
+uint32_t count;
+uint32_t bad_count = 0;
+uint32_t bad_order = 0;
+uint32_t reopens   = 0;
+
+Init_flash_sim(FLASH_SIM_DENSITY, 0);
+Init_flash_geometry();
+if (!Area_in_flash(ADDR_LOG_AREA, LOG_PAGES * page))
+  {
+  Check(Init_Log_ring(ADDR_LOG_AREA, LOG_PAGES, LOG_RECORD) == FLASH_WROG_ADDRES, "Init_Log_ring outside FLASH");
+  printf("Log ring: area outside FLASH, skipped\n");
+  return;
+  }
+
+Check( (Init_Log_ring(ADDR_LOG_AREA, LOG_PAGES, LOG_RECORD) == FLASH_OK) && (Get_Log_count() == 0), "Init_Log_ring blank");
+Check(Read_Log_from_flash(0, record) == FLASH_WROG_ADDRES, "Read_Log_from_flash empty");
+for (uint32_t n = 1; n <= total; n++)
+  {
+  record[0] = n - 1;
+  record[1] = ~(n - 1);
+  record[2] = n - 1;
+  record[3] = ~(n - 1);
+  Check(Append_Log_to_flash(record) == FLASH_OK, "Append_Log_to_flash");
+  pages     = (n - 1) / slots;     // Переходов на следующую страницу: выполняется при записи в заполненную страницу.
+  head_slot = n - pages * slots;
+  expected  = (pages < LOG_PAGES - 1) ? n : (LOG_PAGES - 2) * slots + head_slot;
+  if (Get_Log_count() != expected)
+    bad_count++;
+  if ( (head_slot != slots) && (head_slot != slots / 2) )
+    continue;
+
+  reopens++;
+  count = Get_Log_count();
+  if ( (Init_Log_ring(ADDR_LOG_AREA, LOG_PAGES, LOG_RECORD) != FLASH_OK) || (Get_Log_count() != count) )
+    bad_count++;
+  for (uint32_t i = 0; i < count; i++)
+    {
+    if ( (Read_Log_from_flash(i, record) != FLASH_OK) || (record[0] != n - count + i) || (record[1] != ~record[0]) ||
+         (record[2] != record[0]) || (record[3] != ~record[0]) )
+      bad_order++;
+    }
+  }
+Check(bad_count == 0, "Get_Log_count");
+Check(bad_order == 0, "Read_Log_from_flash order after Init_Log_ring");
+Check( (Read_Log_from_flash(Get_Log_count(), record) == FLASH_WROG_ADDRES) && (Get_Log_count() < LOG_PAGES * slots),
+       "Read_Log_from_flash past end");
+Check( (Init_Log_ring(ADDR_LOG_AREA, LOG_PAGES, LOG_RECORD / 2) == FLASH_OK) && (Get_Log_count() == 0),
+       "Init_Log_ring other record size");
+printf("Log ring: %u pages x %u records, %u appends, %u reopens\n", LOG_PAGES, slots, total, reopens);
+Report("Log ring");
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Счётчики стираний страниц.
+  * @details На чистой FLASH страница Download Buffer стирается WEAR_ERASES раз, счётчики сохраняются и читаются  \n
+  *          заново (как после сброса). Затем WEAR_SAVES сохранений после стирания той же страницы переполняют      \n
+  *          активную область: счётчики переносятся в резервную область без потерь. Затем 2 x WEAR_SAVE_PERIOD - 1   \n
+  *          стираний без Save_Erase_counters: после сброса сохранены WEAR_SAVE_PERIOD, потеряно меньше WEAR_SAVE_PERIOD.   \n
+  *          Если области счётчиков не помещаются во FLASH (Medium-density), учёт отключён.
+  * @return  None.
+  */
+static void Test_Erase_counters (void)
+{
+uint32_t           page = Get_Page_Size_of_flash(ADDR_DOWNLOAD_BUFFER);
+uint32_t           word = 0;
+Erase_stats_struct stats;
+
+Init_flash_sim(FLASH_SIM_DENSITY, 0);
+Init_flash_geometry();
+if (!Area_in_flash(ADDR_WEAR_AREA_A, MEMSIZE_WEAR_AREA * 1024))
+  {
+  Check(Init_Erase_counters() == FLASH_WROG_ADDRES, "Init_Erase_counters outside FLASH");
+  Check(Save_Erase_counters() == FLASH_ERROR, "Save_Erase_counters outside FLASH");
+  printf("Erase counters: areas outside FLASH, skipped\n");
+  return;
+  }
+
+Check(Init_Erase_counters() == FLASH_OK, "Init_Erase_counters blank");
+for (uint32_t i = 0; i < WEAR_ERASES; i++)
+  {
+  Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, 1, &word); // Пустая страница не стирается.
+  Erase_Area_of_flash(ADDR_DOWNLOAD_BUFFER, page);
+  }
+Check(Get_Erase_count(ADDR_DOWNLOAD_BUFFER + page - 1) == WEAR_ERASES, "Get_Erase_count");
+Check(Get_Erase_count(ADDR_DOWNLOAD_BUFFER + page) == 0, "Get_Erase_count other page");
+Check(Save_Erase_counters() == FLASH_OK, "Save_Erase_counters");
+Check( (Init_Erase_counters() == FLASH_OK) && (Get_Erase_count(ADDR_DOWNLOAD_BUFFER) == WEAR_ERASES), "Init_Erase_counters saved");
+Check( (Get_Erase_stats(FLASH_REGION_DOWNLOAD_BUFFER, &stats) == FLASH_OK) && (stats.Max == WEAR_ERASES) && (stats.Min == 0) &&
+       (stats.Warning == 0), "Get_Erase_stats");
+Check(Get_Erase_stats(FLASH_REGIONS_NUM, &stats) == FLASH_WROG_ADDRES, "Get_Erase_stats region");
+Report("Erase counters");
+
+for (uint32_t i = 0; i < WEAR_SAVES; i++)
+  {
+  Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, 1, &word); // Пустая страница не стирается.
+  Erase_Area_of_flash(ADDR_DOWNLOAD_BUFFER, page);
+  Check(Save_Erase_counters() == FLASH_OK, "Save_Erase_counters compact");
+  }
+Check( (Init_Erase_counters() == FLASH_OK) && (Get_Erase_count(ADDR_DOWNLOAD_BUFFER) == WEAR_ERASES + WEAR_SAVES), "erase counts after compact");
+Check( (Get_Erase_count(ADDR_WEAR_AREA_A) + Get_Erase_count(ADDR_WEAR_AREA_B) != 0) && (Get_Wear_warning() == 0), "wear areas counted");
+Report("Erase counters x1000");
+
+for (uint32_t i = 0; i < 2 * WEAR_SAVE_PERIOD - 1; i++) // Без Save_Erase_counters.
+  {
+  Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER, 1, &word); // Пустая страница не стирается.
+  Erase_Area_of_flash(ADDR_DOWNLOAD_BUFFER, page);
+  }
+Check(Get_Erase_count(ADDR_DOWNLOAD_BUFFER) == WEAR_ERASES + WEAR_SAVES + 2 * WEAR_SAVE_PERIOD - 1, "Get_Erase_count unsaved");
+Check( (Init_Erase_counters() == FLASH_OK) && (Get_Erase_count(ADDR_DOWNLOAD_BUFFER) == WEAR_ERASES + WEAR_SAVES + WEAR_SAVE_PERIOD),
+       "erases saved every WEAR_SAVE_PERIOD");
+Report("Erase counters unsaved");
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Геометрия FLASH по объёму.
+  * @details Для каждого варианта платы номера, начала и размеры страниц Flash_geometry.c сравниваются         \n
+  *          со страницами модели, раскладка FLASH.h проверяется на размещение во FLASH. Если раскладка         \n
+  *          не помещается, области за концом FLASH отключены, остальные работают.
+  * @return  None.
+  */
+static void Test_Geometry (void)
+{
+const Flash_geometry_struct *geometry;
+uint32_t                     end;
+uint32_t                     index;
+uint32_t                     bad;
+uint32_t                     size;
+flash_status                 state;
+
+for (uint32_t b = 0; b < sizeof(Boards) / sizeof(Boards[0]); b++)
+  {
+  end   = PAGE0_ADDR + Boards[b].Size_KB * 1024U;
+  index = 0;
+  bad   = 0;
+  Init_flash_sim(Boards[b].Density, Boards[b].Size_KB);
+  state    = Init_flash_geometry();
+  geometry = Get_flash_geometry();
+  Check(state == ((end >= FLASH_LAYOUT_END) ? FLASH_OK : FLASH_WROG_ADDRES), "Init_flash_geometry layout");
+  Check( (geometry->Density == Boards[b].Expected) && (geometry->End_addr == end), "Get_flash_geometry density");
+  for (uint32_t address = PAGE0_ADDR; address < end; address += size, index++)
+    {
+    size = Get_Page_Size_of_flash(address);
+    if ( (Get_Page_Index_of_flash(address + size - 1) != index) || (Get_Page_Start_of_flash(address + size / 2) != address) ||
+         (Get_Page_Addr_of_flash(index) != address) || (Get_Geometry_Page_Size(address) != size) ||
+         (Get_Bank_of_flash(address) != ((geometry->Bank1_addr != 0) && (address >= geometry->Bank1_addr))) )
+      bad++;
+    }
+  Check( (bad == 0) && (geometry->Pages == index), "geometry page lookups");
+  Check( (Get_Page_Index_of_flash(end) == FLASH_PAGE_NONE) && (Get_Page_Addr_of_flash(index) == 0), "geometry outside FLASH");
+  if (state != FLASH_OK)
+    {
+    Check( (Init_Erase_counters() == FLASH_WROG_ADDRES) && (Init_KV_store() == FLASH_WROG_ADDRES) &&
+           (Write_KV_to_flash(0, &end, sizeof(end)) == FLASH_ERROR) && (Get_KV_from_flash(0, 0) == 0) &&
+           (Init_Log_ring(ADDR_LOG_AREA, 3, 16) == FLASH_WROG_ADDRES), "regions outside FLASH disabled");
+    }
+  printf("Geometry %4u KB: density %u, %4u pages, layout %s\n", Boards[b].Size_KB, geometry->Density, geometry->Pages, (state == FLASH_OK) ? "fits" : "does not fit");
+  }
+Init_flash_sim(FLASH_SIM_GD_MD, UNSUPPORTED_KB);
+state = Init_flash_geometry();
+Init_flash_sim(FLASH_SIM_DENSITY, 0); // Без Init_flash_geometry: результат неподдерживаемого объёма сохранён.
+geometry = Get_flash_geometry();
+Check( (state == FLASH_WROG_ADDRES) && (geometry->Density == FLASH_DENSITY_UNKNOWN) && (geometry->Pages == 0) &&
+       (geometry->Size_KB == UNSUPPORTED_KB) && (Get_Page_Index_of_flash(PAGE0_ADDR) == FLASH_PAGE_NONE),
+       "unsupported FLASH size cached");
+Init_flash_sim(FLASH_SIM_DENSITY, 0);
+Check(Init_flash_geometry() == ((PAGE0_ADDR + Read_MCU_FMD() * 1024U >= FLASH_LAYOUT_END) ? FLASH_OK : FLASH_WROG_ADDRES), "Init_flash_geometry");
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Проверка условия: сообщение и подсчёт непройденных проверок.
+  * @param   Condition - условие (0 - проверка не пройдена).
+  * @param   Name      - название проверки.
+  * @return  None.
+  */
+static void Check (int Condition, const char *Name)
+{
+if (!Condition)
+  {
+  printf("FAIL: %s\n", Name);
+  Host_errors++;
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Моделируемое время (мкс) и количество операций с момента предыдущего вызова.
+  * @param   Name - название замера.
+  * @return  None.
+  */
+static void Report (const char *Name)
+{
+Flash_sim_stats_struct stats;
+
+Get_flash_sim_stats(&stats);
+printf("%-28s time_us=%-9llu erases=%-4u programs=%-5u unlocks=%u\n",
+       Name, (unsigned long long)stats.Time_us, stats.Erases, stats.Programs, stats.Unlocks);
+Reset_flash_sim_stats();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Асинхронная запись с ожиданием окончания.
+  * @details Flash_sim_IRQ вызывается вместо прерывания FLASH.
+  * @param   Address - адрес начальной ячейки.
+  * @param   Amount  - количество записываемых слов.
+  * @param   Words   - указатель на массив с данными.
+  * @return  flash status.
+  */
+static flash_status Write_async_and_wait (uint32_t Address, uint32_t Amount, uint32_t *Words)
+{
+flash_status state = Write_Words_to_flash_async(Address, Amount, Words, 0);
+
+while ( (state == FLASH_OK) && (Get_Async_Status() == FLASH_BUSY) )
+  {
+  Flash_sim_IRQ();
+  }
+return (state == FLASH_OK) ? Get_Async_Status() : state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Передача образа частями.
+  * @details Часть, отвергнутая FLASH_BUSY, передаётся повторно. Flash_sim_IRQ (окончание операции FLASH)      \n
+  *          вызывается после отказа FLASH_BUSY и после каждой Irq_period-й попытки: части, принятые во время   \n
+  *          стирания, накапливаются в буфере приёма.
+  * @param   Write      - приём части (Write_Image_chunk, Write_Image_lz_chunk, Write_Image_delta_chunk).
+  * @param   Data       - указатель на образ.
+  * @param   Size       - размер образа в байтах.
+  * @param   Step       - длина i-й части 1 + (i * Step) % Length_max, 0 - части длиной Length_max.
+  * @param   Length_max - наибольшая длина части в байтах.
+  * @param   Irq_period - период вызова Flash_sim_IRQ в попытках (0 - только после FLASH_BUSY).
+  * @param   Busy       - указатель для количества отказов FLASH_BUSY (может быть 0).
+  * @return  uint32_t - количество принятых байт (меньше Size - часть отвергнута с ошибкой).
+  */
+static uint32_t Send_chunks (chunk_writer Write, const uint8_t *Data, uint32_t Size, uint32_t Step,
+                             uint32_t Length_max, uint32_t Irq_period, uint32_t *Busy)
+{
+uint32_t     sent = 0;
+uint32_t     busy = 0;
+uint32_t     length;
+flash_status state;
+
+for (uint32_t i = 0; (sent < Size) && (i < CHUNKS_MAX); i++)
+  {
+  length = (Step != 0) ? 1 + (i * Step) % Length_max : Length_max;
+  if (length > Size - sent)
+    length = Size - sent;
+  state = Write(Data + sent, length);
+  if (state == FLASH_OK)
+    sent += length;
+  else if (state == FLASH_BUSY)
+    busy++;
+  else
+    break;
+  if ( (state == FLASH_BUSY) || ( (Irq_period != 0) && (i % Irq_period == 0) ) )
+    Flash_sim_IRQ();
+  }
+if (Busy != 0)
+  *Busy = busy;
+return sent;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Завершение приёма образа.
+  * @details Пока Finalize возвращает FLASH_BUSY, вызывается Flash_sim_IRQ (не более FINALIZE_TRIES раз).
+  * @param   Finalize - завершение приёма (Finalize_Host_image, Finalize_Image_lz, Finalize_Image_delta).
+  * @return  flash status - результат последнего вызова Finalize.
+  */
+static flash_status Finalize_chunks (chunk_finalize Finalize)
+{
+flash_status state = FLASH_BUSY;
+
+for (uint32_t i = 0; (i < FINALIZE_TRIES) && (state == FLASH_BUSY); i++)
+  {
+  state = Finalize();
+  if (state == FLASH_BUSY)
+    Flash_sim_IRQ();
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Завершение потоковой записи Host_image.
+  * @return  flash status (см. Finalize_Image_writer).
+  */
+static flash_status Finalize_Host_image (void)
+{
+return Finalize_Image_writer(Calc_CRC32(Host_image, IMAGE_WORDS));
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
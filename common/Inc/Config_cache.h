@@ -0,0 +1,65 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Config_cache.h
+  *
+  * @brief     Header for Config_cache.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __CONFIG_CACHE_H
+#define __CONFIG_CACHE_H
+
+//---Includes-------------------------------------------------------------------//
+#include "FLASH.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#define NUM_OF_MODBUS_PORTS      4U    /*!< Количество портов Modbus в Config_struct (ModbusPort0Param ... ModbusPort3Param). */
+#define CONFIG_QUIET_MS_DEFAULT  500U  /*!< Время отсутствия изменений по умолчанию для CONFIG_FLUSH_QUIET, мс.              */
+//------------------------------------------------------------------------------//
+
+//---Exported types-------------------------------------------------------------//
+/**
+  * @brief  Условие записи изменённых параметров из кэша во FLASH.
+  */
+typedef enum
+{
+CONFIG_FLUSH_EXPLICIT = 0, /*!< Только по вызову Flush_Config.                                                         */
+CONFIG_FLUSH_IDLE        , /*!< При каждом вызове Config_cache_process (из цикла ожидания основной программы).       */
+CONFIG_FLUSH_QUIET         /*!< Config_cache_process записывает, если параметры не изменялись заданное время (мс).  */
+} config_flush_policy;
+//------------------------------------------------------------------------------//
+
+//---Exported variables---------------------------------------------------------//
+extern const Config_struct* const Config_cache; /*!< Кэш параметров Config Page в SRAM (только чтение). */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Init_Config_cache              (void);
+void          Set_Config_flush_policy        (config_flush_policy Policy, uint32_t Quiet_ms);
+uint32_t      Get_Config_dirty               (void);
+flash_status  Flush_Config                   (void);
+void          Config_cache_process           (uint32_t Time_ms);
+
+void          Set_Config_AddrModule          (uint32_t AddrModule);
+void          Set_Config_CanSpeed            (uint32_t CanSpeed);
+void          Set_Config_BootloaderVersion   (Version BootloaderVersion);
+void          Set_Config_ProgramVersion      (Version ProgramVersion);
+void          Set_Config_FirstRunFlag        (uint32_t FirstRunFlag);
+void          Set_Config_ModbusPortParam     (uint8_t Port, ModbusPortParam Param);
+void          Set_Config_ModbusBaud          (uint8_t Port, uint8_t Baud);
+void          Set_Config_ModbusParity        (uint8_t Port, uint8_t Parity);
+void          Set_Config_ModbusStop          (uint8_t Port, uint8_t Stop);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __CONFIG_CACHE_H */
+
+//***********************************END OF FILE***********************************
@@ -0,0 +1,71 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Erase_counters.h
+  *
+  * @brief     Header for Erase_counters.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __ERASE_COUNTERS_H
+#define __ERASE_COUNTERS_H
+
+//---Includes-------------------------------------------------------------------//
+#include "FLASH.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#define WEAR_REGIONS_KB      (MEMSIZE_MAIN_PROGRAM + MEMSIZE_DOWNLOAD_BUFFER + MEMSIZE_CONFIG_PAGE + MEMSIZE_CONFIG_PAGE_B + \
+                              MEMSIZE_RO_CONSTANS + 2 * MEMSIZE_KV_AREA + MEMSIZE_LOG_AREA + 2 * MEMSIZE_WEAR_AREA) /*!< Объём областей flash_region в Kbyte. */
+
+#ifndef WEAR_PAGES_MAX
+#define WEAR_PAGES_MAX       (WEAR_REGIONS_KB * 1024U / FLASH_PAGE_SIZE_MIN) /*!< Наибольшее количество учитываемых страниц (4 + 2 байта RAM на страницу): все страницы областей flash_region. */
+#endif
+
+#ifndef WEAR_SAVE_PERIOD
+#define WEAR_SAVE_PERIOD     16U                                  /*!< Количество несохранённых стираний, после которого счётчики сохраняются по окончании блокирующей записи. */
+#endif
+
+#ifndef ERASE_ENDURANCE
+#define ERASE_ENDURANCE      100000U                              /*!< Гарантированное количество циклов стирания страницы (GD32F103, AT32F413).  */
+#endif
+
+#ifndef ERASE_WARNING_LEVEL
+#define ERASE_WARNING_LEVEL  (ERASE_ENDURANCE / 10U * 9U)         /*!< Количество стираний страницы, с которого выдаётся предупреждение (90 %).  */
+#endif
+
+#define WEAR_AREA_VALID      0x3CC35AA5U                          /*!< Значение слова состояния области счётчиков, заполнение которой завершено.  */
+//------------------------------------------------------------------------------//
+
+//---Exported types-------------------------------------------------------------//
+/**
+  * @brief  Статистика стираний страниц области FLASH.
+  */
+typedef struct
+{
+uint32_t Min;     /*!< Наименьшее количество стираний страницы области.                           */
+uint32_t Max;     /*!< Наибольшее количество стираний страницы области.                           */
+uint32_t Mean;    /*!< Среднее количество стираний страницы области.                              */
+uint16_t Pages;   /*!< Количество учитываемых страниц области.                                    */
+uint8_t  Warning; /*!< 1 - количество стираний страницы области достигло ERASE_WARNING_LEVEL.      */
+} Erase_stats_struct;
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Init_Erase_counters          (void);
+flash_status  Save_Erase_counters          (void);
+uint32_t      Get_Erase_count              (uint32_t Address);
+flash_status  Get_Erase_stats              (flash_region Region, Erase_stats_struct *Stats);
+uint8_t       Get_Wear_warning             (void);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __ERASE_COUNTERS_H */
+
+//***********************************END OF FILE***********************************
@@ -5,40 +5,113 @@
   *
   * @brief     Header for FLASH.c file.
   *
-  * @copyright Copyright (C) 2022 Awada Systems.   .
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
   *
   * @author    Larionov A.S. (larion.alex@mail.ru)
   *
-  * Config Page  -     .                                                             \n
-  * RO Constants -      (   ).                          \n
+  * Config Page  - область хранения изменяемых параметров модуля.                                                             \n
+  * RO Constants - область хранения неизменяемых параметров модуля (записывается при сборке модуля).                          \n
   *                                                                                                                           \n 
   *
-  * **  Config Page**
-  * |                         |       |   0x00   |   0x01   | 0x02 | 0x03 |
+  * **Карта памяти Config Page**
+  * | Параметр                        |   Адрес    |   0x00   |   0x01   | 0x02 | 0x03 |
   * | ------------------------------- | :--------: | :------: | :------: | :--: | :--: |
-  * |                      | 0x0801F000 |   addr   |   0xFF   | 0xFF | 0xFF |
-  * |  CAN                    | 0x0801F004 |          |          |      |      |
-  * |                 | 0x0801F008 | bl_minor | bl_major | 0xFF | 0xFF |
-  * |                  | 0x0801F00C | sw_minor | sw_major | 0xFF | 0xFF |
-  * |               | 0x0801F010 |   flag   |   0xFF   | 0xFF | 0xFF |
-  * |     Modbus | 0x0801F014 |   0xFF   |   0xFF   | 0xFF | 0xFF |
-  * |  Modbus  0        | 0x0801F018 |   baud   |    par   | stop | 0xFF |
-  * |  Modbus  1        | 0x0801F01C |   baud   |    par   | stop | 0xFF |
-  * |  Modbus  2        | 0x0801F020 |   baud   |    par   | stop | 0xFF |
-  * |  Modbus  3        | 0x0801F024 |   baud   |    par   | stop | 0xFF |
-  *
-  *  Config Page   ,    32- .
+  * | Номер записи                    | 0x0801F000 |   seq    |   seq    | seq  | seq  |
+  * | Адрес модуля                    | 0x0801F004 |   addr   |   0xFF   | 0xFF | 0xFF |
+  * | Скорость CAN                    | 0x0801F008 |          |          |      |      |
+  * | Версия загрузчика               | 0x0801F00C | bl_minor | bl_major | 0xFF | 0xFF |
+  * | Версия программы                | 0x0801F010 | sw_minor | sw_major | 0xFF | 0xFF |
+  * | Флаг первого запуска            | 0x0801F014 |   flag   |   0xFF   | 0xFF | 0xFF |
+  * | Не используется в модуле Modbus | 0x0801F018 |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Параметры Modbus порта 0        | 0x0801F01C |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 1        | 0x0801F020 |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 2        | 0x0801F024 |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 3        | 0x0801F028 |   baud   |   par    | stop | 0xFF |
+  * | Слово состояния записи          | 0x0801F02C |    st    |    st    |  st  |  st  |
+  *
+  * Страница Config Page содержит параметры модуля, записанные в виде 32-битных слов.                                       \n 
+  * Адреса в таблице приведены для первой записи журнала (см. ниже).
+  * \n \n 
+  *
+  * **Журнал записей Config Page**                                                                                            \n 
+  * Config Page хранит не одну копию параметров, а журнал записей фиксированного размера (CONFIG_RECORD_SIZE слов).           \n 
+  * Журнал ведётся на двух страницах: Config Page (A, ADDR_CONFIG_PAGE) и Config Page B (ADDR_CONFIG_PAGE_B).                \n 
+  * Каждый вызов Write_Config_to_flash дописывает новую запись в первый чистый слот активной страницы.                        \n 
+  * Когда активная страница заполнена, стирается другая страница и запись продолжается на ней,                                \n 
+  * поэтому последняя действительная запись до окончания записи новой всегда остаётся на FLASH.                              \n 
+  * Запись считается действительной, если её слово состояния равно CONFIG_RECORD_VALID ^ CRC32 (Calc_CRC32) номера записи    \n 
+  * и параметров: незавершённая или повреждённая запись пропускается. Слово состояния программируется последним,              \n 
+  * т.е. фиксация записи - это запись одного слова.                                                                          \n 
+  * Из действительных записей выбирается запись с наибольшим номером (с учётом переполнения счётчика).                       \n 
+  * На Medium-density (128 Kbyte и меньше) адреса ADDR_CONFIG_PAGE_B нет, поэтому страницами A и B журнала служат             \n 
+  * половины области Config Page: 0x0801 F000 - 0x0801 F3FF и 0x0801 F400 - 0x0801 F7FF (страницы FLASH по 1 KB,            \n 
+  * CONFIG_RECORDS_IN_PAGE / 2 записей на странице). Размещение выбирается при старте по геометрии FLASH (Flash_geometry.c).
+  * | Слово                    | Смещение в записи               | Содержимое                                    |
+  * | ------------------------ | :-----------------------------: | :-------------------------------------------: |
+  * | Номер записи             | 0                               | Номер записи (увеличивается на 1)             |
+  * | Параметры модуля         | 1 ... NUM_OF_CONFIG_WORDS       | Config_struct                                 |
+  * | Слово состояния записи   | NUM_OF_CONFIG_WORDS + 1         | CONFIG_RECORD_VALID ^ CRC32 (последним)      |
   * \n \n 
   *
-  * **  RO Constants**
-  * |            |       |   0x00   |   0x01   | 0x02 | 0x03 |
+  * **Карта памяти RO Constants**
+  * | Параметр           |   Адрес    |   0x00   |   0x01   | 0x02 | 0x03 |
   * | ------------------ | :--------: | :------: | :------: | :--: | :--: |
-  * |           | 0x0801F800 |  class   |   0xFF   | 0xFF | 0xFF |
-  * |   | 0x0801F804 | hw_minor | hw_major | 0xFF | 0xFF |
-  * |   lw  | 0x0801F808 |   0xFF   |   0xFF   | 0xFF | 0xFF |
-  * |   hw  | 0x0801F80C |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Тип модуля         | 0x0801F800 |  class   |   0xFF   | 0xFF | 0xFF |
+  * | Аппаратная ревизия | 0x0801F804 | hw_minor | hw_major | 0xFF | 0xFF |
+  * | Серийный номер lw  | 0x0801F808 |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Серийный номер hw  | 0x0801F80C |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | CRC32              | 0x0801F810 |   crc    |   crc    | crc  | crc  |
+  *
+  * Страница RO Constants содержит параметры модуля, записанные в виде 32-битных слов.
+  * \n \n 
+  *
+  * **Размещение областей в bank1 (FLASH_BANK1_LAYOUT)**                                                                      \n 
+  * На GD32F103 Extra-density (FLASH больше 512 Kbyte) FMC имеет два банка с отдельными регистрами управления:                \n 
+  * bank0 (первые 512 Kbyte, страницы по 2 KB) и bank1 (с адреса ADDR_OF_BANK1, страницы по 4 KB).                            \n 
+  * Стирание и программирование в bank1 не останавливают выборку команд из bank0.                                            \n 
+  * При FLASH_BANK1_LAYOUT = 1 (по умолчанию для GD32F10X_XD) Download Buffer и области данных (KV Store, кольцевой        \n 
+  * журнал, счётчики стираний, журнал установки) размещаются в bank1. Bootloader, Main Programm, журнал Config Page         \n 
+  * (страницы A и B) и RO Constants остаются на прежних адресах в bank0: параметры модулей, записанные прежними             \n 
+  * прошивками, читаются без переноса.
+  * |   Назначение    | Банк  | Диапазон адресов          | Занимаемый объем  | Число страниц |
+  * | --------------- | :---: | :-----------------------: | :---------------: | :-----------: |
+  * | Config Page     | bank0 | 0x0801 F000 - 0x0801 F7FF | 2 Kbyte (0x800)   | 1 по 2 KB     |
+  * | RO Constants    | bank0 | 0x0801 F800 - 0x0801 FFFF | 2 Kbyte (0x800)   | 1 по 2 KB     |
+  * | Config Page B   | bank0 | 0x0802 0000 - 0x0802 07FF | 2 Kbyte (0x800)   | 1 по 2 KB     |
+  * | Download Buffer | bank1 | 0x0808 0000 - 0x0808 BFFF | 48 Kbyte (0xC000) | 12 по 4 KB    |
+  * | KV Store A      | bank1 | 0x0808 C000 - 0x0808 CFFF | 4 Kbyte (0x1000)  | 1 по 4 KB     |
+  * | KV Store B      | bank1 | 0x0808 D000 - 0x0808 DFFF | 4 Kbyte (0x1000)  | 1 по 4 KB     |
+  *
+  * **Загрузчик при FLASH_BANK1_LAYOUT = 1**                                                                                  \n 
+  * Download Buffer переносится с 0x0801 3000 (bank0) на 0x0808 0000 (bank1), журнал установки - на 0x080A 8000.           \n 
+  * Загрузчик читает образ из ADDR_DOWNLOAD_BUFFER и продолжает установку по журналу ADDR_INSTALL_AREA                      \n 
+  * (Get_Pending_Install, Install_Image), поэтому он должен собираться с этим FLASH.h и тем же значением                   \n 
+  * FLASH_BANK1_LAYOUT (GD32F10X_XD), что и Main Programm. Порядок обновления устройств Extra-density: сначала              \n 
+  * загрузчик с FLASH_BANK1_LAYOUT = 1, затем Main Programm. Прежний загрузчик ищет образ по адресу 0x0801 3000             \n 
+  * и образ, принятый новой программой, не установит. Чтобы оставить прежний загрузчик, программа собирается               \n 
+  * с FLASH_BANK1_LAYOUT = 0.
+  * \n \n 
+  *
+  * **Области KV Store (KV_store.c)**                                                                                         \n 
+  * Хранилище параметров "ключ - значение" занимает две области по MEMSIZE_KV_AREA Kbyte сразу после Config Page B:         \n 
+  * KV Store A (ADDR_KV_AREA_A) и KV Store B (ADDR_KV_AREA_B). Без FLASH_BANK1_LAYOUT это 0x0802 0800 - 0x0802 27FF           \n 
+  * (по 2 страницы 2 KB), поэтому, как и Config Page B, требуется FLASH не менее 256 Kbyte.
+  * \n \n 
+  *
+  * **Область кольцевого журнала (Log_ring.c)**                                                                               \n 
+  * Журнал записей фиксированного размера по умолчанию занимает MEMSIZE_LOG_AREA Kbyte неиспользуемой FLASH сразу после       \n 
+  * KV Store B (ADDR_LOG_AREA): без FLASH_BANK1_LAYOUT это 0x0802 2800 - 0x0803 A7FF (48 страниц 2 KB),                      \n 
+  * в bank1 - 0x0808 E000 - 0x080A 5FFF (24 страницы 4 KB). Диапазон страниц задаётся при вызове Init_Log_ring.
+  * \n \n 
   *
-  *  RO Constants   ,    32- .
+  * **Области счётчиков стираний (Erase_counters.c)**                                                                         \n 
+  * Счётчики стираний страниц областей flash_region хранятся в двух областях по MEMSIZE_WEAR_AREA Kbyte сразу после          \n 
+  * кольцевого журнала: ADDR_WEAR_AREA_A и ADDR_WEAR_AREA_B (0x0803 A800 - 0x0803 C7FF, в bank1 - 0x080A 6000 - 0x080A 7FFF).
+  * \n \n 
+  *
+  * **Область журнала установки прошивки (Image_install.c)**                                                                \n 
+  * Журнал копирования образа из Download Buffer в Main Programm занимает MEMSIZE_INSTALL_AREA Kbyte сразу после             \n 
+  * счётчиков стираний: ADDR_INSTALL_AREA (0x0803 C800 - 0x0803 D7FF, в bank1 - 0x080A 8000 - 0x080A 8FFF).
   * \n \n 
   ******************************************************************************
 **/
@@ -52,15 +125,111 @@
 //------------------------------------------------------------------------------//
 
 //---Defines--------------------------------------------------------------------//
-#define NUM_OF_CONFIG_WORDS 10U /*!<    (  32- ),      Config Page. */
+#define NUM_OF_CONFIG_WORDS 10U /*!< Количество параметров модуля (в виде 32-битных слов), которые будут записываться в область Config Page. */
+
+#define HARDWARE_REVISION_ADDR_IN_FLASH 0x0801F804    /*!< Адрес FLASH памяти (в области RO Constants), где хранится значение аппаратной ревизии.                                */
+#define SERIAL_NUMBER_ADDR_IN_FLASH     0x0801F808    /*!< Адрес FLASH памяти (в области RO Constants), где хранится значение серийного номера lw.                               */
+#define RO_CONST_START_ADDR_IN_FLASH    0x0801F800    /*!< Начальный адрес во FLASH памяти (в области RO Constants), где хранится карта памяти RO Constants.                     */
+
+#define MODULE_ADDR_MASK                (uint8_t)0x1F /*!< Маска для cобственного адреса модуля (микроконтроллера STM, GD, AT ...).                                              */
+
+#define PAGE0_ADDR                      0x08000000U   /*!< Адрес начала первой страницы FLASH.                                                                                  */
+
+//---Банки FLASH---//
+#define ADDR_OF_BANK1            0x08080000U /*!< Адрес начала bank1 на GD32F103 Extra-density.                         */
+#define FLASH_BANKS_MAX          2           /*!< Наибольшее количество банков FLASH (каналов асинхронной записи).       */
+
+#ifndef FLASH_BANK1_LAYOUT
+  #if defined(GD32F10X_XD)
+    #define FLASH_BANK1_LAYOUT   1 /*!< 1 - Download Buffer и области данных (KV Store, журналы) размещаются в bank1; загрузчик собирается с тем же значением (см. описание выше). */
+  #else
+    #define FLASH_BANK1_LAYOUT   0
+  #endif
+#endif
+
+#ifndef FLASH_CONCURRENT_BANKS
+#define FLASH_CONCURRENT_BANKS   1 /*!< 1 - асинхронные записи в разные банки выполняются одновременно, 0 - по одной. */
+#endif
+//-----------------//
+
+//---Размеры требуемой FLASH памяти в Kbyte для размещения соответствующих областей---//
+#define MEMSIZE_BOOTLOADER       28 /*!< Размер требуемой FLASH памяти в Kbyte.       */
+#define MEMSIZE_MAIN_PROGRAM     48 /*!< Размер требуемой FLASH памяти в Kbyte.       */
+#define MEMSIZE_DOWNLOAD_BUFFER  48 /*!< Размер требуемой FLASH памяти в Kbyte.       */
+#define MEMSIZE_RO_CONSTANS      2  /*!< Размер требуемой FLASH памяти в Kbyte.       */
+#define MEMSIZE_CONFIG_PAGE      2  /*!< Размер требуемой FLASH памяти в Kbyte.       */
+#define MEMSIZE_CONFIG_PAGE_B    2  /*!< Размер требуемой FLASH памяти в Kbyte.       */
+#define MEMSIZE_KV_AREA          4  /*!< Размер одной области KV Store в Kbyte (кратен размеру страницы). */
+#define MEMSIZE_LOG_AREA         96 /*!< Размер области кольцевого журнала в Kbyte (кратен размеру страницы). */
+#define MEMSIZE_WEAR_AREA        4  /*!< Размер одной области счётчиков стираний в Kbyte (кратен размеру страницы). */
+#define MEMSIZE_INSTALL_AREA     4  /*!< Размер области журнала установки прошивки в Kbyte (кратен размеру страницы). */
+//------------------------------------------------------------------------------------//
+
+//---Начальные адреса соответствующих областей во FLASH---//
+#define ADDR_BOOTLOADER       PAGE0_ADDR                                              /*!< Начальный адрес секции BootLoader.                   */
+#define ADDR_MAIN_PROGRAM     (ADDR_BOOTLOADER      + MEMSIZE_BOOTLOADER      * 1024) /*!< 0x08007000U // Начальный адрес секции MainProgram. Значение 1024 - количество байт в килобайте. */
+#if (FLASH_BANK1_LAYOUT)
+#define ADDR_DOWNLOAD_BUFFER  ADDR_OF_BANK1                                           /*!< 0x08080000U // Начальный адрес секции DowloadBuffer. */
+#else
+#define ADDR_DOWNLOAD_BUFFER  (ADDR_MAIN_PROGRAM    + MEMSIZE_MAIN_PROGRAM    * 1024) /*!< 0x08013000U // Начальный адрес секции DowloadBuffer. */
+#endif
+#define ADDR_CONFIG_PAGE      (ADDR_MAIN_PROGRAM    + (MEMSIZE_MAIN_PROGRAM + MEMSIZE_DOWNLOAD_BUFFER) * 1024) /*!< 0x0801F000U // Начальный адрес секции ConfigPage (при любой раскладке). */
+#define ADDR_RO_CONSTANS      (ADDR_CONFIG_PAGE     + MEMSIZE_CONFIG_PAGE     * 1024) /*!< 0x0801F800U // Начальный адрес секции RO_Constans.   */
+#define ADDR_CONFIG_PAGE_B    (ADDR_RO_CONSTANS     + MEMSIZE_RO_CONSTANS     * 1024) /*!< 0x08020000U // Начальный адрес секции ConfigPage B.  */
+#define ADDR_RO_CONSTANS_CRC  (ADDR_RO_CONSTANS     + sizeof(RO_Constants_struct))      /*!< 0x0801F810U // Адрес CRC32 области RO Constants.    */
+#if (FLASH_BANK1_LAYOUT)
+#define ADDR_KV_AREA_A        (ADDR_DOWNLOAD_BUFFER + MEMSIZE_DOWNLOAD_BUFFER * 1024) /*!< 0x0808C000U // Начальный адрес области KV Store A (bank1). */
+#else
+#define ADDR_KV_AREA_A        (ADDR_CONFIG_PAGE_B   + MEMSIZE_CONFIG_PAGE_B   * 1024) /*!< 0x08020800U // Начальный адрес области KV Store A. */
+#endif
+#define ADDR_KV_AREA_B        (ADDR_KV_AREA_A       + MEMSIZE_KV_AREA         * 1024) /*!< 0x08021800U (bank1: 0x0808D000U) // Начальный адрес области KV Store B. */
+#define ADDR_LOG_AREA         (ADDR_KV_AREA_B       + MEMSIZE_KV_AREA         * 1024) /*!< 0x08022800U (bank1: 0x0808E000U) // Начальный адрес области кольцевого журнала. */
+#define ADDR_WEAR_AREA_A      (ADDR_LOG_AREA        + MEMSIZE_LOG_AREA        * 1024) /*!< 0x0803A800U (bank1: 0x080A6000U) // Начальный адрес области счётчиков стираний A. */
+#define ADDR_WEAR_AREA_B      (ADDR_WEAR_AREA_A     + MEMSIZE_WEAR_AREA       * 1024) /*!< 0x0803B800U (bank1: 0x080A7000U) // Начальный адрес области счётчиков стираний B. */
+#define ADDR_INSTALL_AREA     (ADDR_WEAR_AREA_B     + MEMSIZE_WEAR_AREA       * 1024) /*!< 0x0803C800U (bank1: 0x080A8000U) // Начальный адрес области журнала установки прошивки. */
+//--------------------------------------------------------//
+
+//---Журнал записей Config Page---//
+#define CONFIG_RECORD_SIZE      (NUM_OF_CONFIG_WORDS + 2U)                                    /*!< Размер одной записи журнала Config Page в 32-битных словах (номер + параметры + слово состояния). */
+#define CONFIG_RECORDS_IN_PAGE  ((MEMSIZE_CONFIG_PAGE * 1024) / (CONFIG_RECORD_SIZE * 4))   /*!< Количество записей, помещающихся на одной странице журнала Config Page (на Medium-density - половина). */
+#define CONFIG_RECORD_VALID     0x5AC3A53CU                                                   /*!< Значение слова состояния полностью записанной записи.                                              */
+#define BLANK_WORD              0xFFFFFFFFU                                                   /*!< Значение стёртого слова FLASH.                                                          */
+//--------------------------------//
 
-#define CAN_SPEED_ADDR_IN_FLASH         0x0801F004    /*!<  FLASH  (  Config Page),     CAN.                                       */
-#define MODULE_ADDR_IN_FLASH            0x0801F000    /*!<  FLASH  (  Config Page),   c   ( STM, GD, AT ...). */
-#define HARDWARE_REVISION_ADDR_IN_FLASH 0x0801F804    /*!<  FLASH  (  RO Constants),     .                                */
-#define SERIAL_NUMBER_ADDR_IN_FLASH     0x0801F808    /*!<  FLASH  (  RO Constants),      lw.                               */
-#define RO_CONST_START_ADDR_IN_FLASH    0x0801F800    /*!<    FLASH  (  RO Constants),     RO Constants.                     */
+//---Режимы аппаратного драйвера---//
+#ifndef FLASH_BATCHED_PROGRAM
+#define FLASH_BATCHED_PROGRAM   1 /*!< 1 - Program_Words_to_flash программирует массив одной серией (бит PG устанавливается один раз), 0 - пословно функциями библиотеки производителя. */
+#endif
 
-#define MODULE_ADDR_MASK                (uint8_t)0x1F /*!<   c   ( STM, GD, AT ...).                                              */
+#ifndef FLASH_RAMFUNC_MODE
+#define FLASH_RAMFUNC_MODE      0 /*!< 1 - стирание и программирование выполняются из SRAM (секция .ramfunc), прерывания с приоритетом выше FLASH_RAM_ISR_PRIO_LIMIT обслуживаются во время операций FLASH. */
+#endif
+
+#ifndef FLASH_PAGE_SIZE_MAX
+#define FLASH_PAGE_SIZE_MAX     4096U /*!< Наибольший размер страницы FLASH в байтах - размер буфера страницы Write_Words_to_flash в RAM (2048 - для AT32F413 и GD32F103 без страниц 4 KB). */
+#endif
+
+#ifndef FLASH_PAGE_SIZE_MIN
+#define FLASH_PAGE_SIZE_MIN     1024U /*!< Наименьший размер страницы FLASH в байтах (GD32F103 Medium-density) - для размеров таблиц по страницам. */
+#endif
+
+#ifndef FLASH_STATS
+#define FLASH_STATS             1 /*!< 1 - аппаратный драйвер ведёт статистику операций (Get_Flash_stats, такты DWT->CYCCNT), 0 - статистика не ведётся, код обновления удаляется при сборке. */
+#endif
+
+#ifndef FLASH_RAM_ISR_PRIO_LIMIT
+#define FLASH_RAM_ISR_PRIO_LIMIT 2 /*!< Во время операций FLASH в режиме FLASH_RAMFUNC_MODE обслуживаются только прерывания с приоритетом 0 ... FLASH_RAM_ISR_PRIO_LIMIT-1 (значение BASEPRI, не меньше 1). */
+#endif
+
+#if (FLASH_RAMFUNC_MODE)
+  #if !(FLASH_BATCHED_PROGRAM)
+    #error "FLASH_RAMFUNC_MODE requires FLASH_BATCHED_PROGRAM = 1"
+  #endif
+  #define FLASH_RAMFUNC __attribute__((section(".ramfunc"))) /*!< Размещение функции в SRAM (см. *_ramfunc.sct). */
+#else
+  #define FLASH_RAMFUNC
+#endif
+//---------------------------------//
 
 //------------------------------------------------------------------------------//
 
@@ -75,73 +244,166 @@ typedef enum
 {
 FLASH_WROG_ADDRES = 0, /*!< flash status is wrong address   */
 FLASH_OK             , /*!< flash status is operate done    */
-FLASH_ERROR            /*!< flash status is operate busy    \n 
+FLASH_ERROR          , /*!< flash status is operate busy    \n 
                             flash status is program error   \n 
                             flash status is epp error       \n 
                             flash status is operate done    \n 
                             flash status is operate timeout */
+FLASH_BUSY             /*!< выполняется асинхронная запись (Write_Words_to_flash_async) */
 } flash_status;
 
 /**
-  * @brief     .
+  * @brief  Функция, вызываемая по окончании асинхронной записи (из прерывания FLASH).
+  */
+typedef void (*flash_callback)(flash_status State);
+
+/**
+  * @brief  Способ выполнения последней записи Write_Words_to_flash.
+  */
+typedef enum
+{
+FLASH_WRITE_SKIPPED = 0, /*!< Данные во FLASH совпадают с записываемыми - стирание и программирование не выполнялись. */
+FLASH_WRITE_PROGRAMMED , /*!< Запрограммированы только отличающиеся слова, стирание не выполнялось.                  */
+FLASH_WRITE_ERASED       /*!< Страница стёрта и данные записаны полностью.                                           */
+} flash_write_path;
+
+/**
+  * @brief  Области FLASH для проверки целостности (Verify_Region_of_flash - Main Programm, Download Buffer, RO Constants) \n 
+  *         и учёта стираний (Erase_counters.c).
+  */
+typedef enum
+{
+FLASH_REGION_MAIN_PROGRAM = 0, /*!< Main Programm   (ADDR_MAIN_PROGRAM,    MEMSIZE_MAIN_PROGRAM).    */
+FLASH_REGION_DOWNLOAD_BUFFER , /*!< Download Buffer (ADDR_DOWNLOAD_BUFFER, MEMSIZE_DOWNLOAD_BUFFER). */
+FLASH_REGION_CONFIG_PAGE     , /*!< Config Page     (ADDR_CONFIG_PAGE,     MEMSIZE_CONFIG_PAGE).     */
+FLASH_REGION_CONFIG_PAGE_B   , /*!< Config Page B   (ADDR_CONFIG_PAGE_B,   MEMSIZE_CONFIG_PAGE_B).   */
+FLASH_REGION_RO_CONSTANTS    , /*!< RO Constants    (ADDR_RO_CONSTANS,     MEMSIZE_RO_CONSTANS).     */
+FLASH_REGION_KV_AREA_A       , /*!< KV Store A      (ADDR_KV_AREA_A,       MEMSIZE_KV_AREA).         */
+FLASH_REGION_KV_AREA_B       , /*!< KV Store B      (ADDR_KV_AREA_B,       MEMSIZE_KV_AREA).         */
+FLASH_REGION_LOG_AREA        , /*!< Кольцевой журнал (ADDR_LOG_AREA,       MEMSIZE_LOG_AREA).        */
+FLASH_REGION_WEAR_AREA       , /*!< Счётчики стираний A и B (ADDR_WEAR_AREA_A, 2 * MEMSIZE_WEAR_AREA). */
+FLASH_REGIONS_NUM              /*!< Количество областей.                                              */
+} flash_region;
+
+/**
+  * @brief  Статистика операций аппаратного драйвера с момента старта (Get_Flash_stats, FLASH_STATS = 1).
+  */
+typedef struct
+{
+uint32_t     Unlocks;            /*!< Количество разблокировок FLASH.                                                    */
+uint32_t     Erases;             /*!< Количество стёртых страниц (включая асинхронные).                                  */
+uint32_t     Programs;           /*!< Количество запрограммированных слов (включая асинхронные).                         */
+uint32_t     Busy_waits;         /*!< Количество итераций циклов ожидания готовности контроллера flash в функциях драйвера. */
+uint32_t     Busy_cycles;        /*!< Суммарное время стираний и программирований в тактах ядра (DWT->CYCCNT).          */
+uint32_t     Erase_max_cycles;   /*!< Наибольшее время стирания страницы в тактах ядра.                                   */
+uint32_t     Program_max_cycles; /*!< Наибольшее время программирования слова в тактах ядра.                                 */
+uint32_t     Timeouts;           /*!< Количество операций, не завершённых за время ожидания.                             */
+uint32_t     Verify_errors;      /*!< Количество слов, прочитанных после программирования с отличием от записанного.     */
+uint32_t     Errors;             /*!< Количество операций с ошибкой (включая Timeouts и Verify_errors).                  */
+flash_status Last_error;         /*!< Результат последней операции с ошибкой (FLASH_OK - ошибок не было).               */
+uint32_t     Last_error_addr;    /*!< Адрес последней операции с ошибкой.                                                 */
+} Flash_stats_struct;
+
+/**
+  * @brief Структура для хранения значения версии.
   */
 #pragma pack(push, 2)
 typedef struct{
-uint8_t minor; /*!< . */
-uint8_t major; /*!< . */
+uint8_t minor; /*!< Минор. */
+uint8_t major; /*!< Мажор. */
 } Version;
 
 
 /**
-  * @brief     Modbus.
+  * @brief Структура для хранения параметров Modbus.
   */
 typedef struct{
 uint8_t baud;           /*!< Boudrate.            */
 uint8_t par;            /*!< Parity.              */
 uint8_t stop;           /*!< Number of stop bits. */
-uint8_t reserved_param; /*!< .     */
+uint8_t reserved_param; /*!< Зарезервировано.     */
 } ModbusPortParam;
 #pragma pack(pop)
 
 
 /**
-  * @brief     Config Page.
+  * @brief Структура для хранения данных Config Page.
   */
 typedef struct{
-uint32_t         AddrModule;        /*!<  .                  */
-uint32_t         CanSpeed;          /*!<   CAN (). */
-Version          BootloaderVersion; /*!<  .             */
-uint16_t         reserved_bver;     /*!< .               */
-Version          ProgramVersion;    /*!<  .              */
-uint16_t         reserved_pver;     /*!< .               */
-uint32_t         FirstRunFlag;      /*!<   .          */
-uint32_t         reserved_unused;   /*!< .               */
-ModbusPortParam  ModbusPort0Param;  /*!<  Modbus  0.      */
-ModbusPortParam  ModbusPort1Param;  /*!<  Modbus  1.      */
-ModbusPortParam  ModbusPort2Param;  /*!<  Modbus  2.      */
-ModbusPortParam  ModbusPort3Param;  /*!<  Modbus  3.      */
+uint32_t         AddrModule;        /*!< Адрес модуля.                  */
+uint32_t         CanSpeed;          /*!< Скорость работы CAN (битрейт). */
+Version          BootloaderVersion; /*!< Версия загрузчика.             */
+uint16_t         reserved_bver;     /*!< Зарезервировано.               */
+Version          ProgramVersion;    /*!< Версия программы.              */
+uint16_t         reserved_pver;     /*!< Зарезервировано.               */
+uint32_t         FirstRunFlag;      /*!< Флаг первого запуска.          */
+uint32_t         reserved_unused;   /*!< Зарезервировано.               */
+ModbusPortParam  ModbusPort0Param;  /*!< Параметры Modbus порта 0.      */
+ModbusPortParam  ModbusPort1Param;  /*!< Параметры Modbus порта 1.      */
+ModbusPortParam  ModbusPort2Param;  /*!< Параметры Modbus порта 2.      */
+ModbusPortParam  ModbusPort3Param;  /*!< Параметры Modbus порта 3.      */
 } Config_struct;
 
 
 /**
-  * @brief     RO Constants.
+  * @brief Структура для хранения данных RO Constants.
   */
 typedef struct{
-uint32_t ModulType;        /*!<  .                   */
-Version  HardwareRevision; /*!<  .           */
-uint16_t reserved_hrev;    /*!< .              */
-uint32_t SerialNumberLW;   /*!<    . */
-uint32_t SerialNumberHW;   /*!<    . */
+uint32_t ModulType;        /*!< Тип модуля.                   */
+Version  HardwareRevision; /*!< Аппаратная ревизия.           */
+uint16_t reserved_hrev;    /*!< Зарезервировано.              */
+uint32_t SerialNumberLW;   /*!< Серийный номер младшее слово. */
+uint32_t SerialNumberHW;   /*!< Серийный номер старшее слово. */
 } RO_Constants_struct;
 //------------------------------------------------------------------------------//
 
 
 //---Function prototypes--------------------------------------------------------//
 flash_status  Write_Config_to_flash        (Config_struct* Config);
-void          Read_Config_from_flash       (Config_struct* Config);
-void          Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants);
+flash_status  Read_Config_from_flash       (Config_struct* Config);
+flash_status  Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants);
+flash_status  Write_RO_Constants_to_flash  (RO_Constants_struct* RO_Constants);
+uint32_t      Calc_CRC32                   (const uint32_t *Words, uint32_t Amount);
+uint32_t      Calc_CRC32_soft              (const uint32_t *Words, uint32_t Amount);
+uint32_t      Calc_CRC32_of_area           (uint32_t Address, uint32_t Size);
+uint32_t      Calc_Region_CRC32            (flash_region Region);
+flash_status  Verify_Region_of_flash       (flash_region Region, uint32_t Crc);
+flash_status  Get_Region_of_flash          (flash_region Region, uint32_t *Address, uint32_t *Size);
+void          Flash_page_erased            (uint32_t Address);
+void          Flash_write_finished         (void);
+const Config_struct*       Get_Config_from_flash       (void);
+const RO_Constants_struct* Get_RO_Constants_from_flash (void);
+uint32_t      Get_Config_CanSpeed          (void);
+uint32_t      Get_Config_AddrModule        (void);
+uint32_t      Get_RO_ModulType             (void);
+Version       Get_RO_HardwareRevision      (void);
+uint32_t      Get_RO_SerialNumberLW        (void);
+uint32_t      Get_RO_SerialNumberHW        (void);
 flash_status  Write_Words_to_flash         (uint32_t Address, uint32_t Amount, uint32_t *Words);
+flash_status  Erase_Area_of_flash          (uint32_t Address, uint32_t Size);
 uint16_t      Read_MCU_FMD                 (void);
+flash_write_path Get_Last_Write_Path       (void);
+uint8_t       Words_blank_in_flash         (uint32_t Address, uint32_t Amount);
+flash_status  Write_Words_to_flash_async   (uint32_t Address, uint32_t Amount, uint32_t *Words, flash_callback Callback);
+flash_status  Erase_Page_of_flash_async    (uint32_t Address, flash_callback Callback);
+flash_status  Get_Async_Status             (void);
+flash_status  Get_Bank_Async_Status        (uint8_t Bank);
+void          Flash_operation_complete     (uint8_t Bank, flash_status State);
+
+void          Unlock_flash                 (void);
+void          Lock_flash                   (void);
+flash_status  Erase_Page_of_flash          (uint32_t Address);
+flash_status  Program_Words_to_flash       (uint32_t Address, uint32_t Amount, uint32_t *Words);
+uint32_t      Get_Page_Size_of_flash       (uint32_t Address);
+flash_status  Start_Erase_Page_of_flash    (uint32_t Address);
+flash_status  Start_Program_Word_of_flash  (uint32_t Address, uint32_t Word);
+void          Enable_flash_IRQ             (uint8_t Bank);
+void          Disable_flash_IRQ            (uint8_t Bank);
+uint8_t       Get_Bank_of_flash            (uint32_t Address);
+void          Get_Flash_stats              (Flash_stats_struct *Stats);
+#if (FLASH_RAMFUNC_MODE)
+void          Init_flash_RAM_mode          (void);
+#endif
 //------------------------------------------------------------------------------//
 
   
@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Flash_bench.h
+  *
+  * @brief     Header for Flash_bench.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FLASH_BENCH_H
+#define __FLASH_BENCH_H
+
+//---Includes-------------------------------------------------------------------//
+#include "Image_lz.h"
+#include "Log_ring.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#ifndef FLASH_BENCH_BUILD
+#define FLASH_BENCH_BUILD        0    /*!< 1 - сборка для замеров: main выполняет замеры при старте (стирает начало Download Buffer), 0 - рабочая сборка. */
+#endif
+
+#define FLASH_BENCH_CHUNK_WORDS  256U /*!< Размер буфера записи в словах (1 KB RAM): массивы записываются частями по 1 KB. */
+#define FLASH_BENCH_AREA_KB      16U  /*!< Наибольший объём замеров в Kbyte (начало Download Buffer).                      */
+#define FLASH_BENCH_LZ_BYTES     2048U /*!< Образ замера lz_unpack_16k в байтах (начало Main Programm, распаковка в RAM).   */
+#define FLASH_BENCH_LOG_RECORD   16U   /*!< Размер записи журнала замера log_init в байтах.                                 */
+//------------------------------------------------------------------------------//
+
+//---Exported types-------------------------------------------------------------//
+/**
+  * @brief  Замеры (строки отчёта Format_Flash_bench_report).
+  */
+typedef enum
+{
+FLASH_BENCH_CONFIG_SAVE = 0, /*!< Write_Config_to_flash - одна запись журнала Config Page.                          */
+FLASH_BENCH_WRITE_1K       , /*!< Write_Words_to_flash 1 KB поверх записанных данных (со стиранием).               */
+FLASH_BENCH_WRITE_4K       , /*!< Write_Words_to_flash 4 KB частями по 1 KB поверх записанных данных.              */
+FLASH_BENCH_WRITE_16K      , /*!< Write_Words_to_flash 16 KB частями по 1 KB поверх записанных данных.             */
+FLASH_BENCH_VERIFY_16K     , /*!< Сравнение 16 KB FLASH с записанными данными.                                     */
+FLASH_BENCH_BLANK_16K      , /*!< Проверка, что 16 KB FLASH стёрты.                                                */
+FLASH_BENCH_LZ_UNPACK_16K  , /*!< Unpack_Image_lz 16 KB: 8 распаковок сжатого образа FLASH_BENCH_LZ_BYTES в RAM.   */
+FLASH_BENCH_LOG_INIT       , /*!< Init_Log_ring журнала 16 KB, записанного примерно на полтора круга.            */
+FLASH_BENCH_NUM              /*!< Количество замеров.                                                              */
+} flash_bench;
+
+
+/**
+  * @brief  Результат замера.
+  */
+typedef struct
+{
+uint32_t     Time;       /*!< Время по часам Run_Flash_bench (такты DWT на плате, мкс модели на ПК).      */
+uint32_t     Erases;     /*!< Количество стёртых страниц (Get_Flash_stats).                              */
+uint32_t     Programs;   /*!< Количество запрограммированных слов.                                        */
+uint32_t     Busy_waits; /*!< Количество итераций ожидания готовности контроллера flash.                 */
+flash_status Status;     /*!< Результат: FLASH_ERROR - данные не совпали или область не стёрта.          */
+} Flash_bench_result_struct;
+
+
+/**
+  * @brief  Часы замеров: возвращает текущее время (переполнение допускается).
+  */
+typedef uint32_t (*flash_bench_clock)(void);
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Run_Flash_bench              (flash_bench_clock Clock, Flash_bench_result_struct *Results);
+uint32_t      Format_Flash_bench_report    (const Flash_bench_result_struct *Results, const char *Unit, char *Text, uint32_t Size);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __FLASH_BENCH_H */
+
+//***********************************END OF FILE***********************************
@@ -0,0 +1,80 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Flash_geometry.h
+  *
+  * @brief     Header for Flash_geometry.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __FLASH_GEOMETRY_H
+#define __FLASH_GEOMETRY_H
+
+//---Includes-------------------------------------------------------------------//
+#include "FLASH.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#define FLASH_SEGMENTS_MAX      2U                                                /*!< Наибольшее количество участков с одним размером страницы.  */
+#define FLASH_PAGE_NONE         0xFFFFFFFFU                                       /*!< Get_Page_Index_of_flash: адрес вне FLASH.                  */
+#define FLASH_LAYOUT_END        (ADDR_INSTALL_AREA + MEMSIZE_INSTALL_AREA * 1024) /*!< Конец последней области раскладки FLASH.h.                */
+//------------------------------------------------------------------------------//
+
+//---Exported types-------------------------------------------------------------//
+/**
+  * @brief  Плотность (density) FLASH, определённая по объёму.
+  */
+typedef enum
+{
+FLASH_DENSITY_UNKNOWN = 0, /*!< Объём FLASH не поддерживается (Read_MCU_FMD).                                            */
+FLASH_DENSITY_MEDIUM     , /*!< Medium-density: 16 ... 128 Kbyte, страницы 1 KB (GD32F103, AT32F413).                  */
+FLASH_DENSITY_HIGH       , /*!< High-density: 256 ... 512 Kbyte, страницы 2 KB (GD32F103, AT32F413 256 Kbyte).         */
+FLASH_DENSITY_EXTRA        /*!< Extra-density: более 512 Kbyte, bank0 - 256 страниц 2 KB, bank1 - страницы 4 KB (GD32F103). */
+} flash_density;
+
+/**
+  * @brief  Участок FLASH с одним размером страницы.
+  */
+typedef struct
+{
+uint32_t Start;      /*!< Адрес первой страницы участка.          */
+uint32_t End;        /*!< Адрес, следующий за последней страницей. */
+uint32_t First_page; /*!< Номер первой страницы участка.          */
+uint8_t  Shift;      /*!< Размер страницы: 1 << Shift байт.       */
+} Flash_segment_struct;
+
+/**
+  * @brief  Геометрия FLASH (Init_flash_geometry).
+  */
+typedef struct
+{
+flash_density        Density;                     /*!< Плотность FLASH.                                   */
+uint16_t             Size_KB;                     /*!< Объём FLASH в Kbyte (Read_MCU_FMD).                */
+uint32_t             End_addr;                    /*!< Адрес, следующий за последним байтом FLASH.        */
+uint32_t             Bank1_addr;                  /*!< Начало bank1 (0 - FLASH из одного банка).          */
+uint32_t             Pages;                       /*!< Количество страниц FLASH.                          */
+uint8_t              Segments;                    /*!< Количество участков Segment.                       */
+Flash_segment_struct Segment[FLASH_SEGMENTS_MAX]; /*!< Участки в порядке адресов.                         */
+} Flash_geometry_struct;
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status                 Init_flash_geometry          (void);
+const Flash_geometry_struct *Get_flash_geometry           (void);
+uint8_t                      Area_in_flash                (uint32_t Address, uint32_t Size);
+uint32_t                     Get_Page_Index_of_flash      (uint32_t Address);
+uint32_t                     Get_Page_Start_of_flash      (uint32_t Address);
+uint32_t                     Get_Page_Addr_of_flash       (uint32_t Index);
+uint32_t                     Get_Geometry_Page_Size       (uint32_t Address);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __FLASH_GEOMETRY_H */
+
+//***********************************END OF FILE***********************************
@@ -0,0 +1,45 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_delta.h
+  *
+  * @brief     Header for Image_delta.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IMAGE_DELTA_H
+#define __IMAGE_DELTA_H
+
+//---Includes-------------------------------------------------------------------//
+#include "Image_writer.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#define IMAGE_DELTA_TAG           0x31504449U /*!< Первое слово заголовка патча ("IDP1").                                    */
+#define IMAGE_DELTA_HEADER_BYTES  20U         /*!< Заголовок: тег, размер и CRC32 нового образа, размер и CRC32 прежнего.   */
+#define IMAGE_DELTA_INSERT_MAX    128U        /*!< Наибольшее количество байт одной команды вставки.                         */
+#define IMAGE_DELTA_COPY          0x80U       /*!< Код команды копирования из прежнего образа.                               */
+#define IMAGE_DELTA_PATCH_MAX(Size) (IMAGE_DELTA_HEADER_BYTES + (Size) + ((Size) + IMAGE_DELTA_INSERT_MAX - 1U) / IMAGE_DELTA_INSERT_MAX) /*!< Наибольший размер патча. */
+
+#ifndef IMAGE_DELTA_INPUT_BYTES
+#define IMAGE_DELTA_INPUT_BYTES   256U        /*!< Буфер приёма патча в байтах: наибольшая часть Write_Image_delta_chunk.   */
+#endif
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Open_Image_delta             (void);
+flash_status  Write_Image_delta_chunk      (const uint8_t *Data, uint32_t Length);
+flash_status  Finalize_Image_delta         (void);
+uint32_t      Get_Image_delta_size         (void);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __IMAGE_DELTA_H */
+
+//***********************************END OF FILE***********************************
@@ -0,0 +1,57 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_install.h
+  *
+  * @brief     Header for Image_install.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IMAGE_INSTALL_H
+#define __IMAGE_INSTALL_H
+
+//---Includes-------------------------------------------------------------------//
+#include "FLASH.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#define INSTALL_JOURNAL_TAG   0x5AC3B44EU                                                       /*!< Первое слово заголовка журнала установки.            */
+#define INSTALL_RECORD(Page)  ((((~(uint32_t)(Page)) & 0xFFFFU) << 16) | ((uint32_t)(Page) & 0xFFFFU)) /*!< Запись журнала: номер страницы и его дополнение. */
+#define INSTALL_DONE_PAGE     0xFFFFU                                                           /*!< Номер страницы в записи окончания установки.         */
+//------------------------------------------------------------------------------//
+
+//---Exported types-------------------------------------------------------------//
+/**
+  * @brief  Результат установки (Install_Image).
+  */
+typedef struct
+{
+uint32_t Time;       /*!< Время установки по часам Install_Image (0 - часы не заданы).           */
+uint32_t Pages;      /*!< Количество страниц Main Programm, занятых образом.                     */
+uint32_t First_page; /*!< Страница, с которой продолжена установка (0 - установка с начала).     */
+uint32_t Copied;     /*!< Количество записанных страниц.                                         */
+uint32_t Skipped;    /*!< Количество страниц, уже совпадавших с образом.                         */
+} Install_report_struct;
+
+
+/**
+  * @brief  Часы установки: возвращает текущее время (переполнение допускается).
+  */
+typedef uint32_t (*install_clock)(void);
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Install_Image                (uint32_t Size, uint32_t Crc, install_clock Clock, Install_report_struct *Report);
+flash_status  Get_Pending_Install          (uint32_t *Size, uint32_t *Crc);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __IMAGE_INSTALL_H */
+
+//***********************************END OF FILE***********************************
@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_lz.h
+  *
+  * @brief     Header for Image_lz.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IMAGE_LZ_H
+#define __IMAGE_LZ_H
+
+//---Includes-------------------------------------------------------------------//
+#include "Image_writer.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#define IMAGE_LZ_TAG            0x315A4C49U /*!< Первое слово заголовка сжатого образа ("ILZ1").                          */
+#define IMAGE_LZ_HEADER_BYTES   12U         /*!< Заголовок: IMAGE_LZ_TAG, размер образа, CRC32 образа.                    */
+#define IMAGE_LZ_WINDOW         2048U       /*!< Окно ссылок в байтах (степень 2): наибольшее смещение повтора.           */
+#define IMAGE_LZ_MIN_MATCH      3U          /*!< Наименьшая длина повтора.                                                */
+#define IMAGE_LZ_MAX_MATCH      34U         /*!< Наибольшая длина повтора.                                                */
+#define IMAGE_LZ_PACKED_MAX(Size) (IMAGE_LZ_HEADER_BYTES + (Size) + ((Size) + 7U) / 8U) /*!< Наибольший размер сжатого образа. */
+
+#ifndef IMAGE_LZ_INPUT_BYTES
+#define IMAGE_LZ_INPUT_BYTES    256U        /*!< Буфер приёма сжатых данных в байтах: наибольшая часть Write_Image_lz_chunk. */
+#endif
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Open_Image_lz                (void);
+flash_status  Write_Image_lz_chunk         (const uint8_t *Data, uint32_t Length);
+flash_status  Finalize_Image_lz            (void);
+uint32_t      Get_Image_lz_size            (void);
+flash_status  Unpack_Image_lz              (const uint8_t *Packed, uint32_t Packed_size, uint32_t *Image, uint32_t Capacity, uint32_t *Size);
+uint32_t      Pack_Image_lz                (const uint32_t *Image, uint32_t Size, uint8_t *Packed, uint32_t Capacity);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __IMAGE_LZ_H */
+
+//***********************************END OF FILE***********************************
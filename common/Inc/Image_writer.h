@@ -0,0 +1,39 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_writer.h
+  *
+  * @brief     Header for Image_writer.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __IMAGE_WRITER_H
+#define __IMAGE_WRITER_H
+
+//---Includes-------------------------------------------------------------------//
+#include "FLASH.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#ifndef IMAGE_WRITER_BUFFER_WORDS
+#define IMAGE_WRITER_BUFFER_WORDS  256U /*!< Размер буфера приёма в словах (1 KB RAM): данные, принятые во время стирания страницы. */
+#endif
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Open_Image_writer            (uint32_t Size);
+flash_status  Write_Image_chunk            (const uint8_t *Data, uint32_t Length);
+flash_status  Finalize_Image_writer        (uint32_t Crc);
+uint32_t      Get_Image_writer_received    (void);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __IMAGE_WRITER_H */
+
+//***********************************END OF FILE***********************************
@@ -0,0 +1,48 @@
+/**
+  ******************************************************************************
+  *
+  * @file      KV_store.h
+  *
+  * @brief     Header for KV_store.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __KV_STORE_H
+#define __KV_STORE_H
+
+//---Includes-------------------------------------------------------------------//
+#include "FLASH.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#ifndef KV_MAX_KEYS
+#define KV_MAX_KEYS         256U        /*!< Количество ключей (0 ... KV_MAX_KEYS-1), размер индекса в RAM - 2 байта на ключ. */
+#endif
+
+#ifndef KV_VALUE_MAX
+#define KV_VALUE_MAX        64U         /*!< Наибольший размер значения в байтах.                                           */
+#endif
+
+#define KV_RECORD_VALID     0xC35A3CA5U /*!< Значение слова состояния полностью записанной записи KV Store.                 */
+#define KV_AREA_VALID       0xA55AC33CU /*!< Значение слова состояния области KV Store, заполнение которой завершено.        */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Init_KV_store                (void);
+flash_status  Write_KV_to_flash            (uint16_t Key, const void *Value, uint16_t Length);
+flash_status  Delete_KV_from_flash         (uint16_t Key);
+uint16_t      Read_KV_from_flash           (uint16_t Key, void *Value, uint16_t Size);
+const void*   Get_KV_from_flash            (uint16_t Key, uint16_t *Length);
+uint32_t      Get_KV_free_space            (void);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __KV_STORE_H */
+
+//***********************************END OF FILE***********************************
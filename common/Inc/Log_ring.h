@@ -0,0 +1,42 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Log_ring.h
+  *
+  * @brief     Header for Log_ring.c file.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+/* Define to prevent recursive inclusion -------------------------------------*/
+#ifndef __LOG_RING_H
+#define __LOG_RING_H
+
+//---Includes-------------------------------------------------------------------//
+#include "FLASH.h"
+//------------------------------------------------------------------------------//
+
+//---Defines--------------------------------------------------------------------//
+#ifndef LOG_RECORD_MAX
+#define LOG_RECORD_MAX      64U                              /*!< Наибольший размер записи журнала в байтах.                          */
+#endif
+
+#define LOG_RECORD_VALID    0x5AC3A53CU                      /*!< Значение слова состояния полностью записанной записи журнала.       */
+#define LOG_PAGE_TAG(Size)  (0x3CA50000U | (uint32_t)(Size)) /*!< Слово состояния заголовка страницы журнала с записями Size байт.   */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+flash_status  Init_Log_ring                (uint32_t Address, uint16_t Pages, uint16_t Record_size);
+flash_status  Append_Log_to_flash          (const void *Record);
+flash_status  Read_Log_from_flash          (uint32_t Index, void *Record);
+uint32_t      Get_Log_count                (void);
+//------------------------------------------------------------------------------//
+
+
+#endif /* __LOG_RING_H */
+
+//***********************************END OF FILE***********************************
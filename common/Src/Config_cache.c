@@ -0,0 +1,342 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Config_cache.c
+  *
+  * @brief     Кэш параметров Config Page в SRAM.
+  *
+  * @details   Изменяемые параметры модуля хранятся в SRAM, запись во FLASH (Write_Config_to_flash) выполняется      \n
+  *            одной записью журнала для серии изменений.
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Init_Config_cache (void) - чтение параметров из FLASH (Read_Config_from_flash) в кэш. Вызывается при старте.       \n
+  *   FLASH_ERROR - сохранённых параметров нет (в кэше содержимое стёртой страницы), программа задаёт значения          \n
+  *   по умолчанию через Set_Config_... и записывает их Flush_Config.                                                     \n
+  *
+  * - Config_cache - указатель на кэш для чтения параметров: чтение не обращается к FLASH.                               \n
+  *
+  * - Set_Config_... - изменение одного параметра в кэше. Изменённые 32-битные слова Config_struct отмечаются           \n
+  *   флагами (Get_Config_dirty), запись значения, совпадающего с текущим, флаг не устанавливает.                        \n
+  *
+  * - Flush_Config (void) - запись кэша во FLASH, если есть изменения.                                                   \n
+  *
+  * - Set_Config_flush_policy (config_flush_policy Policy, uint32_t Quiet_ms),                                           \n
+  *   Config_cache_process (uint32_t Time_ms) - условие записи кэша во FLASH:                                            \n
+  *   + CONFIG_FLUSH_EXPLICIT - только Flush_Config (по умолчанию);                                                        \n
+  *   + CONFIG_FLUSH_IDLE     - при каждом вызове Config_cache_process из цикла ожидания;                                  \n
+  *   + CONFIG_FLUSH_QUIET    - Config_cache_process записывает, если параметры не изменялись Quiet_ms мс.                 \n
+  *   Time_ms - текущее время в мс (например, счётчик SysTick). Время последнего изменения определяется                 \n
+  *   при вызове Config_cache_process, поэтому точность интервала - период вызова Config_cache_process.                 \n
+  *
+  * Если FLASH занята асинхронной записью (Write_Config_to_flash возвращает FLASH_BUSY) или запись завершилась        \n
+  * ошибкой, флаги изменений сохраняются и запись повторяется при следующем вызове.                                    \n
+  * Функции модуля вызываются из основной программы (не из прерываний).
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Config_cache.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define CONFIG_FIELD_OFFSET(Field) ((uint32_t)((uint8_t*)(Field) - (uint8_t*)&Cache)) /*!< Смещение поля кэша от начала Config_struct в байтах. */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static Config_struct       Cache;                                   /*!< Кэш параметров Config Page.                                       */
+static uint32_t            Dirty        = 0;                       /*!< Флаги изменённых 32-битных слов кэша (бит n - слово n).          */
+static uint32_t            Edit_count   = 0;                       /*!< Счётчик изменений кэша.                                          */
+static uint32_t            Edit_seen    = 0;                       /*!< Значение Edit_count при последнем вызове Config_cache_process.   */
+static uint32_t            Edit_time    = 0;                       /*!< Время последнего изменения, замеченного Config_cache_process, мс. */
+static config_flush_policy Flush_policy = CONFIG_FLUSH_EXPLICIT;   /*!< Условие записи кэша во FLASH.                                    */
+static uint32_t            Quiet_time   = CONFIG_QUIET_MS_DEFAULT; /*!< Время отсутствия изменений для CONFIG_FLUSH_QUIET, мс.           */
+//------------------------------------------------------------------------------//
+
+//---Exported variables---------------------------------------------------------//
+const Config_struct* const Config_cache = &Cache;
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static void             Config_set             (void *Field, const void *Value, uint32_t Size);
+static ModbusPortParam* Modbus_port            (uint8_t Port);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Чтение параметров из FLASH в кэш.
+  * @return  flash status: FLASH_OK - прочитана сохранённая запись журнала Config Page,          \n 
+  *          FLASH_ERROR - действительных записей нет (параметры не сохранялись).
+  */
+flash_status Init_Config_cache (void)
+{
+flash_status state = Read_Config_from_flash(&Cache);
+
+Dirty     = 0;
+Edit_seen = Edit_count;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Выбор условия записи кэша во FLASH.
+  * @param   Policy   - условие записи (config_flush_policy).
+  * @param   Quiet_ms - время отсутствия изменений для CONFIG_FLUSH_QUIET, мс.
+  * @return  None.
+  */
+void Set_Config_flush_policy (config_flush_policy Policy, uint32_t Quiet_ms)
+{
+Flush_policy = Policy;
+Quiet_time   = Quiet_ms;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Флаги изменённых параметров.
+  * @return  uint32_t - бит n установлен, если 32-битное слово n Config_struct изменено и не записано во FLASH.
+  */
+uint32_t Get_Config_dirty (void)
+{
+return Dirty;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись кэша во FLASH.
+  * @details Если изменений нет, FLASH не изменяется.
+  * @return  flash status: FLASH_OK - кэш совпадает с FLASH, иначе - результат Write_Config_to_flash (флаги сохранены).
+  */
+flash_status Flush_Config (void)
+{
+flash_status state;
+
+if (Dirty == 0)
+  return FLASH_OK;
+
+state = Write_Config_to_flash(&Cache);
+if (state == FLASH_OK)
+  Dirty = 0;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись кэша во FLASH по условию Set_Config_flush_policy.
+  * @details Вызывается периодически из цикла основной программы.
+  * @param   Time_ms - текущее время, мс.
+  * @return  None.
+  */
+void Config_cache_process (uint32_t Time_ms)
+{
+if (Edit_seen != Edit_count)
+  {
+  Edit_seen = Edit_count;
+  Edit_time = Time_ms;
+  }
+if (Dirty == 0)
+  return;
+
+switch (Flush_policy)
+  {
+  case CONFIG_FLUSH_IDLE:
+    Flush_Config();
+    break;
+  case CONFIG_FLUSH_QUIET:
+    if (Time_ms - Edit_time >= Quiet_time)
+      Flush_Config();
+    break;
+  default:
+    break;
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Изменение адреса модуля.
+  * @param   AddrModule - адрес модуля.
+  * @return  None.
+  */
+void Set_Config_AddrModule (uint32_t AddrModule)
+{
+Config_set(&Cache.AddrModule, &AddrModule, sizeof(AddrModule));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Изменение скорости CAN.
+  * @param   CanSpeed - скорость CAN (битрейт).
+  * @return  None.
+  */
+void Set_Config_CanSpeed (uint32_t CanSpeed)
+{
+Config_set(&Cache.CanSpeed, &CanSpeed, sizeof(CanSpeed));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Изменение версии загрузчика.
+  * @param   BootloaderVersion - версия загрузчика.
+  * @return  None.
+  */
+void Set_Config_BootloaderVersion (Version BootloaderVersion)
+{
+Config_set(&Cache.BootloaderVersion, &BootloaderVersion, sizeof(BootloaderVersion));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Изменение версии программы.
+  * @param   ProgramVersion - версия программы.
+  * @return  None.
+  */
+void Set_Config_ProgramVersion (Version ProgramVersion)
+{
+Config_set(&Cache.ProgramVersion, &ProgramVersion, sizeof(ProgramVersion));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Изменение флага первого запуска.
+  * @param   FirstRunFlag - флаг первого запуска.
+  * @return  None.
+  */
+void Set_Config_FirstRunFlag (uint32_t FirstRunFlag)
+{
+Config_set(&Cache.FirstRunFlag, &FirstRunFlag, sizeof(FirstRunFlag));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Изменение всех параметров порта Modbus.
+  * @param   Port  - номер порта Modbus (0 ... NUM_OF_MODBUS_PORTS-1).
+  * @param   Param - параметры порта.
+  * @return  None.
+  */
+void Set_Config_ModbusPortParam (uint8_t Port, ModbusPortParam Param)
+{
+ModbusPortParam *port = Modbus_port(Port);
+
+if (port != 0)
+  Config_set(port, &Param, sizeof(Param));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Изменение скорости порта Modbus.
+  * @param   Port - номер порта Modbus (0 ... NUM_OF_MODBUS_PORTS-1).
+  * @param   Baud - скорость (Boudrate).
+  * @return  None.
+  */
+void Set_Config_ModbusBaud (uint8_t Port, uint8_t Baud)
+{
+ModbusPortParam *port = Modbus_port(Port);
+
+if (port != 0)
+  Config_set(&port->baud, &Baud, sizeof(Baud));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Изменение чётности порта Modbus.
+  * @param   Port   - номер порта Modbus (0 ... NUM_OF_MODBUS_PORTS-1).
+  * @param   Parity - чётность (Parity).
+  * @return  None.
+  */
+void Set_Config_ModbusParity (uint8_t Port, uint8_t Parity)
+{
+ModbusPortParam *port = Modbus_port(Port);
+
+if (port != 0)
+  Config_set(&port->par, &Parity, sizeof(Parity));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Изменение количества стоп-бит порта Modbus.
+  * @param   Port - номер порта Modbus (0 ... NUM_OF_MODBUS_PORTS-1).
+  * @param   Stop - количество стоп-бит.
+  * @return  None.
+  */
+void Set_Config_ModbusStop (uint8_t Port, uint8_t Stop)
+{
+ModbusPortParam *port = Modbus_port(Port);
+
+if (port != 0)
+  Config_set(&port->stop, &Stop, sizeof(Stop));
+}
+//------------------------------------------------------------------------------//
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Изменение поля кэша.
+  * @details Если значение отличается от текущего, поле изменяется и отмечаются флаги содержащих его 32-битных слов.
+  * @param   Field - указатель на поле кэша.
+  * @param   Value - указатель на новое значение.
+  * @param   Size  - размер поля в байтах.
+  * @return  None.
+  */
+static void Config_set (void *Field, const void *Value, uint32_t Size)
+{
+uint8_t       *dst     = (uint8_t*)Field;
+const uint8_t *src     = (const uint8_t*)Value;
+uint32_t       offset  = CONFIG_FIELD_OFFSET(Field);
+uint8_t        changed = 0;
+
+for (uint32_t i = 0; i < Size; i++)
+  {
+  if (dst[i] != src[i])
+    {
+    dst[i]  = src[i];
+    changed = 1;
+    }
+  }
+if (!changed)
+  return;
+
+for (uint32_t word = offset / 4; word <= (offset + Size - 1) / 4; word++)
+  {
+  Dirty |= 1U << word;
+  }
+Edit_count++;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Параметры порта Modbus в кэше.
+  * @param   Port - номер порта Modbus.
+  * @return  ModbusPortParam* - указатель на параметры порта, 0 - неверный номер порта.
+  */
+static ModbusPortParam* Modbus_port (uint8_t Port)
+{
+switch (Port)
+  {
+  case 0:  return &Cache.ModbusPort0Param;
+  case 1:  return &Cache.ModbusPort1Param;
+  case 2:  return &Cache.ModbusPort2Param;
+  case 3:  return &Cache.ModbusPort3Param;
+  default: return 0;
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
@@ -0,0 +1,405 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Erase_counters.c
+  *
+  * @brief     Счётчики стираний страниц FLASH.
+  *
+  * @details   Каждое стирание страницы функциями FLASH.c (Flash_page_erased) увеличивает счётчик страницы в RAM,      \n
+  *            сохранение во FLASH (Save_Erase_counters) - одно слово на изменённую страницу - выполняется по окончании     \n
+  *            блокирующей записи (Flash_write_finished), после которой накопилось WEAR_SAVE_PERIOD стираний.
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Init_Erase_counters (void) - чтение счётчиков из области счётчиков стираний. Вызывается один раз при старте,      \n
+  *   до первой записи во FLASH: стирания до вызова не учитываются.                                                       \n
+  *
+  * - Flash_page_erased (uint32_t Address) - учёт стирания страницы (заменяет пустую функцию FLASH.c).                 \n
+  *   Учитываются страницы областей flash_region (WEAR_PAGES_MAX по умолчанию вмещает все их страницы размером           \n
+  *   FLASH_PAGE_SIZE_MIN). Функция только изменяет счётчики в RAM, поэтому вызывается и из прерывания FLASH.               \n
+  *
+  * - Flash_write_finished (void) - по окончании блокирующей записи FLASH.c (заменяет пустую функцию FLASH.c)             \n
+  *   вызывает Save_Erase_counters, если после последнего сохранения накопилось не меньше WEAR_SAVE_PERIOD стираний.       \n
+  *
+  * - Save_Erase_counters (void) - сохранение новых стираний во FLASH. Дополнительно вызывается из основной программы    \n
+  *   (например, после асинхронной записи или перед отключением питания).                                                 \n
+  *   При потере питания теряются не больше: WEAR_SAVE_PERIOD - 1 стираний завершённых блокирующих записей, стирания       \n
+  *   прерванной блокирующей записи (Erase_Area_of_flash стирает до MEMSIZE_DOWNLOAD_BUFFER Kbyte) и стирания асинхронных   \n
+  *   записей после последнего сохранения (они сохраняются по окончании следующей блокирующей записи или Save_Erase_counters). \n
+  *
+  * - Get_Erase_count (uint32_t Address) - количество стираний страницы,                                                 \n
+  *   Get_Erase_stats (flash_region Region, Erase_stats_struct *Stats) - наименьшее, наибольшее и среднее количество      \n
+  *   стираний страниц области, Get_Wear_warning (void) - признак приближения к ERASE_ENDURANCE (ERASE_WARNING_LEVEL)     \n
+  *   для любой учитываемой страницы.                                                                                      \n
+  *
+  * Страницы Config Page, RO Constants и KV Store не имеют места для заголовка со счётчиком, поэтому счётчики всех      \n
+  * страниц хранятся в отдельных областях (ADDR_WEAR_AREA_A, ADDR_WEAR_AREA_B), стирания которых также учитываются.
+  *
+  * **Области счётчиков стираний**                                                                                            \n
+  * Одна область активна, вторая - резервная. Когда запись не помещается в активную область, все счётчики              \n
+  * записываются в резервную область, её заголовок записывается последним, затем прежняя область стирается.           \n
+  * Если обе области имеют заголовок, активной считается область с большим номером.
+  * | Слово                 | Смещение в области  | Содержимое                                         |
+  * | --------------------- | :-----------------: | :------------------------------------------------: |
+  * | Номер области         | 0                   | Увеличивается на 1 при каждом переходе             |
+  * | Количество страниц    | 1                   | n - количество счётчиков в области                 |
+  * | Слово состояния       | 2                   | WEAR_AREA_VALID (записывается последним)           |
+  * | Счётчики              | 3 ... n + 2         | Количество стираний страниц на момент перехода     |
+  * | Записи                | n + 3 ...           | Номер страницы (биты 16-31), новые стирания (0-15) |
+  *
+  * Номер страницы - порядковый номер в областях flash_region (в порядке перечисления). Стёртое слово означает конец записей.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Erase_counters.h"
+#include "Flash_geometry.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define WEAR_AREA_WORDS            (MEMSIZE_WEAR_AREA * 1024 / 4)                      /*!< Размер области счётчиков в словах.        */
+#define WEAR_HEADER_WORDS          3U                                                  /*!< Размер заголовка области в словах.        */
+#define WEAR_RECORD(Page, Delta)   (((uint32_t)(Page) << 16) | (uint32_t)(Delta))      /*!< Запись новых стираний страницы.          */
+#define WEAR_WORD(Area, Offset)    (*((uint32_t*)(uintptr_t)((Area) + (Offset) * 4)))  /*!< Слово области по смещению в словах.      */
+#define WEAR_PAGES_NUM             (First_page[FLASH_REGIONS_NUM])                     /*!< Количество учитываемых страниц.          */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint32_t Erases[WEAR_PAGES_MAX];             /*!< Количество стираний страниц.                                          */
+static uint16_t Unsaved[WEAR_PAGES_MAX];            /*!< Стирания страниц после последнего сохранения.                         */
+static uint16_t First_page[FLASH_REGIONS_NUM + 1];  /*!< Номер первой страницы области flash_region, [FLASH_REGIONS_NUM] - всего. */
+static uint32_t Active_area = ADDR_WEAR_AREA_A;     /*!< Начальный адрес активной области.                                     */
+static uint32_t Area_seq    = 0;                    /*!< Номер активной области.                                               */
+static uint32_t Free_offset = WEAR_AREA_WORDS;      /*!< Смещение первого свободного слова активной области.                   */
+static uint32_t Unsaved_sum = 0;                    /*!< Сумма Unsaved - стирания после последнего сохранения.                 */
+static uint8_t  Ready       = 0;                    /*!< 1 - Init_Erase_counters выполнена, стирания учитываются.               */
+static uint8_t  Saving      = 0;                    /*!< 1 - выполняется Save_Erase_counters (Flash_write_finished не сохраняет). */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static void         Area_load    (void);
+static flash_status Compact      (void);
+static uint16_t     Page_number  (uint32_t Address);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Чтение счётчиков стираний.
+  * @details Нумерация страниц строится по областям flash_region. Активная область - область с WEAR_AREA_VALID  \n
+  *          и наибольшим номером. Если действительных областей нет, счётчики начинаются с 0.              \n
+  *          Страницы областей, которые не помещаются во FLASH платы, не учитываются. Если страницы областей не     \n
+  *          помещаются в WEAR_PAGES_MAX (WEAR_PAGES_MAX задан меньше), учитываются первые WEAR_PAGES_MAX страниц.
+  * @return  flash status: FLASH_WROG_ADDRES - области счётчиков не помещаются во FLASH платы, FLASH_ERROR - ошибка FLASH \n
+  *          или учитываются не все страницы областей (WEAR_PAGES_MAX).
+  */
+flash_status Init_Erase_counters (void)
+{
+uint8_t      valid_a;
+uint8_t      valid_b;
+uint8_t      truncated = 0;
+uint32_t     address;
+uint32_t     size;
+uint32_t     pages;
+flash_status state;
+
+Ready = 0;
+if ( !Area_in_flash(ADDR_WEAR_AREA_A, MEMSIZE_WEAR_AREA * 1024) || !Area_in_flash(ADDR_WEAR_AREA_B, MEMSIZE_WEAR_AREA * 1024) )
+  return FLASH_WROG_ADDRES; // Области счётчиков вне FLASH платы: стирания не учитываются.
+
+valid_a = (WEAR_WORD(ADDR_WEAR_AREA_A, 2) == WEAR_AREA_VALID);
+valid_b = (WEAR_WORD(ADDR_WEAR_AREA_B, 2) == WEAR_AREA_VALID);
+for (uint8_t region = 0; region < FLASH_REGIONS_NUM; region++)
+  {
+  Get_Region_of_flash((flash_region)region, &address, &size);
+  pages = Area_in_flash(address, size) ? Get_Page_Index_of_flash(address + size - 1) - Get_Page_Index_of_flash(address) + 1 : 0;
+  if (First_page[region] + pages > WEAR_PAGES_MAX)
+    {
+    pages     = WEAR_PAGES_MAX - First_page[region];
+    truncated = 1;
+    }
+  First_page[region + 1] = (uint16_t)(First_page[region] + pages);
+  }
+for (uint16_t page = 0; page < WEAR_PAGES_MAX; page++)
+  {
+  Erases[page]  = 0;
+  Unsaved[page] = 0;
+  }
+Unsaved_sum = 0;
+
+Ready = 1;
+if (!valid_a && !valid_b) // Счётчики ещё не сохранялись.
+  {
+  Active_area = ADDR_WEAR_AREA_B; // Compact размечает область A.
+  Area_seq    = BLANK_WORD;
+  state       = Compact();
+  }
+else
+  {
+  if (valid_a && valid_b)
+    Active_area = ((int32_t)(WEAR_WORD(ADDR_WEAR_AREA_B, 0) - WEAR_WORD(ADDR_WEAR_AREA_A, 0)) > 0) ? ADDR_WEAR_AREA_B : ADDR_WEAR_AREA_A;
+  else
+    Active_area = valid_b ? ADDR_WEAR_AREA_B : ADDR_WEAR_AREA_A;
+  Area_load();
+  state = FLASH_OK;
+  }
+return truncated ? FLASH_ERROR : state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Сохранение новых стираний во FLASH.
+  * @details Для каждой страницы со стираниями после последнего сохранения дописывается одна запись. \n
+  *          Если записи не помещаются, все счётчики переносятся в резервную область (Compact).
+  * @return  flash status: FLASH_ERROR - счётчики не инициализированы или ошибка FLASH,
+  *          FLASH_BUSY - выполняется асинхронная запись (сохранение не выполнено).
+  */
+flash_status Save_Erase_counters (void)
+{
+uint32_t     record;
+flash_status state = FLASH_OK;
+
+if (!Ready)
+  return FLASH_ERROR;
+if (Get_Async_Status() == FLASH_BUSY) // Прерывание FLASH не изменяет счётчики во время сохранения.
+  return FLASH_BUSY;
+
+Saving = 1; // Записи сохранения вызывают Flash_write_finished.
+for (uint16_t page = 0; (page < WEAR_PAGES_NUM) && (state == FLASH_OK); page++)
+  {
+  if (Unsaved[page] == 0)
+    continue;
+
+  while ( (Free_offset < WEAR_AREA_WORDS) && (WEAR_WORD(Active_area, Free_offset) != BLANK_WORD) )
+    {
+    Free_offset++; // Слово, запись которого прервана.
+    }
+  if (Free_offset >= WEAR_AREA_WORDS)
+    {
+    state = Compact();
+    break;
+    }
+
+  record = WEAR_RECORD(page, Unsaved[page]);
+  state  = Write_Words_to_flash(Active_area + Free_offset * 4, 1, &record);
+  Free_offset++;
+  if (state == FLASH_OK)
+    {
+    Unsaved_sum  -= Unsaved[page];
+    Unsaved[page] = 0;
+    }
+  }
+Saving = 0;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Учёт стирания страницы FLASH.
+  * @details Вызывается функциями FLASH.c после стирания страницы (в том числе из прерывания FLASH).
+  * @param   Address - адрес внутри стёртой страницы.
+  * @return  None.
+  */
+void Flash_page_erased (uint32_t Address)
+{
+uint16_t page;
+
+if (!Ready)
+  return;
+page = Page_number(Address);
+if (page >= WEAR_PAGES_NUM)
+  return;
+
+Erases[page]++;
+if (Unsaved[page] < 0xFFFFU)
+  {
+  Unsaved[page]++;
+  Unsaved_sum++;
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Сохранение счётчиков по окончании блокирующей записи.
+  * @details Вызывается функциями FLASH.c в контексте основной программы. Счётчики сохраняются, если после  \n
+  *          последнего сохранения накопилось не меньше WEAR_SAVE_PERIOD стираний. Во время асинхронной     \n
+  *          записи Save_Erase_counters возвращает FLASH_BUSY: сохранение переносится на следующий вызов.
+  * @return  None.
+  */
+void Flash_write_finished (void)
+{
+if ( Ready && !Saving && (Unsaved_sum >= WEAR_SAVE_PERIOD) )
+  Save_Erase_counters();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Количество стираний страницы.
+  * @param   Address - адрес внутри страницы.
+  * @return  uint32_t - количество стираний, 0 - страница не учитывается.
+  */
+uint32_t Get_Erase_count (uint32_t Address)
+{
+uint16_t page = Page_number(Address);
+
+return (page < WEAR_PAGES_NUM) ? Erases[page] : 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Статистика стираний страниц области.
+  * @param   Region - область (FLASH_REGION_MAIN_PROGRAM ...).
+  * @param   Stats  - указатель на структуру для статистики.
+  * @return  flash status: FLASH_WROG_ADDRES - неверная область, FLASH_ERROR - страницы области не учитываются.
+  */
+flash_status Get_Erase_stats (flash_region Region, Erase_stats_struct *Stats)
+{
+uint32_t sum = 0;
+
+if (Region >= FLASH_REGIONS_NUM)
+  return FLASH_WROG_ADDRES;
+
+Stats->Pages   = (uint16_t)(First_page[Region + 1] - First_page[Region]);
+Stats->Min     = BLANK_WORD;
+Stats->Max     = 0;
+Stats->Mean    = 0;
+Stats->Warning = 0;
+if (Stats->Pages == 0)
+  return FLASH_ERROR;
+
+for (uint16_t page = First_page[Region]; page < First_page[Region + 1]; page++)
+  {
+  if (Erases[page] < Stats->Min)
+    Stats->Min = Erases[page];
+  if (Erases[page] > Stats->Max)
+    Stats->Max = Erases[page];
+  sum += Erases[page];
+  }
+Stats->Mean    = sum / Stats->Pages;
+Stats->Warning = (Stats->Max >= ERASE_WARNING_LEVEL);
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Признак износа FLASH.
+  * @return  uint8_t - 1, если количество стираний какой-либо учитываемой страницы достигло ERASE_WARNING_LEVEL.
+  */
+uint8_t Get_Wear_warning (void)
+{
+for (uint16_t page = 0; page < WEAR_PAGES_NUM; page++)
+  {
+  if (Erases[page] >= ERASE_WARNING_LEVEL)
+    return 1;
+  }
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Чтение счётчиков из активной области.
+  * @details Счётчики заголовка складываются с записями до стёртого слова. \n
+  *          Записи с номером страницы вне текущей нумерации пропускаются.
+  * @return  None.
+  */
+static void Area_load (void)
+{
+uint32_t stored = WEAR_WORD(Active_area, 1);
+uint32_t offset;
+uint32_t record;
+
+if (stored > WEAR_AREA_WORDS - WEAR_HEADER_WORDS)
+  stored = 0;
+Area_seq = WEAR_WORD(Active_area, 0);
+
+for (uint16_t page = 0; (page < WEAR_PAGES_NUM) && (page < stored); page++)
+  {
+  Erases[page] = WEAR_WORD(Active_area, WEAR_HEADER_WORDS + page);
+  }
+for (offset = WEAR_HEADER_WORDS + stored; offset < WEAR_AREA_WORDS; offset++)
+  {
+  record = WEAR_WORD(Active_area, offset);
+  if (record == BLANK_WORD)
+    break;
+  if ((record >> 16) < WEAR_PAGES_NUM)
+    Erases[record >> 16] += record & 0xFFFFU;
+  }
+Free_offset = offset;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Перенос счётчиков в резервную область.
+  * @details Резервная область стирается, в неё записываются все счётчики, затем заголовок; она становится       \n
+  *          активной, прежняя область стирается (это стирание сохраняется следующим Save_Erase_counters).
+  * @return  flash status: при ошибке активная область не изменяется.
+  */
+static flash_status Compact (void)
+{
+uint32_t     spare = (Active_area == ADDR_WEAR_AREA_A) ? ADDR_WEAR_AREA_B : ADDR_WEAR_AREA_A;
+uint32_t     old   = Active_area;
+uint32_t     header[WEAR_HEADER_WORDS] = {Area_seq + 1, WEAR_PAGES_NUM, WEAR_AREA_VALID};
+flash_status state;
+
+if (header[0] == BLANK_WORD) // Номер области не должен совпадать со значением стёртого слова.
+  header[0] = 0;
+
+state = Erase_Area_of_flash(spare, MEMSIZE_WEAR_AREA * 1024);
+if (state == FLASH_OK)
+  state = Write_Words_to_flash(spare + WEAR_HEADER_WORDS * 4, WEAR_PAGES_NUM, Erases);
+if (state == FLASH_OK)
+  state = Write_Words_to_flash(spare, WEAR_HEADER_WORDS, header);
+if (state != FLASH_OK)
+  return state;
+
+for (uint16_t page = 0; page < WEAR_PAGES_NUM; page++)
+  {
+  Unsaved[page] = 0;
+  }
+Unsaved_sum = 0;
+Active_area = spare;
+Area_seq    = header[0];
+Free_offset = WEAR_HEADER_WORDS + WEAR_PAGES_NUM;
+Erase_Area_of_flash(old, MEMSIZE_WEAR_AREA * 1024); // Ошибка стирания не критична: область стирается перед следующим переносом.
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Порядковый номер страницы в областях flash_region.
+  * @param   Address - адрес внутри страницы.
+  * @return  uint16_t - номер страницы, WEAR_PAGES_MAX - страница не учитывается.
+  */
+static uint16_t Page_number (uint32_t Address)
+{
+uint32_t address;
+uint32_t size;
+uint32_t page;
+
+for (uint8_t region = 0; region < FLASH_REGIONS_NUM; region++)
+  {
+  Get_Region_of_flash((flash_region)region, &address, &size);
+  if ( (Address < address) || (Address - address >= size) )
+    continue;
+  page = First_page[region] + Get_Page_Index_of_flash(Address) - Get_Page_Index_of_flash(address);
+  return (page < First_page[region + 1]) ? (uint16_t)page : WEAR_PAGES_MAX;
+  }
+return WEAR_PAGES_MAX;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
@@ -3,63 +3,123 @@
   * 
   * @file      FLASH.c
   * 
-  * @brief       FLASH.
+  * @brief     Надаппаратный драйвер FLASH.
   * 
-  * @details       FLASH.
+  * @details   Функции для работы с FLASH.
   *
-  * @warning   **!**                                                                                                     \n 
-  *       flash   . :
-  *                       +  at32f413_flash.c -     flash  Artery;
-  *                       +  at32f413_flash.h - header for at32f413_flash.c.
+  * @warning   **ВАЖНО!**                                                                                                     \n 
+  * Для работы драйвера требуется аппаратный драйвер flash для конкретного микроконтроллера. Например:
+  *                       + файл at32f413_flash.c - аппаратный драйвер работы с flash от Artery;
+  *                       + файл at32f413_flash.h - header for at32f413_flash.c.
   *
   * **Manual**                                                                                                                \n 
-  *     :
-  * - Write_Config_to_flash (Config_struct* Config) -   FLASH    Config Page.               \n 
-  *           uint32_t   Config_struct.                           \n 
-  *      /    / FLASH   ADDR_CONFIG_PAGE.
+  * В драйвере реализованы следующие функции:
+  * - Write_Config_to_flash (Config_struct* Config) - запись во FLASH изменяемых параметров модуля Config Page.               \n 
+  *   Изменяемые параметры модуля могут храниться в структуре типа uint32_t или типа Config_struct.                           \n 
+  *   Начальныый адрес для записи/чтения изменяемых параметров модуля во/из FLASH определён макросом ADDR_CONFIG_PAGE.       \n 
+  *   Параметры дописываются в журнал записей Config Page (страницы A и B), стирание выполняется только при заполнении   \n 
+  *   активной страницы, и стирается всегда страница, не содержащая последней действительной записи.
   *
-  * - Read_Config_from_flash (Config_struct* Config) -      FLASH                           \n 
-  *      Config_struct.
+  * - Read_Config_from_flash (Config_struct* Config) - чтение изменяемых параметров модуля из FLASH                           \n 
+  *   в структуру типа Config_struct. Читается последняя действительная запись журнала Config Page                          \n 
+  *   (слово состояния записи содержит CRC32, повреждённые записи пропускаются).                                             \n 
+  *   Возвращает FLASH_ERROR, если действительных записей нет.
   *   
-  * - Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants) -                    \n 
-  *      RO_Constants_struct.
+  * - Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants) - чтение неизменяемых параметров модуля                \n 
+  *   в структуру типа RO_Constants_struct с проверкой CRC32. Write_RO_Constants_to_flash (RO_Constants_struct* RO_Constants) - \n 
+  *   запись RO Constants и CRC32 (при сборке модуля).                                                                       \n 
   *
-  * - Write_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words) -   FLASH   . \n 
+  * - Calc_CRC32 (const uint32_t *Words, uint32_t Amount) - CRC32 массива слов (полином 0x04C11DB7, начальное значение         \n 
+  *   0xFFFFFFFF, как у блока CRC GD32/AT32). По умолчанию - табличный расчёт Calc_CRC32_soft, аппаратный драйвер           \n 
+  *   заменяет его расчётом на блоке CRC микроконтроллера.
   *
+  * - Calc_Region_CRC32 (flash_region Region), Verify_Region_of_flash (flash_region Region, uint32_t Crc) - CRC32 области   \n 
+  *   Main Programm, Download Buffer, RO Constants (макросы ADDR_* и MEMSIZE_*) и её сравнение с эталоном.                   \n 
+  *   Области, изменяемые во время работы (журнал Config Page, KV Store, журнал, счётчики стираний), не сравниваются.         \n 
+  *   Расчёт выполняет Calc_CRC32_of_area - Calc_CRC32 по словам области для всех областей и микроконтроллеров,          \n 
+  *   поэтому эталон совпадает с CRC32 образа, рассчитанным на ПК (Calc_CRC32_soft, Pack, Diff).                           \n 
+  *   Get_Region_of_flash (flash_region Region, uint32_t *Address, uint32_t *Size) - адрес и размер области.
   *
-  * Config Page  -     .                                                             \n
-  * RO Constants -      (   ).                          \n
+  * - Flash_page_erased (uint32_t Address) - вызывается после каждого стирания страницы функциями модуля                  \n 
+  *   (по умолчанию пустая, Erase_counters.c ведёт по ней счётчики стираний).                                              \n 
+  *   Flash_write_finished (void) - вызывается по окончании каждой блокирующей записи или стирания в контексте основной    \n 
+  *   программы (по умолчанию пустая, Erase_counters.c сохраняет по ней счётчики стираний каждые WEAR_SAVE_PERIOD стираний).
+  *
+  * - Get_Config_from_flash (void), Get_RO_Constants_from_flash (void) - указатель на параметры модуля во FLASH без        \n 
+  *   копирования в RAM: последняя действительная запись журнала Config Page и область RO Constants.                       \n 
+  *   Get_Config_CanSpeed, Get_Config_AddrModule, Get_RO_ModulType, Get_RO_HardwareRevision, Get_RO_SerialNumberLW,         \n 
+  *   Get_RO_SerialNumberHW - чтение одного параметра. Указатель Get_Config_from_flash действителен до следующей           \n 
+  *   Write_Config_to_flash (запись может стереть страницу журнала).
+  *
+  * - Write_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words) - запись во FLASH произвольного массива слов. \n 
+  *   Массив может пересекать границы страниц: каждая затронутая страница стирается не более одного раза,                  \n 
+  *   вся запись выполняется за одну разблокировку FLASH.                                                                  \n 
+  *   Перед записью данные сравниваются с содержимым FLASH: совпадающие данные не записываются,                            \n 
+  *   отличающиеся слова в стёртых ячейках программируются без стирания, страница стирается только в остальных случаях.   \n 
+  *   Данные страницы вне массива сохраняются (буфер страницы FLASH_PAGE_SIZE_MAX байт в RAM).                             \n 
+  *
+  * - Get_Last_Write_Path (void) - способ, которым была выполнена последняя запись Write_Words_to_flash.                     \n 
+  *
+  * - Words_blank_in_flash (uint32_t Address, uint32_t Amount) - проверка слов FLASH на стёртость (BLANK_WORD)            \n 
+  *   (пропуск стёртых страниц, поиск свободных слотов в KV_store.c и Log_ring.c).
+  *
+  * - Erase_Area_of_flash (uint32_t Address, uint32_t Size) - стирание области FLASH (уже стёртые страницы пропускаются).    \n 
+  *
+  * - Write_Words_to_flash_async (uint32_t Address, uint32_t Amount, uint32_t *Words, flash_callback Callback) -              \n 
+  *   асинхронная запись массива слов: функция запускает первую операцию и сразу возвращает управление,                      \n 
+  *   следующие операции запускаются из прерывания FLASH, по окончании вызывается Callback.                                 \n 
+  *   Get_Async_Status (void), Get_Bank_Async_Status (uint8_t Bank) - состояние асинхронной записи (FLASH_BUSY - выполняется). \n 
+  *   Каждый банк FLASH имеет свой канал асинхронной записи, записи в разные банки выполняются одновременно.                 \n 
+  *   Пока выполняется асинхронная запись в банк, Write_Config_to_flash и Write_Words_to_flash для этого банка             \n 
+  *   возвращают FLASH_BUSY.                                                                                                \n 
+  *
+  * - Erase_Page_of_flash_async (uint32_t Address, flash_callback Callback) - стирание страницы без ожидания окончания       \n 
+  *   через канал асинхронной записи банка (уже стёртая страница не стирается). Используется для стирания следующей         \n 
+  *   страницы, пока принимаются данные для текущей (Image_writer.c).                                                        \n 
+  *
+  * Функции Write_Config_to_flash, Read_Config_from_flash и Write_Words_to_flash не зависят от микроконтроллера и работают через функции          \n 
+  * аппаратного драйвера: Unlock_flash, Lock_flash, Erase_Page_of_flash, Program_Words_to_flash, Get_Page_Size_of_flash,      \n 
+  * Read_MCU_FMD. Границы FLASH и начала страниц определяются по объёму FLASH (Read_MCU_FMD) модулем Flash_geometry.c.        \n 
+  * Асинхронная запись использует функции аппаратного драйвера Start_Erase_Page_of_flash, Start_Program_Word_of_flash,        \n 
+  * Enable_flash_IRQ, Disable_flash_IRQ, Get_Bank_of_flash; обработчик прерывания FLASH аппаратного драйвера сообщает об окончании операции     \n 
+  * вызовом Flash_operation_complete.                                                                                         \n 
+  *
+  *
+  * Config Page  - область хранения изменяемых параметров модуля.                                                             \n
+  * RO Constants - область хранения неизменяемых параметров модуля (записывается при сборке модуля).                          \n
   *                                                                                                                           \n 
   *
-  * **  Config Page**
-  * |                         |       |   0x00   |   0x01   | 0x02 | 0x03 |
+  * **Карта памяти Config Page**
+  * | Параметр                        |   Адрес    |   0x00   |   0x01   | 0x02 | 0x03 |
   * | ------------------------------- | :--------: | :------: | :------: | :--: | :--: |
-  * |                      | 0x0801F000 |   addr   |   0xFF   | 0xFF | 0xFF |
-  * |  CAN                    | 0x0801F004 |          |          |      |      |
-  * |                 | 0x0801F008 | bl_minor | bl_major | 0xFF | 0xFF |
-  * |                  | 0x0801F00C | sw_minor | sw_major | 0xFF | 0xFF |
-  * |               | 0x0801F010 |   flag   |   0xFF   | 0xFF | 0xFF |
-  * |     Modbus | 0x0801F014 |   0xFF   |   0xFF   | 0xFF | 0xFF |
-  * |  Modbus  0        | 0x0801F018 |   baud   |    par   | stop | 0xFF |
-  * |  Modbus  1        | 0x0801F01C |   baud   |    par   | stop | 0xFF |
-  * |  Modbus  2        | 0x0801F020 |   baud   |    par   | stop | 0xFF |
-  * |  Modbus  3        | 0x0801F024 |   baud   |    par   | stop | 0xFF |
-  *
-  *  Config Page   ,    32- .
+  * | Номер записи                    | 0x0801F000 |   seq    |   seq    | seq  | seq  |
+  * | Адрес модуля                    | 0x0801F004 |   addr   |   0xFF   | 0xFF | 0xFF |
+  * | Скорость CAN                    | 0x0801F008 |          |          |      |      |
+  * | Версия загрузчика               | 0x0801F00C | bl_minor | bl_major | 0xFF | 0xFF |
+  * | Версия программы                | 0x0801F010 | sw_minor | sw_major | 0xFF | 0xFF |
+  * | Флаг первого запуска            | 0x0801F014 |   flag   |   0xFF   | 0xFF | 0xFF |
+  * | Не используется в модуле Modbus | 0x0801F018 |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Параметры Modbus порта 0        | 0x0801F01C |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 1        | 0x0801F020 |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 2        | 0x0801F024 |   baud   |   par    | stop | 0xFF |
+  * | Параметры Modbus порта 3        | 0x0801F028 |   baud   |   par    | stop | 0xFF |
+  * | Слово состояния записи          | 0x0801F02C |    st    |    st    |  st  |  st  |
+  *
+  * Страница Config Page содержит параметры модуля, записанные в виде 32-битных слов.
   * \n \n 
   *
-  * **  RO Constants**
-  * |            |       |   0x00   |   0x01   | 0x02 | 0x03 |
+  * **Карта памяти RO Constants**
+  * | Параметр           |   Адрес    |   0x00   |   0x01   | 0x02 | 0x03 |
   * | ------------------ | :--------: | :------: | :------: | :--: | :--: |
-  * |           | 0x0801F800 |  class   |   0xFF   | 0xFF | 0xFF |
-  * |   | 0x0801F804 | hw_minor | hw_major | 0xFF | 0xFF |
-  * |   lw  | 0x0801F808 |   0xFF   |   0xFF   | 0xFF | 0xFF |
-  * |   hw  | 0x0801F80C |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Тип модуля         | 0x0801F800 |  class   |   0xFF   | 0xFF | 0xFF |
+  * | Аппаратная ревизия | 0x0801F804 | hw_minor | hw_major | 0xFF | 0xFF |
+  * | Серийный номер lw  | 0x0801F808 |   0xFF   |   0xFF   | 0xFF | 0xFF |
+  * | Серийный номер hw  | 0x0801F80C |   0xFF   |   0xFF   | 0xFF | 0xFF |
   *
-  *  RO Constants   ,    32- .
+  * Страница RO Constants содержит параметры модуля, записанные в виде 32-битных слов.
   * \n \n 
   *
-  * @copyright Copyright (C) 2022 Awada Systems.   .
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
   *
   * @author    Larionov A.S. (larion.alex@mail.ru)
   * 
@@ -68,72 +128,736 @@
 
 //---Includes-------------------------------------------------------------------//
 #include "FLASH.h"
+#include "Flash_geometry.h"
 //------------------------------------------------------------------------------//
 
 //---Private macros-------------------------------------------------------------//
+#define CONFIG_SLOT_ADDR(page, slot) ((page) + (slot) * CONFIG_RECORD_SIZE * 4)       /*!< Адрес слота с номером slot на странице журнала Config Page page. */
+#define CONFIG_SLOTS                 (Config_page_size / (CONFIG_RECORD_SIZE * 4))     /*!< Количество слотов на странице журнала Config Page (Config_log_layout). */
+#define CONFIG_STATUS_OFFSET         ((NUM_OF_CONFIG_WORDS + 1) * 4)                   /*!< Смещение слова состояния от начала записи журнала Config Page.  */
+#define RO_CONSTANTS_WORDS           (sizeof(RO_Constants_struct) / 4)                  /*!< Размер RO_Constants_struct в 32-битных словах.                  */
+#define END_ADDR_OF_FLASH            (Get_flash_geometry()->End_addr - 1)               /*!< Адрес последнего байта FLASH памяти (Flash_geometry.c).           */
 //------------------------------------------------------------------------------//
 
 //---Exported variables---------------------------------------------------------//
 //------------------------------------------------------------------------------//
 
 //---Private types--------------------------------------------------------------//
+/**
+  * @brief  Канал асинхронной записи (один канал на банк FLASH).
+  */
+typedef struct
+{
+volatile flash_status State;    /*!< FLASH_BUSY - выполняется асинхронная запись, иначе - результат последней асинхронной записи. */
+uint32_t              Addr;     /*!< Адрес очередного слова.                                                                      */
+uint32_t             *Words;    /*!< Указатель на очередное слово массива.                                                        */
+uint32_t              Amount;   /*!< Количество оставшихся слов.                                                                  */
+uint32_t              Chunk;    /*!< Количество оставшихся слов в текущей странице.                                               */
+flash_callback        Callback; /*!< Функция, вызываемая по окончании записи.                                                     */
+} async_channel;
 //------------------------------------------------------------------------------//
 
 //---Private variables----------------------------------------------------------//
+static uint8_t  Config_log_scanned = 0; /*!< Признак выполненного просмотра журнала Config Page.                               */
+static uint32_t Config_page;            /*!< Начальный адрес активной страницы журнала (ADDR_CONFIG_PAGE или Config_page_b). */
+static uint32_t Config_page_b    = ADDR_CONFIG_PAGE_B;          /*!< Начальный адрес страницы B журнала (Config_log_layout).    */
+static uint32_t Config_page_size = MEMSIZE_CONFIG_PAGE * 1024;  /*!< Размер страницы журнала в байтах (Config_log_layout).        */
+static uint32_t Config_free_slot;       /*!< Номер первого чистого слота активной страницы журнала.                             */
+static uint32_t Config_valid_addr;      /*!< Адрес последней действительной записи журнала (0 - записей нет).                   */
+static uint32_t Config_seq;             /*!< Номер последней действительной записи журнала.                                    */
+static uint8_t  RO_Constants_valid = 0; /*!< Признак проверенной (записанной) области RO Constants.                             */
+
+static flash_write_path Last_write_path = FLASH_WRITE_SKIPPED; /*!< Способ выполнения последней записи Write_Words_to_flash. */
+
+static async_channel    Async[FLASH_BANKS_MAX] = { [0].State = FLASH_OK, [1].State = FLASH_OK }; /*!< Каналы асинхронной записи, индекс - номер банка FLASH. */
+static uint32_t         Page_buffer[FLASH_PAGE_SIZE_MAX / 4];                /*!< Буфер страницы для Rewrite_page.                         */
+static volatile uint8_t Sync_active = 0;                                    /*!< Выполняется блокирующая запись (FLASH разблокирована).   */
 //------------------------------------------------------------------------------//
 
 //---Private constants----------------------------------------------------------//
+/**
+  * @brief  Начальные адреса и размеры (байт) областей flash_region.
+  */
+static const uint32_t Regions[FLASH_REGIONS_NUM][2] =
+{
+  {ADDR_MAIN_PROGRAM,    MEMSIZE_MAIN_PROGRAM    * 1024},
+  {ADDR_DOWNLOAD_BUFFER, MEMSIZE_DOWNLOAD_BUFFER * 1024},
+  {ADDR_CONFIG_PAGE,     MEMSIZE_CONFIG_PAGE     * 1024},
+  {ADDR_CONFIG_PAGE_B,   MEMSIZE_CONFIG_PAGE_B   * 1024},
+  {ADDR_RO_CONSTANS,     MEMSIZE_RO_CONSTANS     * 1024},
+  {ADDR_KV_AREA_A,       MEMSIZE_KV_AREA         * 1024},
+  {ADDR_KV_AREA_B,       MEMSIZE_KV_AREA         * 1024},
+  {ADDR_LOG_AREA,        MEMSIZE_LOG_AREA        * 1024},
+  {ADDR_WEAR_AREA_A,     MEMSIZE_WEAR_AREA   * 2 * 1024}
+};
+
+/**
+  * @brief  Таблица CRC32 (полином 0x04C11DB7, без отражения) для Calc_CRC32_soft.
+  */
+static const uint32_t Crc32_table[256] =
+{
+  0x00000000U, 0x04C11DB7U, 0x09823B6EU, 0x0D4326D9U, 0x130476DCU, 0x17C56B6BU, 0x1A864DB2U, 0x1E475005U,
+  0x2608EDB8U, 0x22C9F00FU, 0x2F8AD6D6U, 0x2B4BCB61U, 0x350C9B64U, 0x31CD86D3U, 0x3C8EA00AU, 0x384FBDBDU,
+  0x4C11DB70U, 0x48D0C6C7U, 0x4593E01EU, 0x4152FDA9U, 0x5F15ADACU, 0x5BD4B01BU, 0x569796C2U, 0x52568B75U,
+  0x6A1936C8U, 0x6ED82B7FU, 0x639B0DA6U, 0x675A1011U, 0x791D4014U, 0x7DDC5DA3U, 0x709F7B7AU, 0x745E66CDU,
+  0x9823B6E0U, 0x9CE2AB57U, 0x91A18D8EU, 0x95609039U, 0x8B27C03CU, 0x8FE6DD8BU, 0x82A5FB52U, 0x8664E6E5U,
+  0xBE2B5B58U, 0xBAEA46EFU, 0xB7A96036U, 0xB3687D81U, 0xAD2F2D84U, 0xA9EE3033U, 0xA4AD16EAU, 0xA06C0B5DU,
+  0xD4326D90U, 0xD0F37027U, 0xDDB056FEU, 0xD9714B49U, 0xC7361B4CU, 0xC3F706FBU, 0xCEB42022U, 0xCA753D95U,
+  0xF23A8028U, 0xF6FB9D9FU, 0xFBB8BB46U, 0xFF79A6F1U, 0xE13EF6F4U, 0xE5FFEB43U, 0xE8BCCD9AU, 0xEC7DD02DU,
+  0x34867077U, 0x30476DC0U, 0x3D044B19U, 0x39C556AEU, 0x278206ABU, 0x23431B1CU, 0x2E003DC5U, 0x2AC12072U,
+  0x128E9DCFU, 0x164F8078U, 0x1B0CA6A1U, 0x1FCDBB16U, 0x018AEB13U, 0x054BF6A4U, 0x0808D07DU, 0x0CC9CDCAU,
+  0x7897AB07U, 0x7C56B6B0U, 0x71159069U, 0x75D48DDEU, 0x6B93DDDBU, 0x6F52C06CU, 0x6211E6B5U, 0x66D0FB02U,
+  0x5E9F46BFU, 0x5A5E5B08U, 0x571D7DD1U, 0x53DC6066U, 0x4D9B3063U, 0x495A2DD4U, 0x44190B0DU, 0x40D816BAU,
+  0xACA5C697U, 0xA864DB20U, 0xA527FDF9U, 0xA1E6E04EU, 0xBFA1B04BU, 0xBB60ADFCU, 0xB6238B25U, 0xB2E29692U,
+  0x8AAD2B2FU, 0x8E6C3698U, 0x832F1041U, 0x87EE0DF6U, 0x99A95DF3U, 0x9D684044U, 0x902B669DU, 0x94EA7B2AU,
+  0xE0B41DE7U, 0xE4750050U, 0xE9362689U, 0xEDF73B3EU, 0xF3B06B3BU, 0xF771768CU, 0xFA325055U, 0xFEF34DE2U,
+  0xC6BCF05FU, 0xC27DEDE8U, 0xCF3ECB31U, 0xCBFFD686U, 0xD5B88683U, 0xD1799B34U, 0xDC3ABDEDU, 0xD8FBA05AU,
+  0x690CE0EEU, 0x6DCDFD59U, 0x608EDB80U, 0x644FC637U, 0x7A089632U, 0x7EC98B85U, 0x738AAD5CU, 0x774BB0EBU,
+  0x4F040D56U, 0x4BC510E1U, 0x46863638U, 0x42472B8FU, 0x5C007B8AU, 0x58C1663DU, 0x558240E4U, 0x51435D53U,
+  0x251D3B9EU, 0x21DC2629U, 0x2C9F00F0U, 0x285E1D47U, 0x36194D42U, 0x32D850F5U, 0x3F9B762CU, 0x3B5A6B9BU,
+  0x0315D626U, 0x07D4CB91U, 0x0A97ED48U, 0x0E56F0FFU, 0x1011A0FAU, 0x14D0BD4DU, 0x19939B94U, 0x1D528623U,
+  0xF12F560EU, 0xF5EE4BB9U, 0xF8AD6D60U, 0xFC6C70D7U, 0xE22B20D2U, 0xE6EA3D65U, 0xEBA91BBCU, 0xEF68060BU,
+  0xD727BBB6U, 0xD3E6A601U, 0xDEA580D8U, 0xDA649D6FU, 0xC423CD6AU, 0xC0E2D0DDU, 0xCDA1F604U, 0xC960EBB3U,
+  0xBD3E8D7EU, 0xB9FF90C9U, 0xB4BCB610U, 0xB07DABA7U, 0xAE3AFBA2U, 0xAAFBE615U, 0xA7B8C0CCU, 0xA379DD7BU,
+  0x9B3660C6U, 0x9FF77D71U, 0x92B45BA8U, 0x9675461FU, 0x8832161AU, 0x8CF30BADU, 0x81B02D74U, 0x857130C3U,
+  0x5D8A9099U, 0x594B8D2EU, 0x5408ABF7U, 0x50C9B640U, 0x4E8EE645U, 0x4A4FFBF2U, 0x470CDD2BU, 0x43CDC09CU,
+  0x7B827D21U, 0x7F436096U, 0x7200464FU, 0x76C15BF8U, 0x68860BFDU, 0x6C47164AU, 0x61043093U, 0x65C52D24U,
+  0x119B4BE9U, 0x155A565EU, 0x18197087U, 0x1CD86D30U, 0x029F3D35U, 0x065E2082U, 0x0B1D065BU, 0x0FDC1BECU,
+  0x3793A651U, 0x3352BBE6U, 0x3E119D3FU, 0x3AD08088U, 0x2497D08DU, 0x2056CD3AU, 0x2D15EBE3U, 0x29D4F654U,
+  0xC5A92679U, 0xC1683BCEU, 0xCC2B1D17U, 0xC8EA00A0U, 0xD6AD50A5U, 0xD26C4D12U, 0xDF2F6BCBU, 0xDBEE767CU,
+  0xE3A1CBC1U, 0xE760D676U, 0xEA23F0AFU, 0xEEE2ED18U, 0xF0A5BD1DU, 0xF464A0AAU, 0xF9278673U, 0xFDE69BC4U,
+  0x89B8FD09U, 0x8D79E0BEU, 0x803AC667U, 0x84FBDBD0U, 0x9ABC8BD5U, 0x9E7D9662U, 0x933EB0BBU, 0x97FFAD0CU,
+  0xAFB010B1U, 0xAB710D06U, 0xA6322BDFU, 0xA2F33668U, 0xBCB4666DU, 0xB8757BDAU, 0xB5365D03U, 0xB1F740B4U
+};
 //------------------------------------------------------------------------------//
 
 //---Function prototypes--------------------------------------------------------//
+static void             Config_log_scan        (void);
+static uint8_t          Config_record_valid    (uint32_t Slot_addr);
+static uint32_t         Config_page_scan       (uint32_t Page);
+static void             Config_log_layout      (void);
+static flash_status     Erase_Pages            (uint32_t Address, uint32_t Size);
+static flash_status     Erase_page             (uint32_t Address);
+static flash_status     Rewrite_page           (uint32_t Address, uint32_t Amount, uint32_t *Words);
+static flash_write_path Compare_Words          (uint32_t Address, uint32_t Amount, uint32_t *Words);
+static flash_status     Program_Changed_Words  (uint32_t Address, uint32_t Amount, uint32_t *Words);
+static uint8_t          Banks_busy             (uint32_t Address, uint32_t Size);
+static void             Sync_unlock            (void);
+static void             Sync_lock              (void);
+static void             Lock_if_idle           (void);
+static void             Async_next             (uint8_t Bank);
+static void             Async_finish           (uint8_t Bank, flash_status State);
 //------------------------------------------------------------------------------//
 
 //---Exported functions---------------------------------------------------------//
 /**
-  * @brief    Config  FLASH.
-  * @param   Config -   Config_struct*     Config.
+  * @brief   Запись Config во FLASH.
+  * @details Параметры записываются в первый чистый слот активной страницы журнала Config Page:          \n 
+  *          номер записи, параметры и последним - слово состояния                                       \n 
+  *          (CONFIG_RECORD_VALID ^ CRC32 номера записи и параметров).                                  \n 
+  *          Если на активной странице не осталось чистых слотов, стирается другая страница журнала      \n 
+  *          и запись выполняется в её первый слот. Последняя действительная запись при этом             \n 
+  *          остаётся нетронутой до фиксации новой.
+  * @param   Config - указатель типа Config_struct* на структуру с данными Config.
   * @return  flash status.
   */
-__weak flash_status Write_Config_to_flash (Config_struct* Config)
+flash_status Write_Config_to_flash (Config_struct* Config)
+{
+flash_status state = FLASH_OK;
+uint32_t     record[NUM_OF_CONFIG_WORDS + 1];
+uint32_t     record_status;
+uint32_t     seq;
+uint32_t     slot_addr;
+
+Config_log_layout();
+if (Banks_busy(ADDR_CONFIG_PAGE, Config_page_size) || Banks_busy(Config_page_b, Config_page_size))
+  return FLASH_BUSY;
+
+Config_log_scan();
+
+seq = Config_seq + 1;
+if (seq == BLANK_WORD) // Номер записи не должен совпадать со значением стёртого слова.
+  seq = 0;
+
+record[0] = seq;
+for (uint32_t i = 0; i < NUM_OF_CONFIG_WORDS; i++)
+  {
+  record[i + 1] = *((uint32_t*)Config + i);
+  }
+record_status = CONFIG_RECORD_VALID ^ Calc_CRC32(record, NUM_OF_CONFIG_WORDS + 1);
+if (record_status == BLANK_WORD) // Слово состояния не должно совпадать со значением стёртого слова.
+  record_status = CONFIG_RECORD_VALID;
+
+Sync_unlock(); // Unlock the main FMC operation.
+if (Config_free_slot >= CONFIG_SLOTS)
+  {
+  Config_page      = (Config_page == ADDR_CONFIG_PAGE) ? Config_page_b : ADDR_CONFIG_PAGE;
+  Config_free_slot = 0;
+  state = Erase_Pages(Config_page, Config_page_size); // Активная страница заполнена - стирание другой страницы журнала.
+  }
+if (state == FLASH_OK)
+  {
+  slot_addr = CONFIG_SLOT_ADDR(Config_page, Config_free_slot);
+  Config_free_slot++; // Начатый слот считается занятым даже при ошибке записи.
+  state = Program_Words_to_flash(slot_addr, NUM_OF_CONFIG_WORDS + 1, record);
+  if (state == FLASH_OK)
+    state = Program_Words_to_flash(slot_addr + CONFIG_STATUS_OFFSET, 1, &record_status); // Фиксация записи.
+  if (state == FLASH_OK)
+    {
+    Config_valid_addr = slot_addr;
+    Config_seq        = seq;
+    }
+  }
+Sync_lock(); // Lock the main FMC operation.
+
+if (state != FLASH_OK)
+  Config_log_scanned = 0; // Состояние журнала неизвестно - повторный просмотр при следующем обращении.
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Чтение Config из FLASH.
+  * @details Читается последняя действительная запись журнала Config Page. Её адрес определяется      \n 
+  *          один раз при первом обращении и далее хранится в RAM.                                     \n 
+  *          Если действительных записей нет, читается начало страницы Config Page                      \n 
+  *          (стёртая страница или параметры, записанные без журнала).
+  * @param   Config - указатель типа Config_struct* на структуру с данными Config.
+  * @return  flash status: FLASH_OK - прочитана действительная запись (CRC32 совпадает),               \n 
+  *          FLASH_ERROR - действительных записей нет, прочитано начало страницы Config Page.
+  */
+flash_status Read_Config_from_flash (Config_struct* Config)
 {
+Config_log_scan();
+
+if (Config_valid_addr != 0)
+  {
+  *Config = *((Config_struct*)(uintptr_t)(Config_valid_addr + 4));
+  return FLASH_OK;
+  }
+*Config = *((Config_struct*)ADDR_CONFIG_PAGE);
 return FLASH_ERROR;
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief    Config  FLASH.
-  * @param   Data -   uint32_t*     Config.
+  * @brief   Чтение RO_Constants из FLASH.
+  * @details Проверяется CRC32, записанный после RO_Constants_struct (ADDR_RO_CONSTANS_CRC).                \n 
+  *          Область, записанная без CRC32 (слово CRC стёрто), принимается, если тип модуля записан.
+  * @param   RO_Constants - указатель типа RO_Constants_struct* на структуру с данными RO_Constants.
+  * @return  flash status: FLASH_OK - данные действительны, FLASH_ERROR - CRC32 не совпадает или область не записана.
+  */
+flash_status Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants)
+{
+*RO_Constants = *((RO_Constants_struct*)ADDR_RO_CONSTANS);
+return (Get_RO_Constants_from_flash() != 0) ? FLASH_OK : FLASH_ERROR;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись RO_Constants во FLASH.
+  * @details Записываются RO_Constants_struct и её CRC32 (ADDR_RO_CONSTANS_CRC). Вызывается при сборке модуля.     \n 
+  *          Область стирается, и CRC32 программируется раньше данных: при потере питания во время записи      \n 
+  *          слово CRC уже не стёрто, поэтому частично записанные данные не принимаются за область без CRC32.
+  * @param   RO_Constants - указатель типа RO_Constants_struct* на структуру с данными RO_Constants.
+  * @return  flash status (см. Write_Words_to_flash).
+  */
+flash_status Write_RO_Constants_to_flash (RO_Constants_struct* RO_Constants)
+{
+flash_status state;
+uint32_t     words[RO_CONSTANTS_WORDS + 1];
+uint8_t      same = 1;
+
+for (uint32_t i = 0; i < RO_CONSTANTS_WORDS; i++)
+  {
+  words[i] = *((uint32_t*)RO_Constants + i);
+  }
+words[RO_CONSTANTS_WORDS] = Calc_CRC32(words, RO_CONSTANTS_WORDS);
+
+for (uint32_t i = 0; i <= RO_CONSTANTS_WORDS; i++)
+  {
+  if (*((uint32_t*)ADDR_RO_CONSTANS + i) != words[i])
+    same = 0;
+  }
+if (same)
+  return FLASH_OK;
+
+RO_Constants_valid = 0;
+state = Erase_Area_of_flash(ADDR_RO_CONSTANS, MEMSIZE_RO_CONSTANS * 1024);
+if (state == FLASH_OK)
+  state = Write_Words_to_flash(ADDR_RO_CONSTANS_CRC, 1, &words[RO_CONSTANTS_WORDS]);
+if (state == FLASH_OK)
+  state = Write_Words_to_flash(ADDR_RO_CONSTANS, RO_CONSTANTS_WORDS, words);
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Указатель на Config во FLASH.
+  * @details Последняя действительная запись журнала Config Page без копирования в RAM.             \n 
+  *          Журнал просматривается один раз, далее адрес записи хранится в RAM.                     \n 
+  *          Если действительных записей нет - начало страницы Config Page (как Read_Config_from_flash). \n 
+  *          После Write_Config_to_flash указатель нужно получить заново.
+  * @return  const Config_struct* - указатель на параметры Config во FLASH.
+  */
+const Config_struct* Get_Config_from_flash (void)
+{
+Config_log_scan();
+
+if (Config_valid_addr != 0)
+  return (const Config_struct*)(uintptr_t)(Config_valid_addr + 4);
+return (const Config_struct*)ADDR_CONFIG_PAGE;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Указатель на RO_Constants во FLASH.
+  * @details Область RO Constants проверяется (CRC32, для области без CRC32 - тип модуля записан)     \n 
+  *          до первого успешного результата, далее проверка не выполняется.
+  * @return  const RO_Constants_struct* - указатель на RO Constants во FLASH, 0 - область не записана или повреждена.
+  */
+const RO_Constants_struct* Get_RO_Constants_from_flash (void)
+{
+const RO_Constants_struct *ro_constants = (const RO_Constants_struct*)ADDR_RO_CONSTANS;
+uint32_t                   crc          = *((uint32_t*)ADDR_RO_CONSTANS_CRC);
+
+if (!RO_Constants_valid)
+  {
+  if (crc == BLANK_WORD)
+    {
+    if (ro_constants->ModulType == BLANK_WORD)
+      return 0;
+    }
+  else if (crc != Calc_CRC32((const uint32_t*)ADDR_RO_CONSTANS, RO_CONSTANTS_WORDS))
+    return 0;
+  RO_Constants_valid = 1;
+  }
+return ro_constants;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Скорость CAN из Config во FLASH.
+  * @return  uint32_t - скорость CAN (битрейт).
+  */
+uint32_t Get_Config_CanSpeed (void)
+{
+return Get_Config_from_flash()->CanSpeed;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Адрес модуля из Config во FLASH.
+  * @return  uint32_t - адрес модуля.
+  */
+uint32_t Get_Config_AddrModule (void)
+{
+return Get_Config_from_flash()->AddrModule;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Тип модуля из RO Constants.
+  * @return  uint32_t - тип модуля, BLANK_WORD - область RO Constants не записана.
+  */
+uint32_t Get_RO_ModulType (void)
+{
+const RO_Constants_struct *ro_constants = Get_RO_Constants_from_flash();
+
+return (ro_constants != 0) ? ro_constants->ModulType : BLANK_WORD;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Аппаратная ревизия из RO Constants.
+  * @return  Version - аппаратная ревизия, 0xFF.0xFF - область RO Constants не записана.
+  */
+Version Get_RO_HardwareRevision (void)
+{
+const RO_Constants_struct *ro_constants = Get_RO_Constants_from_flash();
+Version                    blank        = {0xFF, 0xFF};
+
+return (ro_constants != 0) ? ro_constants->HardwareRevision : blank;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Серийный номер (младшее слово) из RO Constants.
+  * @return  uint32_t - серийный номер lw, BLANK_WORD - область RO Constants не записана.
+  */
+uint32_t Get_RO_SerialNumberLW (void)
+{
+const RO_Constants_struct *ro_constants = Get_RO_Constants_from_flash();
+
+return (ro_constants != 0) ? ro_constants->SerialNumberLW : BLANK_WORD;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Серийный номер (старшее слово) из RO Constants.
+  * @return  uint32_t - серийный номер hw, BLANK_WORD - область RO Constants не записана.
+  */
+uint32_t Get_RO_SerialNumberHW (void)
+{
+const RO_Constants_struct *ro_constants = Get_RO_Constants_from_flash();
+
+return (ro_constants != 0) ? ro_constants->SerialNumberHW : BLANK_WORD;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись массива данных во FLASH.
+  * @details Функция записи массива слов во FLASH.                                                     \n 
+  *          Массив может занимать несколько страниц: страницы обходятся по их фактическому размеру    \n 
+  *          (Get_Page_Size_of_flash), каждая затронутая страница стирается не более одного раза,      \n 
+  *          вся запись выполняется за одну разблокировку FLASH.                                       \n 
+  *          Перед записью в каждую страницу данные сравниваются с содержимым FLASH:                   \n 
+  *          - все слова совпадают - запись не выполняется (FLASH_WRITE_SKIPPED);                      \n 
+  *          - все отличающиеся слова стёрты - программируются только они (FLASH_WRITE_PROGRAMMED);   \n 
+  *          - иначе страница стирается и её часть массива записывается полностью (FLASH_WRITE_ERASED). \n 
+  *          Слова страницы вне записываемого массива перед стиранием копируются в буфер страницы       \n 
+  *          и программируются заново (Rewrite_page), данные первой и последней страниц сохраняются.   \n 
+  *          Контроллеры GD32F103 и AT32F413 не допускают повторное программирование записанного слова \n 
+  *          (ошибка PGERR), поэтому без стирания можно записать только слово в стёртой ячейке.        \n 
+  *          Get_Last_Write_Path возвращает наиболее затратный способ, использованный при записи.
+  * @param   Address - адрес начальной ячейки.
+  * @param   Amount  - количество записываемых слов (не меньше 1).
+  * @param   Words   - указатель типа uint32_t* на массив с данными. Данные должны быть выровнены по 4 байта.
+  * @return  flash status: FLASH_WROG_ADDRES - Amount = 0, Address не выровнен по слову или массив выходит за границы FLASH.
+  */
+flash_status Write_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words)
+{
+flash_status     state    = FLASH_OK;
+uint8_t          unlocked = 0;
+flash_write_path path;
+uint32_t         page_size;
+uint32_t         chunk;
+
+if ( (Amount == 0) || (Address & 3U) || (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_FLASH) ||
+     (Amount > (END_ADDR_OF_FLASH + 1 - Address) / 4) ) // Без переполнения Address + 4*Amount.
+  return FLASH_WROG_ADDRES;
+if (Banks_busy(Address, 4*Amount))
+  return FLASH_BUSY;
+
+Last_write_path = FLASH_WRITE_SKIPPED;
+while ( (Amount > 0) && (state == FLASH_OK) )
+  {
+  page_size = Get_Page_Size_of_flash(Address);
+  chunk     = (page_size - (Address & (page_size - 1))) / 4; // Количество слов до конца страницы.
+  if (chunk > Amount)
+    chunk = Amount;
+
+  path = Compare_Words(Address, chunk, Words);
+  if (path != FLASH_WRITE_SKIPPED)
+    {
+    if (!unlocked)
+      {
+      Sync_unlock(); // Unlock the main FMC operation.
+      unlocked = 1;
+      }
+    if (path == FLASH_WRITE_ERASED)
+      state = Rewrite_page(Address, chunk, Words);
+    else
+      state = Program_Changed_Words(Address, chunk, Words);
+    if (path > Last_write_path)
+      Last_write_path = path;
+    }
+
+  Address += 4*chunk;
+  Words   += chunk;
+  Amount  -= chunk;
+  }
+
+if (unlocked)
+  Sync_lock(); // Lock the main FMC operation.
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Стирание области FLASH.
+  * @details Стираются страницы, занятые областью, кроме уже стёртых. Область должна начинаться \n 
+  *          с начала страницы, последняя затронутая страница стирается целиком.
+  * @param   Address - начальный адрес области (начало страницы).
+  * @param   Size    - размер области в байтах.
+  * @return  flash status: FLASH_OK, FLASH_ERROR, FLASH_WROG_ADDRES, FLASH_BUSY - банк занят асинхронной записью.
+  */
+flash_status Erase_Area_of_flash (uint32_t Address, uint32_t Size)
+{
+flash_status state    = FLASH_OK;
+uint32_t     end      = Address + Size;
+uint8_t      unlocked = 0;
+
+if ( (Size == 0) || (Address & 3U) || (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_FLASH) ||
+     (Size > END_ADDR_OF_FLASH + 1 - Address) )
+  return FLASH_WROG_ADDRES;
+if (Banks_busy(Address, Size))
+  return FLASH_BUSY;
+
+while ( (Address < end) && (state == FLASH_OK) )
+  {
+  if (!Words_blank_in_flash(Address, Get_Page_Size_of_flash(Address) / 4))
+    {
+    if (!unlocked)
+      {
+      Sync_unlock(); // Unlock the main FMC operation.
+      unlocked = 1;
+      }
+    state = Erase_page(Address);
+    }
+  Address += Get_Page_Size_of_flash(Address);
+  }
+
+if (unlocked)
+  Sync_lock(); // Lock the main FMC operation.
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Способ выполнения последней записи.
+  * @details Позволяет оценить сэкономленные циклы стирания FLASH.
+  * @return  flash_write_path - способ выполнения последней записи Write_Words_to_flash.
+  */
+flash_write_path Get_Last_Write_Path (void)
+{
+return Last_write_path;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Проверка слов FLASH на стёртость.
+  * @param   Address - адрес начального слова.
+  * @param   Amount  - количество слов.
+  * @return  uint8_t - 1, если все слова равны BLANK_WORD.
+  */
+uint8_t Words_blank_in_flash (uint32_t Address, uint32_t Amount)
+{
+for (uint32_t i = 0; i < Amount; i++)
+  {
+  if (*((uint32_t*)(uintptr_t)Address + i) != BLANK_WORD)
+    return 0;
+  }
+return 1;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Асинхронная запись массива данных во FLASH.
+  * @details Запускает запись и сразу возвращает управление.                                             \n 
+  *          Страницы обрабатываются так же, как в Write_Words_to_flash: совпадающие слова пропускаются,  \n 
+  *          страница стирается только если отличающееся слово не стёрто.                                 \n 
+  *          В отличие от Write_Words_to_flash данные стираемой страницы вне массива не сохраняются        \n 
+  *          (буфер страницы один, каналов записи - по числу банков).                                     \n 
+  *          Каждая операция (стирание страницы, программирование слова) запускается без ожидания,        \n 
+  *          следующая - из прерывания FLASH (Flash_operation_complete).                                  \n 
+  *          По окончании вызывается Callback (в контексте прерывания FLASH). Новую асинхронную запись    \n 
+  *          из Callback запускать нельзя - только из основной программы.                                 \n 
+  *          Массив Words должен оставаться неизменным до окончания записи.                               \n 
+  *          Каждый банк FLASH имеет свой канал записи (Get_Bank_of_flash): массив должен находиться в     \n 
+  *          одном банке, записи в разные банки выполняются одновременно (FLASH_CONCURRENT_BANKS = 1).    \n 
+  *          Выборка команд из банка, в котором выполняется операция, останавливается на время операции,  \n 
+  *          программа выполняется между операциями (см. также FLASH_RAMFUNC_MODE, FLASH_BANK1_LAYOUT).
+  * @param   Address  - адрес начальной ячейки.
+  * @param   Amount   - количество записываемых слов.
+  * @param   Words    - указатель типа uint32_t* на массив с данными. Данные должны быть выровнены по 4 байта.
+  * @param   Callback - функция, вызываемая по окончании записи (может быть 0).
+  * @return  flash status: FLASH_OK - запись запущена, FLASH_BUSY - канал занят, FLASH_WROG_ADDRES - Address не выровнен по слову или массив вне FLASH (банка).
+  */
+flash_status Write_Words_to_flash_async (uint32_t Address, uint32_t Amount, uint32_t *Words, flash_callback Callback)
+{
+uint8_t bank;
+
+if ( (Amount == 0) || (Address & 3U) || (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_FLASH) ||
+     (Amount > (END_ADDR_OF_FLASH + 1 - Address) / 4) ) // Без переполнения Address + 4*Amount.
+  return FLASH_WROG_ADDRES;
+bank = Get_Bank_of_flash(Address);
+if ( (bank >= FLASH_BANKS_MAX) || (Get_Bank_of_flash(Address + 4*Amount - 1) != bank) )
+  return FLASH_WROG_ADDRES; // Массив должен находиться в одном банке.
+if ( Sync_active || Banks_busy(Address, 4*Amount) )
+  return FLASH_BUSY;
+
+Async[bank].Addr     = Address;
+Async[bank].Words    = Words;
+Async[bank].Amount   = Amount;
+Async[bank].Chunk    = 0;
+Async[bank].Callback = Callback;
+Async[bank].State    = FLASH_BUSY; // До разблокировки: Lock_if_idle другого канала не заблокирует FLASH.
+
+Unlock_flash();
+Enable_flash_IRQ(bank);
+Async_next(bank);
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Асинхронное стирание страницы FLASH.
+  * @details Запускает стирание страницы, содержащей адрес Address, и сразу возвращает управление.          \n 
+  *          Стирание выполняется каналом асинхронной записи банка (как Write_Words_to_flash_async):         \n 
+  *          окончание - Get_Bank_Async_Status или Callback (в контексте прерывания FLASH).                  \n 
+  *          Если страница уже стёрта, стирание не запускается: канал сразу завершается с FLASH_OK.
+  * @param   Address  - адрес внутри стираемой страницы.
+  * @param   Callback - функция, вызываемая по окончании стирания (может быть 0).
+  * @return  flash status: FLASH_OK - стирание запущено (или не требуется), FLASH_BUSY - канал занят.
+  */
+flash_status Erase_Page_of_flash_async (uint32_t Address, flash_callback Callback)
+{
+flash_status state;
+uint8_t      bank;
+
+if ( (Address < PAGE0_ADDR) || (Address > END_ADDR_OF_FLASH) )
+  return FLASH_WROG_ADDRES;
+bank = Get_Bank_of_flash(Address);
+if (bank >= FLASH_BANKS_MAX)
+  return FLASH_WROG_ADDRES;
+if ( Sync_active || Banks_busy(Address, 4) )
+  return FLASH_BUSY;
+
+Address = Get_Page_Start_of_flash(Address);
+Async[bank].Addr     = Address; // Начало страницы: Flash_page_erased и Async_next получают тот же адрес, что и при синхронном стирании.
+Async[bank].Words    = 0;
+Async[bank].Amount   = 0; // После стирания программировать нечего: Async_next завершит запись.
+Async[bank].Chunk    = 0;
+Async[bank].Callback = Callback;
+Async[bank].State    = FLASH_BUSY;
+
+if (Words_blank_in_flash(Address, Get_Page_Size_of_flash(Address) / 4))
+  {
+  Async_finish(bank, FLASH_OK);
+  return FLASH_OK;
+  }
+
+Unlock_flash();
+Enable_flash_IRQ(bank);
+state = Start_Erase_Page_of_flash(Address);
+if (state != FLASH_OK)
+  Async_finish(bank, state);
+else
+  Flash_page_erased(Address);
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Состояние асинхронной записи.
+  * @return  flash status: FLASH_BUSY - выполняется запись хотя бы в одном банке,                   \n 
+  *          иначе - FLASH_ERROR, если последняя запись хотя бы в одном банке завершилась ошибкой, или FLASH_OK.
+  */
+flash_status Get_Async_Status (void)
+{
+flash_status state = FLASH_OK;
+
+for (uint8_t bank = 0; bank < FLASH_BANKS_MAX; bank++)
+  {
+  if (Async[bank].State == FLASH_BUSY)
+    return FLASH_BUSY;
+  if (Async[bank].State != FLASH_OK)
+    state = Async[bank].State;
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Состояние асинхронной записи в банк FLASH.
+  * @param   Bank - номер банка FLASH (Get_Bank_of_flash).
+  * @return  flash status: FLASH_BUSY - запись выполняется, иначе - результат последней записи в банк.
+  */
+flash_status Get_Bank_Async_Status (uint8_t Bank)
+{
+if (Bank >= FLASH_BANKS_MAX)
+  return FLASH_WROG_ADDRES;
+return Async[Bank].State;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Окончание операции FLASH.
+  * @details Вызывается из обработчика прерывания FLASH аппаратного драйвера.
+  * @param   Bank  - номер банка FLASH, в котором окончилась операция.
+  * @param   State - результат операции (FLASH_OK или FLASH_ERROR).
   * @return  None.
   */
-__weak void Read_Config_from_flash (Config_struct* Config)
+void Flash_operation_complete (uint8_t Bank, flash_status State)
 {
-;
+if ( (Bank >= FLASH_BANKS_MAX) || (Async[Bank].State != FLASH_BUSY) )
+  return;
+
+if (State != FLASH_OK)
+  Async_finish(Bank, State);
+else
+  Async_next(Bank);
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief    RO_Constants  FLASH.
-  * @param   RO_Constants -   RO_Constants_struct*     RO_Constants.
+  * @brief   Учёт стирания страницы FLASH.
+  * @details Вызывается после каждого стирания страницы функциями FLASH.c (для асинхронной записи - после запуска \n 
+  *          стирания, из прерывания FLASH). По умолчанию ничего не делает, Erase_counters.c заменяет функцию       \n 
+  *          подсчётом стираний.
+  * @param   Address - адрес внутри стёртой страницы.
   * @return  None.
   */
-__weak void Read_RO_Constants_from_flash (RO_Constants_struct* RO_Constants)
+__weak void Flash_page_erased (uint32_t Address)
 {
-;
 }
 //------------------------------------------------------------------------------//
 
 
 /**
-  * @brief       FLASH.
-  * @details      FLASH.
-  * @param   Address -   .
-  * @param   Amount  -   .
-  * @param   Words   -   uint32_t*    .      4 .
+  * @brief   Окончание блокирующей записи или стирания.
+  * @details Вызывается функциями FLASH.c по окончании блокирующей записи, в которой FLASH разблокировалась \n 
+  *          (в контексте основной программы, FLASH заблокирована). По умолчанию ничего не делает,          \n 
+  *          Erase_counters.c заменяет функцию сохранением счётчиков стираний.
+  * @return  None.
+  */
+__weak void Flash_write_finished (void)
+{
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Размер страницы FLASH.
+  * @details По умолчанию - по геометрии FLASH (Flash_geometry.c).
+  * @param   Address - адрес внутри страницы.
+  * @return  uint32_t - размер страницы в байтах.
+  */
+__weak uint32_t Get_Page_Size_of_flash (uint32_t Address)
+{
+return Get_Geometry_Page_Size(Address);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запуск стирания страницы FLASH без ожидания окончания.
+  * @param   Address - адрес внутри стираемой страницы.
   * @return  flash status.
   */
-__weak flash_status Write_Words_to_flash (uint32_t Address, uint32_t Amount, uint32_t *Words)
+__weak flash_status Start_Erase_Page_of_flash (uint32_t Address)
 {
 return FLASH_ERROR;
 }
@@ -141,9 +865,176 @@ return FLASH_ERROR;
 
 
 /**
-  * @brief     Flash memory density.
-  * @details    FLASH  (Flash memory density)  (STM, GD, AT).
-  * @return  uint16_t -  FLASH    (STM, GD, AT)  Kbyte.
+  * @brief   Запуск программирования слова FLASH без ожидания окончания.
+  * @param   Address - адрес ячейки.
+  * @param   Word    - записываемое слово.
+  * @return  flash status.
+  */
+__weak flash_status Start_Program_Word_of_flash (uint32_t Address, uint32_t Word)
+{
+return FLASH_ERROR;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Расчёт CRC32 массива слов.
+  * @details По умолчанию - программный расчёт (Calc_CRC32_soft). Аппаратный драйвер заменяет функцию \n 
+  *          расчётом на блоке CRC микроконтроллера с тем же результатом.
+  * @param   Words  - указатель на массив слов.
+  * @param   Amount - количество слов.
+  * @return  uint32_t - CRC32.
+  */
+__weak uint32_t Calc_CRC32 (const uint32_t *Words, uint32_t Amount)
+{
+return Calc_CRC32_soft(Words, Amount);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Программный расчёт CRC32 массива слов.
+  * @details Табличный расчёт по байтам, результат совпадает с блоком CRC GD32/AT32:                  \n 
+  *          полином 0x04C11DB7, начальное значение 0xFFFFFFFF, слово обрабатывается начиная со старшего байта, \n 
+  *          без отражения и без итогового XOR.
+  * @param   Words  - указатель на массив слов.
+  * @param   Amount - количество слов.
+  * @return  uint32_t - CRC32.
+  */
+uint32_t Calc_CRC32_soft (const uint32_t *Words, uint32_t Amount)
+{
+uint32_t crc = 0xFFFFFFFFU;
+
+for (uint32_t i = 0; i < Amount; i++)
+  {
+  crc ^= Words[i];
+  crc  = (crc << 8) ^ Crc32_table[crc >> 24];
+  crc  = (crc << 8) ^ Crc32_table[crc >> 24];
+  crc  = (crc << 8) ^ Crc32_table[crc >> 24];
+  crc  = (crc << 8) ^ Crc32_table[crc >> 24];
+  }
+return crc;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   CRC32 области FLASH.
+  * @details Calc_CRC32 по словам области. Замена функции должна давать тот же результат (Calc_CRC32_soft): \n 
+  *          эталоны областей рассчитываются на ПК.
+  * @param   Address - начальный адрес области.
+  * @param   Size    - размер области в байтах (кратен 4).
+  * @return  uint32_t - CRC32 области.
+  */
+__weak uint32_t Calc_CRC32_of_area (uint32_t Address, uint32_t Size)
+{
+return Calc_CRC32((const uint32_t*)(uintptr_t)Address, Size / 4);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   CRC32 области FLASH из flash_region.
+  * @param   Region - область (FLASH_REGION_MAIN_PROGRAM ...).
+  * @return  uint32_t - CRC32 области (Calc_CRC32_of_area), 0 - неверная область.
+  */
+uint32_t Calc_Region_CRC32 (flash_region Region)
+{
+uint32_t address;
+uint32_t size;
+
+if (Get_Region_of_flash(Region, &address, &size) != FLASH_OK)
+  return 0;
+return Calc_CRC32_of_area(address, size);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Начальный адрес и размер области FLASH из flash_region.
+  * @details Страницы журнала Config Page - по Config_log_layout (на Medium-density - половины области Config Page).
+  * @param   Region  - область (FLASH_REGION_MAIN_PROGRAM ...).
+  * @param   Address - указатель для начального адреса области.
+  * @param   Size    - указатель для размера области в байтах.
+  * @return  flash status: FLASH_WROG_ADDRES - неверная область.
+  */
+flash_status Get_Region_of_flash (flash_region Region, uint32_t *Address, uint32_t *Size)
+{
+if (Region >= FLASH_REGIONS_NUM)
+  return FLASH_WROG_ADDRES;
+*Address = Regions[Region][0];
+*Size    = Regions[Region][1];
+if ( (Region == FLASH_REGION_CONFIG_PAGE) || (Region == FLASH_REGION_CONFIG_PAGE_B) )
+  {
+  Config_log_layout();
+  *Address = (Region == FLASH_REGION_CONFIG_PAGE) ? ADDR_CONFIG_PAGE : Config_page_b;
+  *Size    = Config_page_size;
+  }
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Проверка целостности области FLASH.
+  * @details Проверяются только области с постоянным содержимым: Main Programm, Download Buffer и RO Constants. \n 
+  *          Во время асинхронной записи возвращается FLASH_BUSY без ожидания: область может изменяться,         \n 
+  *          проверка повторяется после окончания записи (Get_Async_Status).
+  * @param   Region - область (FLASH_REGION_MAIN_PROGRAM, FLASH_REGION_DOWNLOAD_BUFFER, FLASH_REGION_RO_CONSTANTS).
+  * @param   Crc    - эталонный CRC32 области (Calc_Region_CRC32 или Calc_CRC32_soft образа на ПК).
+  * @return  flash status: FLASH_OK - CRC32 совпадает, FLASH_ERROR - не совпадает,                             \n 
+  *          FLASH_WROG_ADDRES - неверная или изменяемая область, FLASH_BUSY - выполняется асинхронная запись.
+  */
+flash_status Verify_Region_of_flash (flash_region Region, uint32_t Crc)
+{
+if ( (Region != FLASH_REGION_MAIN_PROGRAM) && (Region != FLASH_REGION_DOWNLOAD_BUFFER) && (Region != FLASH_REGION_RO_CONSTANTS) )
+  return FLASH_WROG_ADDRES;
+if (Get_Async_Status() == FLASH_BUSY)
+  return FLASH_BUSY;
+return (Calc_Region_CRC32(Region) == Crc) ? FLASH_OK : FLASH_ERROR;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Разрешение прерывания FLASH по окончании операции и по ошибке.
+  * @param   Bank - номер банка FLASH.
+  * @return  None.
+  */
+__weak void Enable_flash_IRQ (uint8_t Bank)
+{
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запрет прерывания FLASH.
+  * @param   Bank - номер банка FLASH.
+  * @return  None.
+  */
+__weak void Disable_flash_IRQ (uint8_t Bank)
+{
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Номер банка FLASH.
+  * @details По умолчанию - один банк (0).
+  * @param   Address - адрес ячейки.
+  * @return  uint8_t - номер банка FLASH, содержащего Address.
+  */
+__weak uint8_t Get_Bank_of_flash (uint32_t Address)
+{
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Чтение параметра Flash memory density.
+  * @details Чтение значения размера FLASH памяти (Flash memory density) микроконтроллера (STM, GD, AT).
+  * @return  uint16_t - размер FLASH памяти используемого микроконтроллера (STM, GD, AT) в Kbyte.
   */
 __weak uint16_t Read_MCU_FMD (void)
 {
@@ -153,6 +1044,403 @@ return 0;
 
 
 //---Private functions----------------------------------------------------------//
+/**
+  * @brief   Просмотр журнала Config Page.
+  * @details Определяет активную страницу журнала, её первый чистый слот и последнюю действительную запись. \n 
+  *          Результат сохраняется до следующей ошибки записи.
+  * @return  None.
+  */
+static void Config_log_scan (void)
+{
+uint32_t free_slot_a;
+
+if (Config_log_scanned)
+  return;
+
+Config_log_layout();
+Config_valid_addr = 0;
+Config_seq        = 0;
+free_slot_a = Config_page_scan(ADDR_CONFIG_PAGE);
+Config_page_scan(Config_page_b);
+
+if (Config_valid_addr == 0) // Действительных записей нет - запись начинается со страницы A.
+  {
+  Config_page      = ADDR_CONFIG_PAGE;
+  Config_free_slot = free_slot_a;
+  }
+Config_log_scanned = 1;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Размещение страниц журнала Config Page по геометрии FLASH.
+  * @details Если Config Page B (ADDR_CONFIG_PAGE_B) не помещается во FLASH (Medium-density, 128 Kbyte и меньше),   \n 
+  *          журнал ведётся на двух половинах области Config Page: страница A - ADDR_CONFIG_PAGE,                 \n 
+  *          страница B - ADDR_CONFIG_PAGE + MEMSIZE_CONFIG_PAGE * 512 (на Medium-density это страницы FLASH по 1 KB).
+  * @return  None.
+  */
+static void Config_log_layout (void)
+{
+if (Area_in_flash(ADDR_CONFIG_PAGE_B, MEMSIZE_CONFIG_PAGE_B * 1024))
+  {
+  Config_page_b    = ADDR_CONFIG_PAGE_B;
+  Config_page_size = MEMSIZE_CONFIG_PAGE * 1024;
+  }
+else
+  {
+  Config_page_size = MEMSIZE_CONFIG_PAGE * 1024 / 2;
+  Config_page_b    = ADDR_CONFIG_PAGE + Config_page_size;
+  }
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Просмотр одной страницы журнала Config Page.
+  * @details Записи занимают начало страницы без пропусков, поэтому первый чистый слот                  \n 
+  *          находится двоичным поиском по слову номера записи (не более log2(CONFIG_SLOTS)+1 чтений). \n 
+  *          Затем от него назад ищется последняя действительная запись (незавершённые записи пропускаются). \n 
+  *          Если её номер больше найденного ранее, страница становится активной.
+  * @param   Page - начальный адрес страницы журнала.
+  * @return  uint32_t - номер первого чистого слота страницы.
+  */
+static uint32_t Config_page_scan (uint32_t Page)
+{
+uint32_t low  = 0;
+uint32_t high = CONFIG_SLOTS;
+uint32_t middle;
+uint32_t slot_addr;
+
+while (low < high)
+  {
+  middle = (low + high) / 2;
+  if (*((uint32_t*)(uintptr_t)CONFIG_SLOT_ADDR(Page, middle)) == BLANK_WORD)
+    high = middle;
+  else
+    low = middle + 1;
+  }
+
+for (uint32_t slot = low; slot > 0; slot--)
+  {
+  slot_addr = CONFIG_SLOT_ADDR(Page, slot - 1);
+  if (Config_record_valid(slot_addr))
+    {
+    if ( (Config_valid_addr == 0) || ((int32_t)(*((uint32_t*)(uintptr_t)slot_addr) - Config_seq) > 0) )
+      {
+      Config_valid_addr = slot_addr;
+      Config_seq        = *((uint32_t*)(uintptr_t)slot_addr);
+      Config_page       = Page;
+      Config_free_slot  = low;
+      }
+    break;
+    }
+  }
+return low;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Проверка записи журнала Config Page.
+  * @details Запись действительна, если слово состояния равно CONFIG_RECORD_VALID ^ CRC32 номера записи и параметров \n 
+  *          (CONFIG_RECORD_VALID, если результат совпадает со значением стёртого слова - как в Write_Config_to_flash).
+  * @param   Slot_addr - адрес записи.
+  * @return  uint8_t - 1, если запись действительна.
+  */
+static uint8_t Config_record_valid (uint32_t Slot_addr)
+{
+uint32_t status = *((uint32_t*)(uintptr_t)(Slot_addr + CONFIG_STATUS_OFFSET));
+uint32_t expected;
+
+if (status == BLANK_WORD)
+  return 0; // Запись не зафиксирована.
+expected = CONFIG_RECORD_VALID ^ Calc_CRC32((const uint32_t*)(uintptr_t)Slot_addr, NUM_OF_CONFIG_WORDS + 1);
+if (expected == BLANK_WORD)
+  expected = CONFIG_RECORD_VALID;
+return (status == expected);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Стирание области FLASH.
+  * @details Стираются все страницы, занятые областью, с учётом их фактического размера. \n 
+  *          FLASH должна быть разблокирована (Unlock_flash).
+  * @param   Address - начальный адрес области (начало страницы).
+  * @param   Size    - размер области в байтах.
+  * @return  flash status.
+  */
+static flash_status Erase_Pages (uint32_t Address, uint32_t Size)
+{
+flash_status state = FLASH_OK;
+uint32_t     end   = Address + Size;
+
+while ( (Address < end) && (state == FLASH_OK) )
+  {
+  state    = Erase_page(Address);
+  Address += Get_Page_Size_of_flash(Address);
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Стирание страницы FLASH с учётом стирания (Flash_page_erased).
+  * @details FLASH должна быть разблокирована (Unlock_flash).
+  * @param   Address - адрес внутри стираемой страницы.
+  * @return  flash status.
+  */
+static flash_status Erase_page (uint32_t Address)
+{
+flash_status state = Erase_Page_of_flash(Address);
+
+if (state == FLASH_OK)
+  Flash_page_erased(Address);
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Перезапись части страницы со стиранием.
+  * @details Слова страницы копируются в Page_buffer, часть заменяется массивом Words, страница стирается  \n 
+  *          и программируются все нестёртые слова буфера. Массив на всю страницу записывается без копирования. \n 
+  *          При потере питания между стиранием и программированием данные страницы вне массива теряются.
+  * @param   Address - адрес начальной ячейки (массив не выходит за пределы страницы).
+  * @param   Amount  - количество слов.
+  * @param   Words   - указатель типа uint32_t* на массив с данными.
+  * @return  flash status: FLASH_ERROR - страница больше FLASH_PAGE_SIZE_MAX (страница не стирается).
+  */
+static flash_status Rewrite_page (uint32_t Address, uint32_t Amount, uint32_t *Words)
+{
+uint32_t     page_words = Get_Page_Size_of_flash(Address) / 4;
+uint32_t     page_start = Get_Page_Start_of_flash(Address);
+uint32_t     offset     = (Address - page_start) / 4;
+flash_status state;
+
+if (Amount == page_words)
+  {
+  state = Erase_page(page_start);
+  if (state == FLASH_OK)
+    state = Program_Words_to_flash(page_start, Amount, Words);
+  return state;
+  }
+if (page_words > FLASH_PAGE_SIZE_MAX / 4)
+  return FLASH_ERROR;
+
+for (uint32_t i = 0; i < page_words; i++)
+  {
+  Page_buffer[i] = *((uint32_t*)(uintptr_t)page_start + i);
+  }
+for (uint32_t i = 0; i < Amount; i++)
+  {
+  Page_buffer[offset + i] = Words[i];
+  }
+
+state = Erase_page(page_start);
+if (state == FLASH_OK)
+  state = Program_Changed_Words(page_start, page_words, Page_buffer); // Стёртые слова буфера не программируются.
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Сравнение массива слов с содержимым FLASH.
+  * @param   Address - адрес начальной ячейки (массив не выходит за пределы страницы).
+  * @param   Amount  - количество сравниваемых слов.
+  * @param   Words   - указатель типа uint32_t* на массив с данными.
+  * @return  flash_write_path - способ, которым можно записать массив.
+  */
+static flash_write_path Compare_Words (uint32_t Address, uint32_t Amount, uint32_t *Words)
+{
+flash_write_path path = FLASH_WRITE_SKIPPED;
+uint32_t         word;
+
+for (uint32_t i = 0; i < Amount; i++)
+  {
+  word = *((uint32_t*)(uintptr_t)Address + i);
+  if (word != *(Words + i))
+    {
+    if (word != BLANK_WORD)
+      return FLASH_WRITE_ERASED;
+    path = FLASH_WRITE_PROGRAMMED;
+    }
+  }
+return path;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Программирование только отличающихся слов массива.
+  * @details Отличающиеся слова должны быть стёрты (см. Compare_Words).                       \n 
+  *          Непрерывные группы отличающихся слов программируются одним вызовом Program_Words_to_flash.
+  * @param   Address - адрес начальной ячейки.
+  * @param   Amount  - количество слов.
+  * @param   Words   - указатель типа uint32_t* на массив с данными.
+  * @return  flash status.
+  */
+static flash_status Program_Changed_Words (uint32_t Address, uint32_t Amount, uint32_t *Words)
+{
+flash_status state = FLASH_OK;
+uint32_t     run;
+
+for (uint32_t i = 0; (i < Amount) && (state == FLASH_OK); i += run)
+  {
+  for (run = 0; (i + run < Amount) && (*((uint32_t*)(uintptr_t)Address + i + run) != *(Words + i + run)); run++)
+    ;
+  if (run == 0)
+    run = 1; // Слово совпадает - пропуск.
+  else
+    state = Program_Words_to_flash(Address + 4*i, run, Words + i);
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+/**
+  * @brief   Проверка занятости банков FLASH асинхронной записью.
+  * @details При FLASH_CONCURRENT_BANKS = 0 занятость любого банка делает недоступными все банки.
+  * @param   Address - начальный адрес области.
+  * @param   Size    - размер области в байтах.
+  * @return  uint8_t - 1, если область находится в банке, занятом асинхронной записью.
+  */
+static uint8_t Banks_busy (uint32_t Address, uint32_t Size)
+{
+uint8_t first = Get_Bank_of_flash(Address);
+uint8_t last  = Get_Bank_of_flash(Address + Size - 1);
+
+for (uint8_t bank = 0; bank < FLASH_BANKS_MAX; bank++)
+  {
+  if (Async[bank].State != FLASH_BUSY)
+    continue;
+  if ( !FLASH_CONCURRENT_BANKS || ( (bank >= first) && (bank <= last) ) )
+    return 1;
+  }
+return 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Разблокировка FLASH для блокирующей записи.
+  * @details Признак Sync_active устанавливается до разблокировки: окончание асинхронной записи \n 
+  *          в другом банке не заблокирует FLASH во время блокирующей записи.
+  * @return  None.
+  */
+static void Sync_unlock (void)
+{
+Sync_active = 1;
+Unlock_flash();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Окончание блокирующей записи.
+  * @details Flash_write_finished вызывается после блокировки: функция может выполнить следующую запись.
+  * @return  None.
+  */
+static void Sync_lock (void)
+{
+Sync_active = 0;
+Lock_if_idle();
+Flash_write_finished();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Блокировка FLASH, если не выполняется ни одна запись.
+  * @return  None.
+  */
+static void Lock_if_idle (void)
+{
+if (Sync_active)
+  return;
+for (uint8_t bank = 0; bank < FLASH_BANKS_MAX; bank++)
+  {
+  if (Async[bank].State == FLASH_BUSY)
+    return;
+  }
+Lock_flash();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запуск очередной операции асинхронной записи.
+  * @details В начале каждой страницы содержимое сравнивается с массивом (Compare_Words) и при необходимости \n 
+  *          запускается стирание страницы. Далее запускается программирование очередного отличающегося слова. \n 
+  *          Совпадающие слова пропускаются. Если операций не осталось, запись завершается (Async_finish).
+  * @param   Bank - номер банка FLASH (канал записи).
+  * @return  None.
+  */
+static void Async_next (uint8_t Bank)
+{
+async_channel *ch = &Async[Bank];
+flash_status   state;
+uint32_t       page_size;
+uint32_t       addr;
+uint32_t       word;
+
+while (ch->Amount > 0)
+  {
+  if (ch->Chunk == 0) // Начало очередной страницы.
+    {
+    page_size = Get_Page_Size_of_flash(ch->Addr);
+    ch->Chunk = (page_size - (ch->Addr & (page_size - 1))) / 4;
+    if (ch->Chunk > ch->Amount)
+      ch->Chunk = ch->Amount;
+
+    if (Compare_Words(ch->Addr, ch->Chunk, ch->Words) == FLASH_WRITE_ERASED)
+      {
+      state = Start_Erase_Page_of_flash(Get_Page_Start_of_flash(ch->Addr));
+      if (state != FLASH_OK)
+        Async_finish(Bank, state);
+      else
+        Flash_page_erased(Get_Page_Start_of_flash(ch->Addr));
+      return; // Программирование страницы - по окончании стирания.
+      }
+    }
+
+  addr = ch->Addr;
+  word = *ch->Words;
+  ch->Addr  += 4;
+  ch->Words += 1;
+  ch->Amount--;
+  ch->Chunk--;
+
+  if (*((uint32_t*)(uintptr_t)addr) != word)
+    {
+    state = Start_Program_Word_of_flash(addr, word);
+    if (state != FLASH_OK)
+      Async_finish(Bank, state);
+    return;
+    }
+  }
+Async_finish(Bank, FLASH_OK);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Завершение асинхронной записи.
+  * @param   Bank  - номер банка FLASH (канал записи).
+  * @param   State - результат записи.
+  * @return  None.
+  */
+static void Async_finish (uint8_t Bank, flash_status State)
+{
+Disable_flash_IRQ(Bank);
+Async[Bank].State = State;
+Lock_if_idle();
+if (Async[Bank].Callback != 0)
+  Async[Bank].Callback(State);
+}
 //------------------------------------------------------------------------------//
 
 
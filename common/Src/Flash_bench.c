@@ -0,0 +1,381 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Flash_bench.c
+  *
+  * @brief     Замеры времени и количества операций функций записи FLASH.
+  *
+  * @details   Постоянный набор замеров (flash_bench) выполняется одинаково на плате и на ПК: на плате время считается   \n
+  *            в тактах ядра (DWT, Get_Cycle_Counter), на ПК - в мкс модели FLASH (Host_Flash, Get_flash_sim_time).       \n
+  *            Результаты сравниваются между сборками и версиями, чтобы изменения пути записи были видны в числах.
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Run_Flash_bench (flash_bench_clock Clock, Flash_bench_result_struct *Results) - выполнение всех замеров.         \n
+  *   Clock - часы замеров (счётчик тактов DWT должен быть запущен). Results - массив из FLASH_BENCH_NUM результатов.    \n
+  *   Замеры стирают первые FLASH_BENCH_AREA_KB Kbyte Download Buffer и добавляют запись в журнал Config Page           \n
+  *   (текущие параметры записываются повторно). Вызывается из основной программы без асинхронной записи.             \n
+  *
+  * - Format_Flash_bench_report (const Flash_bench_result_struct *Results, const char *Unit, char *Text, uint32_t Size) - \n
+  *   отчёт в формате CSV: строка заголовка и строка на каждый замер. Unit - единица времени ("cycles", "us").          \n
+  *   На плате отчёт читается из RAM отладчиком или передаётся по любому интерфейсу, на ПК выводится make bench.          \n
+  *
+  * **Замеры**
+  * | Замер         | Подготовка (не входит в замер)          | Замер                                                  |
+  * | ------------- | --------------------------------------- | ------------------------------------------------------ |
+  * | config_save   | -                                       | Write_Config_to_flash текущих параметров               |
+  * | write_1k      | запись 1 KB данных 0                    | Write_Words_to_flash 1 KB данных 1                     |
+  * | write_4k      | запись 4 KB данных 0                    | Write_Words_to_flash 4 KB данных 1 частями по 1 KB     |
+  * | write_16k     | запись 16 KB данных 0                   | Write_Words_to_flash 16 KB данных 1 частями по 1 KB    |
+  * | verify_16k    | -                                       | сравнение 16 KB FLASH с данными 1                      |
+  * | blank_16k     | Erase_Area_of_flash 16 KB               | проверка 16 KB FLASH на стёртое значение               |
+  * | lz_unpack_16k | Pack_Image_lz 2 KB начала Main Programm | Unpack_Image_lz в RAM 8 раз (скорость распаковки)      |
+  * | log_init      | журнал в 16 KB, около 1,5 круга записей  | Init_Log_ring (поиск конца журнала)                    |
+  *
+  * Данные записываются из буфера 1 KB (FLASH_BENCH_CHUNK_WORDS), как при загрузке прошивки по интерфейсу;       \n
+  * заполнение буфера входит в замер. Количество стираний, программирований и итераций ожидания - разность          \n
+  * статистики аппаратного драйвера (Get_Flash_stats) до и после замера; при FLASH_STATS = 0 счётчики равны 0.      \n
+  * Замер lz_unpack_16k не обращается к контроллеру flash: сжимается код самой программы (FLASH_BENCH_LZ_BYTES), время  \n
+  * распаковки включает проверку CRC32. На ПК часы модели FLASH не учитывают время процессора (замер равен 0,         \n
+  * скорость распаковки на ПК выводит make bench). То же относится к замеру log_init: журнал занимает первые                \n 
+  * FLASH_BENCH_AREA_KB Kbyte Download Buffer (записи FLASH_BENCH_LOG_RECORD байт), на ПК make bench дополнительно выводит  \n 
+  * время Init_Log_ring журнала из 512 страниц. Такты ядра обоих замеров на платах не измерены (таблица результатов \n 
+  * замеров - common/Src/main.c).
+  *
+  * **Отчёт**
+  * | Столбец    | Содержимое                                                   |
+  * | ---------- | ------------------------------------------------------------ |
+  * | workload   | Название замера (таблица выше)                               |
+  * | time       | Время замера в единицах unit                                 |
+  * | unit       | cycles (плата, DWT) или us (модель на ПК)                     |
+  * | erases     | Стёрто страниц                                               |
+  * | programs   | Запрограммировано слов                                       |
+  * | busy_waits | Итераций ожидания готовности контроллера flash               |
+  * | status     | OK, ERROR, BUSY, WRONG_ADDRESS                                |
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Flash_bench.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define BENCH_WORD(Index, Seed)    ((uint32_t)(Index) * 0x9E3779B1U ^ (Seed))   /*!< Слово данных Seed с номером Index.          */
+#define BENCH_SEED_OLD             0x00000000U                                  /*!< Данные 0 (подготовка).                      */
+#define BENCH_SEED_NEW             0xA5A5A5A5U                                  /*!< Данные 1 (замер).                           */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint32_t                 Chunk[FLASH_BENCH_CHUNK_WORDS];  /*!< Буфер записи.                                      */
+static flash_bench_clock        Bench_clock;                     /*!< Часы замеров.                                      */
+static uint32_t                 Start_time;                      /*!< Время начала замера.                               */
+static Flash_stats_struct       Start_stats;                     /*!< Статистика аппаратного драйвера в начале замера.   */
+static uint32_t                 Lz_image[FLASH_BENCH_LZ_BYTES / 4];                       /*!< Распакованный образ lz_unpack_16k. */
+static uint8_t                  Lz_packed[IMAGE_LZ_PACKED_MAX(FLASH_BENCH_LZ_BYTES)];     /*!< Сжатый образ lz_unpack_16k.       */
+//------------------------------------------------------------------------------//
+
+//---Private constants----------------------------------------------------------//
+static const char *const Bench_names[FLASH_BENCH_NUM] = {"config_save", "write_1k", "write_4k", "write_16k", "verify_16k", "blank_16k", "lz_unpack_16k", "log_init"};
+static const char *const Status_names[]               = {"WRONG_ADDRESS", "OK", "ERROR", "BUSY"}; /*!< По flash_status. */
+static const uint16_t    Write_kb[]                   = {1, 4, 16};                               /*!< Объём замеров write_*. */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static void         Bench_start   (void);
+static void         Bench_stop    (Flash_bench_result_struct *Result, flash_status Status);
+static flash_status Write_area    (uint32_t Size_KB, uint32_t Seed);
+static flash_status Verify_area   (uint32_t Size_KB, uint32_t Seed);
+static flash_status Blank_area    (uint32_t Size_KB);
+static flash_status Unpack_area   (uint32_t Packed_size);
+static flash_status Fill_log      (uint16_t Pages);
+static void         Append_text   (char *Text, uint32_t Size, uint32_t *Length, const char *String);
+static void         Append_number (char *Text, uint32_t Size, uint32_t *Length, uint32_t Number);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Выполнение всех замеров.
+  * @param   Clock   - часы замеров (Get_Cycle_Counter на плате, Get_flash_sim_time на ПК).
+  * @param   Results - указатель на массив из FLASH_BENCH_NUM результатов (индекс - flash_bench).
+  * @return  flash status: FLASH_OK - все замеры выполнены, иначе результат первого невыполненного замера.
+  */
+flash_status Run_Flash_bench (flash_bench_clock Clock, Flash_bench_result_struct *Results)
+{
+flash_status  state = FLASH_OK;
+Config_struct config;
+uint32_t      packed;
+uint16_t      log_pages = (uint16_t)(FLASH_BENCH_AREA_KB * 1024 / Get_Page_Size_of_flash(ADDR_DOWNLOAD_BUFFER));
+
+Bench_clock = Clock;
+
+if (Read_Config_from_flash(&config) != FLASH_OK)
+  {
+  for (uint32_t i = 0; i < NUM_OF_CONFIG_WORDS; i++)
+    {
+    *((uint32_t*)&config + i) = 0;
+    }
+  }
+Bench_start();
+Bench_stop(&Results[FLASH_BENCH_CONFIG_SAVE], Write_Config_to_flash(&config));
+
+for (uint32_t i = 0; i < sizeof(Write_kb) / sizeof(Write_kb[0]); i++)
+  {
+  Write_area(Write_kb[i], BENCH_SEED_OLD);
+  Bench_start();
+  Bench_stop(&Results[FLASH_BENCH_WRITE_1K + i], Write_area(Write_kb[i], BENCH_SEED_NEW));
+  }
+
+Bench_start();
+Bench_stop(&Results[FLASH_BENCH_VERIFY_16K], Verify_area(FLASH_BENCH_AREA_KB, BENCH_SEED_NEW));
+
+Erase_Area_of_flash(ADDR_DOWNLOAD_BUFFER, FLASH_BENCH_AREA_KB * 1024);
+Bench_start();
+Bench_stop(&Results[FLASH_BENCH_BLANK_16K], Blank_area(FLASH_BENCH_AREA_KB));
+
+packed = Pack_Image_lz((const uint32_t*)ADDR_MAIN_PROGRAM, FLASH_BENCH_LZ_BYTES, Lz_packed, sizeof(Lz_packed));
+Bench_start();
+Bench_stop(&Results[FLASH_BENCH_LZ_UNPACK_16K], Unpack_area(packed));
+
+Fill_log(log_pages);
+Bench_start();
+Bench_stop(&Results[FLASH_BENCH_LOG_INIT], Init_Log_ring(ADDR_DOWNLOAD_BUFFER, log_pages, FLASH_BENCH_LOG_RECORD));
+
+for (uint32_t i = 0; (i < FLASH_BENCH_NUM) && (state == FLASH_OK); i++)
+  {
+  state = Results[i].Status;
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Отчёт о замерах в формате CSV.
+  * @details Строка заголовка "workload,time,unit,erases,programs,busy_waits,status" и строка на каждый замер,  \n
+  *          строки заканчиваются '\n'. Текст не длиннее Size - 1 символов и всегда заканчивается нулём.
+  * @param   Results - указатель на массив результатов Run_Flash_bench.
+  * @param   Unit    - единица времени ("cycles" или "us").
+  * @param   Text    - указатель на буфер для отчёта.
+  * @param   Size    - размер буфера в байтах (512 достаточно для полного отчёта).
+  * @return  uint32_t - длина отчёта без завершающего нуля.
+  */
+uint32_t Format_Flash_bench_report (const Flash_bench_result_struct *Results, const char *Unit, char *Text, uint32_t Size)
+{
+uint32_t length = 0;
+
+if (Size == 0)
+  return 0;
+Text[0] = 0;
+
+Append_text(Text, Size, &length, "workload,time,unit,erases,programs,busy_waits,status\n");
+for (uint32_t i = 0; i < FLASH_BENCH_NUM; i++)
+  {
+  Append_text  (Text, Size, &length, Bench_names[i]);
+  Append_text  (Text, Size, &length, ",");
+  Append_number(Text, Size, &length, Results[i].Time);
+  Append_text  (Text, Size, &length, ",");
+  Append_text  (Text, Size, &length, Unit);
+  Append_text  (Text, Size, &length, ",");
+  Append_number(Text, Size, &length, Results[i].Erases);
+  Append_text  (Text, Size, &length, ",");
+  Append_number(Text, Size, &length, Results[i].Programs);
+  Append_text  (Text, Size, &length, ",");
+  Append_number(Text, Size, &length, Results[i].Busy_waits);
+  Append_text  (Text, Size, &length, ",");
+  Append_text  (Text, Size, &length, Status_names[Results[i].Status]);
+  Append_text  (Text, Size, &length, "\n");
+  }
+return length;
+}
+//------------------------------------------------------------------------------//
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Начало замера: счётчики аппаратного драйвера и время.
+  * @return  None.
+  */
+static void Bench_start (void)
+{
+Get_Flash_stats(&Start_stats);
+Start_time = Bench_clock();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Окончание замера: разность времени и счётчиков аппаратного драйвера.
+  * @param   Result - указатель на результат замера.
+  * @param   Status - результат выполнения замера.
+  * @return  None.
+  */
+static void Bench_stop (Flash_bench_result_struct *Result, flash_status Status)
+{
+uint32_t           time = Bench_clock();
+Flash_stats_struct stats;
+
+Get_Flash_stats(&stats);
+Result->Time       = time - Start_time;
+Result->Erases     = stats.Erases     - Start_stats.Erases;
+Result->Programs   = stats.Programs   - Start_stats.Programs;
+Result->Busy_waits = stats.Busy_waits - Start_stats.Busy_waits;
+Result->Status     = Status;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись данных Seed в начало Download Buffer частями по FLASH_BENCH_CHUNK_WORDS слов.
+  * @param   Size_KB - объём в Kbyte.
+  * @param   Seed    - данные (BENCH_SEED_OLD или BENCH_SEED_NEW).
+  * @return  flash status (см. Write_Words_to_flash).
+  */
+static flash_status Write_area (uint32_t Size_KB, uint32_t Seed)
+{
+flash_status state = FLASH_OK;
+
+for (uint32_t index = 0; (index < Size_KB * 256) && (state == FLASH_OK); index += FLASH_BENCH_CHUNK_WORDS)
+  {
+  for (uint32_t i = 0; i < FLASH_BENCH_CHUNK_WORDS; i++)
+    {
+    Chunk[i] = BENCH_WORD(index + i, Seed);
+    }
+  state = Write_Words_to_flash(ADDR_DOWNLOAD_BUFFER + 4*index, FLASH_BENCH_CHUNK_WORDS, Chunk);
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Сравнение начала Download Buffer с данными Seed.
+  * @param   Size_KB - объём в Kbyte.
+  * @param   Seed    - данные.
+  * @return  flash status: FLASH_ERROR - данные не совпадают.
+  */
+static flash_status Verify_area (uint32_t Size_KB, uint32_t Seed)
+{
+const uint32_t *flash = (const uint32_t*)ADDR_DOWNLOAD_BUFFER;
+
+for (uint32_t i = 0; i < Size_KB * 256; i++)
+  {
+  if (flash[i] != BENCH_WORD(i, Seed))
+    return FLASH_ERROR;
+  }
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Проверка, что начало Download Buffer стёрто.
+  * @param   Size_KB - объём в Kbyte.
+  * @return  flash status: FLASH_ERROR - есть не стёртые слова.
+  */
+static flash_status Blank_area (uint32_t Size_KB)
+{
+const uint32_t *flash = (const uint32_t*)ADDR_DOWNLOAD_BUFFER;
+
+for (uint32_t i = 0; i < Size_KB * 256; i++)
+  {
+  if (flash[i] != BLANK_WORD)
+    return FLASH_ERROR;
+  }
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Распаковка сжатого образа Lz_packed в RAM, пока не распаковано FLASH_BENCH_AREA_KB Kbyte.
+  * @param   Packed_size - размер сжатого образа в байтах (0 - образ не сжат).
+  * @return  flash status: FLASH_ERROR - сжатые данные или CRC32 образа неверны.
+  */
+static flash_status Unpack_area (uint32_t Packed_size)
+{
+flash_status state = (Packed_size != 0) ? FLASH_OK : FLASH_ERROR;
+uint32_t     size  = 0;
+
+for (uint32_t i = 0; (i < FLASH_BENCH_AREA_KB * 1024 / FLASH_BENCH_LZ_BYTES) && (state == FLASH_OK); i++)
+  {
+  state = Unpack_Image_lz(Lz_packed, Packed_size, Lz_image, sizeof(Lz_image), &size);
+  }
+if ( (state == FLASH_OK) && (size != FLASH_BENCH_LZ_BYTES) )
+  state = FLASH_ERROR;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Журнал замера log_init в начале Download Buffer.
+  * @details Область стирается, журнал записывается примерно на полтора круга: конец журнала - в середине диапазона, \n 
+  *          перед ним - страницы текущего круга, за ним - страницы предыдущего.
+  * @param   Pages - количество страниц журнала.
+  * @return  flash status (см. Init_Log_ring, Append_Log_to_flash).
+  */
+static flash_status Fill_log (uint16_t Pages)
+{
+flash_status state   = Erase_Area_of_flash(ADDR_DOWNLOAD_BUFFER, FLASH_BENCH_AREA_KB * 1024);
+uint32_t     records = (uint32_t)Pages * 3 / 2 * (Get_Page_Size_of_flash(ADDR_DOWNLOAD_BUFFER) / (FLASH_BENCH_LOG_RECORD + 4));
+
+if (state == FLASH_OK)
+  state = Init_Log_ring(ADDR_DOWNLOAD_BUFFER, Pages, FLASH_BENCH_LOG_RECORD);
+for (uint32_t i = 0; (i < records) && (state == FLASH_OK); i++)
+  {
+  Chunk[0] = i;
+  state = Append_Log_to_flash(Chunk);
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Добавление строки к отчёту.
+  * @param   Text   - указатель на буфер отчёта.
+  * @param   Size   - размер буфера в байтах.
+  * @param   Length - указатель на текущую длину отчёта.
+  * @param   String - добавляемая строка (не помещающиеся символы отбрасываются).
+  * @return  None.
+  */
+static void Append_text (char *Text, uint32_t Size, uint32_t *Length, const char *String)
+{
+while ( (*String != 0) && (*Length + 1 < Size) )
+  {
+  Text[(*Length)++] = *String++;
+  }
+Text[*Length] = 0;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Добавление десятичного числа к отчёту.
+  * @param   Text   - указатель на буфер отчёта.
+  * @param   Size   - размер буфера в байтах.
+  * @param   Length - указатель на текущую длину отчёта.
+  * @param   Number - число.
+  * @return  None.
+  */
+static void Append_number (char *Text, uint32_t Size, uint32_t *Length, uint32_t Number)
+{
+char     digits[11];
+uint32_t i = sizeof(digits) - 1;
+
+digits[i] = 0;
+do
+  {
+  digits[--i] = (char)('0' + Number % 10);
+  Number     /= 10;
+  } while (Number != 0);
+Append_text(Text, Size, Length, &digits[i]);
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
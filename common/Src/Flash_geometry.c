@@ -0,0 +1,262 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Flash_geometry.c
+  *
+  * @brief     Геометрия FLASH: плотность, размеры и номера страниц по объёму FLASH микроконтроллера.
+  *
+  * @details   Плотность (density) определяется при старте по объёму FLASH (Read_MCU_FMD: FMC_SIZE на GD32F103,     \n
+  *            FLASH_SIZE на AT32F413), поэтому одна прошивка работает на вариантах плат от 128 Kbyte до 1 Mbyte.      \n
+  *            Страницы FLASH описываются таблицей участков с одним размером страницы (не более FLASH_SEGMENTS_MAX):    \n
+  *            номер, начало и размер страницы по адресу вычисляются сдвигом за постоянное время, без перебора страниц. \n
+  *            Через модуль работают Get_Page_Size_of_flash аппаратных драйверов, проверки адресов стирания и         \n
+  *            программирования (FLASH.c, FLASH_GD32F103R.c, AT_flash.c) и номера страниц счётчиков стираний.
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Init_flash_geometry (void) - определение геометрии. Вызывается при старте до первой записи во FLASH (при первом      \n
+  *   обращении к геометрии вызывается автоматически; результат, в том числе неподдерживаемый объём FLASH, сохраняется).  \n
+  *   FLASH_WROG_ADDRES - объём FLASH не поддерживается или области раскладки FLASH.h (flash_region, до FLASH_LAYOUT_END)  \n
+  *   не помещаются во FLASH или не выровнены по страницам: например, сборка с FLASH_BANK1_LAYOUT на плате без bank1.      \n
+  *   Таблица страниц заполняется и в этом случае: области, которые не помещаются, отключаются (модули проверяют          \n
+  *   Area_in_flash), остальные работают. При неподдерживаемом объёме страниц нет: все адреса вне FLASH.                   \n
+  *
+  * - Area_in_flash (uint32_t Address, uint32_t Size) - область помещается во FLASH и выровнена по страницам.              \n
+  *
+  * - Get_flash_geometry (void) - указатель на геометрию (плотность, объём, банки, участки).                               \n
+  *
+  * - Get_Page_Index_of_flash (uint32_t Address) - номер страницы от PAGE0_ADDR (FLASH_PAGE_NONE - адрес вне FLASH),       \n
+  *   Get_Page_Start_of_flash (uint32_t Address) - начало страницы, Get_Page_Addr_of_flash (uint32_t Index) - начало         \n
+  *   страницы по номеру, Get_Geometry_Page_Size (uint32_t Address) - размер страницы.                                       \n
+  *
+  * **Геометрия по объёму FLASH**
+  * | Плотность     | Объём              | Участки                                                          |
+  * | ------------- | :----------------: | :--------------------------------------------------------------: |
+  * | Medium        | 16 ... 128 Kbyte   | страницы 1 KB                                                    |
+  * | High          | 129 ... 512 Kbyte  | страницы 2 KB                                                    |
+  * | Extra         | 513 ... 3072 Kbyte | bank0: Page 0 - 255 по 2 KB, bank1 (ADDR_OF_BANK1): по 4 KB       |
+  *
+  * AT32F413 (64 ... 256 Kbyte) имеет ту же организацию секторов, что и GD32F103 того же объёма.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Flash_geometry.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define PAGE_SHIFT_1KB          10U     /*!< Страница 1 KB.                                                */
+#define PAGE_SHIFT_2KB          11U     /*!< Страница 2 KB.                                                */
+#define PAGE_SHIFT_4KB          12U     /*!< Страница 4 KB.                                                */
+#define PAGE_SIZE_DEFAULT       0x800U  /*!< Размер страницы, если геометрия не определена.                */
+#define DENSITY_MEDIUM_MIN      16U     /*!< Наименьший объём FLASH в Kbyte.                               */
+#define DENSITY_MEDIUM_MAX      128U    /*!< Наибольший объём Medium-density в Kbyte.                      */
+#define DENSITY_HIGH_MAX        512U    /*!< Наибольший объём High-density в Kbyte (объём bank0).          */
+#define DENSITY_EXTRA_MAX       3072U   /*!< Наибольший объём Extra-density в Kbyte.                       */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static Flash_geometry_struct Geometry = {.Density = FLASH_DENSITY_UNKNOWN, .End_addr = PAGE0_ADDR}; /*!< Геометрия FLASH.                                                 */
+static uint8_t               Ready    = 0;                                                          /*!< 1 - Init_flash_geometry выполнена (и для неподдерживаемого объёма). */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static void                        Geometry_add      (uint32_t End, uint8_t Shift);
+static const Flash_segment_struct *Geometry_segment  (uint32_t Address);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Определение геометрии FLASH по объёму (Read_MCU_FMD).
+  * @details Заполняет таблицу участков и проверяет, что области flash_region помещаются во FLASH и начинаются    \n
+  *          и заканчиваются на границах страниц.
+  * @return  flash status: FLASH_OK, FLASH_WROG_ADDRES - объём FLASH не поддерживается или раскладка FLASH.h   \n
+  *          не соответствует FLASH микроконтроллера (области, которые не помещаются, отключаются).
+  */
+flash_status Init_flash_geometry (void)
+{
+uint16_t size = Read_MCU_FMD();
+uint32_t address;
+uint32_t length;
+
+Ready               = 1;
+Geometry.Size_KB    = size;
+Geometry.End_addr   = PAGE0_ADDR;
+Geometry.Bank1_addr = 0;
+Geometry.Pages      = 0;
+Geometry.Segments   = 0;
+
+if ( (size >= DENSITY_MEDIUM_MIN) && (size <= DENSITY_MEDIUM_MAX) )
+  {
+  Geometry.Density = FLASH_DENSITY_MEDIUM;
+  Geometry_add(PAGE0_ADDR + size * 1024U, PAGE_SHIFT_1KB);
+  }
+else if ( (size > DENSITY_MEDIUM_MAX) && (size <= DENSITY_HIGH_MAX) )
+  {
+  Geometry.Density = FLASH_DENSITY_HIGH;
+  Geometry_add(PAGE0_ADDR + size * 1024U, PAGE_SHIFT_2KB);
+  }
+else if ( (size > DENSITY_HIGH_MAX) && (size <= DENSITY_EXTRA_MAX) )
+  {
+  Geometry.Density    = FLASH_DENSITY_EXTRA;
+  Geometry.Bank1_addr = ADDR_OF_BANK1;
+  Geometry_add(ADDR_OF_BANK1, PAGE_SHIFT_2KB);
+  Geometry_add(PAGE0_ADDR + size * 1024U, PAGE_SHIFT_4KB);
+  }
+else
+  {
+  Geometry.Density = FLASH_DENSITY_UNKNOWN;
+  return FLASH_WROG_ADDRES;
+  }
+
+for (uint8_t region = 0; region < FLASH_REGIONS_NUM; region++)
+  {
+  Get_Region_of_flash((flash_region)region, &address, &length);
+  if (!Area_in_flash(address, length))
+    return FLASH_WROG_ADDRES;
+  }
+return (FLASH_LAYOUT_END <= Geometry.End_addr) ? FLASH_OK : FLASH_WROG_ADDRES;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Геометрия FLASH.
+  * @details Если Init_flash_geometry ещё не вызывалась, вызывается она. Результат сохраняется: при                   \n
+  *          неподдерживаемом объёме FLASH (FLASH_DENSITY_UNKNOWN, нет страниц) повторно не вызывается.
+  * @return  const Flash_geometry_struct* - указатель на геометрию.
+  */
+const Flash_geometry_struct *Get_flash_geometry (void)
+{
+if (!Ready)
+  Init_flash_geometry();
+return &Geometry;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Размещение области во FLASH.
+  * @param   Address - начальный адрес области.
+  * @param   Size    - размер области в байтах.
+  * @return  uint8_t - 1, если область помещается во FLASH и начинается и заканчивается на границах страниц.
+  */
+uint8_t Area_in_flash (uint32_t Address, uint32_t Size)
+{
+uint32_t end = Get_flash_geometry()->End_addr;
+
+if ( (Address < PAGE0_ADDR) || (Address > end) || (Size > end - Address) )
+  return 0;
+return (Get_Page_Start_of_flash(Address) == Address) &&
+       ( (Address + Size == end) || (Get_Page_Start_of_flash(Address + Size) == Address + Size) );
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Номер страницы FLASH.
+  * @param   Address - адрес внутри страницы.
+  * @return  uint32_t - номер страницы от PAGE0_ADDR (Page 0), FLASH_PAGE_NONE - адрес вне FLASH.
+  */
+uint32_t Get_Page_Index_of_flash (uint32_t Address)
+{
+const Flash_segment_struct *segment;
+
+if ( (Address < PAGE0_ADDR) || (Address >= Get_flash_geometry()->End_addr) )
+  return FLASH_PAGE_NONE;
+segment = Geometry_segment(Address);
+return segment->First_page + ((Address - segment->Start) >> segment->Shift);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Начальный адрес страницы FLASH.
+  * @param   Address - адрес внутри страницы.
+  * @return  uint32_t - адрес начала страницы (Address - адрес вне FLASH).
+  */
+uint32_t Get_Page_Start_of_flash (uint32_t Address)
+{
+const Flash_segment_struct *segment;
+
+if ( (Address < PAGE0_ADDR) || (Address >= Get_flash_geometry()->End_addr) )
+  return Address;
+segment = Geometry_segment(Address);
+return segment->Start + (((Address - segment->Start) >> segment->Shift) << segment->Shift);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Начальный адрес страницы FLASH по номеру.
+  * @param   Index - номер страницы от PAGE0_ADDR.
+  * @return  uint32_t - адрес начала страницы, 0 - страницы с номером Index нет.
+  */
+uint32_t Get_Page_Addr_of_flash (uint32_t Index)
+{
+const Flash_segment_struct *segment;
+
+if (Index >= Get_flash_geometry()->Pages)
+  return 0;
+segment = &Geometry.Segment[(Geometry.Segments > 1) && (Index >= Geometry.Segment[1].First_page)];
+return segment->Start + ((Index - segment->First_page) << segment->Shift);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Размер страницы FLASH по геометрии.
+  * @details Для адреса вне FLASH - размер страницы ближайшего участка (циклы по страницам не зацикливаются), \n
+  *          если геометрия не определена - 2 KB.
+  * @param   Address - адрес внутри страницы.
+  * @return  uint32_t - размер страницы в байтах.
+  */
+uint32_t Get_Geometry_Page_Size (uint32_t Address)
+{
+if (Get_flash_geometry()->Segments == 0)
+  return PAGE_SIZE_DEFAULT;
+return 1U << Geometry_segment(Address)->Shift;
+}
+//------------------------------------------------------------------------------//
+
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Добавление участка страниц одного размера от конца предыдущего участка до End.
+  * @param   End   - адрес, следующий за последней страницей участка.
+  * @param   Shift - размер страницы: 1 << Shift байт.
+  * @return  None.
+  */
+static void Geometry_add (uint32_t End, uint8_t Shift)
+{
+Flash_segment_struct *segment = &Geometry.Segment[Geometry.Segments++];
+
+segment->Start      = Geometry.End_addr;
+segment->End        = End;
+segment->First_page = Geometry.Pages;
+segment->Shift      = Shift;
+Geometry.Pages     += (End - segment->Start) >> Shift;
+Geometry.End_addr   = End;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Участок, содержащий адрес.
+  * @details Участков не больше двух: выбор одним сравнением с началом второго участка.
+  * @param   Address - адрес FLASH.
+  * @return  const Flash_segment_struct* - участок (для адреса вне FLASH - ближайший).
+  */
+static const Flash_segment_struct *Geometry_segment (uint32_t Address)
+{
+return &Geometry.Segment[(Geometry.Segments > 1) && (Address >= Geometry.Segment[1].Start)];
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
@@ -0,0 +1,373 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_delta.c
+  *
+  * @brief     Разностное обновление прошивки: применение патча к Main Programm с записью в Download Buffer.
+  *
+  * @details   Вместо образа передаётся патч: команды копирования участков прежнего образа (Main Programm,              \n
+  *            ADDR_MAIN_PROGRAM) и вставки новых байт. Новый образ собирается по мере приёма патча и записывается     \n
+  *            в Download Buffer конвейером Image_writer.c (стирание страниц заранее). Прежний образ читается прямо     \n
+  *            из FLASH, поэтому RAM ограничена буфером приёма (IMAGE_DELTA_INPUT_BYTES). Патч создаётся на ПК            \n
+  *            (Host_Flash: image_diff), после записи новый образ устанавливается Install_Image (Image_install.c).
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Open_Image_delta (void) - начало приёма патча. После приёма заголовка проверяется CRC32 прежнего образа в         \n
+  *   Main Programm (патч создан для другой версии - FLASH_ERROR) и открывается Image_writer.                             \n
+  *
+  * - Write_Image_delta_chunk (const uint8_t *Data, uint32_t Length) - приём очередной части патча (не более              \n
+  *   IMAGE_DELTA_INPUT_BYTES байт). Часть принимается целиком или не принимается: FLASH_BUSY - буфер приёма заполнен,   \n
+  *   так как Image_writer не принимает данные (выполняется стирание страницы), передатчик повторяет часть позже.         \n
+  *
+  * - Finalize_Image_delta (void) - окончание приёма: запись остатка и проверка CRC32 нового образа                         \n
+  *   (Finalize_Image_writer). Вызывается повторно, пока возвращает FLASH_BUSY.                                          \n
+  *
+  * - Get_Image_delta_size (void) - размер нового образа из заголовка (0 - заголовок не принят).                           \n
+  *
+  * **Формат патча**
+  * | Поле             | Размер         | Содержимое                                                                    |
+  * | ---------------- | :------------: | :---------------------------------------------------------------------------: |
+  * | Заголовок        | 5 слов         | IMAGE_DELTA_TAG, размер и CRC32 нового образа, размер и CRC32 прежнего        |
+  * | Вставка          | 1 + N байт     | N - 1 (0x00 ... 0x7F), затем N байт нового образа                             |
+  * | Копирование      | 1 + 2 ... 10   | IMAGE_DELTA_COPY, длина, сдвиг начала относительно курсора прежнего образа    |
+  *
+  * Слова заголовка - little-endian, длина и сдвиг копирования - LEB128 (7 бит в байте, младшие первыми), сдвиг -      \n
+  * со знаком (zigzag: 0, -1, 1, -2 ... кодируются 0, 1, 2, 3 ...). Курсор прежнего образа после копирования указывает    \n
+  * на конец скопированного участка, после вставки сдвигается на N байт (вставка заменяет столько же прежних байт):     \n
+  * неизменённый код после изменённого участка копируется со сдвигом 0. CRC32 (Calc_CRC32) - по словам образа,          \n
+  * дополненного до слова байтами 0xFF, прежний образ - по словам Main Programm (как записывает Install_Image).           \n
+  * Функции модуля вызываются из основной программы (не из прерываний), Main Programm не изменяется до окончания          \n
+  * записи Download Buffer.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Image_delta.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define INPUT_TAIL_BYTES        10U                                                       /*!< Незавершённая команда копирования.     */
+#define FLUSH_BYTES             128U                                                      /*!< Наибольшая часть Write_Image_chunk.    */
+#define VARINT_BAD              0xFFU                                                     /*!< Delta_varint: число длиннее 5 байт.    */
+#define DELTA_READ32(Bytes)     ((uint32_t)(Bytes)[0] | (uint32_t)(Bytes)[1] << 8 | (uint32_t)(Bytes)[2] << 16 | (uint32_t)(Bytes)[3] << 24)
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static flash_status Delta_state  = FLASH_OK;                  /*!< FLASH_BUSY - патч принимается, FLASH_OK - приём закрыт, иначе - ошибка. */
+static uint8_t      Header_done  = 0;                         /*!< 1 - заголовок принят, Image_writer открыт.                 */
+static uint32_t     Image_size   = 0;                         /*!< Размер нового образа в байтах.                             */
+static uint32_t     Image_crc    = 0;                         /*!< CRC32 нового образа.                                       */
+static uint32_t     Old_size     = 0;                         /*!< Размер прежнего образа в байтах.                           */
+static uint32_t     Old_pos      = 0;                         /*!< Курсор прежнего образа.                                    */
+static uint32_t     Written      = 0;                         /*!< Количество байт нового образа, принятых Write_Image_chunk. */
+static uint8_t      Copying      = 0;                         /*!< 1 - выполняется копирование, 0 - вставка.                  */
+static uint32_t     Op_left      = 0;                         /*!< Количество байт текущей команды, ещё не записанных.        */
+static uint8_t      Starved      = 0;                         /*!< 1 - команды остановлены: данные патча приняты не полностью. */
+static uint32_t     Input_count  = 0;                         /*!< Количество байт в буфере приёма.                           */
+static uint8_t      Input[IMAGE_DELTA_INPUT_BYTES + INPUT_TAIL_BYTES]; /*!< Буфер приёма патча.                                        */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static flash_status Delta_step    (void);
+static flash_status Delta_header  (void);
+static flash_status Delta_apply   (void);
+static uint32_t     Delta_varint  (const uint8_t *Data, uint32_t Count, uint32_t *Value);
+static flash_status Delta_fail    (flash_status State);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Начало приёма патча.
+  * @return  flash status: FLASH_OK.
+  */
+flash_status Open_Image_delta (void)
+{
+Header_done = 0;
+Image_size  = 0;
+Image_crc   = 0;
+Old_size    = 0;
+Old_pos     = 0;
+Written     = 0;
+Copying     = 0;
+Op_left     = 0;
+Starved     = 0;
+Input_count = 0;
+Delta_state = FLASH_BUSY;
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Приём очередной части патча.
+  * @details Часть копируется в буфер приёма целиком или не принимается (FLASH_BUSY).                    \n
+  *          Команды патча выполняются, пока Image_writer принимает данные.
+  * @param   Data   - указатель на данные.
+  * @param   Length - количество байт (не более IMAGE_DELTA_INPUT_BYTES).
+  * @return  flash status: FLASH_OK - часть принята, FLASH_BUSY - буфер заполнен, повторить позже,             \n
+  *          FLASH_WROG_ADDRES - часть больше буфера или неверный размер образа, FLASH_ERROR - патч создан      \n
+  *          для другого образа или неверен, ошибка записи или приём не открыт.
+  */
+flash_status Write_Image_delta_chunk (const uint8_t *Data, uint32_t Length)
+{
+flash_status state;
+
+if (Delta_state != FLASH_BUSY)
+  return (Delta_state == FLASH_OK) ? FLASH_ERROR : Delta_state;
+if (Length > IMAGE_DELTA_INPUT_BYTES)
+  return FLASH_WROG_ADDRES;
+
+state = Delta_step();
+if (state != FLASH_OK)
+  return state;
+if (Input_count + Length > sizeof(Input))
+  return FLASH_BUSY; // Часть принимается и при незавершённой команде в буфере.
+
+for (uint32_t i = 0; i < Length; i++)
+  {
+  Input[Input_count + i] = Data[i];
+  }
+Input_count += Length;
+return Delta_step();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Окончание приёма патча.
+  * @details Выполнение оставшихся команд, затем Finalize_Image_writer с CRC32 из заголовка.    \n
+  *          Пока команды не выполнены, возвращается FLASH_BUSY.
+  * @return  flash status: FLASH_OK - образ записан и CRC32 совпадает, FLASH_BUSY - повторить позже,    \n
+  *          FLASH_ERROR - патч неполный, ошибка записи или CRC32 не совпадает.
+  */
+flash_status Finalize_Image_delta (void)
+{
+flash_status state;
+
+if (Delta_state != FLASH_BUSY)
+  return (Delta_state == FLASH_OK) ? FLASH_ERROR : Delta_state;
+
+state = Delta_step();
+if (state != FLASH_OK)
+  return state;
+if (!Header_done)
+  return (Input_count < IMAGE_DELTA_HEADER_BYTES) ? Delta_fail(FLASH_ERROR) : FLASH_BUSY;
+if (Written < Image_size)
+  return Starved ? Delta_fail(FLASH_ERROR) : FLASH_BUSY; // Патч оборван или Image_writer занят.
+
+state = Finalize_Image_writer(Image_crc);
+if (state == FLASH_BUSY)
+  return FLASH_BUSY;
+Delta_state = FLASH_OK;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Размер нового образа.
+  * @return  uint32_t - размер из заголовка патча в байтах, 0 - заголовок ещё не принят.
+  */
+uint32_t Get_Image_delta_size (void)
+{
+return Image_size;
+}
+//------------------------------------------------------------------------------//
+
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Очередной шаг приёма патча: заголовок, затем команды.
+  * @return  flash status: FLASH_OK (в том числе, если Image_writer занят) или ошибка.
+  */
+static flash_status Delta_step (void)
+{
+flash_status state;
+
+if (!Header_done)
+  {
+  state = Delta_header();
+  if ( (state != FLASH_OK) || !Header_done )
+    return state;
+  }
+state = Delta_apply();
+return (state == FLASH_OK) ? FLASH_OK : Delta_fail(state);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Разбор заголовка патча.
+  * @details Прежний образ должен помещаться в Main Programm и совпадать по CRC32 с заголовком.
+  * @return  flash status: FLASH_OK (Header_done = 1 - заголовок принят) или ошибка.
+  */
+static flash_status Delta_header (void)
+{
+flash_status state;
+
+if (Input_count < IMAGE_DELTA_HEADER_BYTES)
+  return FLASH_OK;
+if (DELTA_READ32(Input) != IMAGE_DELTA_TAG)
+  return Delta_fail(FLASH_ERROR);
+Old_size = DELTA_READ32(Input + 12);
+if (Old_size > MEMSIZE_MAIN_PROGRAM * 1024)
+  return Delta_fail(FLASH_WROG_ADDRES);
+if (Calc_CRC32((const uint32_t*)ADDR_MAIN_PROGRAM, (Old_size + 3U) / 4) != DELTA_READ32(Input + 16))
+  return Delta_fail(FLASH_ERROR); // Патч создан для другой версии Main Programm.
+
+state = Open_Image_writer(DELTA_READ32(Input + 4));
+if (state == FLASH_BUSY)
+  return FLASH_OK; // Не окончено стирание предыдущей записи Image_writer.
+if (state != FLASH_OK)
+  return Delta_fail(state);
+Image_size   = DELTA_READ32(Input + 4);
+Image_crc    = DELTA_READ32(Input + 8);
+Header_done  = 1;
+Input_count -= IMAGE_DELTA_HEADER_BYTES;
+for (uint32_t i = 0; i < Input_count; i++)
+  {
+  Input[i] = Input[IMAGE_DELTA_HEADER_BYTES + i];
+  }
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Выполнение команд патча из буфера приёма.
+  * @details Выполнение останавливается, если команда принята не полностью или Image_writer не принимает данные.
+  * @return  flash status: FLASH_OK или ошибка (неверная команда, ошибка записи).
+  */
+static flash_status Delta_apply (void)
+{
+flash_status state = FLASH_OK;
+uint32_t     pos   = 0;
+uint32_t     used;
+uint32_t     length;
+uint32_t     shift;
+uint32_t     piece;
+
+Starved = 0;
+while (state == FLASH_OK)
+  {
+  if (Op_left == 0)
+    {
+    Starved = (Written < Image_size);
+    if ( (Written == Image_size) || (pos >= Input_count) )
+      break;
+    if (Input[pos] < IMAGE_DELTA_COPY)
+      {
+      Copying = 0;
+      Op_left = Input[pos] + 1U;
+      used    = 1;
+      }
+    else
+      {
+      used = Delta_varint(&Input[pos + 1], Input_count - pos - 1, &length);
+      if ( (used == 0) || (used == VARINT_BAD) )
+        {
+        state = (used == 0) ? FLASH_OK : FLASH_ERROR;
+        break; // Команда принята не полностью или неверна.
+        }
+      piece = Delta_varint(&Input[pos + 1 + used], Input_count - pos - 1 - used, &shift);
+      if ( (piece == 0) || (piece == VARINT_BAD) )
+        {
+        state = (piece == 0) ? FLASH_OK : FLASH_ERROR;
+        break;
+        }
+      used   += 1 + piece;
+      Old_pos = (shift & 1) ? Old_pos - (shift >> 1) - 1 : Old_pos + (shift >> 1);
+      if ( (length == 0) || (Old_pos > Old_size) || (length > Old_size - Old_pos) )
+        {
+        state = FLASH_ERROR;
+        break; // Копирование за пределами прежнего образа.
+        }
+      Copying = 1;
+      Op_left = length;
+      }
+    if (Op_left > Image_size - Written)
+      {
+      state = FLASH_ERROR;
+      break; // Команда выходит за размер нового образа.
+      }
+    pos    += used;
+    Starved = 0;
+    }
+
+  piece = (Op_left < FLUSH_BYTES) ? Op_left : FLUSH_BYTES;
+  if (!Copying && (piece > Input_count - pos))
+    piece = Input_count - pos;
+  if (piece == 0)
+    {
+    Starved = 1;
+    break;
+    }
+  state = Write_Image_chunk(Copying ? (const uint8_t*)ADDR_MAIN_PROGRAM + Old_pos : &Input[pos], piece);
+  if (state == FLASH_BUSY)
+    {
+    state = FLASH_OK;
+    break; // Выполняется стирание страницы: команда продолжится при следующем вызове.
+    }
+  if (!Copying)
+    pos += piece;
+  Old_pos += piece;
+  Written += piece;
+  Op_left -= piece;
+  }
+
+if ( (state == FLASH_OK) && (Written == Image_size) && (Op_left == 0) && (pos < Input_count) )
+  state = FLASH_ERROR; // Лишние байты после окончания образа.
+
+Input_count -= pos;
+for (uint32_t i = 0; i < Input_count; i++)
+  {
+  Input[i] = Input[pos + i];
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Чтение числа LEB128.
+  * @param   Data  - указатель на данные.
+  * @param   Count - количество принятых байт.
+  * @param   Value - указатель для числа.
+  * @return  uint32_t - количество байт числа, 0 - число принято не полностью, VARINT_BAD - число длиннее 5 байт.
+  */
+static uint32_t Delta_varint (const uint8_t *Data, uint32_t Count, uint32_t *Value)
+{
+*Value = 0;
+for (uint32_t i = 0; i < 5; i++)
+  {
+  if (i >= Count)
+    return 0;
+  *Value |= (uint32_t)(Data[i] & 0x7FU) << (7 * i);
+  if (!(Data[i] & 0x80U))
+    return i + 1;
+  }
+return VARINT_BAD;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Закрытие приёма с ошибкой.
+  * @param   State - результат операции.
+  * @return  flash status - State.
+  */
+static flash_status Delta_fail (flash_status State)
+{
+Delta_state = State;
+return State;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
@@ -0,0 +1,251 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_install.c
+  *
+  * @brief     Установка прошивки: копирование образа из Download Buffer в Main Programm с журналом.
+  *
+  * @details   Образ, записанный в Download Buffer (например, Image_writer.c), копируется в Main Programm            \n
+  *            по страницам. Номер каждой записанной страницы сохраняется в журнале установки (ADDR_INSTALL_AREA,    \n
+  *            MEMSIZE_INSTALL_AREA - см. FLASH.h), поэтому после сброса копирование продолжается с прерванной        \n
+  *            страницы, а не с начала.
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Install_Image (uint32_t Size, uint32_t Crc, install_clock Clock, Install_report_struct *Report) - установка образа  \n
+  *   размером Size байт. Перед копированием проверяется CRC32 образа в Download Buffer (Calc_CRC32 слов, размер         \n
+  *   дополнен до слова - как в Finalize_Image_writer), после копирования - CRC32 Main Programm. Если журнал содержит    \n
+  *   незавершённую установку того же образа, копирование продолжается с первой незаписанной страницы.                   \n
+  *   Страницы записываются функцией Write_Words_to_flash: совпадающая страница не стирается и не программируется,      \n
+  *   поэтому повторная установка изменяет только отличающиеся страницы. Report - время установки по часам Clock        \n
+  *   и количество записанных и пропущенных страниц.                                                                      \n
+  *
+  * - Get_Pending_Install (uint32_t *Size, uint32_t *Crc) - размер и CRC32 образа незавершённой установки: загрузчик     \n
+  *   вызывает её при старте и продолжает установку (Install_Image).                                                      \n
+  *
+  * **Журнал установки**
+  * | Слово                 | Смещение       | Содержимое                                                     |
+  * | --------------------- | :------------: | :------------------------------------------------------------: |
+  * | Заголовок             | 0              | INSTALL_JOURNAL_TAG                                            |
+  * | ^                     | 1              | Размер образа в байтах                                         |
+  * | ^                     | 2              | CRC32 образа                                                   |
+  * | ^                     | 3              | CRC32 слов 0 ... 2 (заголовок действителен при совпадении)     |
+  * | Записи                | 4 ...          | INSTALL_RECORD(номер страницы) после записи каждой страницы,   |
+  * | ^                     | ^              | INSTALL_RECORD(INSTALL_DONE_PAGE) после проверки CRC32         |
+  *
+  * Запись журнала - одно слово: номер страницы в младшем полуслове и его дополнение в старшем. Прерванное                \n
+  * программирование сбрасывает лишь часть битов и не даёт действительной записи: такое слово                           \n
+  * пропускается, следующая запись дописывается за ним. Журнал стирается только в начале новой установки.
+  *
+  * Функции модуля вызываются из основной программы (не из прерываний), во время установки выборка команд             \n
+  * не должна выполняться из Main Programm (установку выполняет загрузчик).
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Image_install.h"
+#include "Flash_geometry.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define JOURNAL_HEADER_WORDS  4U                                                         /*!< Размер заголовка журнала в словах.          */
+#define JOURNAL_SLOTS         ((MEMSIZE_INSTALL_AREA * 1024) / 4 - JOURNAL_HEADER_WORDS) /*!< Количество записей журнала.                 */
+#define JOURNAL_WORD(Index)   (*((uint32_t*)ADDR_INSTALL_AREA + (Index)))               /*!< Слово журнала по номеру.                    */
+#define RECORD_VALID(Word)    (((Word) >> 16) == (~(Word) & 0xFFFFU))                    /*!< Запись журнала действительна.               */
+#define RECORD_PAGE(Word)     ((Word) & 0xFFFFU)                                         /*!< Номер страницы записи журнала.              */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint32_t Journal_slot = 0; /*!< Номер первой свободной записи журнала. */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static uint8_t      Journal_scan   (uint32_t *Next_page);
+static flash_status Journal_open   (uint32_t Size, uint32_t Crc);
+static flash_status Journal_append (uint32_t Page, uint32_t Size, uint32_t Crc);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Установка образа из Download Buffer в Main Programm.
+  * @details Незавершённая установка того же образа (размер и CRC32 в заголовке журнала) продолжается            \n
+  *          с первой незаписанной страницы, иначе журнал стирается и установка начинается с первой страницы.    \n
+  *          Каждая страница записывается Write_Words_to_flash (совпадающие страницы пропускаются), затем         \n
+  *          в журнал дописывается её номер. После последней страницы проверяется CRC32 Main Programm.
+  * @param   Size   - размер образа в байтах (не более MEMSIZE_MAIN_PROGRAM Kbyte).
+  * @param   Crc    - CRC32 образа, дополненного до слова байтами 0xFF.
+  * @param   Clock  - часы для замера времени установки (может быть 0).
+  * @param   Report - указатель на результат установки (может быть 0).
+  * @return  flash status: FLASH_OK - образ установлен, FLASH_ERROR - CRC32 образа в Download Buffer                \n
+  *          или Main Programm не совпадает либо ошибка записи, FLASH_WROG_ADDRES - неверный размер или журнал  \n
+  *          установки не помещается во FLASH платы.
+  */
+flash_status Install_Image (uint32_t Size, uint32_t Crc, install_clock Clock, Install_report_struct *Report)
+{
+Install_report_struct report    = {0};
+flash_status          state     = FLASH_OK;
+uint32_t              start     = (Clock != 0) ? Clock() : 0;
+uint32_t              page_size = Get_Page_Size_of_flash(ADDR_MAIN_PROGRAM);
+uint32_t              bytes     = (Size + 3U) & ~3U;
+uint32_t              offset;
+uint32_t              amount;
+
+if ( (Size == 0) || (Size > MEMSIZE_MAIN_PROGRAM * 1024) || !Area_in_flash(ADDR_INSTALL_AREA, MEMSIZE_INSTALL_AREA * 1024) )
+  return FLASH_WROG_ADDRES;
+if (Calc_CRC32((const uint32_t*)ADDR_DOWNLOAD_BUFFER, bytes / 4) != Crc)
+  return FLASH_ERROR; // Образ в Download Buffer не принят полностью или повреждён: Main Programm не изменяется.
+
+report.Pages = (bytes + page_size - 1) / page_size;
+if ( !Journal_scan(&report.First_page) || (JOURNAL_WORD(1) != Size) || (JOURNAL_WORD(2) != Crc) )
+  {
+  report.First_page = 0;
+  state             = Journal_open(Size, Crc);
+  }
+
+for (uint32_t page = report.First_page; (page < report.Pages) && (state == FLASH_OK); page++)
+  {
+  offset = page * page_size;
+  amount = (bytes - offset < page_size) ? bytes - offset : page_size;
+  state  = Write_Words_to_flash(ADDR_MAIN_PROGRAM + offset, amount / 4, (uint32_t*)(uintptr_t)(ADDR_DOWNLOAD_BUFFER + offset));
+  if (state != FLASH_OK)
+    break;
+  if (Get_Last_Write_Path() == FLASH_WRITE_SKIPPED)
+    report.Skipped++;
+  else
+    report.Copied++;
+  state = Journal_append(page, Size, Crc);
+  }
+
+if (state == FLASH_OK)
+  {
+  if (Calc_CRC32((const uint32_t*)ADDR_MAIN_PROGRAM, bytes / 4) != Crc)
+    state = FLASH_ERROR;
+  else
+    state = Journal_append(INSTALL_DONE_PAGE, Size, Crc);
+  }
+
+if (Clock != 0)
+  report.Time = Clock() - start;
+if (Report != 0)
+  *Report = report;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Незавершённая установка образа.
+  * @param   Size - указатель для размера образа в байтах.
+  * @param   Crc  - указатель для CRC32 образа.
+  * @return  flash status: FLASH_OK - установка не завершена (Size и Crc заполнены), FLASH_ERROR - незавершённой установки нет.
+  */
+flash_status Get_Pending_Install (uint32_t *Size, uint32_t *Crc)
+{
+uint32_t next_page;
+
+if (!Journal_scan(&next_page))
+  return FLASH_ERROR;
+*Size = JOURNAL_WORD(1);
+*Crc  = JOURNAL_WORD(2);
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Просмотр журнала установки.
+  * @details Записи просматриваются до первого стёртого слова (Journal_slot), недействительные записи пропускаются.
+  * @param   Next_page - указатель для номера первой незаписанной страницы.
+  * @return  uint8_t - 1 - заголовок действителен и записи окончания установки нет (0 - журнал вне FLASH платы).
+  */
+static uint8_t Journal_scan (uint32_t *Next_page)
+{
+uint32_t word;
+uint32_t slot;
+
+Journal_slot = 0;
+*Next_page   = 0;
+if ( !Area_in_flash(ADDR_INSTALL_AREA, MEMSIZE_INSTALL_AREA * 1024) ||
+     (JOURNAL_WORD(0) != INSTALL_JOURNAL_TAG) || (Calc_CRC32((const uint32_t*)ADDR_INSTALL_AREA, 3) != JOURNAL_WORD(3)) )
+  return 0;
+
+for (slot = 0; slot < JOURNAL_SLOTS; slot++)
+  {
+  word = JOURNAL_WORD(JOURNAL_HEADER_WORDS + slot);
+  if (word == BLANK_WORD)
+    break;
+  if (!RECORD_VALID(word))
+    continue; // Прерванная запись.
+  if (RECORD_PAGE(word) == INSTALL_DONE_PAGE)
+    return 0;
+  if (RECORD_PAGE(word) + 1 > *Next_page)
+    *Next_page = RECORD_PAGE(word) + 1;
+  }
+Journal_slot = slot;
+return 1;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Начало нового журнала установки.
+  * @details Область журнала стирается, заголовок записывается одной записью Write_Words_to_flash:       \n
+  *          прерванная запись заголовка не проходит проверку CRC32, и установка начнётся заново.
+  * @param   Size - размер образа в байтах.
+  * @param   Crc  - CRC32 образа.
+  * @return  flash status.
+  */
+static flash_status Journal_open (uint32_t Size, uint32_t Crc)
+{
+uint32_t     header[JOURNAL_HEADER_WORDS] = {INSTALL_JOURNAL_TAG, Size, Crc, 0};
+flash_status state;
+
+header[3]    = Calc_CRC32(header, 3);
+Journal_slot = 0;
+state        = Erase_Area_of_flash(ADDR_INSTALL_AREA, MEMSIZE_INSTALL_AREA * 1024);
+if (state == FLASH_OK)
+  state = Write_Words_to_flash(ADDR_INSTALL_AREA, JOURNAL_HEADER_WORDS, header);
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись номера страницы в журнал установки.
+  * @details Запись программируется только в стёртое слово. Если свободных записей нет, журнал начинается заново: \n
+  *          прежние записи теряются, после сброса уже записанные страницы будут пропущены при сравнении.
+  * @param   Page - номер страницы или INSTALL_DONE_PAGE.
+  * @param   Size - размер образа в байтах (заголовок нового журнала).
+  * @param   Crc  - CRC32 образа (заголовок нового журнала).
+  * @return  flash status.
+  */
+static flash_status Journal_append (uint32_t Page, uint32_t Size, uint32_t Crc)
+{
+uint32_t     record = INSTALL_RECORD(Page);
+flash_status state;
+
+while ( (Journal_slot < JOURNAL_SLOTS) && (JOURNAL_WORD(JOURNAL_HEADER_WORDS + Journal_slot) != BLANK_WORD) )
+  {
+  Journal_slot++;
+  }
+if (Journal_slot >= JOURNAL_SLOTS)
+  {
+  state = Journal_open(Size, Crc);
+  if (state != FLASH_OK)
+    return state;
+  }
+
+state = Write_Words_to_flash(ADDR_INSTALL_AREA + 4 * (JOURNAL_HEADER_WORDS + Journal_slot), 1, &record);
+Journal_slot++;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
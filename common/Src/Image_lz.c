@@ -0,0 +1,510 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_lz.c
+  *
+  * @brief     Сжатые образы прошивки (LZ): потоковая распаковка в Download Buffer.
+  *
+  * @details   Образ передаётся сжатым (Pack_Image_lz на ПК, Host_Flash: image_pack) и распаковывается по мере приёма   \n
+  *            прямо в конвейер записи Image_writer.c: стирание страниц заранее, программирование из буфера приёма.      \n
+  *            RAM распаковки ограничена окном ссылок (IMAGE_LZ_WINDOW) и буфером приёма (IMAGE_LZ_INPUT_BYTES) и      \n
+  *            не зависит от размера образа. После распаковки CRC32 проверяется по несжатому образу (Finalize_Image_writer).
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Open_Image_lz (void) - начало приёма сжатого образа. Image_writer открывается после приёма заголовка.              \n
+  *
+  * - Write_Image_lz_chunk (const uint8_t *Data, uint32_t Length) - приём очередной части сжатого образа (не более          \n
+  *   IMAGE_LZ_INPUT_BYTES байт). Часть принимается целиком или не принимается: FLASH_BUSY - буфер приёма заполнен,        \n
+  *   так как распакованные данные ещё не приняты Image_writer (выполняется стирание страницы), передатчик повторяет      \n
+  *   часть позже - как в Write_Image_chunk. Буфер приёма на INPUT_TAIL_BYTES больше IMAGE_LZ_INPUT_BYTES: часть          \n
+  *   полного размера принимается и тогда, когда в буфере остался незавершённый повтор, ожидающий следующих байт.       \n
+  *
+  * - Finalize_Image_lz (void) - окончание приёма: распаковка и запись остатка, проверка CRC32 несжатого образа           \n
+  *   (Finalize_Image_writer). Вызывается повторно, пока возвращает FLASH_BUSY.                                          \n
+  *
+  * - Get_Image_lz_size (void) - размер несжатого образа из заголовка (0 - заголовок не принят).                           \n
+  *
+  * - Unpack_Image_lz (const uint8_t *Packed, uint32_t Packed_size, uint32_t *Image, uint32_t Capacity, uint32_t *Size) -  \n
+  *   распаковка сжатого образа целиком в RAM (Capacity байт) с проверкой CRC32: проверка упаковщика и замеры скорости.  \n
+  *
+  * - Pack_Image_lz (const uint32_t *Image, uint32_t Size, uint8_t *Packed, uint32_t Capacity) - сжатие образа (Size      \n
+  *   байт, дополнен до слова байтами 0xFF). Capacity - не менее IMAGE_LZ_PACKED_MAX(Size). Возвращает размер сжатого      \n
+  *   образа. Полный перебор окна: выполняется на ПК (image_pack) и в подготовке замера Flash_bench.c.                    \n
+  *
+  * **Формат сжатого образа** (LZSS)
+  * | Поле             | Размер         | Содержимое                                                                    |
+  * | ---------------- | :------------: | :---------------------------------------------------------------------------: |
+  * | Заголовок        | 3 слова        | IMAGE_LZ_TAG, размер несжатого образа в байтах, CRC32 несжатого образа        |
+  * | Байт флагов      | 1 байт         | 8 следующих элементов, начиная с младшего бита: 1 - байт, 0 - повтор          |
+  * | Байт             | 1 байт         | байт образа                                                                   |
+  * | Повтор           | 2 байта        | (смещение - 1) в 11 младших битах, (длина - 3) в 5 старших битах              |
+  *
+  * Слова заголовка и повторы - little-endian. Повтор копирует "длина" байт, начиная с "смещение" байт назад          \n
+  * (1 ... IMAGE_LZ_WINDOW), и может перекрывать сам себя. CRC32 (Calc_CRC32) - по словам образа, дополненного         \n
+  * до слова байтами 0xFF, как в Finalize_Image_writer.
+  *
+  * **Потоковая распаковка**                                                                                                   \n
+  * Распакованные байты записываются в окно (кольцевой буфер IMAGE_LZ_WINDOW байт) и передаются Write_Image_chunk       \n
+  * частями. Элемент распаковывается, только если он не затирает ещё не переданные байты окна, поэтому при занятой       \n
+  * записи распаковка приостанавливается, а сжатые данные остаются в буфере приёма.                                       \n
+  * Функции модуля вызываются из основной программы (не из прерываний).
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Image_lz.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define INPUT_TAIL_BYTES        1U                                                        /*!< Незавершённый повтор (1 байт).         */
+#define WINDOW_MASK             (IMAGE_LZ_WINDOW - 1U)                                    /*!< Маска номера байта окна.               */
+#define FLUSH_BYTES             128U                                                      /*!< Наибольшая часть Write_Image_chunk.    */
+#define LZ_OFFSET(Low, High)    ((((uint32_t)(High) & 0x07U) << 8 | (Low)) + 1U)          /*!< Смещение повтора.                      */
+#define LZ_LENGTH(High)         (((uint32_t)(High) >> 3) + IMAGE_LZ_MIN_MATCH)            /*!< Длина повтора.                         */
+#define LZ_READ32(Bytes)        ((uint32_t)(Bytes)[0] | (uint32_t)(Bytes)[1] << 8 | (uint32_t)(Bytes)[2] << 16 | (uint32_t)(Bytes)[3] << 24)
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static flash_status Lz_state     = FLASH_OK;                  /*!< FLASH_BUSY - образ принимается, FLASH_OK - приём закрыт, иначе - ошибка. */
+static uint8_t      Header_done  = 0;                         /*!< 1 - заголовок принят, Image_writer открыт.                 */
+static uint32_t     Image_size   = 0;                         /*!< Размер несжатого образа в байтах.                          */
+static uint32_t     Image_crc    = 0;                         /*!< CRC32 несжатого образа.                                    */
+static uint32_t     Decoded      = 0;                         /*!< Количество распакованных байт.                             */
+static uint32_t     Flushed      = 0;                         /*!< Количество байт, принятых Write_Image_chunk.               */
+static uint8_t      Flags        = 0;                         /*!< Текущий байт флагов.                                       */
+static uint8_t      Flag_bits    = 0;                         /*!< Количество неиспользованных флагов.                        */
+static uint32_t     Input_count  = 0;                         /*!< Количество байт в буфере приёма.                           */
+static uint8_t      Input[IMAGE_LZ_INPUT_BYTES + INPUT_TAIL_BYTES]; /*!< Буфер приёма сжатых данных.                                */
+static uint8_t      Window[IMAGE_LZ_WINDOW];                  /*!< Окно ссылок: последние распакованные байты.                */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static flash_status Lz_step    (void);
+static flash_status Lz_decode  (void);
+static flash_status Lz_flush   (void);
+static flash_status Lz_fail    (flash_status State);
+static uint32_t     Lz_match   (const uint8_t *Image, uint32_t Position, uint32_t Size, uint32_t *Offset);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Начало приёма сжатого образа.
+  * @return  flash status: FLASH_OK.
+  */
+flash_status Open_Image_lz (void)
+{
+Header_done = 0;
+Image_size  = 0;
+Image_crc   = 0;
+Decoded     = 0;
+Flushed     = 0;
+Flag_bits   = 0;
+Input_count = 0;
+Lz_state    = FLASH_BUSY;
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Приём очередной части сжатого образа.
+  * @details Часть копируется в буфер приёма целиком или не принимается (FLASH_BUSY).                     \n
+  *          Принятые данные распаковываются и передаются Image_writer, пока он их принимает.
+  * @param   Data   - указатель на данные.
+  * @param   Length - количество байт (не более IMAGE_LZ_INPUT_BYTES).
+  * @return  flash status: FLASH_OK - часть принята, FLASH_BUSY - буфер заполнен, повторить позже,             \n
+  *          FLASH_WROG_ADDRES - часть больше буфера или неверный размер образа, FLASH_ERROR - неверные        \n
+  *          сжатые данные, ошибка записи или приём не открыт.
+  */
+flash_status Write_Image_lz_chunk (const uint8_t *Data, uint32_t Length)
+{
+flash_status state;
+
+if (Lz_state != FLASH_BUSY)
+  return (Lz_state == FLASH_OK) ? FLASH_ERROR : Lz_state;
+if (Length > IMAGE_LZ_INPUT_BYTES)
+  return FLASH_WROG_ADDRES;
+
+state = Lz_step();
+if (state != FLASH_OK)
+  return state;
+if (Input_count + Length > sizeof(Input))
+  return FLASH_BUSY; // Часть принимается и при незавершённой команде в буфере.
+
+for (uint32_t i = 0; i < Length; i++)
+  {
+  Input[Input_count + i] = Data[i];
+  }
+Input_count += Length;
+return Lz_step();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Окончание приёма сжатого образа.
+  * @details Распаковка и запись остатка, затем Finalize_Image_writer с CRC32 из заголовка.     \n
+  *          Пока распакованные данные не записаны, возвращается FLASH_BUSY.
+  * @return  flash status: FLASH_OK - образ записан и CRC32 совпадает, FLASH_BUSY - повторить позже,    \n
+  *          FLASH_ERROR - сжатые данные неполные или лишние, ошибка записи или CRC32 не совпадает.
+  */
+flash_status Finalize_Image_lz (void)
+{
+flash_status state;
+
+if (Lz_state != FLASH_BUSY)
+  return (Lz_state == FLASH_OK) ? FLASH_ERROR : Lz_state;
+
+state = Lz_step();
+if (state != FLASH_OK)
+  return state;
+if (!Header_done)
+  return (Input_count < IMAGE_LZ_HEADER_BYTES) ? Lz_fail(FLASH_ERROR) : FLASH_BUSY;
+if (Flushed < Decoded)
+  return FLASH_BUSY;
+if ( (Decoded != Image_size) || (Input_count != 0) )
+  return Lz_fail(FLASH_ERROR); // Сжатые данные оборваны или содержат лишние байты.
+
+state = Finalize_Image_writer(Image_crc);
+if (state == FLASH_BUSY)
+  return FLASH_BUSY;
+Lz_state = FLASH_OK;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Размер несжатого образа.
+  * @return  uint32_t - размер из заголовка сжатого образа в байтах, 0 - заголовок ещё не принят.
+  */
+uint32_t Get_Image_lz_size (void)
+{
+return Image_size;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Распаковка сжатого образа в RAM.
+  * @details Образ дополняется до слова байтами 0xFF, CRC32 сравнивается с заголовком.
+  * @param   Packed      - указатель на сжатый образ (с заголовком).
+  * @param   Packed_size - размер сжатого образа в байтах.
+  * @param   Image       - указатель на буфер образа.
+  * @param   Capacity    - размер буфера образа в байтах.
+  * @param   Size        - указатель для размера образа в байтах.
+  * @return  flash status: FLASH_OK - образ распакован и CRC32 совпадает, FLASH_WROG_ADDRES - образ больше буфера, \n
+  *          FLASH_ERROR - неверные сжатые данные или CRC32.
+  */
+flash_status Unpack_Image_lz (const uint8_t *Packed, uint32_t Packed_size, uint32_t *Image, uint32_t Capacity, uint32_t *Size)
+{
+uint8_t  *image = (uint8_t*)Image;
+uint32_t  size;
+uint32_t  decoded = 0;
+uint32_t  pos     = IMAGE_LZ_HEADER_BYTES;
+uint32_t  flags   = 0;
+uint32_t  offset;
+uint32_t  length;
+
+if ( (Packed_size < IMAGE_LZ_HEADER_BYTES) || (LZ_READ32(Packed) != IMAGE_LZ_TAG) )
+  return FLASH_ERROR;
+size = LZ_READ32(Packed + 4);
+if ( ((size + 3U) & ~3U) > Capacity )
+  return FLASH_WROG_ADDRES;
+
+while (decoded < size)
+  {
+  if (flags <= 1)
+    {
+    if (pos >= Packed_size)
+      return FLASH_ERROR;
+    flags = Packed[pos++] | 0x100U; // Старший бит - признак окончания байта флагов.
+    }
+  if (flags & 1)
+    {
+    if (pos >= Packed_size)
+      return FLASH_ERROR;
+    image[decoded++] = Packed[pos++];
+    }
+  else
+    {
+    if (pos + 2 > Packed_size)
+      return FLASH_ERROR;
+    offset = LZ_OFFSET(Packed[pos], Packed[pos + 1]);
+    length = LZ_LENGTH(Packed[pos + 1]);
+    pos   += 2;
+    if ( (offset > decoded) || (length > size - decoded) )
+      return FLASH_ERROR;
+    for (; length > 0; length--, decoded++)
+      {
+      image[decoded] = image[decoded - offset];
+      }
+    }
+  flags >>= 1;
+  }
+
+while (decoded % 4)
+  {
+  image[decoded++] = 0xFF;
+  }
+*Size = size;
+return (Calc_CRC32(Image, decoded / 4) == LZ_READ32(Packed + 8)) ? FLASH_OK : FLASH_ERROR;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Сжатие образа.
+  * @details Для каждого байта перебираются все смещения окна и выбирается самый длинный повтор. Повтор заменяется     \n
+  *          байтом, если со следующего байта найден более длинный (отложенный разбор).
+  * @param   Image    - указатель на образ, дополненный до слова байтами 0xFF.
+  * @param   Size     - размер образа в байтах.
+  * @param   Packed   - указатель на буфер сжатого образа.
+  * @param   Capacity - размер буфера в байтах (не менее IMAGE_LZ_PACKED_MAX(Size)).
+  * @return  uint32_t - размер сжатого образа в байтах, 0 - буфер мал.
+  */
+uint32_t Pack_Image_lz (const uint32_t *Image, uint32_t Size, uint8_t *Packed, uint32_t Capacity)
+{
+const uint8_t *image = (const uint8_t*)Image;
+uint32_t       header[3];
+uint32_t       pos  = IMAGE_LZ_HEADER_BYTES;
+uint32_t       flag = 0;
+uint32_t       bit  = 8;
+uint32_t       length;
+uint32_t       offset = 0;
+uint32_t       next_offset;
+
+if (Capacity < IMAGE_LZ_PACKED_MAX(Size))
+  return 0;
+header[0] = IMAGE_LZ_TAG;
+header[1] = Size;
+header[2] = Calc_CRC32(Image, (Size + 3U) / 4);
+for (uint32_t i = 0; i < IMAGE_LZ_HEADER_BYTES; i++)
+  {
+  Packed[i] = (uint8_t)(header[i / 4] >> (8 * (i % 4)));
+  }
+
+for (uint32_t i = 0; i < Size; )
+  {
+  if (bit == 8)
+    {
+    flag         = pos++;
+    Packed[flag] = 0;
+    bit          = 0;
+    }
+  length = Lz_match(image, i, Size, &offset);
+  if ( (length >= IMAGE_LZ_MIN_MATCH) && (i + 1 < Size) && (Lz_match(image, i + 1, Size, &next_offset) > length) )
+    length = 0; // Отложенный разбор: со следующего байта повтор длиннее.
+
+  if (length >= IMAGE_LZ_MIN_MATCH)
+    {
+    Packed[pos++] = (uint8_t)(offset - 1);
+    Packed[pos++] = (uint8_t)(((offset - 1) >> 8) | ((length - IMAGE_LZ_MIN_MATCH) << 3));
+    i            += length;
+    }
+  else
+    {
+    Packed[flag] |= (uint8_t)(1U << bit);
+    Packed[pos++] = image[i++];
+    }
+  bit++;
+  }
+return pos;
+}
+//------------------------------------------------------------------------------//
+
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Очередной шаг приёма сжатого образа.
+  * @details Разбор заголовка и открытие Image_writer, затем распаковка и передача данных Image_writer, \n
+  *          пока распаковка или передача продвигаются.
+  * @return  flash status: FLASH_OK (в том числе, если Image_writer занят) или ошибка.
+  */
+static flash_status Lz_step (void)
+{
+flash_status state;
+uint32_t     decoded;
+uint32_t     flushed;
+
+if (!Header_done)
+  {
+  if (Input_count < IMAGE_LZ_HEADER_BYTES)
+    return FLASH_OK;
+  if (LZ_READ32(Input) != IMAGE_LZ_TAG)
+    return Lz_fail(FLASH_ERROR);
+  state = Open_Image_writer(LZ_READ32(Input + 4));
+  if (state == FLASH_BUSY)
+    return FLASH_OK; // Не окончено стирание предыдущей записи Image_writer.
+  if (state != FLASH_OK)
+    return Lz_fail(state);
+  Image_size   = LZ_READ32(Input + 4);
+  Image_crc    = LZ_READ32(Input + 8);
+  Header_done  = 1;
+  Input_count -= IMAGE_LZ_HEADER_BYTES;
+  for (uint32_t i = 0; i < Input_count; i++)
+    {
+    Input[i] = Input[IMAGE_LZ_HEADER_BYTES + i];
+    }
+  }
+
+do
+  {
+  decoded = Decoded;
+  flushed = Flushed;
+  state   = Lz_decode();
+  if (state == FLASH_OK)
+    state = Lz_flush();
+  if (state != FLASH_OK)
+    return Lz_fail(state);
+  } while ( (Decoded != decoded) || (Flushed != flushed) );
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Распаковка данных буфера приёма в окно.
+  * @details Распаковка останавливается, если следующий элемент принят не полностью                 \n
+  *          или затёр бы байты окна, ещё не переданные Image_writer.
+  * @return  flash status: FLASH_OK или FLASH_ERROR - неверный повтор или лишние байты после образа.
+  */
+static flash_status Lz_decode (void)
+{
+flash_status state = FLASH_OK;
+uint32_t     pos   = 0;
+uint32_t     offset;
+uint32_t     length;
+
+while (Decoded < Image_size)
+  {
+  if (Flag_bits == 0)
+    {
+    if (pos >= Input_count)
+      break;
+    Flags     = Input[pos++];
+    Flag_bits = 8;
+    }
+  if (Flags & 1)
+    {
+    if ( (pos >= Input_count) || (Decoded - Flushed >= IMAGE_LZ_WINDOW) )
+      break;
+    Window[Decoded++ & WINDOW_MASK] = Input[pos++];
+    }
+  else
+    {
+    if (pos + 2 > Input_count)
+      break;
+    offset = LZ_OFFSET(Input[pos], Input[pos + 1]);
+    length = LZ_LENGTH(Input[pos + 1]);
+    if ( (offset > Decoded) || (length > Image_size - Decoded) )
+      {
+      state = FLASH_ERROR;
+      break;
+      }
+    if (Decoded - Flushed + length > IMAGE_LZ_WINDOW)
+      break;
+    pos += 2;
+    for (; length > 0; length--, Decoded++)
+      {
+      Window[Decoded & WINDOW_MASK] = Window[(Decoded - offset) & WINDOW_MASK];
+      }
+    }
+  Flags >>= 1;
+  Flag_bits--;
+  }
+if ( (Decoded == Image_size) && (pos < Input_count) )
+  state = FLASH_ERROR; // Лишние байты после окончания образа.
+
+Input_count -= pos;
+for (uint32_t i = 0; i < Input_count; i++)
+  {
+  Input[i] = Input[pos + i];
+  }
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Передача распакованных байт окна Image_writer.
+  * @return  flash status: FLASH_OK (в том числе, если буфер Image_writer заполнен) или ошибка записи.
+  */
+static flash_status Lz_flush (void)
+{
+flash_status state;
+uint32_t     from;
+uint32_t     piece;
+
+while (Flushed < Decoded)
+  {
+  from  = Flushed & WINDOW_MASK;
+  piece = Decoded - Flushed;
+  if (piece > IMAGE_LZ_WINDOW - from)
+    piece = IMAGE_LZ_WINDOW - from;
+  if (piece > FLUSH_BYTES)
+    piece = FLUSH_BYTES;
+  state = Write_Image_chunk(&Window[from], piece);
+  if (state == FLASH_BUSY)
+    return FLASH_OK; // Выполняется стирание страницы: байты остаются в окне.
+  if (state != FLASH_OK)
+    return state;
+  Flushed += piece;
+  }
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Закрытие приёма с ошибкой.
+  * @param   State - результат операции.
+  * @return  flash status - State.
+  */
+static flash_status Lz_fail (flash_status State)
+{
+Lz_state = State;
+return State;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Самый длинный повтор в окне.
+  * @param   Image    - указатель на образ.
+  * @param   Position - номер байта образа.
+  * @param   Size     - размер образа в байтах.
+  * @param   Offset   - указатель для смещения повтора.
+  * @return  uint32_t - длина повтора (не более IMAGE_LZ_MAX_MATCH), 0 - повтора нет.
+  */
+static uint32_t Lz_match (const uint8_t *Image, uint32_t Position, uint32_t Size, uint32_t *Offset)
+{
+uint32_t best       = 0;
+uint32_t max_length = (Size - Position < IMAGE_LZ_MAX_MATCH) ? Size - Position : IMAGE_LZ_MAX_MATCH;
+uint32_t length;
+
+for (uint32_t offset = 1; (offset <= IMAGE_LZ_WINDOW) && (offset <= Position) && (best < max_length); offset++)
+  {
+  if (Image[Position + best] != Image[Position + best - offset])
+    continue; // Повтор не длиннее найденного.
+  for (length = 0; (length < max_length) && (Image[Position + length] == Image[Position + length - offset]); length++)
+    {
+    }
+  if (length > best)
+    {
+    best    = length;
+    *Offset = offset;
+    }
+  }
+return best;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
@@ -0,0 +1,253 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Image_writer.c
+  *
+  * @brief     Потоковая запись образа прошивки в Download Buffer.
+  *
+  * @details   Образ принимается частями произвольного размера (кадры CAN, пакеты Modbus) и записывается        \n
+  *            в Download Buffer (ADDR_DOWNLOAD_BUFFER, MEMSIZE_DOWNLOAD_BUFFER - см. FLASH.h) по мере приёма.   \n
+  *            Следующая страница стирается заранее, пока принимаются данные текущей, поэтому скорость загрузки  \n
+  *            ограничивается интерфейсом, а не стиранием FLASH.
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Open_Image_writer (uint32_t Size) - начало записи образа размером Size байт, запуск стирания первой страницы.        \n
+  *
+  * - Write_Image_chunk (const uint8_t *Data, uint32_t Length) - приём очередной части образа (не более                   \n
+  *   IMAGE_WRITER_BUFFER_WORDS * 4 байт). Части копируются в буфер приёма, целые слова сразу программируются           \n
+  *   в стёртые страницы (Write_Words_to_flash). FLASH_BUSY - буфер заполнен данными, принятыми во время стирания       \n
+  *   страницы: часть не принята, передатчик повторяет её позже (например, не подтверждает кадр).                      \n
+  *
+  * - Finalize_Image_writer (uint32_t Crc) - запись остатка образа (последнее слово дополняется байтами 0xFF)           \n
+  *   и сравнение CRC32 (Calc_CRC32) записанных слов с Crc. Вызывается повторно, пока возвращает FLASH_BUSY.            \n
+  *
+  * - Get_Image_writer_received (void) - количество принятых байт образа.                                                \n
+  *
+  * **Порядок записи**                                                                                                         \n
+  * Страницы стираются по одной функцией Erase_Page_of_flash_async (FLASH.c): стирание выполняется без ожидания,        \n
+  * функции модуля только проверяют его окончание (Get_Bank_Async_Status). Стирание следующей страницы запускается,      \n
+  * как только впереди записанных данных остаётся меньше одной стёртой страницы. Пока страница стирается, банк FLASH      \n
+  * занят: принятые данные накапливаются в буфере приёма и программируются при следующем вызове после окончания          \n
+  * стирания. Буфер приёма должен вмещать данные, принимаемые за время стирания страницы (около 50 мс).                   \n
+  *
+  * Функции модуля вызываются из основной программы (не из прерываний). Во время записи образа другие асинхронные       \n
+  * записи в банк Download Buffer недопустимы. Если канал асинхронной записи занят, стирание откладывается до            \n
+  * следующего вызова.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Image_writer.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define BUFFER_BYTES  (IMAGE_WRITER_BUFFER_WORDS * 4U) /*!< Размер буфера приёма в байтах. */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static flash_status Writer_state = FLASH_OK;                  /*!< FLASH_BUSY - образ записывается, FLASH_OK - запись закрыта, иначе - ошибка. */
+static uint32_t     Image_size   = 0;                         /*!< Размер образа в байтах.                                    */
+static uint32_t     Received     = 0;                         /*!< Количество принятых байт образа.                           */
+static uint32_t     Write_addr   = 0;                         /*!< Адрес первого незаписанного слова образа.                  */
+static uint32_t     Ready_end    = 0;                         /*!< Конец стёртой части Download Buffer.                       */
+static uint32_t     Image_end    = 0;                         /*!< Конец образа во FLASH (размер дополнен до слова).          */
+static uint8_t      Erasing      = 0;                         /*!< 1 - выполняется стирание страницы Ready_end.               */
+static uint8_t      Erase_bank   = 0;                         /*!< Банк FLASH стираемой страницы.                             */
+static uint32_t     Staged       = 0;                         /*!< Количество байт в буфере приёма.                           */
+static uint32_t     Buffer[IMAGE_WRITER_BUFFER_WORDS];        /*!< Буфер приёма: данные с адреса Write_addr.                  */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static flash_status Writer_step  (void);
+static flash_status Writer_fail  (flash_status State);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Начало записи образа в Download Buffer.
+  * @details Запускает стирание первой страницы и сразу возвращает управление.
+  * @param   Size - размер образа в байтах (не более MEMSIZE_DOWNLOAD_BUFFER Kbyte).
+  * @return  flash status: FLASH_WROG_ADDRES - неверный размер, FLASH_BUSY - не окончено стирание предыдущей записи.
+  */
+flash_status Open_Image_writer (uint32_t Size)
+{
+if ( (Size == 0) || (Size > MEMSIZE_DOWNLOAD_BUFFER * 1024) )
+  return FLASH_WROG_ADDRES;
+if ( Erasing && (Get_Bank_Async_Status(Erase_bank) == FLASH_BUSY) )
+  return FLASH_BUSY;
+
+Image_size   = Size;
+Received     = 0;
+Staged       = 0;
+Erasing      = 0;
+Write_addr   = ADDR_DOWNLOAD_BUFFER;
+Ready_end    = ADDR_DOWNLOAD_BUFFER;
+Image_end    = ADDR_DOWNLOAD_BUFFER + ((Size + 3U) & ~3U);
+Writer_state = FLASH_BUSY;
+return Writer_step();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Приём очередной части образа.
+  * @details Часть копируется в буфер приёма целиком или не принимается (FLASH_BUSY).                   \n
+  *          Целые слова программируются сразу, если их страница стёрта и стирание в банке не выполняется.
+  * @param   Data   - указатель на данные (выравнивание не требуется).
+  * @param   Length - количество байт (не более IMAGE_WRITER_BUFFER_WORDS * 4).
+  * @return  flash status: FLASH_OK - часть принята, FLASH_BUSY - буфер заполнен, повторить позже,            \n
+  *          FLASH_WROG_ADDRES - часть больше буфера или выходит за размер образа, FLASH_ERROR - ошибка записи \n
+  *          или запись не открыта.
+  */
+flash_status Write_Image_chunk (const uint8_t *Data, uint32_t Length)
+{
+flash_status state;
+
+if (Writer_state != FLASH_BUSY)
+  return (Writer_state == FLASH_OK) ? FLASH_ERROR : Writer_state;
+if ( (Length > BUFFER_BYTES) || (Length > Image_size - Received) )
+  return FLASH_WROG_ADDRES;
+
+state = Writer_step();
+if (state != FLASH_OK)
+  return state;
+if (Staged + Length > BUFFER_BYTES)
+  return FLASH_BUSY;
+
+for (uint32_t i = 0; i < Length; i++)
+  {
+  ((uint8_t*)Buffer)[Staged + i] = Data[i];
+  }
+Staged   += Length;
+Received += Length;
+return Writer_step();
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Окончание записи образа.
+  * @details Остаток образа дополняется до слова байтами 0xFF и записывается. Если страница ещё стирается, \n
+  *          возвращается FLASH_BUSY: функция вызывается повторно. После записи CRC32 слов образа           \n
+  *          (Calc_CRC32, размер дополнен до слова) сравнивается с Crc, запись закрывается.
+  * @param   Crc - ожидаемый CRC32 образа, дополненного до слова байтами 0xFF.
+  * @return  flash status: FLASH_OK - образ записан и CRC32 совпадает, FLASH_BUSY - повторить позже,    \n
+  *          FLASH_ERROR - принят не весь образ, ошибка записи или CRC32 не совпадает.
+  */
+flash_status Finalize_Image_writer (uint32_t Crc)
+{
+flash_status state;
+
+if (Writer_state != FLASH_BUSY)
+  return (Writer_state == FLASH_OK) ? FLASH_ERROR : Writer_state;
+if (Received != Image_size)
+  return FLASH_ERROR;
+
+while (Staged % 4)
+  {
+  ((uint8_t*)Buffer)[Staged++] = 0xFF;
+  }
+state = Writer_step();
+if (state != FLASH_OK)
+  return state;
+if (Staged > 0)
+  return FLASH_BUSY;
+
+Writer_state = FLASH_OK;
+if (Calc_CRC32((const uint32_t*)ADDR_DOWNLOAD_BUFFER, (Image_end - ADDR_DOWNLOAD_BUFFER) / 4) != Crc)
+  return FLASH_ERROR;
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Количество принятых байт образа.
+  * @return  uint32_t - количество байт, принятых Write_Image_chunk с момента Open_Image_writer.
+  */
+uint32_t Get_Image_writer_received (void)
+{
+return Received;
+}
+//------------------------------------------------------------------------------//
+
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Очередной шаг записи образа.
+  * @details Проверка окончания стирания страницы, программирование слов буфера приёма в стёртые страницы \n
+  *          и запуск стирания следующей страницы, если впереди Write_addr стёрто меньше одной страницы.
+  * @return  flash status: FLASH_OK (в том числе, если стирание ещё выполняется) или ошибка записи.
+  */
+static flash_status Writer_step (void)
+{
+flash_status state;
+uint32_t     words;
+
+if (Erasing)
+  {
+  state = Get_Bank_Async_Status(Erase_bank);
+  if (state == FLASH_BUSY)
+    return FLASH_OK; // Данные остаются в буфере приёма до окончания стирания.
+  Erasing = 0;
+  if (state != FLASH_OK)
+    return Writer_fail(state);
+  Ready_end += Get_Page_Size_of_flash(Ready_end);
+  }
+
+words = Staged / 4;
+if (words > (Ready_end - Write_addr) / 4)
+  words = (Ready_end - Write_addr) / 4;
+if (words > 0)
+  {
+  state = Write_Words_to_flash(Write_addr, words, Buffer);
+  if (state == FLASH_BUSY)
+    return FLASH_OK; // Банк занят асинхронной записью другого модуля (FLASH_CONCURRENT_BANKS = 0).
+  if (state != FLASH_OK)
+    return Writer_fail(state);
+  Write_addr += 4 * words;
+  Staged     -= 4 * words;
+  for (uint32_t i = 0; i < (Staged + 3) / 4; i++)
+    {
+    Buffer[i] = Buffer[words + i];
+    }
+  }
+
+if ( (Ready_end < Image_end) && (Ready_end - Write_addr < Get_Page_Size_of_flash(Ready_end)) )
+  {
+  state = Erase_Page_of_flash_async(Ready_end, 0);
+  if (state == FLASH_OK)
+    {
+    Erasing    = 1;
+    Erase_bank = Get_Bank_of_flash(Ready_end);
+    }
+  else if (state != FLASH_BUSY)
+    {
+    return Writer_fail(state);
+    }
+  }
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Закрытие записи образа с ошибкой.
+  * @param   State - результат операции FLASH.
+  * @return  flash status - State.
+  */
+static flash_status Writer_fail (flash_status State)
+{
+Writer_state = State;
+return State;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
@@ -0,0 +1,348 @@
+/**
+  ******************************************************************************
+  *
+  * @file      KV_store.c
+  *
+  * @brief     Хранилище параметров "ключ - значение" во FLASH (эмуляция EEPROM).
+  *
+  * @details   Параметры записываются во FLASH записями переменной длины, каждая запись дописывается в конец         \n
+  *            активной области, стирание выполняется только при уплотнении заполненной области.
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Init_KV_store (void) - выбор активной области и построение индекса в RAM (ключ - смещение записи).             \n
+  *   Вызывается один раз при старте, до остальных функций модуля. Если области KV Store не помещаются во FLASH платы,  \n
+  *   возвращает FLASH_WROG_ADDRES: ключей нет, запись возвращает FLASH_ERROR.                                            \n
+  *
+  * - Write_KV_to_flash (uint16_t Key, const void *Value, uint16_t Length) - запись значения ключа.                   \n
+  *   Новая запись дописывается в активную область, совпадающее с текущим значение не записывается.                     \n
+  *   Delete_KV_from_flash (uint16_t Key) - удаление ключа (запись нулевой длины).                                      \n
+  *
+  * - Read_KV_from_flash (uint16_t Key, void *Value, uint16_t Size) - копирование значения ключа,                     \n
+  *   Get_KV_from_flash (uint16_t Key, uint16_t *Length) - указатель на значение во FLASH без копирования.              \n
+  *   Адрес записи берётся из индекса в RAM, просмотр FLASH не выполняется.                                              \n
+  *
+  * - Get_KV_free_space (void) - свободное место в активной области в байтах.                                          \n
+  *
+  * Функции модуля вызываются из основной программы (не из прерываний). Запись во FLASH выполняется функциями       \n
+  * Write_Words_to_flash и Erase_Area_of_flash (FLASH.c), поэтому при асинхронной записи в тот же банк возвращается    \n
+  * FLASH_BUSY.
+  *
+  * **Области KV Store**                                                                                                      \n
+  * KV Store занимает две области (ADDR_KV_AREA_A, ADDR_KV_AREA_B) по MEMSIZE_KV_AREA Kbyte.                                \n
+  * В каждый момент одна область активна, вторая - резервная. Когда запись не помещается в активную область,         \n
+  * действительные записи всех ключей копируются в резервную область (уплотнение), её заголовок записывается           \n
+  * последним, затем прежняя область стирается. При потере питания во время уплотнения остаётся прежняя область,       \n
+  * т.к. заголовок новой не записан; если обе области имеют заголовок, активной считается область с большим номером.   \n
+  * | Слово                 | Смещение в области | Содержимое                                        |
+  * | --------------------- | :----------------: | :-----------------------------------------------: |
+  * | Номер области         | 0                  | Увеличивается на 1 при каждом уплотнении          |
+  * | Слово состояния       | 1                  | KV_AREA_VALID (записывается последним)            |
+  * | Записи                | 2 ...              | Записи KV Store без пропусков                     |
+  * \n
+  *
+  * **Запись KV Store**
+  * | Слово                 | Смещение в записи  | Содержимое                                        |
+  * | --------------------- | :----------------: | :-----------------------------------------------: |
+  * | Заголовок             | 0                  | Ключ (биты 0-15), длина значения в байтах (16-31) |
+  * | Значение              | 1 ... n            | Значение, дополненное до слова байтами 0xFF       |
+  * | Слово состояния       | n + 1              | KV_RECORD_VALID (записывается последним)          |
+  *
+  * Стёртый заголовок означает конец записей области. Записи без KV_RECORD_VALID пропускаются.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "KV_store.h"
+#include "Flash_geometry.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define KV_AREA_WORDS              (MEMSIZE_KV_AREA * 1024 / 4)               /*!< Размер области KV Store в словах.                 */
+#define KV_AREA_HEADER_WORDS       2U                                          /*!< Размер заголовка области в словах.                */
+#define KV_RECORD_WORDS(Length)    (1U + ((Length) + 3U) / 4U + 1U)           /*!< Размер записи в словах (заголовок + значение + состояние). */
+#define KV_RECORD_WORDS_MAX        KV_RECORD_WORDS(KV_VALUE_MAX)              /*!< Наибольший размер записи в словах.                */
+#define KV_HEADER(Key, Length)     ((uint32_t)(Key) | ((uint32_t)(Length) << 16)) /*!< Заголовок записи.                               */
+#define KV_WORD(Area, Offset)      (*((uint32_t*)(uintptr_t)((Area) + (Offset) * 4)))    /*!< Слово области по смещению в словах.              */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint16_t Index[KV_MAX_KEYS];           /*!< Смещение действительной записи ключа в активной области (в словах), 0 - ключа нет. */
+static uint32_t Active_area = ADDR_KV_AREA_A; /*!< Начальный адрес активной области.                                                 */
+static uint32_t Area_seq    = 0;              /*!< Номер активной области.                                                           */
+static uint32_t Free_offset = KV_AREA_WORDS;  /*!< Смещение первого свободного слова активной области.                               */
+static uint32_t Record[KV_RECORD_WORDS_MAX];  /*!< Буфер записи.                                                                     */
+static uint8_t  Ready       = 0;              /*!< 1 - Init_KV_store выполнена, области KV Store во FLASH платы.                      */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static void         Area_scan    (void);
+static flash_status Compact      (void);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Выбор активной области KV Store и построение индекса.
+  * @details Активная область - область с KV_AREA_VALID и наибольшим номером. \n
+  *          Если действительных областей нет, область A стирается и размечается как активная.
+  * @return  flash status: FLASH_WROG_ADDRES - области KV Store не помещаются во FLASH платы (хранилище отключено).
+  */
+flash_status Init_KV_store (void)
+{
+uint8_t      valid_a;
+uint8_t      valid_b;
+uint32_t     header[KV_AREA_HEADER_WORDS] = {0, KV_AREA_VALID};
+flash_status state = FLASH_OK;
+
+Ready = 0;
+if ( !Area_in_flash(ADDR_KV_AREA_A, MEMSIZE_KV_AREA * 1024) || !Area_in_flash(ADDR_KV_AREA_B, MEMSIZE_KV_AREA * 1024) )
+  return FLASH_WROG_ADDRES;
+
+valid_a = (KV_WORD(ADDR_KV_AREA_A, 1) == KV_AREA_VALID);
+valid_b = (KV_WORD(ADDR_KV_AREA_B, 1) == KV_AREA_VALID);
+if (valid_a && valid_b)
+  Active_area = ((int32_t)(KV_WORD(ADDR_KV_AREA_B, 0) - KV_WORD(ADDR_KV_AREA_A, 0)) > 0) ? ADDR_KV_AREA_B : ADDR_KV_AREA_A;
+else if (valid_b)
+  Active_area = ADDR_KV_AREA_B;
+else
+  Active_area = ADDR_KV_AREA_A;
+
+if (!valid_a && !valid_b) // Чистое хранилище.
+  {
+  state = Erase_Area_of_flash(ADDR_KV_AREA_A, MEMSIZE_KV_AREA * 1024);
+  if (state == FLASH_OK)
+    state = Write_Words_to_flash(ADDR_KV_AREA_A, KV_AREA_HEADER_WORDS, header);
+  }
+
+Area_scan();
+Ready = 1;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись значения ключа.
+  * @details Запись дописывается в активную область. Если значение совпадает с текущим, запись не выполняется. \n
+  *          Если запись не помещается, выполняется уплотнение (Compact).
+  * @param   Key    - ключ (0 ... KV_MAX_KEYS-1).
+  * @param   Value  - указатель на значение.
+  * @param   Length - длина значения в байтах (0 ... KV_VALUE_MAX), 0 - удаление ключа.
+  * @return  flash status: FLASH_OK, FLASH_ERROR (в том числе - не хватает места после уплотнения или хранилище
+  *          не инициализировано), FLASH_WROG_ADDRES - неверный ключ или длина, FLASH_BUSY - банк занят асинхронной записью.
+  */
+flash_status Write_KV_to_flash (uint16_t Key, const void *Value, uint16_t Length)
+{
+const uint8_t *src = (const uint8_t*)Value;
+const uint8_t *current;
+uint16_t       current_length;
+uint32_t       words = KV_RECORD_WORDS(Length);
+flash_status   state;
+
+if ( (Key >= KV_MAX_KEYS) || (Length > KV_VALUE_MAX) )
+  return FLASH_WROG_ADDRES;
+if (!Ready)
+  return FLASH_ERROR;
+
+current = (const uint8_t*)Get_KV_from_flash(Key, &current_length);
+if ( (Length == 0) && (current == 0) )
+  return FLASH_OK; // Ключа нет - удалять нечего.
+if ( (current != 0) && (current_length == Length) )
+  {
+  uint16_t i = 0;
+  while ( (i < Length) && (current[i] == src[i]) )
+    i++;
+  if (i == Length)
+    return FLASH_OK; // Значение не изменилось.
+  }
+
+if ( (Free_offset + words > KV_AREA_WORDS) || !Words_blank_in_flash(Active_area + Free_offset * 4, words) )
+  {
+  state = Compact();
+  if (state != FLASH_OK)
+    return state;
+  if (Free_offset + words > KV_AREA_WORDS)
+    return FLASH_ERROR;
+  }
+
+for (uint32_t i = 1; i < words - 1; i++)
+  {
+  Record[i] = BLANK_WORD;
+  }
+for (uint16_t i = 0; i < Length; i++)
+  {
+  ((uint8_t*)&Record[1])[i] = src[i];
+  }
+Record[0]         = KV_HEADER(Key, Length);
+Record[words - 1] = KV_RECORD_VALID;
+
+state = Write_Words_to_flash(Active_area + Free_offset * 4, words, Record);
+if (state == FLASH_BUSY)
+  return state;
+if (state == FLASH_OK)
+  Index[Key] = (Length != 0) ? (uint16_t)Free_offset : 0;
+Free_offset += words; // Незавершённая запись пропускается при просмотре области.
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Удаление ключа.
+  * @param   Key - ключ (0 ... KV_MAX_KEYS-1).
+  * @return  flash status (см. Write_KV_to_flash).
+  */
+flash_status Delete_KV_from_flash (uint16_t Key)
+{
+return Write_KV_to_flash(Key, 0, 0);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Чтение значения ключа.
+  * @param   Key   - ключ.
+  * @param   Value - указатель на буфер для значения.
+  * @param   Size  - размер буфера в байтах (копируется не больше Size байт).
+  * @return  uint16_t - длина значения в байтах, 0 - ключа нет.
+  */
+uint16_t Read_KV_from_flash (uint16_t Key, void *Value, uint16_t Size)
+{
+uint16_t       length;
+const uint8_t *src = (const uint8_t*)Get_KV_from_flash(Key, &length);
+
+if (src == 0)
+  return 0;
+for (uint16_t i = 0; (i < length) && (i < Size); i++)
+  {
+  ((uint8_t*)Value)[i] = src[i];
+  }
+return length;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Указатель на значение ключа во FLASH.
+  * @details Указатель действителен до следующей Write_KV_to_flash (уплотнение стирает область).
+  * @param   Key    - ключ.
+  * @param   Length - указатель для длины значения в байтах (может быть 0).
+  * @return  const void* - указатель на значение во FLASH, 0 - ключа нет.
+  */
+const void* Get_KV_from_flash (uint16_t Key, uint16_t *Length)
+{
+uint32_t offset;
+
+if ( (Key >= KV_MAX_KEYS) || (Index[Key] == 0) )
+  return 0;
+
+offset = Index[Key];
+if (Length != 0)
+  *Length = (uint16_t)(KV_WORD(Active_area, offset) >> 16);
+return (const void*)(uintptr_t)(Active_area + (offset + 1) * 4);
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Свободное место в активной области.
+  * @return  uint32_t - размер свободной части активной области в байтах (без уплотнения).
+  */
+uint32_t Get_KV_free_space (void)
+{
+return (KV_AREA_WORDS - Free_offset) * 4;
+}
+//------------------------------------------------------------------------------//
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Просмотр активной области и построение индекса.
+  * @details Записи просматриваются до стёртого заголовка. Если заголовок повреждён (длина больше KV_VALUE_MAX \n
+  *          или запись выходит за область), свободное место считается исчерпанным: следующая запись выполнит уплотнение.
+  * @return  None.
+  */
+static void Area_scan (void)
+{
+uint32_t offset = KV_AREA_HEADER_WORDS;
+uint32_t header;
+uint32_t key;
+uint32_t length;
+uint32_t words;
+
+for (uint32_t i = 0; i < KV_MAX_KEYS; i++)
+  {
+  Index[i] = 0;
+  }
+Area_seq = KV_WORD(Active_area, 0);
+
+while (offset < KV_AREA_WORDS)
+  {
+  header = KV_WORD(Active_area, offset);
+  if (header == BLANK_WORD)
+    break;
+
+  key    = header & 0xFFFFU;
+  length = header >> 16;
+  words  = KV_RECORD_WORDS(length);
+  if ( (length > KV_VALUE_MAX) || (offset + words > KV_AREA_WORDS) )
+    {
+    offset = KV_AREA_WORDS;
+    break;
+    }
+  if ( (KV_WORD(Active_area, offset + words - 1) == KV_RECORD_VALID) && (key < KV_MAX_KEYS) )
+    Index[key] = (length != 0) ? (uint16_t)offset : 0;
+  offset += words;
+  }
+Free_offset = offset;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Уплотнение KV Store.
+  * @details Резервная область стирается, в неё копируются действительные записи всех ключей, затем записывается \n
+  *          заголовок области и она становится активной; прежняя область стирается.
+  * @return  flash status: FLASH_ERROR - записи не помещаются в область или ошибка FLASH (активная область не изменяется).
+  */
+static flash_status Compact (void)
+{
+uint32_t     spare = (Active_area == ADDR_KV_AREA_A) ? ADDR_KV_AREA_B : ADDR_KV_AREA_A;
+uint32_t     old   = Active_area;
+uint32_t     dst   = KV_AREA_HEADER_WORDS;
+uint32_t     header[KV_AREA_HEADER_WORDS] = {Area_seq + 1, KV_AREA_VALID};
+uint32_t     words;
+flash_status state;
+
+if (header[0] == BLANK_WORD) // Номер области не должен совпадать со значением стёртого слова.
+  header[0] = 0;
+state = Erase_Area_of_flash(spare, MEMSIZE_KV_AREA * 1024);
+
+for (uint32_t key = 0; (key < KV_MAX_KEYS) && (state == FLASH_OK); key++)
+  {
+  if (Index[key] == 0)
+    continue;
+  words = KV_RECORD_WORDS(KV_WORD(old, Index[key]) >> 16);
+  if (dst + words > KV_AREA_WORDS)
+    return FLASH_ERROR;
+  state = Write_Words_to_flash(spare + dst * 4, words, (uint32_t*)(uintptr_t)(old + Index[key] * 4));
+  dst  += words;
+  }
+if (state == FLASH_OK)
+  state = Write_Words_to_flash(spare, KV_AREA_HEADER_WORDS, header);
+if (state != FLASH_OK)
+  return state;
+
+Active_area = spare;
+Area_scan();
+Erase_Area_of_flash(old, MEMSIZE_KV_AREA * 1024); // Ошибка стирания не критична: область стирается перед следующим уплотнением.
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
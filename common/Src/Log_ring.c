@@ -0,0 +1,366 @@
+/**
+  ******************************************************************************
+  *
+  * @file      Log_ring.c
+  *
+  * @brief     Кольцевой журнал записей фиксированного размера во FLASH.
+  *
+  * @details   Журнал занимает диапазон страниц FLASH (например, ADDR_LOG_AREA, MEMSIZE_LOG_AREA - см. FLASH.h).       \n
+  *            Записи дописываются подряд, страницы заполняются по кругу, поэтому все страницы стираются одинаково часто.
+  *
+  * **Manual**                                                                                                                \n
+  * В модуле реализованы следующие функции:
+  * - Init_Log_ring (uint32_t Address, uint16_t Pages, uint16_t Record_size) - выбор диапазона страниц и размера записи, \n
+  *   поиск начала и конца журнала. Вызывается один раз при старте, до остальных функций модуля.                          \n
+  *   Если в диапазоне нет страниц журнала с тем же размером записи, диапазон стирается.                                   \n
+  *
+  * - Append_Log_to_flash (const void *Record) - запись в конец журнала: адрес записи известен, просмотр FLASH          \n
+  *   не выполняется. При переходе на следующую страницу стирается страница за ней (самая старая),                       \n
+  *   поэтому впереди конца журнала всегда есть одна стёртая страница.                                                     \n
+  *
+  * - Get_Log_count (void), Read_Log_from_flash (uint32_t Index, void *Record) - количество записей и чтение записи       \n
+  *   по номеру: 0 - самая старая, Get_Log_count() - 1 - самая новая.                                                      \n
+  *
+  * Функции модуля вызываются из основной программы (не из прерываний). Запись во FLASH выполняется функциями       \n
+  * Write_Words_to_flash и Erase_Area_of_flash (FLASH.c), поэтому при асинхронной записи в тот же банк возвращается    \n
+  * FLASH_BUSY. Диапазон страниц не должен пересекаться с другими областями и переходить границу банков.
+  *
+  * **Страница журнала**
+  * | Слово                 | Смещение в странице | Содержимое                                         |
+  * | --------------------- | :-----------------: | :------------------------------------------------: |
+  * | Номер страницы        | 0                   | Увеличивается на 1 при переходе на следующую       |
+  * | Слово состояния       | 1                   | LOG_PAGE_TAG(Record_size) (записывается последним) |
+  * | Записи                | 2 ...               | Записи журнала без пропусков                       |
+  *
+  * **Запись журнала**
+  * | Слово                 | Смещение в записи   | Содержимое                                         |
+  * | --------------------- | :-----------------: | :------------------------------------------------: |
+  * | Данные                | 0 ... n - 1         | Запись, дополненная до слова байтами 0xFF          |
+  * | Слово состояния       | n                   | LOG_RECORD_VALID (записывается последним)          |
+  *
+  * Конец журнала - страница с наибольшим номером и первая стёртая запись на ней. Запись, прерванная потерей питания, \n
+  * пропускается при записи и возвращает FLASH_ERROR при чтении.                                                           \n
+  * Страницы заполняются по кругу, поэтому страницы текущего круга (от первой страницы диапазона до конца журнала)      \n
+  * имеют возрастающие номера, а записи на странице занимают её начало без пропусков. Init_Log_ring находит конец        \n
+  * журнала двоичным поиском сначала по заголовкам страниц, затем по записям страницы: при 512 страницах читается        \n
+  * около 10 заголовков и 7 записей вместо всех заголовков и записей.
+  *
+  * @copyright Copyright (C) 2022 Awada Systems. Все права защищены.
+  *
+  * @author    Larionov A.S. (larion.alex@mail.ru)
+  *
+  ******************************************************************************
+**/
+
+//---Includes-------------------------------------------------------------------//
+#include "Log_ring.h"
+#include "Flash_geometry.h"
+//------------------------------------------------------------------------------//
+
+//---Private macros-------------------------------------------------------------//
+#define LOG_HEADER_WORDS           2U                                                        /*!< Размер заголовка страницы в словах.            */
+#define LOG_SLOT_WORDS(Size)       (((Size) + 3U) / 4U + 1U)                                 /*!< Размер записи в словах (данные + состояние).   */
+#define LOG_PAGE_ADDR(Page)        (Base + (uint32_t)(Page) * Page_size)                     /*!< Начальный адрес страницы журнала.              */
+#define LOG_SLOT_ADDR(Page, Slot)  (LOG_PAGE_ADDR(Page) + (LOG_HEADER_WORDS + (uint32_t)(Slot) * Slot_words) * 4) /*!< Адрес записи на странице. */
+#define LOG_WORD(Address)          (*((uint32_t*)(uintptr_t)(Address)))                      /*!< Слово FLASH по адресу.                         */
+//------------------------------------------------------------------------------//
+
+//---Private variables----------------------------------------------------------//
+static uint32_t Base          = 0;                                 /*!< Начальный адрес диапазона страниц журнала.                 */
+static uint32_t Page_size     = 0;                                 /*!< Размер страницы в байтах.                                  */
+static uint16_t Pages_num     = 0;                                 /*!< Количество страниц журнала.                                */
+static uint16_t Record_bytes  = 0;                                 /*!< Размер записи в байтах.                                    */
+static uint16_t Slot_words    = 0;                                 /*!< Размер записи во FLASH в словах.                           */
+static uint16_t Slots_in_page = 0;                                 /*!< Количество записей на странице.                            */
+static uint16_t Head_page     = 0;                                 /*!< Страница конца журнала (запись новых записей).             */
+static uint16_t Head_slot     = 0;                                 /*!< Номер первой свободной записи на странице конца журнала.   */
+static uint16_t Tail_page     = 0;                                 /*!< Страница начала журнала (самые старые записи).             */
+static uint32_t Head_seq      = 0;                                 /*!< Номер страницы конца журнала.                              */
+static uint8_t  Ready         = 0;                                 /*!< 1 - Init_Log_ring выполнена успешно.                       */
+static uint32_t Slot[LOG_SLOT_WORDS(LOG_RECORD_MAX)];              /*!< Буфер записи.                                              */
+//------------------------------------------------------------------------------//
+
+//---Function prototypes--------------------------------------------------------//
+static flash_status Format       (void);
+static flash_status Next_page    (void);
+static uint8_t      Page_valid   (uint16_t Page);
+static uint16_t     Find_head    (uint16_t First);
+static uint16_t     Find_slot    (uint16_t Page);
+static uint16_t     Page_after   (uint16_t Page);
+//------------------------------------------------------------------------------//
+
+//---Exported functions---------------------------------------------------------//
+/**
+  * @brief   Выбор диапазона страниц журнала и поиск его начала и конца.
+  * @details Конец журнала - страница с наибольшим номером (Find_head) и первая свободная запись на ней (Find_slot), \n
+  *          начало - первая размеченная страница через одну или две после неё (если журнал уже заполнялся по кругу),  \n
+  *          иначе первая страница диапазона. Содержимое страниц вне конца журнала не просматривается.
+  * @param   Address     - начальный адрес первой страницы журнала.
+  * @param   Pages       - количество страниц (не менее 3).
+  * @param   Record_size - размер записи в байтах (1 ... LOG_RECORD_MAX).
+  * @return  flash status: FLASH_WROG_ADDRES - неверный диапазон или размер записи.
+  */
+flash_status Init_Log_ring (uint32_t Address, uint16_t Pages, uint16_t Record_size)
+{
+uint32_t     page_size = Get_Page_Size_of_flash(Address);
+uint16_t     first     = 0;
+uint16_t     tail;
+
+Ready = 0;
+if ( (Pages < 3) || (Record_size == 0) || (Record_size > LOG_RECORD_MAX) || (Address < PAGE0_ADDR)        ||
+     ((Address - PAGE0_ADDR) % page_size != 0) || (Get_Page_Size_of_flash(Address + Pages * page_size - 1) != page_size) ||
+     !Area_in_flash(Address, Pages * page_size) )
+  return FLASH_WROG_ADDRES;
+
+Base          = Address;
+Page_size     = page_size;
+Pages_num     = Pages;
+Record_bytes  = Record_size;
+Slot_words    = LOG_SLOT_WORDS(Record_size);
+Slots_in_page = (uint16_t)((page_size / 4 - LOG_HEADER_WORDS) / Slot_words);
+
+// Перед страницами текущего круга может быть не больше двух стёртых страниц (Next_page прерван после стирания).
+while ( (first < 3) && !Page_valid(first) )
+  {
+  first++;
+  }
+if (first == 3) // Чистый журнал.
+  return Format();
+
+Head_page = Find_head(first);
+Head_seq  = LOG_WORD(LOG_PAGE_ADDR(Head_page));
+Head_slot = Find_slot(Head_page);
+
+tail = Page_after(Page_after(Head_page));
+if (!Page_valid(tail)) // Стирание самой старой страницы выполнено, заголовок следующей не записан.
+  tail = Page_after(tail);
+Tail_page = Page_valid(tail) ? tail : 0;
+Ready     = 1;
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Запись в конец журнала.
+  * @details Если страница заполнена, журнал переходит на следующую (Next_page). \n
+  *          Запись, место которой не стёрто (прерванная запись), пропускается.
+  * @param   Record - указатель на запись (Record_size байт из Init_Log_ring).
+  * @return  flash status: FLASH_ERROR - журнал не инициализирован или ошибка FLASH,
+  *          FLASH_BUSY - банк занят асинхронной записью (запись не выполнена).
+  */
+flash_status Append_Log_to_flash (const void *Record)
+{
+flash_status state;
+
+if (!Ready)
+  return FLASH_ERROR;
+
+do
+  {
+  if (Head_slot >= Slots_in_page)
+    {
+    state = Next_page();
+    if (state != FLASH_OK)
+      return state;
+    }
+  if (Words_blank_in_flash(LOG_SLOT_ADDR(Head_page, Head_slot), Slot_words))
+    break;
+  Head_slot++;
+  } while (1);
+
+Slot[Slot_words - 2] = BLANK_WORD; // Дополнение последнего слова данных.
+for (uint16_t i = 0; i < Record_bytes; i++)
+  {
+  ((uint8_t*)Slot)[i] = ((const uint8_t*)Record)[i];
+  }
+Slot[Slot_words - 1] = LOG_RECORD_VALID;
+
+state = Write_Words_to_flash(LOG_SLOT_ADDR(Head_page, Head_slot), Slot_words, Slot);
+if (state != FLASH_BUSY)
+  Head_slot++;
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Чтение записи журнала по номеру.
+  * @details Адрес записи вычисляется по номеру, просмотр FLASH не выполняется.
+  * @param   Index  - номер записи: 0 - самая старая, Get_Log_count() - 1 - самая новая.
+  * @param   Record - указатель на буфер для записи (Record_size байт).
+  * @return  flash status: FLASH_OK, FLASH_ERROR - запись повреждена (прервана потерей питания),
+  *          FLASH_WROG_ADDRES - записи с таким номером нет.
+  */
+flash_status Read_Log_from_flash (uint32_t Index, void *Record)
+{
+uint32_t address;
+
+if ( !Ready || (Index >= Get_Log_count()) )
+  return FLASH_WROG_ADDRES;
+
+address = LOG_SLOT_ADDR((Tail_page + Index / Slots_in_page) % Pages_num, Index % Slots_in_page);
+if (LOG_WORD(address + (Slot_words - 1) * 4) != LOG_RECORD_VALID)
+  return FLASH_ERROR;
+for (uint16_t i = 0; i < Record_bytes; i++)
+  {
+  ((uint8_t*)Record)[i] = ((const uint8_t*)(uintptr_t)address)[i];
+  }
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Количество записей журнала.
+  * @return  uint32_t - количество записей от начала до конца журнала (включая прерванные).
+  */
+uint32_t Get_Log_count (void)
+{
+if (!Ready)
+  return 0;
+return (uint32_t)((Head_page + Pages_num - Tail_page) % Pages_num) * Slots_in_page + Head_slot;
+}
+//------------------------------------------------------------------------------//
+
+//---Private functions----------------------------------------------------------//
+/**
+  * @brief   Разметка чистого журнала.
+  * @details Диапазон стирается (стёртые страницы пропускаются), на первую страницу записывается заголовок с номером 0.
+  * @return  flash status.
+  */
+static flash_status Format (void)
+{
+uint32_t     header[LOG_HEADER_WORDS] = {0, LOG_PAGE_TAG(Record_bytes)};
+flash_status state;
+
+Head_page = 0;
+Head_slot = 0;
+Tail_page = 0;
+Head_seq  = 0;
+
+state = Erase_Area_of_flash(Base, Pages_num * Page_size);
+if (state == FLASH_OK)
+  state = Write_Words_to_flash(LOG_PAGE_ADDR(0), LOG_HEADER_WORDS, header);
+Ready = (state == FLASH_OK);
+return state;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Переход конца журнала на следующую страницу.
+  * @details Сначала стирается страница после следующей (самая старая, начало журнала сдвигается), затем         \n
+  *          записывается заголовок следующей страницы. Следующая страница уже стёрта при переходе на текущую:     \n
+  *          она стирается повторно, только если её стирание было прервано (уже стёртые страницы пропускаются).   \n
+  *          При потере питания между этими операциями Init_Log_ring находит прежний конец журнала.
+  * @return  flash status.
+  */
+static flash_status Next_page (void)
+{
+uint16_t     next   = Page_after(Head_page);
+uint16_t     ahead  = Page_after(next);
+uint32_t     header[LOG_HEADER_WORDS] = {Head_seq + 1, LOG_PAGE_TAG(Record_bytes)};
+flash_status state;
+
+if (header[0] == BLANK_WORD) // Номер страницы не должен совпадать со значением стёртого слова.
+  header[0] = 0;
+
+state = Erase_Area_of_flash(LOG_PAGE_ADDR(ahead), Page_size);
+if (state == FLASH_OK)
+  state = Erase_Area_of_flash(LOG_PAGE_ADDR(next), Page_size);
+if (state != FLASH_OK)
+  return state;
+if (Tail_page == ahead)
+  Tail_page = Page_after(ahead);
+
+state = Write_Words_to_flash(LOG_PAGE_ADDR(next), LOG_HEADER_WORDS, header);
+if (state != FLASH_OK)
+  return state;
+
+Head_page = next;
+Head_seq  = header[0];
+Head_slot = 0;
+return FLASH_OK;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Проверка заголовка страницы журнала.
+  * @param   Page - номер страницы в диапазоне журнала.
+  * @return  uint8_t - 1, если страница размечена для записей текущего размера.
+  */
+static uint8_t Page_valid (uint16_t Page)
+{
+return (LOG_WORD(LOG_PAGE_ADDR(Page) + 4) == LOG_PAGE_TAG(Record_bytes));
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Двоичный поиск страницы конца журнала.
+  * @details Страницы First ... Pages_num-1 начинаются страницами текущего круга с номерами не меньше номера First, \n
+  *          за ними следуют стёртые страницы и страницы прошлого круга с меньшими номерами.                         \n
+  *          Ищется последняя страница текущего круга.
+  * @param   First - первая размеченная страница диапазона (0 ... 2).
+  * @return  uint16_t - номер страницы конца журнала.
+  */
+static uint16_t Find_head (uint16_t First)
+{
+uint32_t first_seq = LOG_WORD(LOG_PAGE_ADDR(First));
+uint16_t low       = First;         // Страница текущего круга.
+uint16_t high      = Pages_num;     // Первая страница вне текущего круга (Pages_num - нет таких).
+uint16_t middle;
+
+while (high - low > 1)
+  {
+  middle = low + (high - low) / 2;
+  if ( Page_valid(middle) && ((int32_t)(LOG_WORD(LOG_PAGE_ADDR(middle)) - first_seq) >= 0) )
+    low  = middle;
+  else
+    high = middle;
+  }
+return low;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Двоичный поиск первой свободной записи на странице.
+  * @details Записи занимают начало страницы без пропусков: запись, прерванная потерей питания, не стёрта.
+  * @param   Page - номер страницы в диапазоне журнала.
+  * @return  uint16_t - номер первой стёртой записи, Slots_in_page - страница заполнена.
+  */
+static uint16_t Find_slot (uint16_t Page)
+{
+uint16_t low  = 0;              // Первая запись, которая может быть стёртой.
+uint16_t high = Slots_in_page;  // Стёртая запись (Slots_in_page - нет стёртых после low).
+uint16_t middle;
+
+while (low < high)
+  {
+  middle = low + (high - low) / 2;
+  if (Words_blank_in_flash(LOG_SLOT_ADDR(Page, middle), Slot_words))
+    high = middle;
+  else
+    low  = middle + 1;
+  }
+return low;
+}
+//------------------------------------------------------------------------------//
+
+
+/**
+  * @brief   Следующая страница журнала (по кругу).
+  * @param   Page - номер страницы в диапазоне журнала.
+  * @return  uint16_t - номер следующей страницы.
+  */
+static uint16_t Page_after (uint16_t Page)
+{
+return (Page + 1U < Pages_num) ? (uint16_t)(Page + 1U) : 0;
+}
+//------------------------------------------------------------------------------//
+
+
+//***************************************END OF FILE**************************************//
@@ -1,35 +1,155 @@
 #include "GD_32103C-EVAL.h"
 //#include "AT_START_F413_V1.2.h"
 #include "FLASH.h"
+#include "Config_cache.h"
+#include "Erase_counters.h"
+#include "Flash_geometry.h"
+#include "Flash_bench.h"
 
 
-Config_struct Cfg_struct, Cfg_struct_rd;
-Config_struct* Cfg    = &Cfg_struct;
-Config_struct* Cfg_rd = &Cfg_struct_rd;
+Config_struct Cfg_struct;
+Config_struct* Cfg = &Cfg_struct;
+const Config_struct* Cfg_rd;
 
 
-RO_Constants_struct RO_Constants, RO_Constants_rd;
-RO_Constants_struct* RO_Const    = &RO_Constants;
-RO_Constants_struct* RO_Const_rd = &RO_Constants_rd;
+RO_Constants_struct RO_Constants;
+RO_Constants_struct* RO_Const = &RO_Constants;
+const RO_Constants_struct* RO_Const_rd;
+
+
+/*
+  * **Результаты замеров на платах (FLASH_BENCH_BUILD = 1)**
+  * Величина                                      | GD32F103 (GD_32103C-EVAL) | AT32F413 (AT-START-F413) | Условия
+  * --------------------------------------------- | ------------------------- | ------------------------ | -------
+  * Bench_cycles_per_word, FLASH_BATCHED_PROGRAM=0 | не измерено               | не измерено              | 256 слов в стёртую страницу Download Buffer
+  * Bench_cycles_per_word, FLASH_BATCHED_PROGRAM=1 | не измерено               | не измерено              | то же
+  * Bench_irq_latency_max, FLASH_RAMFUNC_MODE=0    | не измерено               | не измерено              | SysTick (Start_Latency_Probe), все замеры FLASH_BENCH_BUILD
+  * Bench_irq_latency_max, FLASH_RAMFUNC_MODE=1    | не измерено               | не измерено              | то же, SysTick приоритета < FLASH_RAM_ISR_PRIO_LIMIT
+  * Bench_crc_hw_cycles                           | не измерено               | не измерено              | Calc_CRC32 записи Config Page (NUM_OF_CONFIG_WORDS + 1 слов), блок CRC
+  * Bench_crc_sw_cycles                           | не измерено               | не измерено              | то же, Calc_CRC32_soft (таблица)
+  * Bench_crc_match                               | не проверено              | не проверено             | 1 - блок CRC и Calc_CRC32_soft совпадают
+  * Bench_region_cycles                           | не измерено               | не измерено              | Calc_Region_CRC32 Main Programm (48 KB), блок CRC по словам
+  * Bench_region_sw_cycles                        | не измерено               | не измерено              | то же, Calc_CRC32_soft
+  * Bench_results[FLASH_BENCH_LZ_UNPACK_16K]      | не измерено               | не измерено              | Unpack_Image_lz: 8 распаковок FLASH_BENCH_LZ_BYTES из Main Programm в RAM
+  * Bench_results[FLASH_BENCH_LOG_INIT]           | не измерено               | не измерено              | Init_Log_ring журнала в FLASH_BENCH_AREA_KB Kbyte Download Buffer
+  *
+  * Замеры на платах не выполнялись: значения выше нужно заполнить по Bench_* после запуска сборки на плате.
+  * Модель FLASH (Host_Flash) задаёт время программирования слова константой (Flash_sim_timing_struct)
+  * и не моделирует накладные расходы ядра, поэтому разность серийного и пословного программирования
+  * на ней не видна: программирование 1024 слов на модели занимает 1024 x Program_word_us независимо от FLASH_BATCHED_PROGRAM.
+  * Задержку прерываний модель не воспроизводит (прерывания FLASH вызываются тестом - Flash_sim_IRQ).
+  * Замеры lz_unpack_16k и log_init на модели всегда равны 0: часы модели (Get_flash_sim_time) учитывают только операции FLASH,
+  * а распаковка и поиск конца журнала только читают память. make bench выводит скорость распаковки и время Init_Log_ring
+  * на ПК, такты ядра измеряются только на плате.
+  * Время расчёта CRC32 при старте на модели не замеряется: блока CRC на ПК нет, Calc_CRC32 - табличный
+  * расчёт Calc_CRC32_soft, и его время на ПК не связано с тактами Cortex-M3/M4.
+*/
+
+
+#if (FLASH_BENCH_BUILD)
+#define BENCH_WORDS 256U /*!< Количество слов для замера времени программирования (1 KB - одна страница на любой плотности). */
+
+uint32_t Bench_words [BENCH_WORDS];
+uint32_t Bench_cycles_per_word = 0; /*!< Тактов ядра на одно слово в Program_Words_to_flash.                        */
+uint32_t Bench_irq_latency_max = 0; /*!< Наибольшая задержка входа в SysTick_Handler (тактов ядра) за время замеров. */
+uint32_t Bench_crc_hw_cycles   = 0; /*!< Тактов ядра на Calc_CRC32 (блок CRC) записи Config Page.                     */
+uint32_t Bench_crc_sw_cycles   = 0; /*!< Тактов ядра на Calc_CRC32_soft (таблица) записи Config Page.                 */
+uint8_t  Bench_crc_match       = 0; /*!< 1 - аппаратный и программный CRC32 совпадают.                                */
+uint32_t Bench_region_cycles   = 0; /*!< Тактов ядра на Calc_Region_CRC32 (Main Programm, 48 KB).                     */
+uint32_t Bench_region_sw_cycles = 0; /*!< Тактов ядра на Calc_CRC32_soft по той же области.                            */
+
+Flash_bench_result_struct Bench_results [FLASH_BENCH_NUM]; /*!< Замеры Run_Flash_bench (такты ядра).                     */
+char                      Bench_report  [512];             /*!< Отчёт CSV о замерах (читается отладчиком из RAM).      */
+Flash_stats_struct        Bench_flash_stats;               /*!< Статистика аппаратного драйвера после замеров.          */
+
+
+/*
+  * Замер времени программирования первой страницы Download Buffer.
+  * Накладные расходы на слово - разность Bench_cycles_per_word для сборок
+  * с FLASH_BATCHED_PROGRAM = 1 (серия) и FLASH_BATCHED_PROGRAM = 0 (пословно).
+  * Счётчик тактов запущен при старте (Start_Latency_Probe).
+*/
+uint32_t Bench_Program_Words (void)
+{
+uint32_t start;
+uint32_t cycles;
+
+for (uint32_t i = 0; i < BENCH_WORDS; i++)
+  {
+  Bench_words[i] = 0xA5A50000U + i;
+  }
+
+Erase_Area_of_flash(ADDR_DOWNLOAD_BUFFER, BENCH_WORDS * 4); // Стирание с учётом в счётчиках стираний.
+Unlock_flash();
+start  = Get_Cycle_Counter();
+Program_Words_to_flash(ADDR_DOWNLOAD_BUFFER, BENCH_WORDS, Bench_words);
+cycles = Get_Cycle_Counter() - start;
+Lock_flash();
+
+return cycles / BENCH_WORDS;
+}
+
+
+/*
+  * Замер времени расчёта CRC32 записи Config Page (номер + параметры):
+  * блок CRC (Calc_CRC32 аппаратного драйвера) и табличный расчёт (Calc_CRC32_soft).
+  * Время проверки при старте - одна запись журнала и RO Constants.
+  * Замер проверки области Main Programm: Calc_Region_CRC32 (блок CRC по словам) и табличный расчёт.
+*/
+void Bench_CRC32 (void)
+{
+uint32_t start;
+uint32_t crc_hw;
+uint32_t crc_sw;
+
+start               = Get_Cycle_Counter();
+crc_hw              = Calc_CRC32(Bench_words, NUM_OF_CONFIG_WORDS + 1);
+Bench_crc_hw_cycles = Get_Cycle_Counter() - start;
+
+start               = Get_Cycle_Counter();
+crc_sw              = Calc_CRC32_soft(Bench_words, NUM_OF_CONFIG_WORDS + 1);
+Bench_crc_sw_cycles = Get_Cycle_Counter() - start;
+
+Bench_crc_match = (crc_hw == crc_sw);
+
+start                  = Get_Cycle_Counter();
+Calc_Region_CRC32(FLASH_REGION_MAIN_PROGRAM);
+Bench_region_cycles    = Get_Cycle_Counter() - start;
+
+start                  = Get_Cycle_Counter();
+Calc_CRC32_soft((const uint32_t*)ADDR_MAIN_PROGRAM, MEMSIZE_MAIN_PROGRAM * 1024 / 4);
+Bench_region_sw_cycles = Get_Cycle_Counter() - start;
+}
+#endif /* FLASH_BENCH_BUILD */
+
 
 int main (void)
 {
 Init_MCU();
+#if (FLASH_RAMFUNC_MODE)
+Init_flash_RAM_mode(); // Таблица векторов в SRAM: SysTick обслуживается во время операций FLASH.
+#endif
+Start_Latency_Probe();
+Init_flash_geometry(); // FLASH_WROG_ADDRES: области, не помещающиеся во FLASH платы, отключены (их модули возвращают FLASH_WROG_ADDRES).
+Init_Erase_counters(); // До первой записи во FLASH: учитываются все стирания (FLASH_WROG_ADDRES - не учитываются).
 
 
 /*
-  * **  Config Page**
-  *                         |       | 0x00 | 0x01 | 0x02 | 0x03
-  * ------------------------------- | ---------- | ---- | ---- | ---- | ---- 
-  *                      | 0x0801F000 | addr | 0xFF | 0xFF | 0xFF
-  *                 | 0x0801F004 | minor| major| 0xFF | 0xFF
-  *                  | 0x0801F008 | minor| major| 0xFF | 0xFF
-  *               | 0x0801F00C | flag | 0xFF | 0xFF | 0xFF
-  *     Modbus | 0x0801F010 | 0xFF | 0xFF | 0xFF | 0xFF
-  *  Modbus  0        | 0x0801F014 | baud | par  | stop | 0xFF
-  *  Modbus  1        | 0x0801F018 | baud | par  | stop | 0xFF
-  *  Modbus  2        | 0x0801F01C | baud | par  | stop | 0xFF
-  *  Modbus  3        | 0x0801F020 | baud | par  | stop | 0xFF
+  * **Карта памяти Config Page**
+  * Параметр                        | Адрес      | 0x00     | 0x01     | 0x02 | 0x03
+  * ------------------------------- | ---------- | -------- | -------- | ---- | ----
+  * Номер записи                    | 0x0801F000 | seq      | seq      | seq  | seq
+  * Адрес модуля                    | 0x0801F004 | addr     | 0xFF     | 0xFF | 0xFF
+  * Скорость CAN                    | 0x0801F008 |          |          |      |
+  * Версия загрузчика               | 0x0801F00C | bl_minor | bl_major | 0xFF | 0xFF
+  * Версия программы                | 0x0801F010 | sw_minor | sw_major | 0xFF | 0xFF
+  * Флаг первого запуска            | 0x0801F014 | flag     | 0xFF     | 0xFF | 0xFF
+  * Не используется в модуле Modbus | 0x0801F018 | 0xFF     | 0xFF     | 0xFF | 0xFF
+  * Параметры Modbus порта 0        | 0x0801F01C | baud     | par      | stop | 0xFF
+  * Параметры Modbus порта 1        | 0x0801F020 | baud     | par      | stop | 0xFF
+  * Параметры Modbus порта 2        | 0x0801F024 | baud     | par      | stop | 0xFF
+  * Параметры Modbus порта 3        | 0x0801F028 | baud     | par      | stop | 0xFF
+  * Слово состояния записи          | 0x0801F02C | st       | st       | st   | st
 */
 
 
@@ -47,13 +167,13 @@ Write_Config_to_flash(Cfg);
 
 
 /*
-  * **  RO Constants**
-  *              |       | 0x00  | 0x01  | 0x02 | 0x03
+  * **Карта памяти RO Constants**
+  * Параметр             | Адрес      | 0x00  | 0x01  | 0x02 | 0x03
   * -------------------- | ---------- | ----- | ----- | ---- | ---- 
-  *             | 0x0801F800 | class | 0xFF  | 0xFF | 0xFF
-  *     | 0x0801F804 | minor | major | 0xFF | 0xFF
-  *   hw    | 0x0801F808 | 0xFF  | 0xFF  | 0xFF | 0xFF
-  *   lw    | 0x0801F810 | 0xFF  | 0xFF  | 0xFF | 0xFF
+  * Тип модуля           | 0x0801F800 | class | 0xFF  | 0xFF | 0xFF
+  * Аппаратная ревизия   | 0x0801F804 | minor | major | 0xFF | 0xFF
+  * Серийный номер hw    | 0x0801F808 | 0xFF  | 0xFF  | 0xFF | 0xFF
+  * Серийный номер lw    | 0x0801F810 | 0xFF  | 0xFF  | 0xFF | 0xFF
 */
 
 
@@ -63,10 +183,33 @@ RO_Const->HardwareRevision.major = 0x56;
 RO_Const->reserved_hrev          = 0xEEEE;
 RO_Const->SerialNumberHW         = 0x789ABCDE;
 RO_Const->SerialNumberLW         = 0xF0F1F2F3;
-Write_Words_to_flash (0x0801F800U, 4, (uint32_t*)RO_Const);
+Write_RO_Constants_to_flash(RO_Const); // RO Constants и CRC32.
 
-Read_Config_from_flash(Cfg_rd);
-Read_RO_Constants_from_flash(RO_Const_rd);
+/*
+  * Серия изменений параметров Modbus через кэш Config Page - одна запись журнала во FLASH.
+*/
+if (Init_Config_cache() != FLASH_OK) // Параметры не сохранялись: значения по умолчанию.
+  Set_Config_AddrModule(1);
+for (uint8_t port = 0; port < NUM_OF_MODBUS_PORTS; port++)
+  {
+  Set_Config_ModbusBaud  (port, 6);
+  Set_Config_ModbusParity(port, 7);
+  Set_Config_ModbusStop  (port, 8);
+  }
+Flush_Config();
+Save_Erase_counters(); // Стирания страниц журнала Config Page и RO Constants.
+
+Cfg_rd      = Get_Config_from_flash();       // Параметры читаются прямо из FLASH, без копии в RAM.
+RO_Const_rd = Get_RO_Constants_from_flash();
+
+#if (FLASH_BENCH_BUILD) // Замеры стирают начало Download Buffer: загруженный образ теряется.
+Bench_cycles_per_word = Bench_Program_Words();
+Bench_CRC32();
+Run_Flash_bench(Get_Cycle_Counter, Bench_results);
+Format_Flash_bench_report(Bench_results, "cycles", Bench_report, sizeof(Bench_report));
+Bench_irq_latency_max = Get_IRQ_Latency_max(); // Сравнить для сборок с FLASH_RAMFUNC_MODE = 0 и 1.
+Get_Flash_stats(&Bench_flash_stats);            // Время операций, таймауты и последняя ошибка (FLASH_STATS = 1).
+#endif
 
 
 while(1)